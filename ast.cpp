@@ -46,13 +46,13 @@ const char *Untyped_AST_Symbol::display_str() const {
     const char *str;
     switch (kind) {
         case Untyped_AST_Kind::Ident: {
-            auto id = dynamic_cast<const Untyped_AST_Ident *>(this);
+            auto id = kind_cast<const Untyped_AST_Ident>(this);
             internal_verify(id, "Failed to cast to Ident* in Untyped_AST_Symbol::debug_str().");
             
             str = id->id.c_str();
         } break;
         case Untyped_AST_Kind::Path: {
-            auto path = dynamic_cast<const Untyped_AST_Path *>(this);
+            auto path = kind_cast<const Untyped_AST_Path>(this);
             internal_verify(path, "Failed to cast to Path* in Untyped_AST_Symbol::debug_str().");
             
             std::ostringstream s;
@@ -77,13 +77,13 @@ bool Untyped_AST_Symbol::matches(const char *symbol) const {
     while (matches) {
         switch (kind) {
             case Untyped_AST_Kind::Ident: {
-                auto id = dynamic_cast<const Untyped_AST_Ident *>(self);
+                auto id = kind_cast<const Untyped_AST_Ident>(self);
                 internal_verify(id, "Failed to cast to Ident* in Untyped_AST_Symbol::matches().");
                 matches = id->id == symbol;
                 return matches;
             } break;
             case Untyped_AST_Kind::Path: {
-                auto path = dynamic_cast<const Untyped_AST_Path *>(self);
+                auto path = kind_cast<const Untyped_AST_Path>(self);
                 internal_verify(path, "Failed to cast to Path* in Untyped_AST_Symbol::matches().");
 
                 if (memcmp(path->lhs->id.c_str(), symbol, path->lhs->id.size()) != 0) {
@@ -107,18 +107,14 @@ bool Untyped_AST_Symbol::matches(const char *symbol) const {
     return matches;
 }
 
-Untyped_AST_Ident::Untyped_AST_Ident(String id, Code_Location location) {
+Untyped_AST_Ident::Untyped_AST_Ident(Symbol id, Code_Location location) {
     kind = Untyped_AST_Kind::Ident;
     this->id = id;
     this->location = location;
 }
 
-Untyped_AST_Ident::~Untyped_AST_Ident() {
-    id.free();
-}
-
 Ref<Untyped_AST> Untyped_AST_Ident::clone() {
-    return Mem.make<Untyped_AST_Ident>(id.clone(), location);
+    return Mem.make<Untyped_AST_Ident>(id, location);
 }
 
 Untyped_AST_Path::Untyped_AST_Path(
@@ -202,18 +198,14 @@ Ref<Untyped_AST> Untyped_AST_Return::clone() {
     return Mem.make<Untyped_AST_Return>(sub ? sub->clone() : nullptr, location);
 }
 
-Untyped_AST_Loop_Control::Untyped_AST_Loop_Control(Untyped_AST_Kind kind, String label, Code_Location location) {
+Untyped_AST_Loop_Control::Untyped_AST_Loop_Control(Untyped_AST_Kind kind, Symbol label, Code_Location location) {
     this->kind = kind;
     this->label = label;
     this->location = location;
 }
 
-Untyped_AST_Loop_Control::~Untyped_AST_Loop_Control() {
-    label.free();
-}
-
 Ref<Untyped_AST> Untyped_AST_Loop_Control::clone() {
-    return Mem.make<Untyped_AST_Loop_Control>(kind, label.clone(), location);
+    return Mem.make<Untyped_AST_Loop_Control>(kind, label, location);
 }
 
 Untyped_AST_Binary::Untyped_AST_Binary(
@@ -324,18 +316,14 @@ Ref<Untyped_AST> Untyped_AST_Struct_Literal::clone() {
     );
 }
 
-Untyped_AST_Builtin::Untyped_AST_Builtin(String id, Code_Location location) {
+Untyped_AST_Builtin::Untyped_AST_Builtin(Symbol id, Code_Location location) {
     this->kind = Untyped_AST_Kind::Builtin;
     this->id = id;
     this->location = location;
 }
 
-Untyped_AST_Builtin::~Untyped_AST_Builtin() {
-    id.free();
-}
-
 Ref<Untyped_AST> Untyped_AST_Builtin::clone() {
-    return Mem.make<Untyped_AST_Builtin>(id.clone(), location);
+    return Mem.make<Untyped_AST_Builtin>(id, location);
 }
 
 Untyped_AST_Builtin_Printlike::Untyped_AST_Builtin_Printlike(
@@ -355,7 +343,7 @@ Ref<Untyped_AST> Untyped_AST_Builtin_Printlike::clone() {
 
 Untyped_AST_Field_Access::Untyped_AST_Field_Access(
     Ref<Untyped_AST> instance,
-    String field_id, 
+    Symbol field_id, 
     Code_Location location)
 {
     this->kind = Untyped_AST_Kind::Field_Access;
@@ -364,12 +352,8 @@ Untyped_AST_Field_Access::Untyped_AST_Field_Access(
     this->location = location;
 }
 
-Untyped_AST_Field_Access::~Untyped_AST_Field_Access() {
-    field_id.free();
-}
-
 Ref<Untyped_AST> Untyped_AST_Field_Access::clone() {
-    return Mem.make<Untyped_AST_Field_Access>(instance->clone(), field_id.clone(), location);
+    return Mem.make<Untyped_AST_Field_Access>(instance->clone(), field_id, location);
 }
 
 bool Untyped_AST_Pattern::are_all_variables_mut() {
@@ -379,12 +363,12 @@ bool Untyped_AST_Pattern::are_all_variables_mut() {
             is_mut = true;
             break;
         case Untyped_AST_Kind::Pattern_Ident: {
-            auto ip = dynamic_cast<Untyped_AST_Pattern_Ident *>(this);
+            auto ip = kind_cast<Untyped_AST_Pattern_Ident>(this);
             internal_verify(ip, "Failed to cast pattern to Pattern_Ident*");
             is_mut = ip->is_mut;
         } break;
         case Untyped_AST_Kind::Pattern_Tuple: {
-            auto tp = dynamic_cast<Untyped_AST_Pattern_Tuple *>(this);
+            auto tp = kind_cast<Untyped_AST_Pattern_Tuple>(this);
             internal_verify(tp, "Failed to cast pattern to Pattern_Tuple*");
             is_mut = true;
             for (auto sub : tp->sub_patterns) {
@@ -407,12 +391,12 @@ bool Untyped_AST_Pattern::are_no_variables_mut() {
             not_mut = true;
             break;
         case Untyped_AST_Kind::Pattern_Ident: {
-            auto ip = dynamic_cast<Untyped_AST_Pattern_Ident *>(this);
+            auto ip = kind_cast<Untyped_AST_Pattern_Ident>(this);
             internal_verify(ip, "Failed to cast pattern to Pattern_Ident*");
             not_mut = !ip->is_mut;
         } break;
         case Untyped_AST_Kind::Pattern_Tuple: {
-            auto tp = dynamic_cast<Untyped_AST_Pattern_Tuple *>(this);
+            auto tp = kind_cast<Untyped_AST_Pattern_Tuple>(this);
             internal_verify(tp, "Failed to cast pattern to Pattern_Tuple*");
             not_mut = true;
             for (auto sub : tp->sub_patterns) {
@@ -437,19 +421,15 @@ Ref<Untyped_AST> Untyped_AST_Pattern_Underscore::clone() {
     return Mem.make<Untyped_AST_Pattern_Underscore>(location);
 }
 
-Untyped_AST_Pattern_Ident::Untyped_AST_Pattern_Ident(bool is_mut, String id, Code_Location location) {
+Untyped_AST_Pattern_Ident::Untyped_AST_Pattern_Ident(bool is_mut, Symbol id, Code_Location location) {
     kind = Untyped_AST_Kind::Pattern_Ident;
     this->is_mut = is_mut;
     this->id = id;
     this->location = location;
 }
 
-Untyped_AST_Pattern_Ident::~Untyped_AST_Pattern_Ident() {
-    id.free();
-}
-
 Ref<Untyped_AST> Untyped_AST_Pattern_Ident::clone() {
-    return Mem.make<Untyped_AST_Pattern_Ident>(is_mut, id.clone(), location);
+    return Mem.make<Untyped_AST_Pattern_Ident>(is_mut, id, location);
 }
 
 Untyped_AST_Pattern_Tuple::Untyped_AST_Pattern_Tuple(Code_Location location) {
@@ -558,7 +538,7 @@ Ref<Untyped_AST> Untyped_AST_While::clone() {
 Untyped_AST_For::Untyped_AST_For(
     Ref<Untyped_AST_Ident> label,
     Ref<Untyped_AST_Pattern> target,
-    String counter,
+    Symbol counter,
     Ref<Untyped_AST> iterable,
     Ref<Untyped_AST_Multiary> body, 
     Code_Location location)
@@ -572,15 +552,11 @@ Untyped_AST_For::Untyped_AST_For(
     this->location = location;
 }
 
-Untyped_AST_For::~Untyped_AST_For() {
-    counter.free();
-}
-
 Ref<Untyped_AST> Untyped_AST_For::clone() {
     return Mem.make<Untyped_AST_For>(
         label->clone().cast<Untyped_AST_Ident>(),
         target->clone().cast<Untyped_AST_Pattern>(),
-        counter.clone(),
+        counter,
         iterable->clone(),
         body->clone().cast<Untyped_AST_Multiary>(), 
         location
@@ -672,58 +648,50 @@ Ref<Untyped_AST> Untyped_AST_Generic_Specification::clone() {
     );
 }
 
-Untyped_AST_Struct_Declaration::Untyped_AST_Struct_Declaration(String id, Code_Location location) {
+Untyped_AST_Struct_Declaration::Untyped_AST_Struct_Declaration(Symbol id, Code_Location location) {
     kind = Untyped_AST_Kind::Struct_Decl;
     this->id = id;
     this->location = location;
 }
 
-Untyped_AST_Struct_Declaration::~Untyped_AST_Struct_Declaration() {
-    id.free();
-}
-
 void Untyped_AST_Struct_Declaration::add_field(
-    String id,
+    Symbol id,
     Ref<Untyped_AST_Type_Signature> type)
 {
     fields.push_back({ id, type });
 }
 
 Ref<Untyped_AST> Untyped_AST_Struct_Declaration::clone() {
-    auto copy = Mem.make<Untyped_AST_Struct_Declaration>(id.clone(), location);
+    auto copy = Mem.make<Untyped_AST_Struct_Declaration>(id, location);
     for (auto &f : fields) {
-        copy->add_field(f.id.clone(), f.type->clone().cast<Untyped_AST_Type_Signature>());
+        copy->add_field(f.id, f.type->clone().cast<Untyped_AST_Type_Signature>());
     }
     return copy;
 }
 
-Untyped_AST_Enum_Declaration::Untyped_AST_Enum_Declaration(String id, Code_Location location) {
+Untyped_AST_Enum_Declaration::Untyped_AST_Enum_Declaration(Symbol id, Code_Location location) {
     this->kind = Untyped_AST_Kind::Enum_Decl;
     this->id = id;
     this->location = location;
 }
 
-Untyped_AST_Enum_Declaration::~Untyped_AST_Enum_Declaration() {
-    id.free();
-}
-
 void Untyped_AST_Enum_Declaration::add_variant(
-    String id,
+    Symbol id,
     Ref<Untyped_AST_Multiary> payload)
 {
     variants.push_back({ id, payload });
 }
 
 Ref<Untyped_AST> Untyped_AST_Enum_Declaration::clone() {
-    auto copy = Mem.make<Untyped_AST_Enum_Declaration>(id.clone(), location);
+    auto copy = Mem.make<Untyped_AST_Enum_Declaration>(id, location);
     for (auto &v : variants) {
-        copy->add_variant(v.id.clone(), v.payload->clone().cast<Untyped_AST_Multiary>());
+        copy->add_variant(v.id, v.payload->clone().cast<Untyped_AST_Multiary>());
     }
     return copy;
 }
 
 Untyped_AST_Trait_Declaration::Untyped_AST_Trait_Declaration(
-    String id, 
+    Symbol id, 
     Ref<Untyped_AST_Multiary> body, 
     Code_Location location)
 {
@@ -733,13 +701,9 @@ Untyped_AST_Trait_Declaration::Untyped_AST_Trait_Declaration(
     this->location = location;
 }
 
-Untyped_AST_Trait_Declaration::~Untyped_AST_Trait_Declaration() {
-    id.free();
-}
-
 Ref<Untyped_AST> Untyped_AST_Trait_Declaration::clone() {
     return Mem.make<Untyped_AST_Trait_Declaration>(
-        id.clone(), 
+        id, 
         body->clone().cast<Untyped_AST_Multiary>(),
         location
     );
@@ -747,7 +711,7 @@ Ref<Untyped_AST> Untyped_AST_Trait_Declaration::clone() {
 
 Untyped_AST_Fn_Declaration_Header::Untyped_AST_Fn_Declaration_Header(
     Untyped_AST_Kind kind, 
-    String id, 
+    Symbol id, 
     Ref<Untyped_AST_Multiary> params, 
     bool varargs, 
     Ref<Untyped_AST_Type_Signature> return_type_signature, 
@@ -761,14 +725,10 @@ Untyped_AST_Fn_Declaration_Header::Untyped_AST_Fn_Declaration_Header(
     this->location = location;
 }
 
-Untyped_AST_Fn_Declaration_Header::~Untyped_AST_Fn_Declaration_Header() {
-    id.free();
-}
-
 Ref<Untyped_AST> Untyped_AST_Fn_Declaration_Header::clone() {
     return Mem.make<Untyped_AST_Fn_Declaration_Header>(
         kind,
-        id.clone(),
+        id,
         params->clone().cast<Untyped_AST_Multiary>(),
         varargs,
         return_type_signature->clone().cast<Untyped_AST_Type_Signature>(),
@@ -778,7 +738,7 @@ Ref<Untyped_AST> Untyped_AST_Fn_Declaration_Header::clone() {
 
 Untyped_AST_Fn_Declaration::Untyped_AST_Fn_Declaration(
     Untyped_AST_Kind kind,
-    String id,
+    Symbol id,
     Ref<Untyped_AST_Multiary> params,
     bool varargs,
     Ref<Untyped_AST_Type_Signature> return_type_signature,
@@ -789,14 +749,10 @@ Untyped_AST_Fn_Declaration::Untyped_AST_Fn_Declaration(
     this->body = body;   
 }
 
-Untyped_AST_Fn_Declaration::~Untyped_AST_Fn_Declaration() {
-    id.free();
-}
-
 Ref<Untyped_AST> Untyped_AST_Fn_Declaration::clone() {
     return Mem.make<Untyped_AST_Fn_Declaration>(
         kind,
-        id.clone(),
+        id,
         params->clone().cast<Untyped_AST_Multiary>(),
         varargs,
         return_type_signature->clone().cast<Untyped_AST_Type_Signature>(),
@@ -829,7 +785,7 @@ Ref<Untyped_AST> Untyped_AST_Impl_Declaration::clone() {
 
 Untyped_AST_Dot_Call::Untyped_AST_Dot_Call(
     Ref<Untyped_AST> receiver,
-    String method_id,
+    Symbol method_id,
     Ref<Untyped_AST_Multiary> args, 
     Code_Location location)
 {
@@ -840,14 +796,10 @@ Untyped_AST_Dot_Call::Untyped_AST_Dot_Call(
     this->location = location;
 }
 
-Untyped_AST_Dot_Call::~Untyped_AST_Dot_Call() {
-    method_id.free();
-}
-
 Ref<Untyped_AST> Untyped_AST_Dot_Call::clone() {
     return Mem.make<Untyped_AST_Dot_Call>(
         receiver->clone(),
-        method_id.clone(),
+        method_id,
         args->clone().cast<Untyped_AST_Multiary>(), 
         location
     );
@@ -864,6 +816,24 @@ Untyped_AST_Import_Declaration::Untyped_AST_Import_Declaration(
     this->location = location;
 }
 
+std::string Untyped_AST_Import_Declaration::filepath() const {
+    std::stringstream s;
+    const Untyped_AST_Symbol *segment = path.as_ptr();
+    while (true) {
+        if (segment->kind == Untyped_AST_Kind::Ident) {
+            auto id = kind_cast<const Untyped_AST_Ident>(segment);
+            s << id->id.c_str() << ".fox";
+            break;
+        }
+        
+        auto path = kind_cast<const Untyped_AST_Path>(segment);
+        s << path->lhs->id.c_str() << "/";
+        
+        segment = path->rhs.as_ptr();
+    }
+    return s.str();
+}
+
 Ref<Untyped_AST> Untyped_AST_Import_Declaration::clone() {
     return Mem.make<Untyped_AST_Import_Declaration>(
         path->clone().cast<Untyped_AST_Symbol>(),
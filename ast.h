@@ -128,6 +128,7 @@ struct Untyped_AST {
 struct Untyped_AST_Bool : public Untyped_AST {
     bool value;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Bool; }
     Untyped_AST_Bool(bool value, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -136,6 +137,7 @@ struct Untyped_AST_Bool : public Untyped_AST {
 struct Untyped_AST_Char : public Untyped_AST {
     char32_t value;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Char; }
     Untyped_AST_Char(char32_t value, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -144,21 +146,31 @@ struct Untyped_AST_Char : public Untyped_AST {
 struct Untyped_AST_Float : public Untyped_AST {
     double value;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Float; }
     Untyped_AST_Float(double value, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
 
 struct Untyped_AST_Symbol : public Untyped_AST {
+    static bool is_kind(Untyped_AST_Kind kind) {
+        switch (kind) {
+            case Untyped_AST_Kind::Ident:
+            case Untyped_AST_Kind::Path:
+                return true;
+            default:
+                return false;
+        }
+    }
     const char *display_str() const;
     bool matches(const char *symbol) const;
 };
 
 struct Untyped_AST_Ident : public Untyped_AST_Symbol {
-    String id;
+    Symbol id;
     
-    Untyped_AST_Ident(String id, Code_Location location);
-    ~Untyped_AST_Ident() override;
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Ident; }
+    Untyped_AST_Ident(Symbol id, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
@@ -167,6 +179,7 @@ struct Untyped_AST_Path : public Untyped_AST_Symbol {
     Ref<Untyped_AST_Ident> lhs;
     Ref<Untyped_AST_Symbol> rhs;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Path; }
     Untyped_AST_Path(Ref<Untyped_AST_Ident> lhs, Ref<Untyped_AST_Symbol> rhs, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -175,6 +188,7 @@ struct Untyped_AST_Path : public Untyped_AST_Symbol {
 struct Untyped_AST_Byte : public Untyped_AST {
     uint8_t value;
 
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Byte; }
     Untyped_AST_Byte(uint8_t value, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -183,6 +197,7 @@ struct Untyped_AST_Byte : public Untyped_AST {
 struct Untyped_AST_Int : public Untyped_AST {
     int64_t value;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Int; }
     Untyped_AST_Int(int64_t value, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -191,6 +206,7 @@ struct Untyped_AST_Int : public Untyped_AST {
 struct Untyped_AST_Str : public Untyped_AST {
     String value;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Str; }
     Untyped_AST_Str(String value, Code_Location location);
     ~Untyped_AST_Str() override;
     Ref<Typed_AST> typecheck(Typer &t) override;
@@ -198,6 +214,7 @@ struct Untyped_AST_Str : public Untyped_AST {
 };
 
 struct Untyped_AST_Nullary : Untyped_AST {
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Noinit; }
     Untyped_AST_Nullary(Untyped_AST_Kind kind, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -206,22 +223,47 @@ struct Untyped_AST_Nullary : Untyped_AST {
 struct Untyped_AST_Unary : public Untyped_AST {
     Ref<Untyped_AST> sub;
     
+    static bool is_kind(Untyped_AST_Kind kind) {
+        switch (kind) {
+            case Untyped_AST_Kind::Negation:
+            case Untyped_AST_Kind::Not:
+            case Untyped_AST_Kind::Address_Of:
+            case Untyped_AST_Kind::Address_Of_Mut:
+            case Untyped_AST_Kind::Deref:
+            case Untyped_AST_Kind::Defer:
+            case Untyped_AST_Kind::Return:
+            case Untyped_AST_Kind::Builtin_Sizeof:
+            case Untyped_AST_Kind::Builtin_Free:
+                return true;
+            default:
+                return false;
+        }
+    }
     Untyped_AST_Unary(Untyped_AST_Kind kind, Ref<Untyped_AST> sub, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
 
 struct Untyped_AST_Return : public Untyped_AST_Unary {
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Return; }
     Untyped_AST_Return(Ref<Untyped_AST> sub, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
 
 struct Untyped_AST_Loop_Control : public Untyped_AST {
-    String label;
+    Symbol label;
 
-    Untyped_AST_Loop_Control(Untyped_AST_Kind kind, String label, Code_Location location);
-    ~Untyped_AST_Loop_Control();
+    static bool is_kind(Untyped_AST_Kind kind) {
+        switch (kind) {
+            case Untyped_AST_Kind::Break:
+            case Untyped_AST_Kind::Continue:
+                return true;
+            default:
+                return false;
+        }
+    }
+    Untyped_AST_Loop_Control(Untyped_AST_Kind kind, Symbol label, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
@@ -230,6 +272,37 @@ struct Untyped_AST_Binary : public Untyped_AST {
     Ref<Untyped_AST> lhs;
     Ref<Untyped_AST> rhs;
     
+    static bool is_kind(Untyped_AST_Kind kind) {
+        switch (kind) {
+            case Untyped_AST_Kind::Addition:
+            case Untyped_AST_Kind::Subtraction:
+            case Untyped_AST_Kind::Multiplication:
+            case Untyped_AST_Kind::Division:
+            case Untyped_AST_Kind::Mod:
+            case Untyped_AST_Kind::Assignment:
+            case Untyped_AST_Kind::Equal:
+            case Untyped_AST_Kind::Not_Equal:
+            case Untyped_AST_Kind::Less:
+            case Untyped_AST_Kind::Less_Eq:
+            case Untyped_AST_Kind::Greater:
+            case Untyped_AST_Kind::Greater_Eq:
+            case Untyped_AST_Kind::And:
+            case Untyped_AST_Kind::Or:
+            case Untyped_AST_Kind::Field_Access_Tuple:
+            case Untyped_AST_Kind::Subscript:
+            case Untyped_AST_Kind::Range:
+            case Untyped_AST_Kind::Inclusive_Range:
+            case Untyped_AST_Kind::Binding:
+            case Untyped_AST_Kind::Invocation:
+            case Untyped_AST_Kind::Match_Arm:
+            case Untyped_AST_Kind::Cast:
+            case Untyped_AST_Kind::Slice:
+            case Untyped_AST_Kind::Builtin_Alloc:
+                return true;
+            default:
+                return false;
+        }
+    }
     Untyped_AST_Binary(Untyped_AST_Kind kind, Ref<Untyped_AST> lhs, Ref<Untyped_AST> rhs, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -248,6 +321,16 @@ struct Untyped_AST_Ternary : public Untyped_AST {
 struct Untyped_AST_Multiary : public Untyped_AST {
     std::vector<Ref<Untyped_AST>> nodes;
     
+    static bool is_kind(Untyped_AST_Kind kind) {
+        switch (kind) {
+            case Untyped_AST_Kind::Block:
+            case Untyped_AST_Kind::Comma:
+            case Untyped_AST_Kind::Tuple:
+                return true;
+            default:
+                return false;
+        }
+    }
     Untyped_AST_Multiary(Untyped_AST_Kind kind, Code_Location location);
     void add(Ref<Untyped_AST> node);
     Ref<Typed_AST> typecheck(Typer &t) override;
@@ -259,6 +342,7 @@ struct Untyped_AST_Array : public Untyped_AST {
     Ref<Value_Type> array_type;
     Ref<Untyped_AST_Multiary> element_nodes;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Array; }
     Untyped_AST_Array(Untyped_AST_Kind kind, size_t count, Ref<Value_Type> array_type, Ref<Untyped_AST_Multiary> element_nodes, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -268,16 +352,17 @@ struct Untyped_AST_Struct_Literal : public Untyped_AST {
     Ref<Untyped_AST_Symbol> struct_id;
     Ref<Untyped_AST_Multiary> bindings;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Struct; }
     Untyped_AST_Struct_Literal(Ref<Untyped_AST_Symbol> struct_id, Ref<Untyped_AST_Multiary> bindings, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
 
 struct Untyped_AST_Builtin : public Untyped_AST {
-    String id;
+    Symbol id;
     
-    Untyped_AST_Builtin(String id, Code_Location location);
-    ~Untyped_AST_Builtin();
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Builtin; }
+    Untyped_AST_Builtin(Symbol id, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
@@ -289,6 +374,7 @@ struct Untyped_AST_Builtin_Printlike : public Untyped_AST {
     } printlike_kind;
     Ref<Untyped_AST> arg;
 
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Builtin_Printlike; }
     Untyped_AST_Builtin_Printlike(Kind kind, Ref<Untyped_AST> arg, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -296,20 +382,34 @@ struct Untyped_AST_Builtin_Printlike : public Untyped_AST {
 
 struct Untyped_AST_Field_Access : public Untyped_AST {
     Ref<Untyped_AST> instance;
-    String field_id;
+    Symbol field_id;
     
-    Untyped_AST_Field_Access(Ref<Untyped_AST> instance, String field_id, Code_Location location);
-    ~Untyped_AST_Field_Access() override;
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Field_Access; }
+    Untyped_AST_Field_Access(Ref<Untyped_AST> instance, Symbol field_id, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
 
 struct Untyped_AST_Pattern : public Untyped_AST {
+    static bool is_kind(Untyped_AST_Kind kind) {
+        switch (kind) {
+            case Untyped_AST_Kind::Pattern_Underscore:
+            case Untyped_AST_Kind::Pattern_Ident:
+            case Untyped_AST_Kind::Pattern_Tuple:
+            case Untyped_AST_Kind::Pattern_Struct:
+            case Untyped_AST_Kind::Pattern_Enum:
+            case Untyped_AST_Kind::Pattern_Value:
+                return true;
+            default:
+                return false;
+        }
+    }
     bool are_all_variables_mut();
     bool are_no_variables_mut();
 };
 
 struct Untyped_AST_Pattern_Underscore : public Untyped_AST_Pattern {
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Pattern_Underscore; }
     Untyped_AST_Pattern_Underscore(Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -317,10 +417,10 @@ struct Untyped_AST_Pattern_Underscore : public Untyped_AST_Pattern {
 
 struct Untyped_AST_Pattern_Ident : public Untyped_AST_Pattern {
     bool is_mut;
-    String id;
+    Symbol id;
     
-    Untyped_AST_Pattern_Ident(bool is_mut, String id, Code_Location location);
-    ~Untyped_AST_Pattern_Ident();
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Pattern_Ident; }
+    Untyped_AST_Pattern_Ident(bool is_mut, Symbol id, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
@@ -328,6 +428,16 @@ struct Untyped_AST_Pattern_Ident : public Untyped_AST_Pattern {
 struct Untyped_AST_Pattern_Tuple : public Untyped_AST_Pattern {
     std::vector<Ref<Untyped_AST_Pattern>> sub_patterns;
     
+    static bool is_kind(Untyped_AST_Kind kind) {
+        switch (kind) {
+            case Untyped_AST_Kind::Pattern_Tuple:
+            case Untyped_AST_Kind::Pattern_Struct:
+            case Untyped_AST_Kind::Pattern_Enum:
+                return true;
+            default:
+                return false;
+        }
+    }
     Untyped_AST_Pattern_Tuple(Code_Location location);
     void add(Ref<Untyped_AST_Pattern> sub);
     Ref<Typed_AST> typecheck(Typer &t) override;
@@ -337,6 +447,7 @@ struct Untyped_AST_Pattern_Tuple : public Untyped_AST_Pattern {
 struct Untyped_AST_Pattern_Struct : public Untyped_AST_Pattern_Tuple {
     Ref<Untyped_AST_Symbol> struct_id;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Pattern_Struct; }
     Untyped_AST_Pattern_Struct(Ref<Untyped_AST_Symbol> struct_id, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -345,6 +456,7 @@ struct Untyped_AST_Pattern_Struct : public Untyped_AST_Pattern_Tuple {
 struct Untyped_AST_Pattern_Enum : public Untyped_AST_Pattern_Tuple {
     Ref<Untyped_AST_Symbol> enum_id;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Pattern_Enum; }
     Untyped_AST_Pattern_Enum(Ref<Untyped_AST_Symbol> enum_id, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -353,6 +465,7 @@ struct Untyped_AST_Pattern_Enum : public Untyped_AST_Pattern_Tuple {
 struct Untyped_AST_Pattern_Value : public Untyped_AST_Pattern {
     Ref<Untyped_AST> value;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Pattern_Value; }
     Untyped_AST_Pattern_Value(Ref<Untyped_AST> value, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -363,6 +476,7 @@ struct Untyped_AST_If : public Untyped_AST {
     Ref<Untyped_AST> then;
     Ref<Untyped_AST> else_;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::If; }
     Untyped_AST_If(Ref<Untyped_AST> cond, Ref<Untyped_AST> then, Ref<Untyped_AST> else_, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -373,6 +487,7 @@ struct Untyped_AST_While : public Untyped_AST {
     Ref<Untyped_AST> condition;
     Ref<Untyped_AST_Multiary> body;
 
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::While; }
     Untyped_AST_While(Ref<Untyped_AST_Ident> label, Ref<Untyped_AST> condition, Ref<Untyped_AST_Multiary> body, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -381,12 +496,12 @@ struct Untyped_AST_While : public Untyped_AST {
 struct Untyped_AST_For : public Untyped_AST {
     Ref<Untyped_AST_Ident> label;
     Ref<Untyped_AST_Pattern> target;
-    String counter;
+    Symbol counter;
     Ref<Untyped_AST> iterable;
     Ref<Untyped_AST_Multiary> body;
     
-    Untyped_AST_For(Ref<Untyped_AST_Ident> label, Ref<Untyped_AST_Pattern> target, String counter, Ref<Untyped_AST> iterable, Ref<Untyped_AST_Multiary> body, Code_Location location);
-    ~Untyped_AST_For();
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::For; }
+    Untyped_AST_For(Ref<Untyped_AST_Ident> label, Ref<Untyped_AST_Pattern> target, Symbol counter, Ref<Untyped_AST> iterable, Ref<Untyped_AST_Multiary> body, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
@@ -395,6 +510,7 @@ struct Untyped_AST_Forever : public Untyped_AST {
     Ref<Untyped_AST_Ident> label;
     Ref<Untyped_AST_Multiary> body;
 
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Forever; }
     Untyped_AST_Forever(Ref<Untyped_AST_Ident> label, Ref<Untyped_AST_Multiary> body, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -405,6 +521,7 @@ struct Untyped_AST_Match : public Untyped_AST {
     Ref<Untyped_AST> default_arm;
     Ref<Untyped_AST_Multiary> arms;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Match; }
     Untyped_AST_Match(Ref<Untyped_AST> cond, Ref<Untyped_AST> default_arm, Ref<Untyped_AST_Multiary> arms, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -413,6 +530,7 @@ struct Untyped_AST_Match : public Untyped_AST {
 struct Untyped_AST_Type_Signature : public Untyped_AST {
     Ref<Value_Type> value_type;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Type_Signature; }
     Untyped_AST_Type_Signature(Ref<Value_Type> value_type, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -424,6 +542,7 @@ struct Untyped_AST_Let : public Untyped_AST {
     Ref<Untyped_AST_Type_Signature> specified_type;
     Ref<Untyped_AST> initializer;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Let; }
     Untyped_AST_Let(bool is_const, Ref<Untyped_AST_Pattern> target, Ref<Untyped_AST_Type_Signature> specified_type, Ref<Untyped_AST> initializer, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -433,6 +552,7 @@ struct Untyped_AST_Generic_Specification : public Untyped_AST {
     Ref<Untyped_AST_Symbol> id;
     Ref<Untyped_AST_Multiary> type_params;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Generic_Specification; }
     Untyped_AST_Generic_Specification(Ref<Untyped_AST_Symbol> id, Ref<Untyped_AST_Multiary> type_params, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -440,54 +560,64 @@ struct Untyped_AST_Generic_Specification : public Untyped_AST {
 
 struct Untyped_AST_Struct_Declaration : public Untyped_AST {
     struct Field {
-        String id;
+        Symbol id;
         Ref<Untyped_AST_Type_Signature> type;
     };
     
-    String id;
+    Symbol id;
     std::vector<Field> fields;
     
-    Untyped_AST_Struct_Declaration(String id, Code_Location location);
-    ~Untyped_AST_Struct_Declaration() override;
-    void add_field(String id, Ref<Untyped_AST_Type_Signature> type);
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Struct_Decl; }
+    Untyped_AST_Struct_Declaration(Symbol id, Code_Location location);
+    void add_field(Symbol id, Ref<Untyped_AST_Type_Signature> type);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
 
 struct Untyped_AST_Enum_Declaration : public Untyped_AST {
     struct Variant {
-        String id;
+        Symbol id;
         Ref<Untyped_AST_Multiary> payload;
     };
     
-    String id;
+    Symbol id;
     std::vector<Variant> variants;
     
-    Untyped_AST_Enum_Declaration(String id, Code_Location location);
-    ~Untyped_AST_Enum_Declaration() override;
-    void add_variant(String id, Ref<Untyped_AST_Multiary> payload);
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Enum_Decl; }
+    Untyped_AST_Enum_Declaration(Symbol id, Code_Location location);
+    void add_variant(Symbol id, Ref<Untyped_AST_Multiary> payload);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
 
 struct Untyped_AST_Trait_Declaration : public Untyped_AST {
-    String id;
+    Symbol id;
     Ref<Untyped_AST_Multiary> body;
 
-    Untyped_AST_Trait_Declaration(String id, Ref<Untyped_AST_Multiary> body, Code_Location location);
-    ~Untyped_AST_Trait_Declaration();
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Trait_Decl; }
+    Untyped_AST_Trait_Declaration(Symbol id, Ref<Untyped_AST_Multiary> body, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
 
 struct Untyped_AST_Fn_Declaration_Header : public Untyped_AST {
-    String id;
+    Symbol id;
     Ref<Untyped_AST_Multiary> params;
     bool varargs;
     Ref<Untyped_AST_Type_Signature> return_type_signature;
 
-    Untyped_AST_Fn_Declaration_Header(Untyped_AST_Kind kind, String id, Ref<Untyped_AST_Multiary> params, bool varargs, Ref<Untyped_AST_Type_Signature> return_type_signature, Code_Location location);
-    ~Untyped_AST_Fn_Declaration_Header();
+    static bool is_kind(Untyped_AST_Kind kind) {
+        switch (kind) {
+            case Untyped_AST_Kind::Fn_Decl_Header:
+            case Untyped_AST_Kind::Method_Decl_Header:
+            case Untyped_AST_Kind::Fn_Decl:
+            case Untyped_AST_Kind::Method_Decl:
+                return true;
+            default:
+                return false;
+        }
+    }
+    Untyped_AST_Fn_Declaration_Header(Untyped_AST_Kind kind, Symbol id, Ref<Untyped_AST_Multiary> params, bool varargs, Ref<Untyped_AST_Type_Signature> return_type_signature, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
@@ -495,8 +625,16 @@ struct Untyped_AST_Fn_Declaration_Header : public Untyped_AST {
 struct Untyped_AST_Fn_Declaration : public Untyped_AST_Fn_Declaration_Header {
     Ref<Untyped_AST_Multiary> body;
     
-    Untyped_AST_Fn_Declaration(Untyped_AST_Kind kind, String id, Ref<Untyped_AST_Multiary> params, bool varargs, Ref<Untyped_AST_Type_Signature> return_type_signature, Ref<Untyped_AST_Multiary> body, Code_Location location);
-    ~Untyped_AST_Fn_Declaration();
+    static bool is_kind(Untyped_AST_Kind kind) {
+        switch (kind) {
+            case Untyped_AST_Kind::Fn_Decl:
+            case Untyped_AST_Kind::Method_Decl:
+                return true;
+            default:
+                return false;
+        }
+    }
+    Untyped_AST_Fn_Declaration(Untyped_AST_Kind kind, Symbol id, Ref<Untyped_AST_Multiary> params, bool varargs, Ref<Untyped_AST_Type_Signature> return_type_signature, Ref<Untyped_AST_Multiary> body, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
@@ -506,6 +644,7 @@ struct Untyped_AST_Impl_Declaration : public Untyped_AST {
     Ref<Untyped_AST_Symbol> for_;
     Ref<Untyped_AST_Multiary> body;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Impl_Decl; }
     Untyped_AST_Impl_Declaration(Ref<Untyped_AST_Symbol> target, Ref<Untyped_AST_Symbol> for_, Ref<Untyped_AST_Multiary> body, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
@@ -514,10 +653,10 @@ struct Untyped_AST_Impl_Declaration : public Untyped_AST {
 struct Untyped_AST_Dot_Call : public Untyped_AST {
     Ref<Untyped_AST> receiver;
     Ref<Untyped_AST_Multiary> args;
-    String method_id;
+    Symbol method_id;
     
-    Untyped_AST_Dot_Call(Ref<Untyped_AST> receiver, String method_id, Ref<Untyped_AST_Multiary> args, Code_Location location);
-    ~Untyped_AST_Dot_Call();
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Dot_Call; }
+    Untyped_AST_Dot_Call(Ref<Untyped_AST> receiver, Symbol method_id, Ref<Untyped_AST_Multiary> args, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
 };
@@ -526,7 +665,10 @@ struct Untyped_AST_Import_Declaration : public Untyped_AST {
     Ref<Untyped_AST_Symbol> path;
     Ref<Untyped_AST_Ident> rename_id;
     
+    static bool is_kind(Untyped_AST_Kind kind) { return kind == Untyped_AST_Kind::Import_Decl; }
     Untyped_AST_Import_Declaration(Ref<Untyped_AST_Symbol> path, Ref<Untyped_AST_Ident> rename_id, Code_Location location);
     Ref<Typed_AST> typecheck(Typer &t) override;
     Ref<Untyped_AST> clone() override;
+    
+    std::string filepath() const; // a::b::c -> a/b/c.fox
 };
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Writes benchmarks/frontend.fox: 100,000 lines of structs, enums, methods and
+# functions that are compiled but barely run, for timing the frontend. Run from
+# the repository root.
+
+awk 'BEGIN {
+	n = 2000
+	print "// Generated by benchmarks/frontend.sh. Compile time of a large program."
+	print ""
+	for (i = 0; i < n; i++) {
+		printf "struct Item%d {\n\ta: int,\n\tb: int,\n}\n\n", i
+		printf "impl Item%d {\n", i
+		print "\tfn sum(self) -> int {\n\t\treturn self.a + self.b;\n\t}\n"
+		print "\tfn scaled(self, n: int) -> int {\n\t\treturn self.a * n - self.b * 1;\n\t}\n}\n"
+		printf "enum Kind%d {\n\tEmpty,\n\tCount(int),\n\tPair(int, int),\n}\n\n", i
+		printf "impl Kind%d {\n", i
+		print "\tfn value(self) -> int {\n\t\tmatch *self {"
+		print "\t\t\tSelf::Empty => return 0;\n\t\t\tSelf::Count(n) => return n + 0;\n\t\t\tSelf::Pair(x, y) => return x * y;"
+		print "\t\t}\n\t\treturn 0;\n\t}\n}\n"
+		printf "fn step%d(n: int) -> int {\n", i
+		print "\tlet mut total = 0;\n\tlet mut i = 0;\n\twhile i < n {\n\t\tif i % 2 == 0 {\n\t\t\ttotal += i * 3;\n\t\t} else {\n\t\t\ttotal -= i;\n\t\t}\n\t\ti += 1;\n\t}"
+		printf "\tlet item = Item%d { a: n, b: total };\n\tlet kind = Kind%d::Pair(n, 0);\n", i, i
+		print "\tlet values = [_]{ n, total, n * 2, total / 3 };\n\tfor v in values {\n\t\ttotal += v;\n\t}"
+		print "\treturn item.sum() + item.scaled(3) + kind.value() + total;\n}\n"
+	}
+	print "let mut total = 0;"
+	for (i = 0; i < n; i += 100) printf "total += step%d(3);\n", i
+	print "@print(total);"
+}' > benchmarks/frontend.fox
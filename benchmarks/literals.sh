@@ -0,0 +1,22 @@
+#!/bin/sh
+# Writes benchmarks/literals.fox: 50,000 distinct string literals and 50,000
+# distinct float constants, for timing how long the constant pool takes to
+# build. Run from the repository root.
+
+awk 'BEGIN {
+	n = 50000
+	print "// Generated by benchmarks/literals.sh. Compile time of a large constant pool."
+	print ""
+	print "let mut count = 0;"
+	print ""
+	print "fn use(s: str) {"
+	print "\tcount += s.len();"
+	print "}"
+	print ""
+	for (i = 0; i < n; i++) printf "const F%d = %d.25;\n", i, i
+	print ""
+	for (i = 0; i < n; i++) printf "use(\"literal number %d\");\n", i
+	print ""
+	print "@print(count);"
+	printf "@print(F0 + F%d);\n", n - 1
+}' > benchmarks/literals.fox
@@ -228,107 +228,107 @@ void builtin_print_enum(Stack &stack, Address arg_start) {
 }
 
 void load_builtins(Interpreter *interp) {
-    interp->builtins.add_builtin("alloc", {
+    interp->builtins.add_builtin(Symbol::intern("alloc"), {
         builtin_alloc,
         value_types::func(value_types::ptr_to(const_cast<Value_Type *>(&value_types::Void)), value_types::Int)
     });
     
-    interp->builtins.add_builtin("<free-ptr>", {
+    interp->builtins.add_builtin(Symbol::intern("<free-ptr>"), {
         builtin_free_pointer,
         value_types::func(value_types::Void, value_types::ptr_to(const_cast<Value_Type *>(&value_types::Void)))
     });
 
-    interp->builtins.add_builtin("<free-slice>", {
+    interp->builtins.add_builtin(Symbol::intern("<free-slice>"), {
         builtin_free_slice,
         value_types::func(value_types::Void, value_types::slice_of(const_cast<Value_Type *>(&value_types::Void)))
     });
 
-    interp->builtins.add_builtin("<free-str>", {
+    interp->builtins.add_builtin(Symbol::intern("<free-str>"), {
         builtin_free_str,
         value_types::func(value_types::Void, value_types::Str)
     });
     
-    interp->builtins.add_builtin("panic", {
+    interp->builtins.add_builtin(Symbol::intern("panic"), {
         builtin_panic,
         value_types::func(value_types::Void, value_types::Str)
     });
 
-    interp->builtins.add_builtin("<puts-byte>", {
+    interp->builtins.add_builtin(Symbol::intern("<puts-byte>"), {
         builtin_puts_byte,
         value_types::func(value_types::Void, value_types::Byte)
     });
 
-    interp->builtins.add_builtin("<puts-bool>", {
+    interp->builtins.add_builtin(Symbol::intern("<puts-bool>"), {
         builtin_puts_bool,
         value_types::func(value_types::Void, value_types::Bool)
     });
     
-    interp->builtins.add_builtin("<puts-char>", {
+    interp->builtins.add_builtin(Symbol::intern("<puts-char>"), {
         builtin_puts_char,
         value_types::func(value_types::Void, value_types::Char)
     });
     
-    interp->builtins.add_builtin("<puts-int>", {
+    interp->builtins.add_builtin(Symbol::intern("<puts-int>"), {
         builtin_puts_int,
         value_types::func(value_types::Void, value_types::Int)
     });
     
-    interp->builtins.add_builtin("<puts-float>", {
+    interp->builtins.add_builtin(Symbol::intern("<puts-float>"), {
         builtin_puts_float,
         value_types::func(value_types::Void, value_types::Float)
     });
     
-    interp->builtins.add_builtin("<puts-str>", {
+    interp->builtins.add_builtin(Symbol::intern("<puts-str>"), {
         builtin_puts_str,
         value_types::func(value_types::Void, value_types::Str)
     });
 
-    interp->builtins.add_builtin("<puts-struct>", {
+    interp->builtins.add_builtin(Symbol::intern("<puts-struct>"), {
         builtin_puts_struct,
         value_types::func(value_types::Void, Value_Type{ Value_Type_Kind::Struct })
     });
 
-    interp->builtins.add_builtin("<puts-enum>", {
+    interp->builtins.add_builtin(Symbol::intern("<puts-enum>"), {
         builtin_puts_enum,
         value_types::func(value_types::Void, Value_Type{ Value_Type_Kind::Enum })
     });
 
-    interp->builtins.add_builtin("<print-byte>", {
+    interp->builtins.add_builtin(Symbol::intern("<print-byte>"), {
         builtin_print_byte,
         value_types::func(value_types::Void, value_types::Byte)
     });
     
-    interp->builtins.add_builtin("<print-bool>", {
+    interp->builtins.add_builtin(Symbol::intern("<print-bool>"), {
         builtin_print_bool,
         value_types::func(value_types::Void, value_types::Bool)
     });
     
-    interp->builtins.add_builtin("<print-char>", {
+    interp->builtins.add_builtin(Symbol::intern("<print-char>"), {
         builtin_print_char,
         value_types::func(value_types::Void, value_types::Char)
     });
     
-    interp->builtins.add_builtin("<print-int>", {
+    interp->builtins.add_builtin(Symbol::intern("<print-int>"), {
         builtin_print_int,
         value_types::func(value_types::Void, value_types::Int)
     });
     
-    interp->builtins.add_builtin("<print-float>", {
+    interp->builtins.add_builtin(Symbol::intern("<print-float>"), {
         builtin_print_float,
         value_types::func(value_types::Void, value_types::Float)
     });
     
-    interp->builtins.add_builtin("<print-str>", {
+    interp->builtins.add_builtin(Symbol::intern("<print-str>"), {
         builtin_print_str,
         value_types::func(value_types::Void, value_types::Str)
     });
 
-    interp->builtins.add_builtin("<print-struct>", {
+    interp->builtins.add_builtin(Symbol::intern("<print-struct>"), {
         builtin_print_struct,
         value_types::func(value_types::Void, Value_Type{ Value_Type_Kind::Struct })
     });
 
-    interp->builtins.add_builtin("<print-enum>", {
+    interp->builtins.add_builtin(Symbol::intern("<print-enum>"), {
         builtin_print_enum,
         value_types::func(value_types::Void, Value_Type{ Value_Type_Kind::Enum })
     });
@@ -14,6 +14,7 @@ typedef void(*Builtin)(struct Stack &stack, Address arg_start);
 struct Builtin_Definition {
     Builtin builtin;
     Value_Type type;
+    Builtin_Index index = 0; // where builtin is in Builtins::table, filled in by add_builtin()
 };
 
 void load_builtins(struct Interpreter *interp);
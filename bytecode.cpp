@@ -0,0 +1,786 @@
+//
+//  bytecode.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "bytecode.h"
+
+#include "definitions.h"
+#include "error.h"
+#include "interpreter.h"
+
+Operand_Layout operand_layout(Opcode op) {
+    switch (op) {
+        case Opcode::Lit_Char:
+            return Operand_Layout::Char;
+        case Opcode::Lit_Byte:
+            return Operand_Layout::Byte;
+        case Opcode::Lit_Int:
+        case Opcode::Lit_Float:
+        case Opcode::Lit_Pointer:
+        case Opcode::Int_Add_Imm:
+        case Opcode::Int_Mul_Imm:
+            return Operand_Layout::Word;
+        case Opcode::Load_Const_String:
+            return Operand_Layout::Constant;
+        case Opcode::Load_Const:
+            return Operand_Layout::Size_Constant;
+
+        case Opcode::Equal:
+        case Opcode::Not_Equal:
+        case Opcode::Move:
+        case Opcode::Move_Push_Pointer:
+        case Opcode::Copy:
+        case Opcode::Load:
+        case Opcode::Pop:
+        case Opcode::Allocate:
+        case Opcode::Clear_Allocate:
+        case Opcode::Return:
+        case Opcode::Variadic_Return:
+        case Opcode::Call:
+        case Opcode::Load_Indexed:
+            return Operand_Layout::Size;
+        case Opcode::Push_Pointer:
+        case Opcode::Push_Global_Pointer:
+        case Opcode::Flush:
+        case Opcode::Inc_Local:
+        case Opcode::Reg_Int_Inc:
+        case Opcode::Reg_Int_Dec:
+            return Operand_Layout::Address;
+        case Opcode::Add_Local:
+            return Operand_Layout::Address_Word;
+        case Opcode::Push_Value:
+        case Opcode::Push_Global_Value:
+        case Opcode::Load_Field_Indirect:
+        case Opcode::Flush_Value:
+            return Operand_Layout::Size_Address;
+
+        case Opcode::Jump:
+        case Opcode::Loop:
+        case Opcode::Jump_True:
+        case Opcode::Jump_False:
+        case Opcode::Jump_True_No_Pop:
+        case Opcode::Jump_False_No_Pop:
+        case Opcode::Int_Lt_Jump_False:
+        case Opcode::Int_Le_Jump_False:
+            return Operand_Layout::Jump;
+        case Opcode::Jump_Long:
+        case Opcode::Loop_Long:
+        case Opcode::Jump_True_Long:
+        case Opcode::Jump_False_Long:
+        case Opcode::Jump_True_No_Pop_Long:
+        case Opcode::Jump_False_No_Pop_Long:
+        case Opcode::Int_Lt_Jump_False_Long:
+        case Opcode::Int_Le_Jump_False_Long:
+            return Operand_Layout::Long_Jump;
+        case Opcode::Call_Builtin:
+            return Operand_Layout::Builtin_Size;
+        case Opcode::Call_Direct:
+        case Opcode::Tail_Call:
+            return Operand_Layout::Function_Size;
+
+        case Opcode::Reg_Address:
+        case Opcode::Reg_Global_Address:
+        case Opcode::Reg_Int_Neg:
+        case Opcode::Reg_Not:
+            return Operand_Layout::Dst_Src;
+        case Opcode::Reg_Move:
+        case Opcode::Reg_Move_Global:
+        case Opcode::Reg_Load:
+        case Opcode::Reg_Store:
+            return Operand_Layout::Size_Dst_Src;
+        case Opcode::Reg_Set:
+            return Operand_Layout::Size_Dst_Word;
+        case Opcode::Reg_Int_Add:
+        case Opcode::Reg_Int_Sub:
+        case Opcode::Reg_Int_Mul:
+        case Opcode::Reg_Int_Div:
+        case Opcode::Reg_Int_Mod:
+        case Opcode::Reg_Float_Add:
+        case Opcode::Reg_Float_Sub:
+        case Opcode::Reg_Float_Mul:
+        case Opcode::Reg_Float_Div:
+        case Opcode::Reg_Int_Less_Than:
+        case Opcode::Reg_Int_Less_Equal:
+        case Opcode::Reg_Int_Greater_Than:
+        case Opcode::Reg_Int_Greater_Equal:
+        case Opcode::Reg_Float_Less_Than:
+        case Opcode::Reg_Float_Less_Equal:
+        case Opcode::Reg_Float_Greater_Than:
+        case Opcode::Reg_Float_Greater_Equal:
+            return Operand_Layout::Dst_Src_Src;
+        case Opcode::Reg_Int_Add_Imm:
+        case Opcode::Reg_Int_Mul_Imm:
+        case Opcode::Reg_Int_Less_Than_Imm:
+        case Opcode::Reg_Int_Less_Equal_Imm:
+        case Opcode::Reg_Int_Greater_Than_Imm:
+        case Opcode::Reg_Int_Greater_Equal_Imm:
+        case Opcode::Reg_Int_Equal_Imm:
+        case Opcode::Reg_Int_Not_Equal_Imm:
+            return Operand_Layout::Dst_Src_Word;
+        case Opcode::Reg_Load_Indexed:
+        case Opcode::Reg_Equal:
+        case Opcode::Reg_Not_Equal:
+            return Operand_Layout::Size_Dst_Src_Src;
+        case Opcode::Reg_Jump_True:
+        case Opcode::Reg_Jump_False:
+            return Operand_Layout::Address_Jump;
+        case Opcode::Reg_Jump_True_Long:
+        case Opcode::Reg_Jump_False_Long:
+            return Operand_Layout::Address_Long_Jump;
+
+        default:
+            return Operand_Layout::None;
+    }
+}
+
+size_t instruction_size(Opcode op) {
+    size_t operands = 0;
+    switch (operand_layout(op)) {
+        case Operand_Layout::None:
+            break;
+        case Operand_Layout::Char:
+            operands = sizeof(runtime::Char);
+            break;
+        case Operand_Layout::Byte:
+            operands = sizeof(runtime::Byte);
+            break;
+        case Operand_Layout::Word:
+            operands = sizeof(uint64_t);
+            break;
+        case Operand_Layout::Constant:
+            operands = sizeof(Constant_Index);
+            break;
+        case Operand_Layout::Size:
+            operands = sizeof(Size);
+            break;
+        case Operand_Layout::Address:
+            operands = sizeof(Address);
+            break;
+        case Operand_Layout::Size_Address:
+            operands = sizeof(Size) + sizeof(Address);
+            break;
+        case Operand_Layout::Size_Constant:
+            operands = sizeof(Size) + sizeof(Constant_Index);
+            break;
+        case Operand_Layout::Jump:
+            operands = sizeof(Short_Jump);
+            break;
+        case Operand_Layout::Long_Jump:
+            operands = sizeof(Long_Jump);
+            break;
+        case Operand_Layout::Builtin_Size:
+            operands = sizeof(Builtin_Index) + sizeof(Size);
+            break;
+        case Operand_Layout::Function_Size:
+            operands = sizeof(Function_Index) + sizeof(Size);
+            break;
+        case Operand_Layout::Dst_Src:
+            operands = 2 * sizeof(Address);
+            break;
+        case Operand_Layout::Size_Dst_Src:
+            operands = sizeof(Size) + 2 * sizeof(Address);
+            break;
+        case Operand_Layout::Size_Dst_Word:
+            operands = sizeof(Size) + sizeof(Address) + sizeof(uint64_t);
+            break;
+        case Operand_Layout::Address_Word:
+            operands = sizeof(Address) + sizeof(uint64_t);
+            break;
+        case Operand_Layout::Dst_Src_Src:
+            operands = 3 * sizeof(Address);
+            break;
+        case Operand_Layout::Dst_Src_Word:
+            operands = 2 * sizeof(Address) + sizeof(uint64_t);
+            break;
+        case Operand_Layout::Size_Dst_Src_Src:
+            operands = sizeof(Size) + 3 * sizeof(Address);
+            break;
+        case Operand_Layout::Address_Jump:
+            operands = sizeof(Address) + sizeof(Short_Jump);
+            break;
+        case Operand_Layout::Address_Long_Jump:
+            operands = sizeof(Address) + sizeof(Long_Jump);
+            break;
+    }
+    return sizeof(Opcode) + operands;
+}
+
+bool is_jump(Opcode op) {
+    switch (operand_layout(op)) {
+        case Operand_Layout::Jump:
+        case Operand_Layout::Long_Jump:
+        case Operand_Layout::Address_Jump:
+        case Operand_Layout::Address_Long_Jump:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_long_jump(Opcode op) {
+    auto layout = operand_layout(op);
+    return layout == Operand_Layout::Long_Jump || layout == Operand_Layout::Address_Long_Jump;
+}
+
+bool falls_through(Opcode op) {
+    return op != Opcode::Jump &&
+           op != Opcode::Loop &&
+           op != Opcode::Jump_Long &&
+           op != Opcode::Loop_Long &&
+           op != Opcode::Return &&
+           op != Opcode::Variadic_Return &&
+           op != Opcode::Tail_Call;
+}
+
+Opcode long_jump(Opcode op) {
+    switch (op) {
+        case Opcode::Jump:                  return Opcode::Jump_Long;
+        case Opcode::Loop:                  return Opcode::Loop_Long;
+        case Opcode::Jump_True:             return Opcode::Jump_True_Long;
+        case Opcode::Jump_False:            return Opcode::Jump_False_Long;
+        case Opcode::Jump_True_No_Pop:      return Opcode::Jump_True_No_Pop_Long;
+        case Opcode::Jump_False_No_Pop:     return Opcode::Jump_False_No_Pop_Long;
+        case Opcode::Int_Lt_Jump_False:     return Opcode::Int_Lt_Jump_False_Long;
+        case Opcode::Int_Le_Jump_False:     return Opcode::Int_Le_Jump_False_Long;
+        case Opcode::Reg_Jump_True:         return Opcode::Reg_Jump_True_Long;
+        case Opcode::Reg_Jump_False:        return Opcode::Reg_Jump_False_Long;
+        default:
+            internal_verify(is_long_jump(op), "Opcode %d is not a jump.", op);
+            return op;
+    }
+}
+
+Opcode short_jump(Opcode op) {
+    switch (op) {
+        case Opcode::Jump_Long:                 return Opcode::Jump;
+        case Opcode::Loop_Long:                 return Opcode::Loop;
+        case Opcode::Jump_True_Long:            return Opcode::Jump_True;
+        case Opcode::Jump_False_Long:           return Opcode::Jump_False;
+        case Opcode::Jump_True_No_Pop_Long:     return Opcode::Jump_True_No_Pop;
+        case Opcode::Jump_False_No_Pop_Long:    return Opcode::Jump_False_No_Pop;
+        case Opcode::Int_Lt_Jump_False_Long:    return Opcode::Int_Lt_Jump_False;
+        case Opcode::Int_Le_Jump_False_Long:    return Opcode::Int_Le_Jump_False;
+        case Opcode::Reg_Jump_True_Long:        return Opcode::Reg_Jump_True;
+        case Opcode::Reg_Jump_False_Long:       return Opcode::Reg_Jump_False;
+        default:
+            internal_verify(is_jump(op), "Opcode %d is not a jump.", op);
+            return op;
+    }
+}
+
+static constexpr int Unvisited = -2;
+
+Callees::Callees(Interpreter *interp) : builtin_returns(interp->builtins.table.size()), functions(interp->functions.table) {
+    for (auto &[_, defn] : interp->builtins.builtins) {
+        builtin_returns[defn.index] = defn.type.data.func.return_type->size();
+    }
+}
+
+int depth_after(const std::vector<Instruction> &code, size_t i, int depth, const Callees &callees) {
+    constexpr int Bool_Size = sizeof(runtime::Bool);
+    constexpr int Byte_Size = sizeof(runtime::Byte);
+    constexpr int Char_Size = sizeof(runtime::Char);
+    constexpr int Word_Size = sizeof(runtime::Int);
+    constexpr int Pointer_Size = sizeof(runtime::Pointer);
+    constexpr int String_Size = sizeof(runtime::String);
+
+    auto &inst = code[i];
+    if (inst.op == Opcode::Flush) return inst.address;
+    if (inst.op == Opcode::Flush_Value) return inst.address + inst.size;
+    if (depth == Unknown_Depth) return Unknown_Depth;
+
+    switch (inst.op) {
+        case Opcode::Lit_True:
+        case Opcode::Lit_False:
+        case Opcode::Lit_0b:
+        case Opcode::Lit_1b:
+        case Opcode::Lit_Byte:
+            return depth + Byte_Size;
+        case Opcode::Lit_Char:
+            return depth + Char_Size;
+        case Opcode::Lit_0:
+        case Opcode::Lit_1:
+        case Opcode::Lit_Int:
+        case Opcode::Lit_Float:
+        case Opcode::Lit_Pointer:
+            return depth + Word_Size;
+        case Opcode::Load_Const:
+            return depth + inst.size;
+        case Opcode::Load_Const_String:
+            return depth + String_Size;
+
+        case Opcode::Int_Add:
+        case Opcode::Int_Sub:
+        case Opcode::Int_Mul:
+        case Opcode::Int_Div:
+        case Opcode::Int_Mod:
+        case Opcode::Float_Add:
+        case Opcode::Float_Sub:
+        case Opcode::Float_Mul:
+        case Opcode::Float_Div:
+        case Opcode::Shift_Left:
+        case Opcode::Shift_Right:
+        case Opcode::Bit_And:
+        case Opcode::Xor:
+        case Opcode::Bit_Or:
+            return depth - Word_Size;
+        case Opcode::Byte_Add:
+        case Opcode::Byte_Sub:
+        case Opcode::Byte_Mul:
+        case Opcode::Byte_Div:
+        case Opcode::Byte_Mod:
+            return depth - Byte_Size;
+        case Opcode::Int_Inc:
+        case Opcode::Int_Dec:
+        case Opcode::Byte_Inc:
+        case Opcode::Byte_Dec:
+            return depth - Pointer_Size;
+        case Opcode::Int_Neg:
+        case Opcode::Byte_Neg:
+        case Opcode::Float_Neg:
+        case Opcode::Bit_Not:
+        case Opcode::Not:
+        case Opcode::Cast_Int_Float:
+        case Opcode::Cast_Float_Int:
+        case Opcode::Int_Add_Imm:
+        case Opcode::Int_Mul_Imm:
+        case Opcode::Inc_Local:
+        case Opcode::Add_Local:
+            return depth;
+        case Opcode::Str_Add:
+            return depth - String_Size;
+
+        case Opcode::And:
+        case Opcode::Or:
+            return depth - Bool_Size;
+        case Opcode::Equal:
+        case Opcode::Not_Equal:
+            return depth - 2 * inst.size + Bool_Size;
+        case Opcode::Str_Equal:
+        case Opcode::Str_Not_Equal:
+            return depth - 2 * String_Size + Bool_Size;
+        case Opcode::Int_Less_Than:
+        case Opcode::Int_Less_Equal:
+        case Opcode::Int_Greater_Than:
+        case Opcode::Int_Greater_Equal:
+        case Opcode::Float_Less_Than:
+        case Opcode::Float_Less_Equal:
+        case Opcode::Float_Greater_Than:
+        case Opcode::Float_Greater_Equal:
+            return depth - 2 * Word_Size + Bool_Size;
+        case Opcode::Byte_Less_Than:
+        case Opcode::Byte_Less_Equal:
+        case Opcode::Byte_Greater_Than:
+        case Opcode::Byte_Greater_Equal:
+            return depth - 2 * Byte_Size + Bool_Size;
+
+        case Opcode::Move:
+            return depth - Pointer_Size - inst.size;
+        case Opcode::Move_Push_Pointer:
+            return depth - inst.size;
+        case Opcode::Copy:
+            return depth - 2 * Pointer_Size;
+        case Opcode::Load:
+        case Opcode::Load_Field_Indirect:
+            return depth - Pointer_Size + inst.size;
+        case Opcode::Load_Indexed:
+            return depth - Pointer_Size - Word_Size + inst.size;
+        case Opcode::Push_Pointer:
+        case Opcode::Push_Global_Pointer:
+            return depth + Pointer_Size;
+        case Opcode::Push_Value:
+        case Opcode::Push_Global_Value:
+        case Opcode::Allocate:
+        case Opcode::Clear_Allocate:
+            return depth + inst.size;
+        case Opcode::Pop:
+            return depth - inst.size;
+        case Opcode::Return:
+        case Opcode::Variadic_Return:
+        case Opcode::Tail_Call:
+            return Unknown_Depth;
+
+        case Opcode::Jump:
+        case Opcode::Loop:
+        case Opcode::Jump_True_No_Pop:
+        case Opcode::Jump_False_No_Pop:
+            return depth;
+        case Opcode::Jump_True:
+        case Opcode::Jump_False:
+            return depth - Bool_Size;
+        case Opcode::Int_Lt_Jump_False:
+        case Opcode::Int_Le_Jump_False:
+            return depth - 2 * Word_Size;
+
+        case Opcode::Call: {
+            // the callee is only known when it's pushed right before the call
+            if (i == 0 || code[i - 1].op != Opcode::Lit_Pointer) return Unknown_Depth;
+            auto defn = reinterpret_cast<Function_Definition *>(code[i - 1].value);
+            if (defn->varargs) return Unknown_Depth;
+            return depth - Pointer_Size - inst.size + defn->type.data.func.return_type->size();
+        }
+        case Opcode::Call_Builtin: {
+            internal_verify(inst.value < callees.builtin_returns.size(), "Call_Builtin refers to an unknown builtin.");
+            return depth - inst.size + callees.builtin_returns[inst.value];
+        }
+        case Opcode::Call_Direct: {
+            internal_verify(inst.value < callees.functions.size(), "Call_Direct refers to an unknown function.");
+            auto defn = callees.functions[inst.value];
+            if (defn->varargs) return Unknown_Depth;
+            return depth - inst.size + defn->type.data.func.return_type->size();
+        }
+
+        case Opcode::Cast_Byte_Int:
+        case Opcode::Cast_Byte_Float:
+        case Opcode::Cast_Bool_Int:
+            return depth - Byte_Size + Word_Size;
+        case Opcode::Cast_Char_Int:
+            return depth - Char_Size + Word_Size;
+
+        default:
+            internal_error("Unexpected opcode while tracking stack depth: %d.", inst.op);
+            return Unknown_Depth;
+    }
+}
+
+std::vector<int> stack_depths(const std::vector<Instruction> &code, int entry_depth, const Callees &callees) {
+    std::vector<int> depths(code.size() + 1, Unvisited);
+    std::vector<size_t> work;
+
+    //
+    // Paths can reach the same instruction at different depths, e.g. a break
+    // doesn't flush the scopes it jumps out of. Everything above the lowest
+    // depth is dead at that point so that's the one to use.
+    //
+    auto reach = [&](size_t i, int depth) {
+        int &d = depths[i];
+        if (d == Unvisited) {
+            d = depth;
+        } else if (d == Unknown_Depth || d == depth) {
+            return;
+        } else if (depth == Unknown_Depth) {
+            d = Unknown_Depth;
+        } else if (depth < d) {
+            d = depth;
+        } else {
+            return;
+        }
+        if (i < code.size()) work.push_back(i);
+    };
+
+    reach(0, entry_depth);
+    while (!work.empty()) {
+        size_t i = work.back();
+        work.pop_back();
+
+        int after = depth_after(code, i, depths[i], callees);
+        if (is_jump(code[i].op)) {
+            reach(code[i].target, after);
+        }
+        if (falls_through(code[i].op)) {
+            reach(i + 1, after);
+        }
+    }
+
+    // unreachable code is left alone
+    for (auto &d : depths) {
+        if (d == Unvisited) d = Unknown_Depth;
+    }
+
+    return depths;
+}
+
+template<typename T>
+static T read_operand(Byte_Span code, size_t &i) {
+    T value = 0;
+    memcpy(&value, &code[i], sizeof(T));
+    i += sizeof(T);
+    return value;
+}
+
+template<typename T>
+static void write_operand(std::vector<uint8_t> &code, T value) {
+    uint8_t bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    code.insert(code.end(), bytes, bytes + sizeof(T));
+}
+
+std::vector<Instruction> decode_instructions(Byte_Span code) {
+    std::vector<Instruction> instructions;
+
+    // byte offset of an instruction -> its index, used to resolve jumps
+    std::vector<size_t> indices(code.size() + 1, SIZE_MAX);
+
+    size_t i = 0;
+    while (i < code.size()) {
+        indices[i] = instructions.size();
+
+        Instruction inst;
+        inst.op = static_cast<Opcode>(code[i++]);
+        switch (operand_layout(inst.op)) {
+            case Operand_Layout::None:
+                break;
+            case Operand_Layout::Char:
+                inst.value = read_operand<runtime::Char>(code, i);
+                break;
+            case Operand_Layout::Byte:
+                inst.value = read_operand<runtime::Byte>(code, i);
+                break;
+            case Operand_Layout::Word:
+                inst.value = read_operand<uint64_t>(code, i);
+                break;
+            case Operand_Layout::Constant:
+                inst.value = read_operand<Constant_Index>(code, i);
+                break;
+            case Operand_Layout::Size:
+                inst.size = read_operand<Size>(code, i);
+                break;
+            case Operand_Layout::Address:
+                inst.address = read_operand<Address>(code, i);
+                break;
+            case Operand_Layout::Size_Address:
+                inst.size = read_operand<Size>(code, i);
+                inst.address = read_operand<Address>(code, i);
+                break;
+            case Operand_Layout::Size_Constant:
+                inst.size = read_operand<Size>(code, i);
+                inst.value = read_operand<Constant_Index>(code, i);
+                break;
+            case Operand_Layout::Jump:
+                inst.target = read_operand<Short_Jump>(code, i);
+                break;
+            case Operand_Layout::Long_Jump:
+                inst.target = read_operand<Long_Jump>(code, i);
+                break;
+            case Operand_Layout::Builtin_Size:
+                inst.value = read_operand<Builtin_Index>(code, i);
+                inst.size = read_operand<Size>(code, i);
+                break;
+            case Operand_Layout::Function_Size:
+                inst.value = read_operand<Function_Index>(code, i);
+                inst.size = read_operand<Size>(code, i);
+                break;
+            case Operand_Layout::Dst_Src:
+                inst.address = read_operand<Address>(code, i);
+                inst.a = read_operand<Address>(code, i);
+                break;
+            case Operand_Layout::Size_Dst_Src:
+                inst.size = read_operand<Size>(code, i);
+                inst.address = read_operand<Address>(code, i);
+                inst.a = read_operand<Address>(code, i);
+                break;
+            case Operand_Layout::Size_Dst_Word:
+                inst.size = read_operand<Size>(code, i);
+                inst.address = read_operand<Address>(code, i);
+                inst.value = read_operand<uint64_t>(code, i);
+                break;
+            case Operand_Layout::Address_Word:
+                inst.address = read_operand<Address>(code, i);
+                inst.value = read_operand<uint64_t>(code, i);
+                break;
+            case Operand_Layout::Dst_Src_Src:
+                inst.address = read_operand<Address>(code, i);
+                inst.a = read_operand<Address>(code, i);
+                inst.b = read_operand<Address>(code, i);
+                break;
+            case Operand_Layout::Dst_Src_Word:
+                inst.address = read_operand<Address>(code, i);
+                inst.a = read_operand<Address>(code, i);
+                inst.value = read_operand<uint64_t>(code, i);
+                break;
+            case Operand_Layout::Size_Dst_Src_Src:
+                inst.size = read_operand<Size>(code, i);
+                inst.address = read_operand<Address>(code, i);
+                inst.a = read_operand<Address>(code, i);
+                inst.b = read_operand<Address>(code, i);
+                break;
+            case Operand_Layout::Address_Jump:
+                inst.address = read_operand<Address>(code, i);
+                inst.target = read_operand<Short_Jump>(code, i);
+                break;
+            case Operand_Layout::Address_Long_Jump:
+                inst.address = read_operand<Address>(code, i);
+                inst.target = read_operand<Long_Jump>(code, i);
+                break;
+        }
+
+        if (is_jump(inst.op)) {
+            inst.op = short_jump(inst.op);
+
+            // jumps are relative to the end of the instruction
+            inst.target = inst.op == Opcode::Loop ? i - inst.target : i + inst.target;
+        }
+
+        instructions.push_back(inst);
+    }
+    indices[code.size()] = instructions.size();
+
+    for (auto &inst : instructions) {
+        if (!is_jump(inst.op)) continue;
+        internal_verify(inst.target <= code.size() && indices[inst.target] != SIZE_MAX, "Jump lands in the middle of an instruction.");
+        inst.target = indices[inst.target];
+    }
+
+    return instructions;
+}
+
+// the opcode a decoded jump is encoded with, given where it's going
+static Opcode jump_opcode(Opcode op, size_t from, size_t to, bool is_long) {
+    // passes are free to retarget an unconditional jump either way
+    if (op == Opcode::Jump || op == Opcode::Loop) {
+        op = to < from ? Opcode::Loop : Opcode::Jump;
+    }
+    return is_long ? long_jump(op) : op;
+}
+
+void encode_instructions(const std::vector<Instruction> &instructions, std::vector<uint8_t> &out_code) {
+    //
+    // Start with every jump short and lengthen the ones that don't reach.
+    // Lengthening a jump can push others out of range so go until nothing
+    // changes, jumps only ever get longer so this always finishes.
+    //
+    std::vector<bool> is_long(instructions.size(), false);
+    std::vector<size_t> offsets(instructions.size() + 1);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        size_t offset = 0;
+        for (size_t i = 0; i < instructions.size(); i++) {
+            offsets[i] = offset;
+            Opcode op = instructions[i].op;
+            offset += instruction_size(is_long[i] ? long_jump(op) : op);
+        }
+        offsets[instructions.size()] = offset;
+
+        for (size_t i = 0; i < instructions.size(); i++) {
+            if (!is_jump(instructions[i].op) || is_long[i]) continue;
+
+            size_t from = offsets[i + 1];
+            size_t to = offsets[instructions[i].target];
+            size_t distance = to < from ? from - to : to - from;
+            if (distance > UINT16_MAX) {
+                is_long[i] = true;
+                changed = true;
+            }
+        }
+    }
+
+    out_code.clear();
+    out_code.reserve(offsets[instructions.size()]);
+
+    for (size_t i = 0; i < instructions.size(); i++) {
+        Instruction inst = instructions[i];
+
+        size_t jump = 0;
+        if (is_jump(inst.op)) {
+            size_t from = offsets[i + 1];
+            size_t to = offsets[inst.target];
+            inst.op = jump_opcode(inst.op, from, to, is_long[i]);
+
+            if (inst.op == Opcode::Loop || inst.op == Opcode::Loop_Long) {
+                jump = from - to;
+            } else {
+                internal_verify(to >= from, "Conditional jumps can only jump forwards.");
+                jump = to - from;
+            }
+            internal_verify(jump <= UINT32_MAX, "Jump is too far to encode.");
+        }
+
+        out_code.push_back(static_cast<uint8_t>(inst.op));
+        switch (operand_layout(inst.op)) {
+            case Operand_Layout::None:
+                break;
+            case Operand_Layout::Char:
+                write_operand(out_code, static_cast<runtime::Char>(inst.value));
+                break;
+            case Operand_Layout::Byte:
+                write_operand(out_code, static_cast<runtime::Byte>(inst.value));
+                break;
+            case Operand_Layout::Word:
+                write_operand(out_code, inst.value);
+                break;
+            case Operand_Layout::Constant:
+                write_operand(out_code, static_cast<Constant_Index>(inst.value));
+                break;
+            case Operand_Layout::Size:
+                write_operand(out_code, inst.size);
+                break;
+            case Operand_Layout::Address:
+                write_operand(out_code, inst.address);
+                break;
+            case Operand_Layout::Size_Address:
+                write_operand(out_code, inst.size);
+                write_operand(out_code, inst.address);
+                break;
+            case Operand_Layout::Size_Constant:
+                write_operand(out_code, inst.size);
+                write_operand(out_code, static_cast<Constant_Index>(inst.value));
+                break;
+            case Operand_Layout::Jump:
+                write_operand(out_code, static_cast<Short_Jump>(jump));
+                break;
+            case Operand_Layout::Long_Jump:
+                write_operand(out_code, static_cast<Long_Jump>(jump));
+                break;
+            case Operand_Layout::Builtin_Size:
+                write_operand(out_code, static_cast<Builtin_Index>(inst.value));
+                write_operand(out_code, inst.size);
+                break;
+            case Operand_Layout::Function_Size:
+                write_operand(out_code, static_cast<Function_Index>(inst.value));
+                write_operand(out_code, inst.size);
+                break;
+            case Operand_Layout::Dst_Src:
+                write_operand(out_code, inst.address);
+                write_operand(out_code, inst.a);
+                break;
+            case Operand_Layout::Size_Dst_Src:
+                write_operand(out_code, inst.size);
+                write_operand(out_code, inst.address);
+                write_operand(out_code, inst.a);
+                break;
+            case Operand_Layout::Size_Dst_Word:
+                write_operand(out_code, inst.size);
+                write_operand(out_code, inst.address);
+                write_operand(out_code, inst.value);
+                break;
+            case Operand_Layout::Address_Word:
+                write_operand(out_code, inst.address);
+                write_operand(out_code, inst.value);
+                break;
+            case Operand_Layout::Dst_Src_Src:
+                write_operand(out_code, inst.address);
+                write_operand(out_code, inst.a);
+                write_operand(out_code, inst.b);
+                break;
+            case Operand_Layout::Dst_Src_Word:
+                write_operand(out_code, inst.address);
+                write_operand(out_code, inst.a);
+                write_operand(out_code, inst.value);
+                break;
+            case Operand_Layout::Size_Dst_Src_Src:
+                write_operand(out_code, inst.size);
+                write_operand(out_code, inst.address);
+                write_operand(out_code, inst.a);
+                write_operand(out_code, inst.b);
+                break;
+            case Operand_Layout::Address_Jump:
+                write_operand(out_code, inst.address);
+                write_operand(out_code, static_cast<Short_Jump>(jump));
+                break;
+            case Operand_Layout::Address_Long_Jump:
+                write_operand(out_code, inst.address);
+                write_operand(out_code, static_cast<Long_Jump>(jump));
+                break;
+        }
+    }
+}
+
+void shorten_jumps(Function_Definition *fn) {
+    encode_instructions(decode_instructions(fn->instructions), fn->instructions);
+}
@@ -0,0 +1,99 @@
+//
+//  bytecode.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "vm.h"
+
+struct Function_Definition;
+
+//
+// Passes that rewrite a function's code work on a list of decoded instructions
+// instead of the raw byte stream. Jumps hold the index of the instruction they
+// land on so instructions can be inserted and removed freely, the byte offsets
+// get recomputed by encode_instructions().
+//
+struct Instruction {
+    Opcode op = Opcode::None;
+    Size size = 0;
+    Address address = 0;    // also the destination slot of register instructions
+    Address a = 0;
+    Address b = 0;
+    uint64_t value = 0;     // literal bits, constant index, builtin index or function index
+    size_t target = 0;
+};
+
+// The operands an instruction is encoded with, in the order they're encoded.
+enum class Operand_Layout : uint8_t {
+    None,
+    Char,               // value (4 bytes)
+    Byte,               // value (1 byte)
+    Word,               // value (8 bytes)
+    Constant,           // value (Constant_Index)
+    Size,               // size
+    Address,            // address
+    Size_Address,       // size, address
+    Size_Constant,      // size, value (Constant_Index)
+    Jump,               // target (Short_Jump)
+    Long_Jump,          // target (Long_Jump)
+    Builtin_Size,       // value (Builtin_Index), size
+    Function_Size,      // value (Function_Index), size
+    Dst_Src,            // address, a
+    Size_Dst_Src,       // size, address, a
+    Size_Dst_Word,      // size, address, value
+    Address_Word,       // address, value (8 bytes)
+    Dst_Src_Src,        // address, a, b
+    Dst_Src_Word,       // address, a, value
+    Size_Dst_Src_Src,   // size, address, a, b
+    Address_Jump,       // address, target (Short_Jump)
+    Address_Long_Jump,  // address, target (Long_Jump)
+};
+
+Operand_Layout operand_layout(Opcode op);
+size_t instruction_size(Opcode op);
+bool is_jump(Opcode op);
+bool is_long_jump(Opcode op);
+bool falls_through(Opcode op);
+
+// Every jump comes in a short and a long form, these convert between them.
+Opcode long_jump(Opcode op);
+Opcode short_jump(Opcode op);
+
+static constexpr int Unknown_Depth = -1;
+
+// What's needed to know how a call changes the stack depth.
+struct Callees {
+    std::vector<Size> builtin_returns; // indexed by Builtin_Index
+    const std::vector<Function_Definition *> &functions; // indexed by Function_Index
+
+    Callees(struct Interpreter *interp);
+};
+
+//
+// The depth of the stack (relative to the stack bottom) after code[i] runs
+// given the depth before it. Calls through function values and variadic calls
+// leave the depth unknown until the next Flush.
+//
+int depth_after(const std::vector<Instruction> &code, size_t i, int depth, const Callees &callees);
+
+// The depth before each instruction, Unknown_Depth where it can't be worked out or the instruction is unreachable.
+std::vector<int> stack_depths(const std::vector<Instruction> &code, int entry_depth, const Callees &callees);
+
+//
+// Decoded jumps are always in their short form. encode_instructions() picks
+// the short form wherever the distance fits in a Short_Jump and falls back to
+// the long form for the rest.
+//
+
+std::vector<Instruction> decode_instructions(Byte_Span code);
+void encode_instructions(const std::vector<Instruction> &instructions, std::vector<uint8_t> &out_code);
+
+// Re-encodes a function without changing it, which is enough to shorten its jumps.
+void shorten_jumps(Function_Definition *fn);
@@ -7,9 +7,14 @@
 //
 
 #include "compiler.h"
+#include "bytecode.h"
+
+#include <string_view>
+#include <unordered_set>
 
 #include "error.h"
 #include "interpreter.h"
+#include "ssa.h"
 
 struct Find_Static_Address_Result {
     enum {
@@ -21,6 +26,7 @@ struct Find_Static_Address_Result {
     Address address;
 };
 static Find_Static_Address_Result find_static_address(Compiler &c, Typed_AST &node);
+static bool might_point_into_frame(Typed_AST &node);
 
 Compiler::Compiler(
     Interpreter *interp,
@@ -28,7 +34,9 @@ Compiler::Compiler(
     Data_Section &str_constants,
     Function_Definition *function)
   : constants(constants),
-    str_constants(str_constants)
+    str_constants(str_constants),
+    constants_index(interp->constants_index),
+    str_constants_index(interp->str_constants_index)
 {
     stack_top = 0;
     parent = nullptr;
@@ -40,7 +48,9 @@ Compiler::Compiler(
 
 Compiler::Compiler(Compiler *parent, Function_Definition *function)
   : constants(parent->constants),
-    str_constants(parent->str_constants)
+    str_constants(parent->str_constants),
+    constants_index(parent->constants_index),
+    str_constants_index(parent->str_constants_index)
 {
     stack_top = 0;
     this->parent = parent;
@@ -59,6 +69,10 @@ Function_Definition *Compiler::compile(Ref<Typed_AST_Multiary> multi) {
 
     compile_deferred_statements(global_scope, nullptr, Clear_Defers::Yes);
     
+    // the VM doesn't bounds check the pc so every instruction stream must end in a return
+    emit_opcode(Opcode::Return);
+    emit_size(0);
+    
     return this->function;
 }
 
@@ -79,10 +93,16 @@ void Compiler::emit_address(Address address) {
     emit_value<Address>(address);
 }
 
+void Compiler::emit_constant_index(size_t constant) {
+    internal_verify(constant <= UINT32_MAX, "Constant index %zu doesn't fit in a Constant_Index.", constant);
+    emit_value<Constant_Index>(static_cast<Constant_Index>(constant));
+}
+
+// jumps are emitted long because their distance isn't known yet, encode_instructions() shortens them
 size_t Compiler::emit_jump(Opcode jump_code, bool update_stack_top) {
-    emit_opcode(jump_code);
+    emit_opcode(long_jump(jump_code));
     size_t jump = function->instructions.size();
-    emit_value<size_t>(-1);
+    emit_value<Long_Jump>(-1);
     if (update_stack_top &&
         (jump_code == Opcode::Jump_True ||
          jump_code == Opcode::Jump_False))
@@ -94,14 +114,17 @@ size_t Compiler::emit_jump(Opcode jump_code, bool update_stack_top) {
 
 void Compiler::patch_jump(size_t jump) {
     size_t to = function->instructions.size();
-    size_t *jump_size = reinterpret_cast<size_t *>(&function->instructions[jump]);
-    *jump_size = to - jump - sizeof(size_t);
+    size_t distance = to - jump - sizeof(Long_Jump);
+    internal_verify(distance <= UINT32_MAX, "Jump of %zu bytes is too large.", distance);
+    Long_Jump jump_size = static_cast<Long_Jump>(distance);
+    memcpy(&function->instructions[jump], &jump_size, sizeof(Long_Jump));
 }
 
 void Compiler::emit_loop(size_t loop_start) {
-    emit_opcode(Opcode::Loop);
-    size_t jump = function->instructions.size() - loop_start + sizeof(size_t);
-    emit_value<size_t>(jump);
+    emit_opcode(Opcode::Loop_Long);
+    size_t jump = function->instructions.size() - loop_start + sizeof(Long_Jump);
+    internal_verify(jump <= UINT32_MAX, "Loop of %zu bytes is too large.", jump);
+    emit_value<Long_Jump>(static_cast<Long_Jump>(jump));
 }
 
 void Compiler::patch_loop_controls(const std::vector<size_t> &controls) {
@@ -111,16 +134,14 @@ void Compiler::patch_loop_controls(const std::vector<size_t> &controls) {
 }
 
 Variable &Compiler::put_variable(
-    String id,
+    Symbol id,
     Value_Type type,
     Address address,
     bool is_const)
 {
-    std::string sid = id.str();
     Compiler_Scope &s = current_scope();
     Variable v = { is_const, type, address };
-    s.variables[sid] = v;
-    return s.variables[sid];
+    return s.variables[id] = v;
 }
 
 void Compiler::put_variables_from_pattern(
@@ -136,28 +157,27 @@ void Compiler::put_variables_from_pattern(
     }
 }
 
-Find_Variable_Result Compiler::find_variable(String id) {
-    std::string sid = id.str();
+Find_Variable_Result Compiler::find_variable(Symbol id) {
     for (Compiler_Scope *s = &current_scope(); s != nullptr; s = s->parent) {
-        auto it = s->variables.find(sid);
+        auto it = s->variables.find(id);
         if (it != s->variables.end()) {
             return {
                 it->second.is_const ?
                     Find_Variable_Result::Found_Constant :
                     Find_Variable_Result::Found,
-                &s->variables[sid]
+                &it->second
             };
         }
     }
     
     // check global scope
-    auto it = global_scope->variables.find(sid);
+    auto it = global_scope->variables.find(id);
     if (it != global_scope->variables.end()) {
         return {
             it->second.is_const ?
                 Find_Variable_Result::Found_Constant :
                 Find_Variable_Result::Found_Global,
-            &global_scope->variables[sid]
+            &it->second
         };
     }
     
@@ -248,8 +268,7 @@ void Compiler::declare_constant(Typed_AST_Let &let) {
             internal_error("Unexpected Value_Type_Kind in Compiler::declare_variable(): %d.", let.initializer->type.kind);
     }
     
-    std::string sid = id.str();
-    current_scope().variables[sid] = constant;
+    current_scope().variables[id] = constant;
     
     stack_top = old_top;
 }
@@ -285,7 +304,7 @@ void Compiler::compile_constant(Variable constant) {
         } break;
         case Value_Type_Kind::Str: {
             emit_opcode(Opcode::Load_Const_String);
-            emit_value<size_t>(constant.address);
+            emit_constant_index(constant.address);
         } break;
         case Value_Type_Kind::Ptr: {
             runtime::Pointer value = get_constant<runtime::Pointer>(constant.address);
@@ -295,7 +314,7 @@ void Compiler::compile_constant(Variable constant) {
         case Value_Type_Kind::Array: {
             emit_opcode(Opcode::Load_Const);
             emit_size(constant.type.size());
-            emit_value<size_t>(constant.address);
+            emit_constant_index(constant.address);
         } break;
         case Value_Type_Kind::Slice:
             todo("Constant Slices not yet compilable.");
@@ -305,7 +324,7 @@ void Compiler::compile_constant(Variable constant) {
         case Value_Type_Kind::Range:
             emit_opcode(Opcode::Load_Const);
             emit_size(constant.type.size());
-            emit_value<size_t>(constant.address);
+            emit_constant_index(constant.address);
             break;
             
         case Value_Type_Kind::Struct:
@@ -319,18 +338,345 @@ void Compiler::compile_constant(Variable constant) {
     stack_top = old_top + constant.type.size();
 }
 
+// Int arithmetic wraps around like it does in the VM
+static runtime::Int wrapping(Typed_AST_Kind kind, runtime::Int a, runtime::Int b) {
+    uint64_t ua = static_cast<uint64_t>(a);
+    uint64_t ub = static_cast<uint64_t>(b);
+    switch (kind) {
+        case Typed_AST_Kind::Addition:       return static_cast<runtime::Int>(ua + ub);
+        case Typed_AST_Kind::Subtraction:    return static_cast<runtime::Int>(ua - ub);
+        case Typed_AST_Kind::Multiplication: return static_cast<runtime::Int>(ua * ub);
+        default:
+            internal_error("Invalid wrapping operation: %d.", kind);
+            return 0;
+    }
+}
+
+template<typename T>
+static bool fold_comparison(Typed_AST_Kind kind, T a, T b, Constant_Value &out_value) {
+    bool result;
+    switch (kind) {
+        case Typed_AST_Kind::Less:       result = a < b;  break;
+        case Typed_AST_Kind::Less_Eq:    result = a <= b; break;
+        case Typed_AST_Kind::Greater:    result = a > b;  break;
+        case Typed_AST_Kind::Greater_Eq: result = a >= b; break;
+        default:
+            return false;
+    }
+    out_value.set<runtime::Bool>(Value_Type_Kind::Bool, result);
+    return true;
+}
+
+bool fold_unary(Typed_AST_Kind kind, const Constant_Value &value, Constant_Value &out_value) {
+    switch (kind) {
+        case Typed_AST_Kind::Negation:
+            if (value.kind == Value_Type_Kind::Int) {
+                out_value.set<runtime::Int>(Value_Type_Kind::Int, wrapping(Typed_AST_Kind::Subtraction, 0, value.get<runtime::Int>()));
+                return true;
+            }
+            if (value.kind == Value_Type_Kind::Float) {
+                out_value.set<runtime::Float>(Value_Type_Kind::Float, -value.get<runtime::Float>());
+                return true;
+            }
+            return false;
+        case Typed_AST_Kind::Not:
+            out_value.set<runtime::Bool>(Value_Type_Kind::Bool, !value.get<runtime::Bool>());
+            return true;
+            
+        default:
+            return false;
+    }
+}
+
+//
+// Anything the VM would report as an error at runtime (dividing by zero, or the
+// one Int division that overflows) is left unfolded so it's still reported.
+//
+bool fold_binary(Typed_AST_Kind kind, const Constant_Value &a, const Constant_Value &b, Constant_Value &out_value) {
+    switch (kind) {
+        case Typed_AST_Kind::Equal:
+            out_value.set<runtime::Bool>(Value_Type_Kind::Bool, a.bits == b.bits);
+            return true;
+        case Typed_AST_Kind::Not_Equal:
+            out_value.set<runtime::Bool>(Value_Type_Kind::Bool, a.bits != b.bits);
+            return true;
+        case Typed_AST_Kind::And:
+            out_value.set<runtime::Bool>(Value_Type_Kind::Bool, a.get<runtime::Bool>() && b.get<runtime::Bool>());
+            return true;
+        case Typed_AST_Kind::Or:
+            out_value.set<runtime::Bool>(Value_Type_Kind::Bool, a.get<runtime::Bool>() || b.get<runtime::Bool>());
+            return true;
+        default:
+            break;
+    }
+    
+    switch (a.kind) {
+        case Value_Type_Kind::Int: {
+            auto x = a.get<runtime::Int>();
+            auto y = b.get<runtime::Int>();
+            switch (kind) {
+                case Typed_AST_Kind::Addition:
+                case Typed_AST_Kind::Subtraction:
+                case Typed_AST_Kind::Multiplication:
+                    out_value.set<runtime::Int>(Value_Type_Kind::Int, wrapping(kind, x, y));
+                    return true;
+                case Typed_AST_Kind::Division:
+                case Typed_AST_Kind::Mod:
+                    if (y == 0 || (x == INT64_MIN && y == -1)) return false;
+                    out_value.set<runtime::Int>(Value_Type_Kind::Int, kind == Typed_AST_Kind::Division ? x / y : x % y);
+                    return true;
+                default:
+                    return fold_comparison(kind, x, y, out_value);
+            }
+        }
+        case Value_Type_Kind::Byte: {
+            auto x = a.get<runtime::Byte>();
+            auto y = b.get<runtime::Byte>();
+            runtime::Byte result;
+            switch (kind) {
+                case Typed_AST_Kind::Addition:       result = x + y; break;
+                case Typed_AST_Kind::Subtraction:    result = x - y; break;
+                case Typed_AST_Kind::Multiplication: result = x * y; break;
+                case Typed_AST_Kind::Division:
+                    if (y == 0) return false;
+                    result = x / y;
+                    break;
+                case Typed_AST_Kind::Mod:
+                    if (y == 0) return false;
+                    result = x % y;
+                    break;
+                default:
+                    return fold_comparison(kind, x, y, out_value);
+            }
+            out_value.set<runtime::Byte>(Value_Type_Kind::Byte, result);
+            return true;
+        }
+        case Value_Type_Kind::Float: {
+            auto x = a.get<runtime::Float>();
+            auto y = b.get<runtime::Float>();
+            runtime::Float result;
+            switch (kind) {
+                case Typed_AST_Kind::Addition:       result = x + y; break;
+                case Typed_AST_Kind::Subtraction:    result = x - y; break;
+                case Typed_AST_Kind::Multiplication: result = x * y; break;
+                case Typed_AST_Kind::Division:
+                    if (y == 0) return false;
+                    result = x / y;
+                    break;
+                default:
+                    return fold_comparison(kind, x, y, out_value);
+            }
+            out_value.set<runtime::Float>(Value_Type_Kind::Float, result);
+            return true;
+        }
+            
+        default:
+            return false;
+    }
+}
+
+bool fold_cast(Typed_AST_Kind kind, const Constant_Value &value, Constant_Value &out_value) {
+    switch (kind) {
+        case Typed_AST_Kind::Cast_Byte_Int:
+            out_value.set<runtime::Int>(Value_Type_Kind::Int, value.get<runtime::Byte>());
+            return true;
+        case Typed_AST_Kind::Cast_Byte_Float:
+            out_value.set<runtime::Float>(Value_Type_Kind::Float, value.get<runtime::Byte>());
+            return true;
+        case Typed_AST_Kind::Cast_Bool_Int:
+            out_value.set<runtime::Int>(Value_Type_Kind::Int, value.get<runtime::Bool>() ? 1 : 0);
+            return true;
+        case Typed_AST_Kind::Cast_Char_Int:
+            out_value.set<runtime::Int>(Value_Type_Kind::Int, static_cast<runtime::Int>(value.get<runtime::Char>()));
+            return true;
+        case Typed_AST_Kind::Cast_Int_Float:
+            out_value.set<runtime::Float>(Value_Type_Kind::Float, static_cast<runtime::Float>(value.get<runtime::Int>()));
+            return true;
+        case Typed_AST_Kind::Cast_Float_Int: {
+            // out of range conversions are whatever the hardware does, leave those to it
+            auto f = value.get<runtime::Float>();
+            if (!(f > -9223372036854775808.0 && f < 9223372036854775808.0)) return false;
+            out_value.set<runtime::Int>(Value_Type_Kind::Int, static_cast<runtime::Int>(f));
+            return true;
+        }
+            
+        default:
+            return false;
+    }
+}
+
+//
+// Works out the value of scalar expressions made up of literals, constants,
+// immutable variables with a known value and the arithmetic, comparison,
+// logical and cast operators on them. None of those can have side effects so
+// if the whole expression folds it can be replaced by its value. Returns false
+// if any part of it isn't known at compile time.
+//
+bool Compiler::fold(Typed_AST &node, Constant_Value &out_value) {
+    switch (node.kind) {
+        case Typed_AST_Kind::Byte:
+            out_value.set<runtime::Byte>(Value_Type_Kind::Byte, static_cast<Typed_AST_Byte &>(node).value);
+            return true;
+        case Typed_AST_Kind::Bool:
+            out_value.set<runtime::Bool>(Value_Type_Kind::Bool, static_cast<Typed_AST_Bool &>(node).value);
+            return true;
+        case Typed_AST_Kind::Char:
+            out_value.set<runtime::Char>(Value_Type_Kind::Char, static_cast<Typed_AST_Char &>(node).value);
+            return true;
+        case Typed_AST_Kind::Int:
+            out_value.set<runtime::Int>(Value_Type_Kind::Int, static_cast<Typed_AST_Int &>(node).value);
+            return true;
+        case Typed_AST_Kind::Float:
+            out_value.set<runtime::Float>(Value_Type_Kind::Float, static_cast<Typed_AST_Float &>(node).value);
+            return true;
+            
+        case Typed_AST_Kind::Ident: {
+            auto [status, v] = find_variable(static_cast<Typed_AST_Ident &>(node).id);
+            if (status == Find_Variable_Result::Found_Constant) {
+                switch (v->type.kind) {
+                    case Value_Type_Kind::Bool:
+                        out_value.set(Value_Type_Kind::Bool, get_constant<runtime::Bool>(v->address));
+                        return true;
+                    case Value_Type_Kind::Char:
+                        out_value.set(Value_Type_Kind::Char, get_constant<runtime::Char>(v->address));
+                        return true;
+                    case Value_Type_Kind::Int:
+                        out_value.set(Value_Type_Kind::Int, get_constant<runtime::Int>(v->address));
+                        return true;
+                    case Value_Type_Kind::Float:
+                        out_value.set(Value_Type_Kind::Float, get_constant<runtime::Float>(v->address));
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+            if (status != Find_Variable_Result::Not_Found && v->is_known) {
+                out_value = v->known;
+                return true;
+            }
+            return false;
+        }
+            
+        case Typed_AST_Kind::Negation:
+        case Typed_AST_Kind::Not: {
+            Constant_Value sub;
+            if (!fold(*static_cast<Typed_AST_Unary &>(node).sub, sub)) return false;
+            return fold_unary(node.kind, sub, out_value);
+        }
+            
+        case Typed_AST_Kind::Addition:
+        case Typed_AST_Kind::Subtraction:
+        case Typed_AST_Kind::Multiplication:
+        case Typed_AST_Kind::Division:
+        case Typed_AST_Kind::Mod:
+        case Typed_AST_Kind::Equal:
+        case Typed_AST_Kind::Not_Equal:
+        case Typed_AST_Kind::Less:
+        case Typed_AST_Kind::Less_Eq:
+        case Typed_AST_Kind::Greater:
+        case Typed_AST_Kind::Greater_Eq:
+        case Typed_AST_Kind::And:
+        case Typed_AST_Kind::Or: {
+            auto &b = static_cast<Typed_AST_Binary &>(node);
+            Constant_Value lhs, rhs;
+            if (!fold(*b.lhs, lhs) || !fold(*b.rhs, rhs)) return false;
+            return fold_binary(node.kind, lhs, rhs, out_value);
+        }
+            
+        case Typed_AST_Kind::Cast_Byte_Int:
+        case Typed_AST_Kind::Cast_Byte_Float:
+        case Typed_AST_Kind::Cast_Bool_Int:
+        case Typed_AST_Kind::Cast_Char_Int:
+        case Typed_AST_Kind::Cast_Int_Float:
+        case Typed_AST_Kind::Cast_Float_Int: {
+            Constant_Value value;
+            if (!fold(*static_cast<Typed_AST_Cast &>(node).expr, value)) return false;
+            return fold_cast(node.kind, value, out_value);
+        }
+            
+        default:
+            return false;
+    }
+}
+
+void Compiler::emit_constant_value(const Constant_Value &value) {
+    switch (value.kind) {
+        case Value_Type_Kind::Byte: {
+            auto b = value.get<runtime::Byte>();
+            if (b == 0) {
+                emit_opcode(Opcode::Lit_0b);
+            } else if (b == 1) {
+                emit_opcode(Opcode::Lit_1b);
+            } else {
+                emit_opcode(Opcode::Lit_Byte);
+                emit_value<runtime::Byte>(b);
+            }
+            stack_top += value_types::Byte.size();
+        } break;
+        case Value_Type_Kind::Bool:
+            emit_opcode(value.get<runtime::Bool>() ? Opcode::Lit_True : Opcode::Lit_False);
+            stack_top += value_types::Bool.size();
+            break;
+        case Value_Type_Kind::Char:
+            emit_opcode(Opcode::Lit_Char);
+            emit_value<runtime::Char>(value.get<runtime::Char>());
+            stack_top += value_types::Char.size();
+            break;
+        case Value_Type_Kind::Int: {
+            auto n = value.get<runtime::Int>();
+            if (n == 0) {
+                emit_opcode(Opcode::Lit_0);
+            } else if (n == 1) {
+                emit_opcode(Opcode::Lit_1);
+            } else {
+                emit_opcode(Opcode::Lit_Int);
+                emit_value<runtime::Int>(n);
+            }
+            stack_top += value_types::Int.size();
+        } break;
+        case Value_Type_Kind::Float:
+            emit_opcode(Opcode::Lit_Float);
+            emit_value<runtime::Float>(value.get<runtime::Float>());
+            stack_top += value_types::Float.size();
+            break;
+            
+        default:
+            internal_error("Invalid Value_Type_Kind in Compiler::emit_constant_value(): %d", value.kind);
+    }
+}
+
+// emits the value of `node` if it's known at compile time
+static bool compile_folded(Compiler &c, Typed_AST &node) {
+    Constant_Value value;
+    if (!c.fold(node, value)) return false;
+    c.emit_constant_value(value);
+    return true;
+}
+
+// pushes the value of `node` from where it was put if it was hoisted out of a loop
+static bool compile_hoisted(Compiler &c, Typed_AST &node) {
+    auto it = c.hoisted.find(&node);
+    if (it == c.hoisted.end()) return false;
+    c.emit_opcode(Opcode::Push_Value);
+    c.emit_size(node.type.size());
+    c.emit_address(it->second);
+    c.stack_top += node.type.size();
+    return true;
+}
+
+static size_t hash_constant(const void *data, size_t size) {
+    return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char *>(data), size));
+}
+
 size_t Compiler::add_constant(void *data, size_t size) {
     size_t alligned_size = (((size + Constants_Allignment - 1)) / Constants_Allignment) * Constants_Allignment;
     
     // search for identical constant
-    for (size_t i = 0; i < constants.size(); i += Constants_Allignment) {
-        if (i + alligned_size > constants.size()) {
-            // this constant can't fit and therefore can't already be in
-            // the constants data section
-            break;
-        }
-        
-        if (memcmp(data, &constants[i], size) == 0) {
+    size_t hash = hash_constant(data, size);
+    auto [first, last] = constants_index.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        auto [i, entry_size] = it->second;
+        if (entry_size == size && memcmp(data, &constants[i], size) == 0) {
             return i;
         }
     }
@@ -344,22 +690,35 @@ size_t Compiler::add_constant(void *data, size_t size) {
     for (; i < alligned_size; i++) {
         constants.push_back(0);
     }
+    constants_index.emplace(hash, Data_Section_Entry { index, size });
     
     return index;
 }
 
+const std::vector<Builtin> &Compiler::builtin_table() const {
+    return interp->builtins.table;
+}
+
+const std::vector<Function_Definition *> &Compiler::function_table() const {
+    return interp->functions.table;
+}
+
+size_t Compiler::max_call_depth() const {
+    return interp->max_call_depth;
+}
+
 size_t Compiler::add_slice_constant(size_t size, char *source) {
     // search for identical string
-    size_t i = 0;
-    while (i < str_constants.size()) {
-        size_t index = i;
-        size_t len = *reinterpret_cast<size_t *>(&str_constants[i]);
-        i += sizeof(size_t);
-        char *str = reinterpret_cast<char *>(&str_constants[i]);
-        if (size == len && memcmp(source, str, len) == 0) {
+    size_t hash = hash_constant(source, size);
+    auto [first, last] = str_constants_index.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        auto [index, len] = it->second;
+        if (len != size) continue;
+        
+        char *str = reinterpret_cast<char *>(&str_constants[index + sizeof(size_t)]);
+        if (memcmp(source, str, len) == 0) {
             return index;
         }
-        i += len;
     }
     
     // no identical so add new string
@@ -374,6 +733,7 @@ size_t Compiler::add_slice_constant(size_t size, char *source) {
     for (size_t i = 0; i < size; i++) {
         str_constants.push_back(source[i]);
     }
+    str_constants_index.emplace(hash, Data_Section_Entry { index, size });
     
     return index;
 }
@@ -421,12 +781,13 @@ void Compiler::compile_deferred_statements(Compiler_Scope *begin, Compiler_Scope
     }
 }
 
-void Compiler::begin_loop(String label, Code_Location location) {
+void Compiler::begin_loop(Symbol label, Code_Location location) {
     auto loop = find_loop(label);
     verify(loop == nullptr, location, "Cannot use '%.*s' as label for loop as it's already the label for another loop.\n\tThe other loop is located at %s:%zu:%zu.", label.size(), label.c_str(), loop->location.filename, loop->location.l0 + 1, loop->location.c0 + 1);
 
     loops.push_back(Compiler_Loop {
         .scope = &current_scope(),
+        .stack_top = stack_top,
         .label = label,
         .location = location
     });
@@ -436,7 +797,7 @@ void Compiler::end_loop() {
     loops.pop_back();
 }
 
-Compiler_Loop *Compiler::find_loop(String label) {
+Compiler_Loop *Compiler::find_loop(Symbol label) {
     if (label.size() != 0) {
         for (auto &loop : loops) {
             if (loop.label == label) {
@@ -465,6 +826,8 @@ void Typed_AST_Float::compile(Compiler &c) {
 }
 
 void Typed_AST_Ident::compile(Compiler &c) {
+    if (compile_folded(c, *this)) return;
+    
     Address stack_top = c.stack_top;
     
     auto [status, v] = c.find_variable(id);
@@ -513,7 +876,7 @@ void Typed_AST_Int::compile(Compiler &c) {
 void Typed_AST_Str::compile(Compiler &c) {
     size_t constant = c.add_slice_constant(value.size(), value.c_str());
     c.emit_opcode(Opcode::Load_Const_String);
-    c.emit_value<size_t>(constant);
+    c.emit_constant_index(constant);
     c.stack_top += type.size();
 }
 
@@ -535,7 +898,7 @@ static Find_Static_Address_Result find_static_address(Compiler &c, Typed_AST &no
     
     switch (node.kind) {
         case Typed_AST_Kind::Ident: {
-            auto id = dynamic_cast<Typed_AST_Ident *>(&node);
+            auto id = kind_cast<Typed_AST_Ident>(&node);
             internal_verify(id, "Failed to cast node to an Ident* in find_static_address.");
             
             auto [v_status, v] = c.find_variable(id->id);
@@ -548,7 +911,7 @@ static Find_Static_Address_Result find_static_address(Compiler &c, Typed_AST &no
             address = v->address;
         } break;
         case Typed_AST_Kind::Subscript: {
-            auto sub = dynamic_cast<Typed_AST_Binary *>(&node);
+            auto sub = kind_cast<Typed_AST_Binary>(&node);
             internal_verify(sub, "Failed to cast node to a Binary* in find_static_address().");
             
             auto [array_status, array_address] = find_static_address(c, *sub->lhs);
@@ -571,7 +934,7 @@ static Find_Static_Address_Result find_static_address(Compiler &c, Typed_AST &no
             address = array_address + index * sub->type.size();
         } break;
         case Typed_AST_Kind::Field_Access: {
-            auto dot = dynamic_cast<Typed_AST_Field_Access *>(&node);
+            auto dot = kind_cast<Typed_AST_Field_Access>(&node);
             internal_verify(dot, "Failed to cast node to Field_Access* in find_static_address().");
             
             if (dot->deref) {
@@ -607,7 +970,7 @@ static Find_Static_Address_Result find_static_address(Compiler &c, Typed_AST &no
 static bool emit_dynamic_address_code(Compiler &c, Typed_AST &node) {
     switch (node.kind) {
         case Typed_AST_Kind::Ident: {
-            auto id = dynamic_cast<Typed_AST_Ident *>(&node);
+            auto id = kind_cast<Typed_AST_Ident>(&node);
             internal_verify(id, "Failed to cast node to Ident* in emit_dynamic_address_code().");
             
             auto [v_status, v] = c.find_variable(id->id);
@@ -617,12 +980,12 @@ static bool emit_dynamic_address_code(Compiler &c, Typed_AST &node) {
             c.emit_address(v->address);
         } break;
         case Typed_AST_Kind::Deref: {
-            auto deref = dynamic_cast<Typed_AST_Unary *>(&node);
+            auto deref = kind_cast<Typed_AST_Unary>(&node);
             internal_verify(deref, "Failed to cast node to Unary* in emit_dynamic_address_code().");
             deref->sub->compile(c);
         } break;
         case Typed_AST_Kind::Subscript: {
-            auto sub = dynamic_cast<Typed_AST_Binary *>(&node);
+            auto sub = kind_cast<Typed_AST_Binary>(&node);
             internal_verify(sub, "Failed to cast node to Binary* in emit_dynamic_address_code().");
             
             Size element_size = sub->lhs->type.child_type()->size();
@@ -646,7 +1009,7 @@ static bool emit_dynamic_address_code(Compiler &c, Typed_AST &node) {
             c.emit_opcode(Opcode::Int_Add);
         } break;
         case Typed_AST_Kind::Negative_Subscript: {
-            auto sub = dynamic_cast<Typed_AST_Binary *>(&node);
+            auto sub = kind_cast<Typed_AST_Binary>(&node);
             internal_verify(sub, "Failed to cast node to Binary* in emit_dynamic_address_code().");
             internal_verify(sub->lhs->type.kind == Value_Type_Kind::Slice, "sub->lhs is not a slice in Negative_Subscript part of emit_dynamic_address_code().");
             
@@ -671,7 +1034,7 @@ static bool emit_dynamic_address_code(Compiler &c, Typed_AST &node) {
             c.emit_opcode(Opcode::Int_Add);
         } break;
         case Typed_AST_Kind::Field_Access: {
-            auto dot = dynamic_cast<Typed_AST_Field_Access *>(&node);
+            auto dot = kind_cast<Typed_AST_Field_Access>(&node);
             internal_verify(dot, "Failed to cast node to Field_Access* in emit_dynamic_address_code().");
             
             if (dot->deref) {
@@ -746,6 +1109,8 @@ void Typed_AST_Nullary::compile(Compiler &c) {
 }
 
 void Typed_AST_Unary::compile(Compiler &c) {
+    if (compile_folded(c, *this) || compile_hoisted(c, *this)) return;
+    
     Address stack_top = c.stack_top;
     switch (kind) {
         case Typed_AST_Kind::Negation:
@@ -780,11 +1145,43 @@ void Typed_AST_Unary::compile(Compiler &c) {
     c.stack_top = stack_top + type.size();
 }
 
+//
+// `return f(...)` where f is known doesn't need its own frame, f can take over
+// the current one. The defers have already run by the time the return value is
+// evaluated so they're unaffected. The arguments are moved down over the frame,
+// so it can't be done if anything, an argument, a method's receiver or a pointer
+// put somewhere earlier, could still point into it.
+//
+static bool compile_tail_call(Compiler &c, Ref<Typed_AST> sub) {
+    if (!c.parent || c.frame_escapes || sub->kind != Typed_AST_Kind::Function_Call) return false;
+    
+    auto call = sub.cast<Typed_AST_Binary>();
+    auto uuid = call->lhs.cast<Typed_AST_UUID>();
+    if (!uuid || uuid->type.kind != Value_Type_Kind::Function) return false;
+    
+    Function_Definition *defn = c.interp->functions.get_func_by_uuid(uuid->uuid);
+    internal_verify(defn, "Failed to retrieve Function_Definition in compile_tail_call().");
+    
+    // the varargs slice points into the caller's frame so it can't be moved
+    if (defn->varargs) return false;
+    
+    call->rhs->compile(c);
+    c.emit_opcode(Opcode::Tail_Call);
+    c.emit_value<Function_Index>(defn->index);
+    c.emit_size(uuid->type.data.func.arg_size());
+    return true;
+}
+
 void Typed_AST_Return::compile(Compiler &c) {
     Address stack_top = c.stack_top;
 
     c.compile_deferred_statements(&c.current_scope(), nullptr, Clear_Defers::No);
     
+    if (sub && compile_tail_call(c, sub)) {
+        c.stack_top = stack_top;
+        return;
+    }
+    
     Size size = 0;
     if (sub) {
         size = sub->type.size();
@@ -812,6 +1209,13 @@ void Typed_AST_Loop_Control::compile(Compiler &c) {
 
     c.compile_deferred_statements(&c.current_scope(), loop->scope->parent, Clear_Defers::No);
 
+    // drop any locals declared inside the loop so the target sees the stack
+    // the way the loop left it.
+    if (c.stack_top != loop->stack_top) {
+        c.emit_opcode(Opcode::Flush);
+        c.emit_address(loop->stack_top);
+    }
+
     size_t jump = c.emit_jump(Opcode::Jump);
 
     if (kind == Typed_AST_Kind::Break) {
@@ -871,20 +1275,10 @@ static void emit_dynamic_offset_load(
     Typed_AST &index,
     Size element_size)
 {
-    // offset = index * element_size
     index.compile(c);
     
-    c.emit_opcode(Opcode::Lit_Int);
-    if (element_size > 1) {
-        c.emit_value<runtime::Int>(element_size);
-        c.emit_opcode(Opcode::Int_Mul);
-    }
-    
-    // element_ptr = &lhs + offset
-    c.emit_opcode(Opcode::Int_Add);
-    
-    // result = Load(element_size, element_ptr)
-    c.emit_opcode(Opcode::Load);
+    // result = Load(&lhs + index * element_size, element_size)
+    c.emit_opcode(Opcode::Load_Indexed);
     c.emit_size(element_size);
 }
 
@@ -940,7 +1334,7 @@ static void compile_subscript_operator_for_constant(
         
         c.emit_opcode(Opcode::Load_Const);
         c.emit_size(child_size);
-        c.emit_address(v->address + idx * child_size);
+        c.emit_constant_index(v->address + idx * child_size);
     }
     
     c.stack_top = stack_top + child_size;
@@ -951,7 +1345,7 @@ static void compile_subscript_operator(Compiler &c, Typed_AST_Binary &sub) {
         compile_range_subscript_operator(c, sub);
         return;
     } else if (sub.lhs->kind == Typed_AST_Kind::Ident) {
-        String id = sub.lhs.cast<Typed_AST_Ident>()->id;
+        Symbol id = sub.lhs.cast<Typed_AST_Ident>()->id;
         auto [result, v] = c.find_variable(id);
         
         if (result == Find_Variable_Result::Found_Constant) {
@@ -1007,18 +1401,10 @@ static void compile_subscript_operator(Compiler &c, Typed_AST_Binary &sub) {
         c.emit_opcode(Opcode::Load);
         c.emit_size(value_types::Ptr.size());
         
-        // element_ptr = data + index * sizeof(Element)
+        // element = Load(data + index * sizeof(Element), sizeof(Element))
         sub.rhs->compile(c);
         
-        c.emit_opcode(Opcode::Lit_Int);
-        c.emit_value<runtime::Int>(sub.type.size());
-        
-        c.emit_opcode(Opcode::Int_Mul);
-        
-        c.emit_opcode(Opcode::Int_Add);
-        
-        // element = Load(element_ptr, sizeof(Element))
-        c.emit_opcode(Opcode::Load);
+        c.emit_opcode(Opcode::Load_Indexed);
         c.emit_size(sub.type.size());
             
 //            if (!success) {
@@ -1047,13 +1433,31 @@ static void compile_negative_subscript_operator(Compiler &c, Typed_AST_Binary &s
     c.stack_top = stack_top + sub.type.size();
 }
 
+// the arguments must already be on the stack
+static void emit_call(Compiler &c, Ref<Typed_AST> callee) {
+    Size arg_size = callee->type.data.func.arg_size();
+    
+    // calling a function by name, no need to push its definition
+    auto uuid = callee.cast<Typed_AST_UUID>();
+    if (uuid && uuid->type.kind == Value_Type_Kind::Function) {
+        Function_Definition *defn = c.interp->functions.get_func_by_uuid(uuid->uuid);
+        internal_verify(defn, "Failed to retrieve Function_Definition in emit_call().");
+        c.emit_opcode(Opcode::Call_Direct);
+        c.emit_value<Function_Index>(defn->index);
+        c.emit_size(arg_size);
+        return;
+    }
+    
+    callee->compile(c);
+    c.emit_opcode(Opcode::Call);
+    c.emit_size(arg_size);
+}
+
 static void compile_function_call(Compiler &c, Typed_AST_Binary &call) {
     Address stack_top = c.stack_top;
     
     call.rhs->compile(c);
-    call.lhs->compile(c);
-    c.emit_opcode(Opcode::Call);
-    c.emit_size(call.lhs->type.data.func.arg_size());
+    emit_call(c, call.lhs);
     
     c.stack_top = stack_top + call.type.size();
 }
@@ -1086,9 +1490,7 @@ void Typed_AST_Variadic_Call::compile(Compiler &c) {
         }
     }
     
-    func->compile(c);
-    c.emit_opcode(Opcode::Call);
-    c.emit_size(func->type.data.func.arg_size());
+    emit_call(c, func);
     
     c.stack_top = stack_top + type.size();
 }
@@ -1100,14 +1502,101 @@ static void compile_builtin_call(Compiler &c, Typed_AST_Binary &call) {
     internal_verify(builtin, "Failed to cast builtin to a Builtin*.");
     
     call.rhs->compile(c);
+    
+    // not the builtin's arg_size() because @print and @puts also push a definition for structs and enums
+    Size arg_size = c.stack_top - stack_top;
     c.emit_opcode(Opcode::Call_Builtin);
-    c.emit_value<Builtin>(builtin->defn->builtin);
-    c.emit_size(builtin->type.data.func.arg_size());
+    c.emit_value<Builtin_Index>(builtin->defn->index);
+    c.emit_size(arg_size);
     
     c.stack_top = stack_top + call.type.size();
 }
 
+Opcode binary_opcode(Typed_AST_Kind kind, Value_Type_Kind operand) {
+    switch (kind) {
+        case Typed_AST_Kind::Addition:
+            if (operand == Value_Type_Kind::Int)
+                return Opcode::Int_Add;
+            else if (operand == Value_Type_Kind::Float)
+                return Opcode::Float_Add;
+            else if (operand == Value_Type_Kind::Byte)
+                return Opcode::Byte_Add;
+            else if (operand == Value_Type_Kind::Str)
+                return Opcode::Str_Add;
+            break;
+        case Typed_AST_Kind::Subtraction:
+            if (operand == Value_Type_Kind::Int)
+                return Opcode::Int_Sub;
+            else if (operand == Value_Type_Kind::Float)
+                return Opcode::Float_Sub;
+            else if (operand == Value_Type_Kind::Byte)
+                return Opcode::Byte_Sub;
+            break;
+        case Typed_AST_Kind::Multiplication:
+            if (operand == Value_Type_Kind::Int)
+                return Opcode::Int_Mul;
+            else if (operand == Value_Type_Kind::Float)
+                return Opcode::Float_Mul;
+            else if (operand == Value_Type_Kind::Byte)
+                return Opcode::Byte_Mul;
+            break;
+        case Typed_AST_Kind::Division:
+            if (operand == Value_Type_Kind::Int)
+                return Opcode::Int_Div;
+            else if (operand == Value_Type_Kind::Float)
+                return Opcode::Float_Div;
+            else if (operand == Value_Type_Kind::Byte)
+                return Opcode::Byte_Div;
+            break;
+        case Typed_AST_Kind::Mod:
+            if (operand == Value_Type_Kind::Int)
+                return Opcode::Int_Mod;
+            else if (operand == Value_Type_Kind::Byte)
+                return Opcode::Byte_Mod;
+            break;
+            
+        case Typed_AST_Kind::Less:
+            if (operand == Value_Type_Kind::Int)
+                return Opcode::Int_Less_Than;
+            else if (operand == Value_Type_Kind::Float)
+                return Opcode::Float_Less_Than;
+            else if (operand == Value_Type_Kind::Byte)
+                return Opcode::Byte_Less_Than;
+            break;
+        case Typed_AST_Kind::Less_Eq:
+            if (operand == Value_Type_Kind::Int)
+                return Opcode::Int_Less_Equal;
+            else if (operand == Value_Type_Kind::Float)
+                return Opcode::Float_Less_Equal;
+            else if (operand == Value_Type_Kind::Byte)
+                return Opcode::Byte_Less_Equal;
+            break;
+        case Typed_AST_Kind::Greater:
+            if (operand == Value_Type_Kind::Int)
+                return Opcode::Int_Greater_Than;
+            else if (operand == Value_Type_Kind::Float)
+                return Opcode::Float_Greater_Than;
+            else if (operand == Value_Type_Kind::Byte)
+                return Opcode::Byte_Greater_Than;
+            break;
+        case Typed_AST_Kind::Greater_Eq:
+            if (operand == Value_Type_Kind::Int)
+                return Opcode::Int_Greater_Equal;
+            else if (operand == Value_Type_Kind::Float)
+                return Opcode::Float_Greater_Equal;
+            else if (operand == Value_Type_Kind::Byte)
+                return Opcode::Byte_Greater_Equal;
+            break;
+            
+        default:
+            break;
+    }
+    return Opcode::None;
+}
+
 void Typed_AST_Binary::compile(Compiler &c) {
+    if (compile_folded(c, *this) || compile_hoisted(c, *this)) return;
+    
     Address stack_top = c.stack_top;
     
     switch (kind) {
@@ -1159,86 +1648,8 @@ void Typed_AST_Binary::compile(Compiler &c) {
             return;
     }
     
-    Opcode op;
-    switch (kind) {
-        case Typed_AST_Kind::Addition:
-            if (lhs->type.kind == Value_Type_Kind::Int)
-                op = Opcode::Int_Add;
-            else if (lhs->type.kind == Value_Type_Kind::Float)
-                op = Opcode::Float_Add;
-            else if (lhs->type.kind == Value_Type_Kind::Byte)
-                op = Opcode::Byte_Add;
-            else if (type.kind == Value_Type_Kind::Str)
-                op = Opcode::Str_Add;
-            break;
-        case Typed_AST_Kind::Subtraction:
-            if (lhs->type.kind == Value_Type_Kind::Int)
-                op = Opcode::Int_Sub;
-            else if (lhs->type.kind == Value_Type_Kind::Float)
-                op = Opcode::Float_Sub;
-            else if (lhs->type.kind == Value_Type_Kind::Byte)
-                op = Opcode::Byte_Sub;
-            break;
-        case Typed_AST_Kind::Multiplication:
-            if (lhs->type.kind == Value_Type_Kind::Int)
-                op = Opcode::Int_Mul;
-            else if (lhs->type.kind == Value_Type_Kind::Float)
-                op = Opcode::Float_Mul;
-            else if (lhs->type.kind == Value_Type_Kind::Byte)
-                op = Opcode::Byte_Mul;
-            break;
-        case Typed_AST_Kind::Division:
-            if (lhs->type.kind == Value_Type_Kind::Int)
-                op = Opcode::Int_Div;
-            else if (lhs->type.kind == Value_Type_Kind::Float)
-                op = Opcode::Float_Div;
-            else if (lhs->type.kind == Value_Type_Kind::Byte)
-                op = Opcode::Byte_Div;
-            break;
-        case Typed_AST_Kind::Mod:
-            if (lhs->type.kind == Value_Type_Kind::Int)
-                op = Opcode::Int_Mod;
-            else if (lhs->type.kind == Value_Type_Kind::Byte)
-                op = Opcode::Byte_Mod;
-            break;
-            
-        case Typed_AST_Kind::Less:
-            if (lhs->type.kind == Value_Type_Kind::Int)
-                op = Opcode::Int_Less_Than;
-            else if (lhs->type.kind == Value_Type_Kind::Float)
-                op = Opcode::Float_Less_Than;
-            else if (lhs->type.kind == Value_Type_Kind::Byte)
-                op = Opcode::Byte_Less_Than;
-            break;
-        case Typed_AST_Kind::Less_Eq:
-            if (lhs->type.kind == Value_Type_Kind::Int)
-                op = Opcode::Int_Less_Equal;
-            else if (lhs->type.kind == Value_Type_Kind::Float)
-                op = Opcode::Float_Less_Equal;
-            else if (lhs->type.kind == Value_Type_Kind::Byte)
-                op = Opcode::Byte_Less_Equal;
-            break;
-        case Typed_AST_Kind::Greater:
-            if (lhs->type.kind == Value_Type_Kind::Int)
-                op = Opcode::Int_Greater_Than;
-            else if (lhs->type.kind == Value_Type_Kind::Float)
-                op = Opcode::Float_Greater_Than;
-            else if (lhs->type.kind == Value_Type_Kind::Byte)
-                op = Opcode::Byte_Greater_Than;
-            break;
-        case Typed_AST_Kind::Greater_Eq:
-            if (lhs->type.kind == Value_Type_Kind::Int)
-                op = Opcode::Int_Greater_Equal;
-            else if (lhs->type.kind == Value_Type_Kind::Float)
-                op = Opcode::Float_Greater_Equal;
-            else if (lhs->type.kind == Value_Type_Kind::Byte)
-                op = Opcode::Byte_Greater_Equal;
-            break;
-            
-        default:
-            internal_error("Invalid binary operation: %d.", kind);
-            break;
-    }
+    Opcode op = binary_opcode(kind, lhs->type.kind);
+    internal_verify(op != Opcode::None, "Invalid binary operation: %d.", kind);
     
     lhs->compile(c);
     rhs->compile(c);
@@ -1323,7 +1734,7 @@ void Typed_AST_While::compile(Compiler &c) {
     size_t loop_start = c.function->instructions.size();
     Address stack_top = c.stack_top;
 
-    auto label = this->label ? this->label->id : String{};
+    auto label = this->label ? this->label->id : Symbol{};
     c.begin_loop(label, location);
 
     condition->compile(c);
@@ -1344,13 +1755,270 @@ void Typed_AST_While::compile(Compiler &c) {
     c.stack_top = stack_top;
 }
 
+//
+// Calls `visit` on each node directly inside `node` that runs as part of it and
+// stops at the first one `visit` returns false for. Function declarations and
+// defers aren't looked inside since their bodies run somewhere else. Returns
+// false for a match, its patterns bind variables that can't be followed here.
+//
+template<typename Visit>
+static bool for_each_child(Typed_AST &node, Visit visit) {
+    auto each = [&](std::vector<Ref<Typed_AST>> &nodes) {
+        for (auto &n : nodes) {
+            if (!visit(*n)) return false;
+        }
+        return true;
+    };
+    auto all = [&](Ref<Typed_AST_Multiary> m) {
+        return !m || each(m->nodes);
+    };
+    auto one = [&](Ref<Typed_AST> n) {
+        return !n || visit(*n);
+    };
+    
+    switch (node.kind) {
+        case Typed_AST_Kind::Negation:
+        case Typed_AST_Kind::Not:
+        case Typed_AST_Kind::Address_Of:
+        case Typed_AST_Kind::Address_Of_Mut:
+        case Typed_AST_Kind::Deref:
+        case Typed_AST_Kind::Return:
+            return one(static_cast<Typed_AST_Unary &>(node).sub);
+            
+        case Typed_AST_Kind::Addition:
+        case Typed_AST_Kind::Subtraction:
+        case Typed_AST_Kind::Multiplication:
+        case Typed_AST_Kind::Division:
+        case Typed_AST_Kind::Mod:
+        case Typed_AST_Kind::Assignment:
+        case Typed_AST_Kind::Equal:
+        case Typed_AST_Kind::Not_Equal:
+        case Typed_AST_Kind::Less:
+        case Typed_AST_Kind::Less_Eq:
+        case Typed_AST_Kind::Greater:
+        case Typed_AST_Kind::Greater_Eq:
+        case Typed_AST_Kind::And:
+        case Typed_AST_Kind::Or:
+        case Typed_AST_Kind::Subscript:
+        case Typed_AST_Kind::Negative_Subscript:
+        case Typed_AST_Kind::Range:
+        case Typed_AST_Kind::Inclusive_Range:
+        case Typed_AST_Kind::Function_Call:
+        case Typed_AST_Kind::Builtin_Call: {
+            auto &b = static_cast<Typed_AST_Binary &>(node);
+            return one(b.lhs) && one(b.rhs);
+        }
+            
+        case Typed_AST_Kind::Block:
+        case Typed_AST_Kind::Comma:
+        case Typed_AST_Kind::Tuple:
+            return each(static_cast<Typed_AST_Multiary &>(node).nodes);
+            
+        case Typed_AST_Kind::Array:
+        case Typed_AST_Kind::Slice:
+            return all(static_cast<Typed_AST_Array &>(node).element_nodes);
+        case Typed_AST_Kind::Enum:
+            return all(static_cast<Typed_AST_Enum_Literal &>(node).payload);
+        case Typed_AST_Kind::Let:
+            return one(static_cast<Typed_AST_Let &>(node).initializer);
+            
+        case Typed_AST_Kind::Cast_Byte_Int:
+        case Typed_AST_Kind::Cast_Byte_Float:
+        case Typed_AST_Kind::Cast_Bool_Int:
+        case Typed_AST_Kind::Cast_Char_Int:
+        case Typed_AST_Kind::Cast_Int_Float:
+        case Typed_AST_Kind::Cast_Float_Int:
+            return one(static_cast<Typed_AST_Cast &>(node).expr);
+            
+        case Typed_AST_Kind::If: {
+            auto &i = static_cast<Typed_AST_If &>(node);
+            return one(i.cond) && one(i.then) && one(i.else_);
+        }
+        case Typed_AST_Kind::While: {
+            auto &w = static_cast<Typed_AST_While &>(node);
+            return one(w.condition) && all(w.body);
+        }
+        case Typed_AST_Kind::For:
+        case Typed_AST_Kind::For_Range: {
+            auto &f = static_cast<Typed_AST_For &>(node);
+            return one(f.iterable) && all(f.body);
+        }
+        case Typed_AST_Kind::Forever:
+            return all(static_cast<Typed_AST_Forever &>(node).body);
+        case Typed_AST_Kind::Field_Access:
+            return one(static_cast<Typed_AST_Field_Access &>(node).instance);
+        case Typed_AST_Kind::Variadic_Call: {
+            auto &v = static_cast<Typed_AST_Variadic_Call &>(node);
+            return one(v.func) && all(v.args) && all(v.varargs);
+        }
+            
+        case Typed_AST_Kind::Match:
+            return false;
+            
+        default:
+            return true;
+    }
+}
+
+//
+// Whether running `node` could make a pointer into the frame it runs in: taking
+// an address, which is also how a method gets its receiver, a slice literal or a
+// slice of an array, whose elements are on the stack, or a variadic call's
+// slice. Anything that can't be looked inside is assumed to.
+//
+static bool might_point_into_frame(Typed_AST &node) {
+    switch (node.kind) {
+        case Typed_AST_Kind::Address_Of:
+        case Typed_AST_Kind::Address_Of_Mut:
+        case Typed_AST_Kind::Slice:
+        case Typed_AST_Kind::Variadic_Call:
+        case Typed_AST_Kind::Match:
+            return true;
+        case Typed_AST_Kind::Subscript: {
+            auto &b = static_cast<Typed_AST_Binary &>(node);
+            if (b.lhs->type.kind == Value_Type_Kind::Array && b.rhs->type.kind == Value_Type_Kind::Range) return true;
+        } break;
+        case Typed_AST_Kind::Defer:
+            // runs in this frame, just later
+            return might_point_into_frame(*static_cast<Typed_AST_Unary &>(node).sub);
+            
+        default:
+            break;
+    }
+    return !for_each_child(node, [](Typed_AST &child) {
+        return !might_point_into_frame(child);
+    });
+}
+
+// adds the names declared anywhere in `node` to `names`, returns false if they can't all be found
+static bool collect_declared_names(Typed_AST &node, std::unordered_set<Symbol> &names) {
+    if (node.kind == Typed_AST_Kind::Let) {
+        for (auto &b : static_cast<Typed_AST_Let &>(node).target->bindings) names.insert(b.id);
+    } else if (node.kind == Typed_AST_Kind::For || node.kind == Typed_AST_Kind::For_Range) {
+        auto &f = static_cast<Typed_AST_For &>(node);
+        for (auto &b : f.target->bindings) names.insert(b.id);
+        if (f.counter != "") names.insert(f.counter);
+    }
+    return for_each_child(node, [&](Typed_AST &child) {
+        return collect_declared_names(child, names);
+    });
+}
+
+static bool is_scalar(const Value_Type &type) {
+    switch (type.kind) {
+        case Value_Type_Kind::Byte:
+        case Value_Type_Kind::Bool:
+        case Value_Type_Kind::Char:
+        case Value_Type_Kind::Int:
+        case Value_Type_Kind::Float:
+            return true;
+        default:
+            return false;
+    }
+}
+
+//
+// Whether `node` is an operator on scalars that only reads variables nothing in
+// the loop can change, immutable ones declared outside of it. Division and mod
+// are left out since they can fail and the loop might never have run them.
+//
+static bool is_loop_invariant(Compiler &c, Typed_AST &node, const std::unordered_set<Symbol> &declared) {
+    switch (node.kind) {
+        case Typed_AST_Kind::Byte:
+        case Typed_AST_Kind::Bool:
+        case Typed_AST_Kind::Char:
+        case Typed_AST_Kind::Int:
+        case Typed_AST_Kind::Float:
+            return true;
+        case Typed_AST_Kind::Ident: {
+            auto &id = static_cast<Typed_AST_Ident &>(node).id;
+            if (declared.count(id)) return false;
+            auto [status, v] = c.find_variable(id);
+            return status != Find_Variable_Result::Not_Found && !v->type.is_mut && is_scalar(v->type);
+        }
+            
+        case Typed_AST_Kind::Negation:
+        case Typed_AST_Kind::Not:
+            return is_scalar(node.type) && is_loop_invariant(c, *static_cast<Typed_AST_Unary &>(node).sub, declared);
+        case Typed_AST_Kind::Addition:
+        case Typed_AST_Kind::Subtraction:
+        case Typed_AST_Kind::Multiplication:
+        case Typed_AST_Kind::Equal:
+        case Typed_AST_Kind::Not_Equal:
+        case Typed_AST_Kind::Less:
+        case Typed_AST_Kind::Less_Eq:
+        case Typed_AST_Kind::Greater:
+        case Typed_AST_Kind::Greater_Eq:
+        case Typed_AST_Kind::And:
+        case Typed_AST_Kind::Or: {
+            auto &b = static_cast<Typed_AST_Binary &>(node);
+            return is_scalar(node.type) && is_loop_invariant(c, *b.lhs, declared) && is_loop_invariant(c, *b.rhs, declared);
+        }
+        case Typed_AST_Kind::Cast_Byte_Int:
+        case Typed_AST_Kind::Cast_Byte_Float:
+        case Typed_AST_Kind::Cast_Bool_Int:
+        case Typed_AST_Kind::Cast_Char_Int:
+        case Typed_AST_Kind::Cast_Int_Float:
+        case Typed_AST_Kind::Cast_Float_Int:
+            return is_loop_invariant(c, *static_cast<Typed_AST_Cast &>(node).expr, declared);
+            
+        default:
+            return false;
+    }
+}
+
+static void hoist_invariants(Compiler &c, Typed_AST &node, const std::unordered_set<Symbol> &declared, std::vector<const Typed_AST *> &hoisted) {
+    // constants are worked out by a VM of their own that can't see the loop's slots
+    if (node.kind == Typed_AST_Kind::Let && static_cast<Typed_AST_Let &>(node).is_const) return;
+    
+    bool is_operator = node.kind != Typed_AST_Kind::Ident && !node.is_constant(c);
+    if (is_operator && is_loop_invariant(c, node, declared)) {
+        Address address = c.stack_top;
+        node.compile(c);
+        c.hoisted[&node] = address;
+        hoisted.push_back(&node);
+        return;
+    }
+    
+    for_each_child(node, [&](Typed_AST &child) {
+        hoist_invariants(c, child, declared, hoisted);
+        return true;
+    });
+}
+
+//
+// Works out the expressions in the body of `f` that come out the same on every
+// iteration once before the loop starts, into slots of their own that the body
+// then pushes instead. Returns the nodes that were hoisted so they can be
+// forgotten when the loop ends.
+//
+static std::vector<const Typed_AST *> hoist_loop_invariants(Compiler &c, Typed_AST_For &f) {
+    std::vector<const Typed_AST *> hoisted;
+    
+    std::unordered_set<Symbol> declared;
+    for (auto &b : f.target->bindings) declared.insert(b.id);
+    if (f.counter != "") declared.insert(f.counter);
+    if (!collect_declared_names(*f.body, declared)) return hoisted;
+    
+    hoist_invariants(c, *f.body, declared, hoisted);
+    return hoisted;
+}
+
+static void forget_hoisted(Compiler &c, const std::vector<const Typed_AST *> &hoisted) {
+    for (auto node : hoisted) c.hoisted.erase(node);
+}
+
+//
+// Walks a cursor over the elements instead of indexing with the counter, so
+// each iteration only bumps a pointer rather than working out
+// `base + counter * size`. Where the elements end is worked out once up front.
+//
 static void compile_for_loop(Typed_AST_For &f, Compiler &c) {
-    // initialize counter variable
+    // initialize counter variable, only kept if the loop names it
     Variable counter_v = { false, value_types::Int, c.stack_top };
-    c.emit_opcode(Opcode::Lit_0);
-    c.stack_top += counter_v.type.size();
-    
     if (f.counter != "") {
+        c.emit_opcode(Opcode::Lit_0);
+        c.stack_top += counter_v.type.size();
         c.put_variable(f.counter, counter_v.type, counter_v.address);
     }
     
@@ -1367,6 +2035,42 @@ static void compile_for_loop(Typed_AST_For &f, Compiler &c) {
         f.iterable->compile(c);
     }
     
+    // elements with no size still need the cursor to move for the loop to end
+    Size stride = std::max<Size>(iterable_v.type.child_type()->size(), 1);
+    
+    // cursor_v = &iterable[0]
+    Variable cursor_v = { false, value_types::Ptr, c.stack_top };
+    if (iterable_v.type.kind == Value_Type_Kind::Array) {
+        c.emit_opcode(Opcode::Push_Pointer);
+        c.emit_address(iterable_v.address);
+    } else {
+        c.emit_opcode(Opcode::Push_Value);
+        c.emit_size(value_types::Ptr.size());
+        c.emit_address(iterable_v.address);
+    }
+    c.stack_top += cursor_v.type.size();
+    
+    // end_v = cursor_v + count * stride
+    Variable end_v = { false, value_types::Ptr, c.stack_top };
+    c.emit_opcode(Opcode::Push_Value);
+    c.emit_size(cursor_v.type.size());
+    c.emit_address(cursor_v.address);
+    if (iterable_v.type.kind == Value_Type_Kind::Array) {
+        c.emit_opcode(Opcode::Lit_Int);
+        c.emit_value<runtime::Int>(iterable_v.type.data.array.count * stride);
+    } else {
+        c.emit_opcode(Opcode::Push_Value);
+        c.emit_size(value_types::Int.size());
+        c.emit_address(iterable_v.address + value_types::Ptr.size());
+        
+        c.emit_opcode(Opcode::Lit_Int);
+        c.emit_value<runtime::Int>(stride);
+        
+        c.emit_opcode(Opcode::Int_Mul);
+    }
+    c.emit_opcode(Opcode::Int_Add);
+    c.stack_top += end_v.type.size();
+    
     // initialize target variable
     Variable target_v = { false, *iterable_v.type.child_type(), c.stack_top };
     c.put_variables_from_pattern(*f.target, target_v.address);
@@ -1374,57 +2078,25 @@ static void compile_for_loop(Typed_AST_For &f, Compiler &c) {
     c.emit_size(target_v.type.size());
     c.stack_top += target_v.type.size();
     
+    auto hoisted = hoist_loop_invariants(c, f);
+    
     size_t loop_start = c.function->instructions.size();
     
     // test condition
     c.emit_opcode(Opcode::Push_Value);
-    c.emit_size(counter_v.type.size());
-    c.emit_address(counter_v.address);
+    c.emit_size(cursor_v.type.size());
+    c.emit_address(cursor_v.address);
     
-    if (iterable_v.type.kind == Value_Type_Kind::Array) {
-        if (iterable_v.type.data.array.count == 1) {
-            c.emit_opcode(Opcode::Lit_1);
-        } else {
-            c.emit_opcode(Opcode::Lit_Int);
-            c.emit_value<runtime::Int>(iterable_v.type.data.array.count);
-        }
-    } else {
-        c.emit_opcode(Opcode::Push_Value);
-        c.emit_size(value_types::Int.size());
-        c.emit_address(iterable_v.address + value_types::Ptr.size());
-    }
+    c.emit_opcode(Opcode::Push_Value);
+    c.emit_size(end_v.type.size());
+    c.emit_address(end_v.address);
     
-    c.emit_opcode(Opcode::Int_Less_Than);
-    size_t exit_jump = c.emit_jump(Opcode::Jump_False, false);
+    size_t exit_jump = c.emit_jump(Opcode::Int_Lt_Jump_False, false);
     
-    // target_v = iterable[counter]
+    // target_v = *cursor_v
     c.emit_opcode(Opcode::Push_Value);
-    c.emit_size(counter_v.type.size());
-    c.emit_address(counter_v.address);
-    
-    if (iterable_v.type.kind == Value_Type_Kind::Array) {
-        c.emit_opcode(Opcode::Lit_Int);
-        c.emit_value<runtime::Int>(target_v.type.size());
-        
-        c.emit_opcode(Opcode::Int_Mul);
-        
-        c.emit_opcode(Opcode::Push_Pointer);
-        c.emit_address(iterable_v.address);
-        
-        c.emit_opcode(Opcode::Int_Add);
-    } else {
-        c.emit_opcode(Opcode::Lit_Int);
-        c.emit_value<runtime::Int>(iterable_v.type.child_type()->size());
-        
-        c.emit_opcode(Opcode::Int_Mul);
-        
-        c.emit_opcode(Opcode::Push_Value);
-//        c.emit_size(sizeof(size_t));
-        c.emit_size(value_types::Ptr.size());
-        c.emit_address(iterable_v.address);
-        
-        c.emit_opcode(Opcode::Int_Add);
-    }
+    c.emit_size(cursor_v.type.size());
+    c.emit_address(cursor_v.address);
     
     c.emit_opcode(Opcode::Push_Pointer);
     c.emit_address(target_v.address);
@@ -1432,7 +2104,7 @@ static void compile_for_loop(Typed_AST_For &f, Compiler &c) {
     c.emit_opcode(Opcode::Copy);
     c.emit_size(target_v.type.size());
     
-    auto label = f.label ? f.label->id : String{};
+    auto label = f.label ? f.label->id : Symbol{};
     c.begin_loop(label, f.location);
     
     f.body->compile(c);
@@ -1441,10 +2113,16 @@ static void compile_for_loop(Typed_AST_For &f, Compiler &c) {
 
     c.patch_loop_controls(loop.continues);
     
-    // increment counter
-    c.emit_opcode(Opcode::Push_Pointer);
-    c.emit_address(counter_v.address);
-    c.emit_opcode(Opcode::Int_Inc);
+    if (f.counter != "") {
+        // increment counter
+        c.emit_opcode(Opcode::Inc_Local);
+        c.emit_address(counter_v.address);
+    }
+    
+    // advance cursor
+    c.emit_opcode(Opcode::Add_Local);
+    c.emit_address(cursor_v.address);
+    c.emit_value<runtime::Int>(stride);
 
     c.emit_loop(loop_start);
 
@@ -1452,6 +2130,8 @@ static void compile_for_loop(Typed_AST_For &f, Compiler &c) {
     c.patch_loop_controls(loop.breaks);
 
     c.end_loop();
+    
+    forget_hoisted(c, hoisted);
 }
 
 static void compile_for_range_loop(Typed_AST_For &f, Compiler &c) {
@@ -1477,6 +2157,8 @@ static void compile_for_range_loop(Typed_AST_For &f, Compiler &c) {
     
     Variable end_v = { false, range->rhs->type, c.stack_top };
     range->rhs->compile(c);
+    
+    auto hoisted = hoist_loop_invariants(c, f);
 
     size_t loop_start = c.function->instructions.size();
 
@@ -1489,10 +2171,10 @@ static void compile_for_range_loop(Typed_AST_For &f, Compiler &c) {
     c.emit_size(end_v.type.size());
     c.emit_address(end_v.address);
     
-    c.emit_opcode(f.iterable->type.data.range.inclusive ? Opcode::Int_Less_Equal : Opcode::Int_Less_Than);
-    size_t exit_jump = c.emit_jump(Opcode::Jump_False, false);
+    auto test = f.iterable->type.data.range.inclusive ? Opcode::Int_Le_Jump_False : Opcode::Int_Lt_Jump_False;
+    size_t exit_jump = c.emit_jump(test, false);
 
-    auto label = f.label ? f.label->id : String{};
+    auto label = f.label ? f.label->id : Symbol{};
     c.begin_loop(label, f.location);
 
     f.body->compile(c);
@@ -1502,15 +2184,13 @@ static void compile_for_range_loop(Typed_AST_For &f, Compiler &c) {
     
     if (counter_v) {
         // increment counter
-        c.emit_opcode(Opcode::Push_Pointer);
+        c.emit_opcode(Opcode::Inc_Local);
         c.emit_address(counter_v->address);
-        c.emit_opcode(Opcode::Int_Inc);
     }
     
     // increment target_v
-    c.emit_opcode(Opcode::Push_Pointer);
+    c.emit_opcode(Opcode::Inc_Local);
     c.emit_address(target_v.address);
-    c.emit_opcode(Opcode::Int_Inc);
     
     c.emit_loop(loop_start);
     
@@ -1518,6 +2198,8 @@ static void compile_for_range_loop(Typed_AST_For &f, Compiler &c) {
     c.patch_loop_controls(loop.breaks);
 
     c.end_loop();
+    
+    forget_hoisted(c, hoisted);
 }
 
 void Typed_AST_For::compile(Compiler &c) {
@@ -1543,7 +2225,7 @@ void Typed_AST_Forever::compile(Compiler &c) {
     size_t loop_start = c.function->instructions.size();
     Address stack_top = c.stack_top;
 
-    auto label = this->label ? this->label->id : String{};
+    auto label = this->label ? this->label->id : Symbol{};
     c.begin_loop(label, location);
     
     body->compile(c);
@@ -1578,7 +2260,7 @@ void Typed_AST_Match::compile(Compiler &c) {
     //      Bit of a hack just to get this to work. There's probably a better way
     //      to achieve the same effect.
     //
-    std::vector<std::vector<std::pair<String, Variable>>> idents;
+    std::vector<std::vector<std::pair<Symbol, Variable>>> idents;
     
     // arms conditions
     for (auto arm : arms->nodes) {
@@ -1761,17 +2443,41 @@ void Typed_AST_Let::compile(Compiler &c) {
     
     c.put_variables_from_pattern(*target, stack_top);
     
+    // reads of an immutable variable can use its value directly
+    Constant_Value value;
+    if (initializer && target->bindings.size() == 1 && !target->bindings[0].type.is_mut && c.fold(*initializer, value)) {
+        Variable *v = c.find_variable(target->bindings[0].id).variable;
+        v->is_known = true;
+        v->known = value;
+    }
+    
     c.stack_top = stack_top + type.size();
 }
 
+// field = Load(&instance + field_offset, sizeof(field))
+static void emit_field_load(Compiler &c, Typed_AST_Field_Access &dot) {
+    if (dot.deref) {
+        dot.instance->compile(c);
+    } else {
+        bool success = emit_address_code(c, *dot.instance);
+        verify(success, dot.instance->location, "Cannot access field of this expression.");
+    }
+    
+    if (dot.field_offset == 0) {
+        c.emit_opcode(Opcode::Load);
+        c.emit_size(dot.type.size());
+    } else {
+        c.emit_opcode(Opcode::Load_Field_Indirect);
+        c.emit_size(dot.type.size());
+        c.emit_address(dot.field_offset);
+    }
+}
+
 void Typed_AST_Field_Access::compile(Compiler &c) {
     Address stack_top = c.stack_top;
     
     if (deref) {
-        bool success = emit_dynamic_address_code(c, *this);
-        verify(success, instance->location, "Cannot access field of this expression.");
-        c.emit_opcode(Opcode::Load);
-        c.emit_size(type.size());
+        emit_field_load(c, *this);
     } else {
         auto [status, address] = find_static_address(c, *instance);
         switch (status) {
@@ -1786,10 +2492,7 @@ void Typed_AST_Field_Access::compile(Compiler &c) {
                 c.emit_address(address + field_offset);
                 break;
             case Find_Static_Address_Result::Not_Found:
-                bool success = emit_dynamic_address_code(c, *this);
-                verify(success, instance->location, "Cannot access field of this expression.");
-                c.emit_opcode(Opcode::Load);
-                c.emit_size(type.size());
+                emit_field_load(c, *this);
                 break;
         }
     }
@@ -1823,8 +2526,11 @@ void Typed_AST_UUID::compile(Compiler &c) {
 void Typed_AST_Fn_Declaration::compile(Compiler &c) {
     auto fn = c.interp->functions.get_func_by_uuid(defn->uuid);
     auto new_c = Compiler { &c, fn };
+    new_c.frame_escapes = might_point_into_frame(*body);
     
     new_c.begin_scope();
+    if (c.interp->ssa && compile_function_ssa(new_c, *this)) return;
+    
     for (size_t i = 0; i < defn->param_names.size(); i++) {
         new_c.put_variable(
             defn->param_names[i],
@@ -1845,34 +2551,33 @@ void Typed_AST_Fn_Declaration::compile(Compiler &c) {
     }
 }
 
-void Typed_AST_Cast::compile(Compiler &c) {
-    Address stack_top = c.stack_top;
-    
-    Opcode cast_op;
+Opcode cast_opcode(Typed_AST_Kind kind) {
     switch (kind) {
         case Typed_AST_Kind::Cast_Byte_Int:
-            cast_op = Opcode::Cast_Byte_Int;
-            break;
+            return Opcode::Cast_Byte_Int;
         case Typed_AST_Kind::Cast_Byte_Float:
-            cast_op = Opcode::Cast_Byte_Float;
-            break;
+            return Opcode::Cast_Byte_Float;
         case Typed_AST_Kind::Cast_Bool_Int:
-            cast_op = Opcode::Cast_Bool_Int;
-            break;
+            return Opcode::Cast_Bool_Int;
         case Typed_AST_Kind::Cast_Char_Int:
-            cast_op = Opcode::Cast_Char_Int;
-            break;
+            return Opcode::Cast_Char_Int;
         case Typed_AST_Kind::Cast_Int_Float:
-            cast_op = Opcode::Cast_Int_Float;
-            break;
+            return Opcode::Cast_Int_Float;
         case Typed_AST_Kind::Cast_Float_Int:
-            cast_op = Opcode::Cast_Float_Int;
-            break;
+            return Opcode::Cast_Float_Int;
             
         default:
-            internal_error("Invalid Cast Kind: %d\n", kind);
-            break;
+            return Opcode::None;
     }
+}
+
+void Typed_AST_Cast::compile(Compiler &c) {
+    if (compile_folded(c, *this) || compile_hoisted(c, *this)) return;
+    
+    Address stack_top = c.stack_top;
+    
+    Opcode cast_op = cast_opcode(kind);
+    internal_verify(cast_op != Opcode::None, "Invalid Cast Kind: %d\n", kind);
 
     expr->compile(c);
     c.emit_opcode(cast_op);
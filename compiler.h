@@ -13,28 +13,69 @@
 #include <string>
 #include <unordered_map>
 #include <forward_list>
+#include <string.h>
 
 #include "ast.h"
 #include "typer.h"
 #include "vm.h"
 #include "definitions.h"
 
+//
+// A scalar whose value is known at compile time. The value is kept in the low
+// bytes of `bits` with the rest zeroed, so two values of the same kind are
+// equal exactly when their bits are, the same as Opcode::Equal compares them.
+//
+struct Constant_Value {
+    Value_Type_Kind kind = Value_Type_Kind::None;
+    uint64_t bits = 0;
+    
+    template<typename T>
+    T get() const {
+        T value;
+        memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+    
+    template<typename T>
+    void set(Value_Type_Kind value_kind, T value) {
+        static_assert(sizeof(T) <= sizeof(bits));
+        kind = value_kind;
+        bits = 0;
+        memcpy(&bits, &value, sizeof(T));
+    }
+};
+
+//
+// Work out an operation on known values the way the VM would. These return
+// false where the VM would report an error, so that it still gets reported.
+//
+bool fold_unary(Typed_AST_Kind kind, const Constant_Value &value, Constant_Value &out_value);
+bool fold_binary(Typed_AST_Kind kind, const Constant_Value &a, const Constant_Value &b, Constant_Value &out_value);
+bool fold_cast(Typed_AST_Kind kind, const Constant_Value &value, Constant_Value &out_value);
+
+// The opcode for an arithmetic or comparison operator on operands of `operand` kind, Opcode::None if there isn't one.
+Opcode binary_opcode(Typed_AST_Kind kind, Value_Type_Kind operand);
+Opcode cast_opcode(Typed_AST_Kind kind);
+
 struct Variable {
     bool is_const;
     Value_Type type;
     Address address;
+    bool is_known = false; // immutable and initialized with a foldable expression
+    Constant_Value known;
 };
 
 struct Compiler_Scope {
     Address stack_bottom;
     Compiler_Scope *parent;
-    std::unordered_map<std::string, Variable> variables;
+    std::unordered_map<Symbol, Variable> variables;
     std::vector<Ref<Typed_AST>> deferred_statements;
 };
 
 struct Compiler_Loop {
     Compiler_Scope *scope;
-    String label;
+    Address stack_top;  // depth the loop's continue and break targets expect
+    Symbol label;
     Code_Location location;
     std::vector<size_t> breaks;
     std::vector<size_t> continues;
@@ -80,9 +121,17 @@ struct Compiler {
     std::forward_list<Compiler_Scope> scopes;
     std::vector<Compiler_Loop> loops;
     
+    // loop invariant expressions that were worked out before the loop and where they were put
+    std::unordered_map<const Typed_AST *, Address> hoisted;
+    
+    // whether the function might leave a pointer into its own frame, in which case it can't tail call
+    bool frame_escapes = true;
+    
     static constexpr size_t Constants_Allignment = 8;
     Data_Section &constants;
     Data_Section &str_constants;
+    Data_Section_Index &constants_index;
+    Data_Section_Index &str_constants_index;
 //    int wb_top;
 //    AST *ret_statement = nullptr;
     
@@ -95,13 +144,14 @@ struct Compiler {
     void emit_opcode(Opcode op);
     void emit_size(Size size);
     void emit_address(Address address);
+    void emit_constant_index(size_t constant);
     size_t emit_jump(Opcode jump_code, bool update_stack_top = true);
     void patch_jump(size_t jump);
     void emit_loop(size_t loop_start);
     void patch_loop_controls(const std::vector<size_t> &controls);
-    Variable &put_variable(String id, Value_Type type, Address address, bool is_const = false);
+    Variable &put_variable(Symbol id, Value_Type type, Address address, bool is_const = false);
     void put_variables_from_pattern(Typed_AST_Processed_Pattern &pp, Address address);
-    Find_Variable_Result find_variable(String id);
+    Find_Variable_Result find_variable(Symbol id);
     
     template<typename T>
     void emit_value(T value) {
@@ -112,10 +162,15 @@ struct Compiler {
     
     void declare_constant(Typed_AST_Let &let);
     void compile_constant(Variable constant);
+    bool fold(Typed_AST &node, Constant_Value &out_value);
+    void emit_constant_value(const Constant_Value &value);
     
     size_t add_constant(void *data, size_t size);
     size_t add_slice_constant(size_t size, char *source);
     void *get_constant(size_t constant);
+    const std::vector<Builtin> &builtin_table() const;
+    const std::vector<Function_Definition *> &function_table() const;
+    size_t max_call_depth() const;
     
     template<typename T>
     size_t add_constant(T constant) {
@@ -132,9 +187,9 @@ struct Compiler {
     void end_scope();
     void compile_deferred_statements(Compiler_Scope *begin, Compiler_Scope *end, Clear_Defers clear);
 
-    void begin_loop(String label, Code_Location location);
+    void begin_loop(Symbol label, Code_Location location);
     void end_loop();
-    Compiler_Loop *find_loop(String label);
+    Compiler_Loop *find_loop(Symbol label);
     
     template<typename T>
     bool evaluate(Ref<Typed_AST> expression, T &out_result) {
@@ -147,13 +202,25 @@ struct Compiler {
     
     template<typename T>
     void evaluate_unchecked(Ref<Typed_AST> expression, T &out_result) {
+        // scalars can usually be worked out without spinning up a VM
+        if constexpr (!std::is_pointer_v<T> && sizeof(T) <= sizeof(uint64_t)) {
+            Constant_Value value;
+            if (fold(*expression, value)) {
+                out_result = value.get<T>();
+                return;
+            }
+        }
+        
         Function_Definition code;
+        code.name = Symbol::intern("<constant>");
         Function_Definition *old_func = function;
         function = &code;
         expression->compile(*this);
+        emit_opcode(Opcode::Return);
+        emit_size(0);
         function = old_func;
         
-        auto vm = VM { constants, str_constants };
+        auto vm = VM { constants, str_constants, builtin_table(), function_table(), max_call_depth() };
         vm.call(&code, 0);
         vm.run();
         
@@ -0,0 +1,184 @@
+//
+//  dead_code.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "dead_code.h"
+
+#include "bytecode.h"
+
+// instructions that only push a value, dropping them along with the value changes nothing
+static bool is_pure_push(Opcode op) {
+    switch (op) {
+        case Opcode::Lit_True:
+        case Opcode::Lit_False:
+        case Opcode::Lit_0:
+        case Opcode::Lit_1:
+        case Opcode::Lit_0b:
+        case Opcode::Lit_1b:
+        case Opcode::Lit_Char:
+        case Opcode::Lit_Int:
+        case Opcode::Lit_Byte:
+        case Opcode::Lit_Float:
+        case Opcode::Lit_Pointer:
+        case Opcode::Load_Const:
+        case Opcode::Load_Const_String:
+        case Opcode::Push_Pointer:
+        case Opcode::Push_Value:
+        case Opcode::Push_Global_Pointer:
+        case Opcode::Push_Global_Value:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static std::vector<bool> reachable(const std::vector<Instruction> &code) {
+    std::vector<bool> reached(code.size(), false);
+    std::vector<size_t> work;
+    auto reach = [&](size_t i) {
+        if (i < code.size() && !reached[i]) {
+            reached[i] = true;
+            work.push_back(i);
+        }
+    };
+
+    reach(0);
+    while (!work.empty()) {
+        size_t i = work.back();
+        work.pop_back();
+        if (is_jump(code[i].op)) reach(code[i].target);
+        if (falls_through(code[i].op)) reach(i + 1);
+    }
+    return reached;
+}
+
+//
+// stack_depths() gives the lowest depth an instruction is reached at. Whether
+// every path agrees on it matters before dropping a Flush, so this marks the
+// instructions some path reaches at a different depth.
+//
+static std::vector<bool> agreed_depths(
+    const std::vector<Instruction> &code,
+    const std::vector<bool> &reached,
+    const std::vector<int> &depths,
+    int entry_depth,
+    const Callees &callees)
+{
+    std::vector<bool> agreed(code.size() + 1, true);
+    agreed[0] = depths[0] == entry_depth;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < code.size(); i++) {
+            if (!reached[i]) continue;
+
+            // a flush puts the stack in the same place whatever it was before
+            bool resets = code[i].op == Opcode::Flush || code[i].op == Opcode::Flush_Value;
+            int after = depth_after(code, i, depths[i], callees);
+            auto check = [&](size_t next) {
+                if (agreed[next] && ((!agreed[i] && !resets) || after == Unknown_Depth || after != depths[next])) {
+                    agreed[next] = false;
+                    changed = true;
+                }
+            };
+            if (is_jump(code[i].op)) check(code[i].target);
+            if (falls_through(code[i].op)) check(i + 1);
+        }
+    }
+    return agreed;
+}
+
+bool eliminate_dead_code(std::vector<Instruction> &code, int entry_depth, const Callees &callees) {
+    if (code.empty()) return false;
+
+    auto reached = reachable(code);
+    auto depths = stack_depths(code, entry_depth, callees);
+    auto agreed = agreed_depths(code, reached, depths, entry_depth, callees);
+
+    std::vector<bool> is_target(code.size() + 1, false);
+    for (size_t i = 0; i < code.size(); i++) {
+        if (reached[i] && is_jump(code[i].op)) is_target[code[i].target] = true;
+    }
+
+    std::vector<bool> removed(code.size(), false);
+    bool changed = false;
+    auto remove = [&](size_t i) {
+        removed[i] = true;
+        changed = true;
+    };
+
+    for (size_t i = 0; i < code.size(); i++) {
+        if (!reached[i]) {
+            remove(i);
+            continue;
+        }
+        if (removed[i]) continue;
+
+        auto &inst = code[i];
+        bool has_next = i + 1 < code.size() && !removed[i + 1];
+
+        // a literal condition always jumps or never does
+        if ((inst.op == Opcode::Lit_True || inst.op == Opcode::Lit_False) && has_next && !is_target[i + 1]) {
+            auto &jump = code[i + 1];
+            bool jumps_on_true = jump.op == Opcode::Jump_True || jump.op == Opcode::Jump_True_No_Pop;
+            bool pops = jump.op == Opcode::Jump_True || jump.op == Opcode::Jump_False;
+            if (jumps_on_true || jump.op == Opcode::Jump_False || jump.op == Opcode::Jump_False_No_Pop) {
+                bool taken = jumps_on_true == (inst.op == Opcode::Lit_True);
+                if (pops) remove(i);
+                if (taken) {
+                    jump.op = Opcode::Jump;
+                } else {
+                    remove(i + 1);
+                }
+                changed = true;
+                continue;
+            }
+        }
+
+        if (depths[i] == Unknown_Depth) continue;
+
+        if (is_pure_push(inst.op) && has_next) {
+            auto &next = code[i + 1];
+            int pushed = depth_after(code, i, depths[i], callees) - depths[i];
+
+            // Flush drops the value no matter which path got there
+            if (next.op == Opcode::Flush && next.address <= depths[i]) {
+                remove(i);
+                continue;
+            }
+            if (next.op == Opcode::Pop && next.size == pushed && !is_target[i + 1]) {
+                remove(i);
+                remove(i + 1);
+                continue;
+            }
+        }
+
+        if (inst.op == Opcode::Flush && agreed[i] && inst.address == depths[i]) {
+            remove(i);
+            continue;
+        }
+    }
+
+    if (!changed) return false;
+
+    // anything that jumped into a removed instruction now lands on whatever follows it
+    std::vector<size_t> new_indices(code.size() + 1);
+    std::vector<Instruction> out;
+    out.reserve(code.size());
+    for (size_t i = 0; i < code.size(); i++) {
+        new_indices[i] = out.size();
+        if (!removed[i]) out.push_back(code[i]);
+    }
+    new_indices[code.size()] = out.size();
+
+    for (auto &inst : out) {
+        if (is_jump(inst.op)) inst.target = new_indices[inst.target];
+    }
+
+    code = std::move(out);
+    return true;
+}
@@ -0,0 +1,23 @@
+//
+//  dead_code.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+#include <vector>
+
+struct Instruction;
+struct Callees;
+
+//
+// Removes instructions that can't affect the result of a function: code no
+// path reaches, conditional jumps on a literal condition, values pushed only to
+// be popped or flushed straight away and flushes that leave the stack where it
+// already is. Jumps are re-pointed at whatever ends up in place of their
+// target. Returns whether anything was removed.
+//
+bool eliminate_dead_code(std::vector<Instruction> &code, int entry_depth, const Callees &callees);
@@ -10,7 +10,7 @@
 #include "vm.h"
 #include "error.h"
 
-bool Struct_Definition::has_field(String id) {
+bool Struct_Definition::has_field(Symbol id) {
     for (auto &f : fields) {
         if (f.id == id) {
             return true;
@@ -19,7 +19,7 @@ bool Struct_Definition::has_field(String id) {
     return false;
 }
 
-Struct_Field *Struct_Definition::find_field(String id) {
+Struct_Field *Struct_Definition::find_field(Symbol id) {
     for (auto &f : fields) {
         if (f.id == id) {
             return &f;
@@ -28,15 +28,13 @@ Struct_Field *Struct_Definition::find_field(String id) {
     return nullptr;
 }
 
-bool Struct_Definition::has_method(String id) {
-    auto sid = id.str();
-    auto it = methods.find(sid);
+bool Struct_Definition::has_method(Symbol id) {
+    auto it = methods.find(id);
     return it != methods.end();
 }
 
-bool Struct_Definition::find_method(String id, Method &out_method) {
-    auto sid = id.str();
-    auto it = methods.find(sid);
+bool Struct_Definition::find_method(Symbol id, Method &out_method) {
+    auto it = methods.find(id);
     if (it != methods.end()) {
         out_method = it->second;
         return true;
@@ -44,7 +42,7 @@ bool Struct_Definition::find_method(String id, Method &out_method) {
     return false;
 }
 
-Enum_Variant *Enum_Definition::find_variant(String id) {
+Enum_Variant *Enum_Definition::find_variant(Symbol id) {
     for (auto &v : variants) {
         if (v.id == id) {
             return &v;
@@ -62,15 +60,13 @@ Enum_Variant *Enum_Definition::find_variant_by_tag(runtime::Int tag) {
     return nullptr;
 }
 
-bool Enum_Definition::has_method(String id) {
-    auto sid = id.str();
-    auto it = methods.find(sid);
+bool Enum_Definition::has_method(Symbol id) {
+    auto it = methods.find(id);
     return it != methods.end();
 }
 
-bool Enum_Definition::find_method(String id, Method &out_method) {
-    auto sid = id.str();
-    auto it = methods.find(sid);
+bool Enum_Definition::find_method(Symbol id, Method &out_method) {
+    auto it = methods.find(id);
     if (it != methods.end()) {
         out_method = it->second;
         return true;
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "String.h"
+#include "symbols.h"
 #include "value.h"
 #include "typedefs.h"
 #include "codelocation.h"
@@ -16,20 +17,31 @@
 #include <unordered_map>
 
 struct Module;
+struct Native_Code;
 
 struct Function_Definition {
     bool varargs;
     UUID uuid;
+    Function_Index index = 0; // where function is in Functions::table, filled in by add_func()
     Module *module;
-    String name;
+    Symbol name;
     Value_Type type;
-    std::vector<String> param_names;
+    std::vector<Symbol> param_names;
     std::vector<uint8_t> instructions;
+    Byte_Span image_instructions; // in place of instructions when the function was loaded from a mapped image
+    std::vector<uint8_t> unoptimized; // instructions as compiled, kept by --watch to optimize again from
+    bool optimized = false; // the optimization passes skip it once they've run over it
+    Size frame_size = 0; // highest stack depth written to by register instructions
+    uint32_t hotness = 0; // calls and loop iterations counted towards VM::jit_threshold
+    Native_Code *native = nullptr; // filled in by the JIT once the function gets hot
+    
+    // The code that runs, instructions unless the function came from an image.
+    Byte_Span code() const { return image_instructions.data() ? image_instructions : Byte_Span(instructions); }
 };
 
 struct Struct_Field {
     Size offset;
-    String id;
+    Symbol id;
     Value_Type type;
 };
 
@@ -43,15 +55,15 @@ struct Struct_Definition {
     // Struct_Definition *super;
     UUID uuid;
     Module *module;
-    String name;
+    Symbol name;
     std::vector<Struct_Field> fields;
-    std::unordered_map<std::string, Method> methods;
+    std::unordered_map<Symbol, Method> methods;
     // std::vector<Ref<Typed_AST>> initializer;
     
-    bool has_field(String id);
-    Struct_Field *find_field(String id);
-    bool has_method(String id);
-    bool find_method(String id, Method &out_method);
+    bool has_field(Symbol id);
+    Struct_Field *find_field(Symbol id);
+    bool has_method(Symbol id);
+    bool find_method(Symbol id, Method &out_method);
 };
 
 struct Enum_Payload_Field {
@@ -61,7 +73,7 @@ struct Enum_Payload_Field {
 
 struct Enum_Variant {
     runtime::Int tag;
-    String id;
+    Symbol id;
     std::vector<Enum_Payload_Field> payload;
 };
 
@@ -70,25 +82,25 @@ struct Enum_Definition {
     Size size;
     UUID uuid;
     Module *module;
-    String name;
+    Symbol name;
     std::vector<Enum_Variant> variants;
-    std::unordered_map<std::string, Method> methods;
+    std::unordered_map<Symbol, Method> methods;
     
-    Enum_Variant *find_variant(String id);
+    Enum_Variant *find_variant(Symbol id);
     Enum_Variant *find_variant_by_tag(runtime::Int tag);
-    bool has_method(String id);
-    bool find_method(String id, Method &out_method);
+    bool has_method(Symbol id);
+    bool find_method(Symbol id, Method &out_method);
 };
 
 struct Trait_Method {
     struct Parameter {
-        String name;
+        Symbol name;
         Value_Type type;
     };
 
     bool variadic;
     bool is_method;
-    String name;
+    Symbol name;
     Value_Type return_type;
     std::vector<Parameter> params;
 
@@ -98,6 +110,6 @@ struct Trait_Method {
 struct Trait_Definition {
     UUID uuid;
     Module *module;
-    String name;
+    Symbol name;
     std::vector<Trait_Method> methods;
 };
@@ -0,0 +1,708 @@
+//
+//  emit_c.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "emit_c.h"
+
+#include <cmath>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "bytecode.h"
+#include "error.h"
+#include "interpreter.h"
+
+struct C_Emitter {
+    Interpreter *interp;
+    std::string out;
+
+    // what the pointers Lit_Pointer pushes are called in the C
+    std::unordered_map<const void *, std::string> pointer_names;
+    std::vector<Struct_Definition *> printed_structs;
+    std::vector<Enum_Definition *> printed_enums;
+
+    void line(const char *fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        char buf[512];
+        int len = vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        internal_verify(len >= 0 && len < static_cast<int>(sizeof(buf)), "Line too long in C_Emitter::line().");
+        out += buf;
+        out += '\n';
+    }
+
+    void emit_data_section(const char *name, Byte_Span data);
+    void need_printers(const Value_Type &type);
+    void need_printer(Struct_Definition *defn);
+    void need_printer(Enum_Definition *defn);
+    void emit_print_value(const Value_Type &type, Size offset);
+    void emit_printers();
+    void emit_function(Function_Definition *fn, const std::string &name);
+    void emit_instruction(Function_Definition *fn, const Instruction &inst);
+};
+
+static std::string function_name(Function_Definition *fn) {
+    return "fox_fn_" + std::to_string(fn->index);
+}
+
+static std::string struct_name(Struct_Definition *defn) {
+    return "fox_struct_" + std::to_string(defn->uuid);
+}
+
+static std::string enum_name(Enum_Definition *defn) {
+    return "fox_enum_" + std::to_string(defn->uuid);
+}
+
+// "<puts-int>" -> "fox_builtin_puts_int"
+static std::string builtin_name(const std::string &id) {
+    std::string name = "fox_builtin_";
+    for (char c : id) {
+        if (c == '<' || c == '>') continue;
+        name += c == '-' ? '_' : c;
+    }
+    return name;
+}
+
+static std::string int_literal(int64_t value) {
+    if (value == INT64_MIN) return "INT64_MIN";
+    return "INT64_C(" + std::to_string(value) + ")";
+}
+
+static std::string c_string_literal(const char *s, size_t len) {
+    std::string literal = "\"";
+    for (size_t i = 0; i < len; i++) {
+        char c = s[i];
+        if (c == '"' || c == '\\') literal += '\\';
+        if (c == '%') literal += '%'; // everything ends up as a printf() format
+        literal += c;
+    }
+    return literal + "\"";
+}
+
+void C_Emitter::emit_data_section(const char *name, Byte_Span data) {
+    // C doesn't allow empty arrays
+    line("static uint8_t %s[%zu] = {", name, std::max<size_t>(data.size(), 1));
+    std::string row;
+    for (size_t i = 0; i < data.size(); i++) {
+        row += std::to_string(data[i]) + ",";
+        if (row.size() > 100 || i + 1 == data.size()) {
+            line("    %s", row.c_str());
+            row.clear();
+        }
+    }
+    line("};");
+    line("");
+}
+
+void C_Emitter::need_printers(const Value_Type &type) {
+    if (type.kind == Value_Type_Kind::Struct) {
+        need_printer(type.data.struct_.defn);
+    } else if (type.kind == Value_Type_Kind::Enum) {
+        need_printer(type.data.enum_.defn);
+    }
+}
+
+void C_Emitter::need_printer(Struct_Definition *defn) {
+    if (std::find(printed_structs.begin(), printed_structs.end(), defn) != printed_structs.end()) return;
+    printed_structs.push_back(defn);
+    for (auto &field : defn->fields) {
+        need_printers(field.type);
+    }
+}
+
+void C_Emitter::need_printer(Enum_Definition *defn) {
+    if (std::find(printed_enums.begin(), printed_enums.end(), defn) != printed_enums.end()) return;
+    printed_enums.push_back(defn);
+    for (auto &variant : defn->variants) {
+        for (auto &p : variant.payload) {
+            need_printers(p.type);
+        }
+    }
+}
+
+// the same as print_value() in builtins.cpp
+void C_Emitter::emit_print_value(const Value_Type &type, Size offset) {
+    switch (type.kind) {
+        case Value_Type_Kind::Byte:   line("    fox_print_byte(p + %u);", offset); break;
+        case Value_Type_Kind::Bool:   line("    fox_print_bool(p + %u);", offset); break;
+        case Value_Type_Kind::Char:   line("    fox_print_char(p + %u);", offset); break;
+        case Value_Type_Kind::Int:    line("    fox_print_int(p + %u);", offset); break;
+        case Value_Type_Kind::Float:  line("    fox_print_float(p + %u);", offset); break;
+        case Value_Type_Kind::Str:    line("    fox_print_str(p + %u);", offset); break;
+        case Value_Type_Kind::Struct: line("    print_%s(p + %u);", struct_name(type.data.struct_.defn).c_str(), offset); break;
+        case Value_Type_Kind::Enum:   line("    print_%s(p + %u);", enum_name(type.data.enum_.defn).c_str(), offset); break;
+        default: {
+            const char *display = type.display_str();
+            line("    printf(%s);", c_string_literal(display, strlen(display)).c_str());
+        } break;
+    }
+}
+
+void C_Emitter::emit_printers() {
+    for (auto defn : printed_structs) {
+        line("static void print_%s(const uint8_t *p);", struct_name(defn).c_str());
+    }
+    for (auto defn : printed_enums) {
+        line("static void print_%s(const uint8_t *p);", enum_name(defn).c_str());
+    }
+    line("");
+
+    for (auto defn : printed_structs) {
+        std::string name = struct_name(defn);
+        line("static const Fox_Type %s = { %u, print_%s };", name.c_str(), defn->size, name.c_str());
+        line("static void print_%s(const uint8_t *p) {", name.c_str());
+        line("    printf(%s);", c_string_literal(defn->name.c_str(), defn->name.size()).c_str());
+        line("    printf(\"{ \");");
+        for (size_t i = 0; i < defn->fields.size(); i++) {
+            auto &field = defn->fields[i];
+            line("    printf(%s);", c_string_literal(field.id.c_str(), field.id.size()).c_str());
+            line("    printf(\": \");");
+            emit_print_value(field.type, field.offset);
+            if (i + 1 < defn->fields.size()) line("    printf(\", \");");
+        }
+        line("    printf(\" }\");");
+        line("}");
+        line("");
+    }
+
+    for (auto defn : printed_enums) {
+        std::string name = enum_name(defn);
+        line("static const Fox_Type %s = { %u, print_%s };", name.c_str(), defn->size, name.c_str());
+        line("static void print_%s(const uint8_t *p) {", name.c_str());
+        line("    switch (fox_int(p)) {");
+        for (auto &variant : defn->variants) {
+            line("    case %s:", int_literal(variant.tag).c_str());
+            line("    printf(%s);", c_string_literal(variant.id.c_str(), variant.id.size()).c_str());
+            if (!variant.payload.empty()) {
+                line("    printf(\"(\");");
+                for (size_t i = 0; i < variant.payload.size(); i++) {
+                    emit_print_value(variant.payload[i].type, variant.payload[i].offset);
+                    if (i + 1 < variant.payload.size()) line("    printf(\", \");");
+                }
+                line("    printf(\")\");");
+            }
+            line("    break;");
+        }
+        line("    default:");
+        line("    fox_error(%s);", c_string_literal("Invalid variant tag.", 20).c_str());
+        line("    }");
+        line("}");
+        line("");
+    }
+}
+
+void C_Emitter::emit_instruction(Function_Definition *fn, const Instruction &inst) {
+    unsigned size = inst.size;
+    unsigned address = inst.address;
+    unsigned a = inst.a;
+    unsigned b = inst.b;
+    std::string imm = int_literal(static_cast<int64_t>(inst.value));
+
+    #define PUSH_CHECK(n) line("    fox_check_stack(sp + %u);", static_cast<unsigned>(n))
+    #define INT_BIOP(expr) line("    fox_set_int(sp - 16, " expr "); sp -= 8;")
+    #define BYTE_BIOP(op) line("    fox_set_byte(sp - 2, (uint8_t)(fox_byte(sp - 2) " op " fox_byte(sp - 1))); sp -= 1;")
+    #define FLOAT_BIOP(op) line("    fox_set_float(sp - 16, fox_float(sp - 16) " op " fox_float(sp - 8)); sp -= 8;")
+    #define COMPARE(type, width, op) line("    fox_set_bool(sp - %d, fox_" type "(sp - %d) " op " fox_" type "(sp - %d)); sp -= %d;", 2 * (width), 2 * (width), (width), 2 * (width) - 1)
+    #define CHECK_ZERO(type, width, op) line("    fox_check_zero(fox_" type "(sp - %d) == 0, \"" op "\");", (width))
+    #define REG_BIOP(ret, type, expr) line("    fox_set_" ret "(bp + %u, " expr ");", address, a, b)
+    #define REG_COMPARE(type, op) line("    fox_set_bool(bp + %u, fox_" type "(bp + %u) " op " fox_" type "(bp + %u));", address, a, b)
+    #define REG_COMPARE_IMM(op) line("    fox_set_bool(bp + %u, fox_int(bp + %u) " op " %s);", address, a, imm.c_str())
+    #define REG_CHECK_ZERO(type, op) line("    fox_check_zero(fox_" type "(bp + %u) == 0, \"" op "\");", b)
+
+    switch (inst.op) {
+        // Literals
+        case Opcode::Lit_True:
+        case Opcode::Lit_1b:
+            PUSH_CHECK(1);
+            line("    fox_set_byte(sp, 1); sp += 1;");
+            break;
+        case Opcode::Lit_False:
+        case Opcode::Lit_0b:
+            PUSH_CHECK(1);
+            line("    fox_set_byte(sp, 0); sp += 1;");
+            break;
+        case Opcode::Lit_Byte:
+            PUSH_CHECK(1);
+            line("    fox_set_byte(sp, %u); sp += 1;", static_cast<unsigned>(static_cast<uint8_t>(inst.value)));
+            break;
+        case Opcode::Lit_Char:
+            PUSH_CHECK(4);
+            line("    fox_set_char(sp, %uu); sp += 4;", static_cast<unsigned>(inst.value));
+            break;
+        case Opcode::Lit_0:
+        case Opcode::Lit_1:
+            PUSH_CHECK(8);
+            line("    fox_set_int(sp, %d); sp += 8;", inst.op == Opcode::Lit_1 ? 1 : 0);
+            break;
+        case Opcode::Lit_Int:
+            PUSH_CHECK(8);
+            line("    fox_set_int(sp, %s); sp += 8;", imm.c_str());
+            break;
+        case Opcode::Lit_Float: {
+            runtime::Float value;
+            memcpy(&value, &inst.value, sizeof(value));
+            PUSH_CHECK(8);
+            if (std::isfinite(value)) {
+                line("    fox_set_float(sp, %a); sp += 8;", value);
+            } else {
+                line("    fox_set_int(sp, %s); sp += 8;", imm.c_str());
+            }
+        } break;
+        case Opcode::Lit_Pointer: {
+            auto pointer = reinterpret_cast<const void *>(inst.value);
+            PUSH_CHECK(8);
+            if (!pointer) {
+                line("    fox_set_ptr(sp, NULL); sp += 8;");
+                break;
+            }
+            auto it = pointer_names.find(pointer);
+            internal_verify(it != pointer_names.end(), "Lit_Pointer to something that can't be emitted as C in %.*s.", fn->name.size(), fn->name.c_str());
+            line("    fox_set_ptr(sp, (void *)%s); sp += 8;", it->second.c_str());
+        } break;
+
+        // Constants
+        case Opcode::Load_Const:
+            PUSH_CHECK(size);
+            line("    memcpy(sp, fox_constants + %llu, %u); sp += %u;", static_cast<unsigned long long>(inst.value), size, size);
+            break;
+        case Opcode::Load_Const_String:
+            PUSH_CHECK(sizeof(runtime::String));
+            line("    fox_set_str(sp, fox_str_constant(fox_str_constants + %llu)); sp += %zu;", static_cast<unsigned long long>(inst.value), sizeof(runtime::String));
+            break;
+
+        // Arithmetic
+        case Opcode::Int_Add: INT_BIOP("fox_add(fox_int(sp - 16), fox_int(sp - 8))"); break;
+        case Opcode::Int_Sub: INT_BIOP("fox_sub(fox_int(sp - 16), fox_int(sp - 8))"); break;
+        case Opcode::Int_Mul: INT_BIOP("fox_mul(fox_int(sp - 16), fox_int(sp - 8))"); break;
+        case Opcode::Int_Div: CHECK_ZERO("int", 8, "/"); INT_BIOP("fox_int(sp - 16) / fox_int(sp - 8)"); break;
+        case Opcode::Int_Mod: CHECK_ZERO("int", 8, "%%"); INT_BIOP("fox_int(sp - 16) %% fox_int(sp - 8)"); break;
+        case Opcode::Int_Neg: line("    fox_set_int(sp - 8, fox_neg(fox_int(sp - 8)));"); break;
+        case Opcode::Int_Inc:
+        case Opcode::Int_Dec:
+            line("    sp -= 8; { uint8_t *n = fox_addr(sp); fox_set_int(n, fox_add(fox_int(n), %d)); }", inst.op == Opcode::Int_Inc ? 1 : -1);
+            break;
+
+        case Opcode::Byte_Add: BYTE_BIOP("+"); break;
+        case Opcode::Byte_Sub: BYTE_BIOP("-"); break;
+        case Opcode::Byte_Mul: BYTE_BIOP("*"); break;
+        case Opcode::Byte_Div: CHECK_ZERO("byte", 1, "/"); BYTE_BIOP("/"); break;
+        case Opcode::Byte_Mod: CHECK_ZERO("byte", 1, "%%"); BYTE_BIOP("%%"); break;
+        case Opcode::Byte_Neg: line("    fox_set_byte(sp - 1, (uint8_t)-fox_byte(sp - 1));"); break;
+        case Opcode::Byte_Inc:
+        case Opcode::Byte_Dec:
+            line("    sp -= 8; { uint8_t *n = fox_addr(sp); fox_set_byte(n, (uint8_t)(fox_byte(n) %s 1)); }", inst.op == Opcode::Byte_Inc ? "+" : "-");
+            break;
+
+        case Opcode::Float_Add: FLOAT_BIOP("+"); break;
+        case Opcode::Float_Sub: FLOAT_BIOP("-"); break;
+        case Opcode::Float_Mul: FLOAT_BIOP("*"); break;
+        case Opcode::Float_Div: CHECK_ZERO("float", 8, "/"); FLOAT_BIOP("/"); break;
+        case Opcode::Float_Neg: line("    fox_set_float(sp - 8, -fox_float(sp - 8));"); break;
+
+        case Opcode::Str_Add:
+            line("    fox_error(\"Str_Add not yet implemented.\");");
+            break;
+
+        // Bitwise
+        case Opcode::Bit_Not:     line("    fox_set_int(sp - 8, ~fox_int(sp - 8));"); break;
+        case Opcode::Shift_Left:  INT_BIOP("fox_shl(fox_int(sp - 16), fox_int(sp - 8))"); break;
+        case Opcode::Shift_Right: INT_BIOP("fox_int(sp - 16) >> fox_int(sp - 8)"); break;
+        case Opcode::Bit_And:     INT_BIOP("fox_int(sp - 16) & fox_int(sp - 8)"); break;
+        case Opcode::Xor:         INT_BIOP("fox_int(sp - 16) ^ fox_int(sp - 8)"); break;
+        case Opcode::Bit_Or:      INT_BIOP("fox_int(sp - 16) | fox_int(sp - 8)"); break;
+
+        // Logic
+        case Opcode::And: line("    fox_set_bool(sp - 2, fox_bool(sp - 2) && fox_bool(sp - 1)); sp -= 1;"); break;
+        case Opcode::Or:  line("    fox_set_bool(sp - 2, fox_bool(sp - 2) || fox_bool(sp - 1)); sp -= 1;"); break;
+        case Opcode::Not: line("    fox_set_bool(sp - 1, !fox_bool(sp - 1));"); break;
+
+        // Relational
+        case Opcode::Equal:
+        case Opcode::Not_Equal:
+            if (size == 0) PUSH_CHECK(1);
+            line("    fox_set_bool(sp - %u, memcmp(sp - %u, sp - %u, %u) %s 0); sp += %d;",
+                 2 * size, size, 2 * size, size, inst.op == Opcode::Equal ? "==" : "!=", 1 - 2 * static_cast<int>(size));
+            break;
+        case Opcode::Str_Equal:
+        case Opcode::Str_Not_Equal:
+            line("    fox_set_bool(sp - 32, %s(fox_str(sp - 32), fox_str(sp - 16))); sp -= 31;",
+                 inst.op == Opcode::Str_Equal ? "fox_str_equal" : "fox_str_not_equal");
+            break;
+
+        case Opcode::Int_Less_Than:       COMPARE("int", 8, "<"); break;
+        case Opcode::Int_Less_Equal:      COMPARE("int", 8, "<="); break;
+        case Opcode::Int_Greater_Than:    COMPARE("int", 8, ">"); break;
+        case Opcode::Int_Greater_Equal:   COMPARE("int", 8, ">="); break;
+        case Opcode::Byte_Less_Than:      COMPARE("byte", 1, "<"); break;
+        case Opcode::Byte_Less_Equal:     COMPARE("byte", 1, "<="); break;
+        case Opcode::Byte_Greater_Than:   COMPARE("byte", 1, ">"); break;
+        case Opcode::Byte_Greater_Equal:  COMPARE("byte", 1, ">="); break;
+        case Opcode::Float_Less_Than:     COMPARE("float", 8, "<"); break;
+        case Opcode::Float_Less_Equal:    COMPARE("float", 8, "<="); break;
+        case Opcode::Float_Greater_Than:  COMPARE("float", 8, ">"); break;
+        case Opcode::Float_Greater_Equal: COMPARE("float", 8, ">="); break;
+
+        // Stack
+        case Opcode::Move:
+        case Opcode::Move_Push_Pointer:
+            line("    sp -= 8; {");
+            line("        uint8_t *dest = fox_addr(sp);");
+            line("        if (dest != sp - %u) { memmove(dest, sp - %u, %u); sp -= %u; }", size, size, size, size);
+            if (inst.op == Opcode::Move_Push_Pointer) {
+                line("        fox_set_addr(sp, dest); sp += 8;");
+            }
+            line("    }");
+            break;
+        case Opcode::Copy:
+            line("    sp -= 16; {");
+            line("        uint8_t *dest = fox_addr(sp + 8), *src = fox_addr(sp);");
+            line("        if (dest != src) memmove(dest, src, %u);", size);
+            line("    }");
+            break;
+        case Opcode::Load:
+            line("    sp -= 8; { uint8_t *src = fox_addr(sp); fox_check_stack(sp + %u); memmove(sp, src, %u); } sp += %u;", size, size, size);
+            break;
+        case Opcode::Push_Pointer:
+            PUSH_CHECK(8);
+            line("    fox_set_addr(sp, bp + %u); sp += 8;", address);
+            break;
+        case Opcode::Push_Global_Pointer:
+            PUSH_CHECK(8);
+            line("    fox_set_addr(sp, fox_stack + %u); sp += 8;", address);
+            break;
+        case Opcode::Push_Value:
+            PUSH_CHECK(size);
+            line("    memmove(sp, bp + %u, %u); sp += %u;", address, size, size);
+            break;
+        case Opcode::Push_Global_Value:
+            PUSH_CHECK(size);
+            line("    memmove(sp, fox_stack + %u, %u); sp += %u;", address, size, size);
+            break;
+        case Opcode::Pop:
+            line("    sp -= %u;", size);
+            break;
+        case Opcode::Allocate:
+            PUSH_CHECK(size);
+            line("    sp += %u;", size);
+            break;
+        case Opcode::Clear_Allocate:
+            PUSH_CHECK(size);
+            line("    memset(sp, 0, %u); sp += %u;", size, size);
+            break;
+        case Opcode::Flush:
+            line("    sp = bp + %u;", address);
+            break;
+        case Opcode::Flush_Value:
+            line("    memmove(bp + %u, sp - %u, %u); sp = bp + %u;", address, size, size, address + size);
+            break;
+        case Opcode::Return:
+            line("    memmove(bp, sp - %u, %u); fox_sp = bp + %u; fox_depth--; return;", size, size, size);
+            break;
+        case Opcode::Variadic_Return:
+            line("    {");
+            line("        uint8_t *dest = bp - (fox_int(bp - 8) + 8);");
+            line("        memmove(dest, sp - %u, %u); fox_sp = dest + %u; fox_depth--; return;", size, size, size);
+            line("    }");
+            break;
+
+        // Branching
+        case Opcode::Jump:
+        case Opcode::Loop:
+        case Opcode::Jump_Long:
+        case Opcode::Loop_Long:
+            line("    goto L%zu;", inst.target);
+            break;
+        case Opcode::Jump_True:
+        case Opcode::Jump_True_Long:
+            line("    sp -= 1; if (fox_bool(sp)) goto L%zu;", inst.target);
+            break;
+        case Opcode::Jump_False:
+        case Opcode::Jump_False_Long:
+            line("    sp -= 1; if (!fox_bool(sp)) goto L%zu;", inst.target);
+            break;
+        case Opcode::Jump_True_No_Pop:
+        case Opcode::Jump_True_No_Pop_Long:
+            line("    if (fox_bool(sp - 1)) goto L%zu;", inst.target);
+            break;
+        case Opcode::Jump_False_No_Pop:
+        case Opcode::Jump_False_No_Pop_Long:
+            line("    if (!fox_bool(sp - 1)) goto L%zu;", inst.target);
+            break;
+
+        // Invocation
+        case Opcode::Call:
+            line("    sp -= 8; { Fox_Function f = (Fox_Function)fox_ptr(sp); fox_sp = sp; f(%u); sp = fox_sp; }", size);
+            break;
+        case Opcode::Call_Builtin: {
+            std::string name;
+            for (auto &[id, builtin] : interp->builtins.builtins) {
+                if (builtin.index == inst.value) name = builtin_name(id.str());
+            }
+            internal_verify(!name.empty(), "Unknown builtin in C_Emitter::emit_instruction(): %llu.", static_cast<unsigned long long>(inst.value));
+            line("    sp = %s(sp);", name.c_str());
+        } break;
+        case Opcode::Call_Direct: {
+            Function_Definition *callee = interp->functions.table[inst.value];
+            line("    fox_sp = sp; %s(%u); sp = fox_sp;", function_name(callee).c_str(), size);
+        } break;
+        case Opcode::Tail_Call: {
+            Function_Definition *callee = interp->functions.table[inst.value];
+            if (callee == fn && !fn->varargs) {
+                // reuses the frame like VM::tail_call() so deep recursion doesn't use up the C stack
+                line("    memmove(bp, sp - %u, %u); sp = bp + %u; goto start;", size, size, size);
+                break;
+            }
+            // the callee's result ends up where the current function's would have
+            line("    {");
+            line("        uint8_t *args = sp - %u;", size);
+            line("        fox_sp = sp; fox_depth--; %s(%u);", function_name(callee).c_str(), size);
+            line("        size_t size = (size_t)(fox_sp - args);");
+            line("        uint8_t *dest = %s;", fn->varargs ? "bp - (fox_int(bp - 8) + 8)" : "bp");
+            line("        memmove(dest, args, size); fox_sp = dest + size; return;");
+            line("    }");
+        } break;
+
+        // Cast
+        case Opcode::Cast_Byte_Int:
+            PUSH_CHECK(7);
+            line("    fox_set_int(sp - 1, (int64_t)fox_byte(sp - 1)); sp += 7;");
+            break;
+        case Opcode::Cast_Byte_Float:
+            PUSH_CHECK(7);
+            line("    fox_set_float(sp - 1, (double)fox_byte(sp - 1)); sp += 7;");
+            break;
+        case Opcode::Cast_Bool_Int:
+            PUSH_CHECK(7);
+            line("    fox_set_int(sp - 1, fox_bool(sp - 1) ? 1 : 0); sp += 7;");
+            break;
+        case Opcode::Cast_Char_Int:
+            PUSH_CHECK(4);
+            line("    fox_set_int(sp - 4, (int64_t)fox_char(sp - 4)); sp += 4;");
+            break;
+        case Opcode::Cast_Int_Float:
+            line("    fox_set_float(sp - 8, (double)fox_int(sp - 8));");
+            break;
+        case Opcode::Cast_Float_Int:
+            line("    fox_set_int(sp - 8, (int64_t)fox_float(sp - 8));");
+            break;
+
+        // Fused
+        case Opcode::Int_Add_Imm:
+            line("    fox_set_int(sp - 8, fox_add(fox_int(sp - 8), %s));", imm.c_str());
+            break;
+        case Opcode::Int_Mul_Imm:
+            line("    fox_set_int(sp - 8, fox_mul(fox_int(sp - 8), %s));", imm.c_str());
+            break;
+        case Opcode::Inc_Local:
+            line("    fox_set_int(bp + %u, fox_add(fox_int(bp + %u), 1));", address, address);
+            break;
+        case Opcode::Add_Local:
+            line("    fox_set_int(bp + %u, fox_add(fox_int(bp + %u), %s));", address, address, imm.c_str());
+            break;
+        case Opcode::Load_Indexed:
+            line("    sp -= 16; { uint8_t *src = fox_addr(sp) + fox_int(sp + 8) * %u; fox_check_stack(sp + %u); memmove(sp, src, %u); } sp += %u;", size, size, size, size);
+            break;
+        case Opcode::Load_Field_Indirect:
+            line("    sp -= 8; { uint8_t *src = fox_addr(sp) + %u; fox_check_stack(sp + %u); memmove(sp, src, %u); } sp += %u;", address, size, size, size);
+            break;
+        case Opcode::Int_Lt_Jump_False:
+        case Opcode::Int_Lt_Jump_False_Long:
+            line("    sp -= 16; if (!(fox_int(sp) < fox_int(sp + 8))) goto L%zu;", inst.target);
+            break;
+        case Opcode::Int_Le_Jump_False:
+        case Opcode::Int_Le_Jump_False_Long:
+            line("    sp -= 16; if (!(fox_int(sp) <= fox_int(sp + 8))) goto L%zu;", inst.target);
+            break;
+
+        // Register
+        case Opcode::Reg_Move:
+            line("    memmove(bp + %u, bp + %u, %u);", address, a, size);
+            break;
+        case Opcode::Reg_Move_Global:
+            line("    memmove(bp + %u, fox_stack + %u, %u);", address, a, size);
+            break;
+        case Opcode::Reg_Address:
+            line("    fox_set_addr(bp + %u, bp + %u);", address, a);
+            break;
+        case Opcode::Reg_Global_Address:
+            line("    fox_set_addr(bp + %u, fox_stack + %u);", address, a);
+            break;
+        case Opcode::Reg_Set:
+            line("    { uint64_t v = UINT64_C(%llu); memcpy(bp + %u, &v, %u); }", static_cast<unsigned long long>(inst.value), address, size);
+            break;
+        case Opcode::Reg_Load:
+            line("    memmove(bp + %u, fox_addr(bp + %u), %u);", address, a, size);
+            break;
+        case Opcode::Reg_Load_Indexed:
+            line("    memmove(bp + %u, fox_addr(bp + %u) + fox_int(bp + %u) * %u, %u);", address, a, b, size, size);
+            break;
+        case Opcode::Reg_Store:
+            line("    memmove(fox_addr(bp + %u), bp + %u, %u);", address, a, size);
+            break;
+
+        case Opcode::Reg_Int_Add: REG_BIOP("int", "int", "fox_add(fox_int(bp + %u), fox_int(bp + %u))"); break;
+        case Opcode::Reg_Int_Sub: REG_BIOP("int", "int", "fox_sub(fox_int(bp + %u), fox_int(bp + %u))"); break;
+        case Opcode::Reg_Int_Mul: REG_BIOP("int", "int", "fox_mul(fox_int(bp + %u), fox_int(bp + %u))"); break;
+        case Opcode::Reg_Int_Div: REG_CHECK_ZERO("int", "/"); REG_BIOP("int", "int", "fox_int(bp + %u) / fox_int(bp + %u)"); break;
+        case Opcode::Reg_Int_Mod: REG_CHECK_ZERO("int", "%%"); REG_BIOP("int", "int", "fox_int(bp + %u) %% fox_int(bp + %u)"); break;
+        case Opcode::Reg_Int_Neg:
+            line("    fox_set_int(bp + %u, fox_neg(fox_int(bp + %u)));", address, a);
+            break;
+        case Opcode::Reg_Int_Add_Imm:
+            line("    fox_set_int(bp + %u, fox_add(fox_int(bp + %u), %s));", address, a, imm.c_str());
+            break;
+        case Opcode::Reg_Int_Mul_Imm:
+            line("    fox_set_int(bp + %u, fox_mul(fox_int(bp + %u), %s));", address, a, imm.c_str());
+            break;
+        case Opcode::Reg_Int_Inc:
+        case Opcode::Reg_Int_Dec:
+            line("    fox_set_int(bp + %u, fox_add(fox_int(bp + %u), %d));", address, address, inst.op == Opcode::Reg_Int_Inc ? 1 : -1);
+            break;
+
+        case Opcode::Reg_Float_Add: REG_BIOP("float", "float", "fox_float(bp + %u) + fox_float(bp + %u)"); break;
+        case Opcode::Reg_Float_Sub: REG_BIOP("float", "float", "fox_float(bp + %u) - fox_float(bp + %u)"); break;
+        case Opcode::Reg_Float_Mul: REG_BIOP("float", "float", "fox_float(bp + %u) * fox_float(bp + %u)"); break;
+        case Opcode::Reg_Float_Div: REG_CHECK_ZERO("float", "/"); REG_BIOP("float", "float", "fox_float(bp + %u) / fox_float(bp + %u)"); break;
+
+        case Opcode::Reg_Not:
+            line("    fox_set_bool(bp + %u, !fox_bool(bp + %u));", address, a);
+            break;
+        case Opcode::Reg_Equal:
+        case Opcode::Reg_Not_Equal:
+            line("    fox_set_bool(bp + %u, memcmp(bp + %u, bp + %u, %u) %s 0);", address, a, b, size, inst.op == Opcode::Reg_Equal ? "==" : "!=");
+            break;
+
+        case Opcode::Reg_Int_Less_Than:         REG_COMPARE("int", "<"); break;
+        case Opcode::Reg_Int_Less_Equal:        REG_COMPARE("int", "<="); break;
+        case Opcode::Reg_Int_Greater_Than:      REG_COMPARE("int", ">"); break;
+        case Opcode::Reg_Int_Greater_Equal:     REG_COMPARE("int", ">="); break;
+        case Opcode::Reg_Int_Less_Than_Imm:     REG_COMPARE_IMM("<"); break;
+        case Opcode::Reg_Int_Less_Equal_Imm:    REG_COMPARE_IMM("<="); break;
+        case Opcode::Reg_Int_Greater_Than_Imm:  REG_COMPARE_IMM(">"); break;
+        case Opcode::Reg_Int_Greater_Equal_Imm: REG_COMPARE_IMM(">="); break;
+        case Opcode::Reg_Int_Equal_Imm:         REG_COMPARE_IMM("=="); break;
+        case Opcode::Reg_Int_Not_Equal_Imm:     REG_COMPARE_IMM("!="); break;
+        case Opcode::Reg_Float_Less_Than:       REG_COMPARE("float", "<"); break;
+        case Opcode::Reg_Float_Less_Equal:      REG_COMPARE("float", "<="); break;
+        case Opcode::Reg_Float_Greater_Than:    REG_COMPARE("float", ">"); break;
+        case Opcode::Reg_Float_Greater_Equal:   REG_COMPARE("float", ">="); break;
+
+        case Opcode::Reg_Jump_True:
+        case Opcode::Reg_Jump_True_Long:
+            line("    if (fox_bool(bp + %u)) goto L%zu;", address, inst.target);
+            break;
+        case Opcode::Reg_Jump_False:
+        case Opcode::Reg_Jump_False_Long:
+            line("    if (!fox_bool(bp + %u)) goto L%zu;", address, inst.target);
+            break;
+
+        case Opcode::None:
+            internal_error("Unknown opcode in C_Emitter::emit_instruction(): %d.", inst.op);
+            break;
+    }
+
+    #undef PUSH_CHECK
+    #undef INT_BIOP
+    #undef BYTE_BIOP
+    #undef FLOAT_BIOP
+    #undef COMPARE
+    #undef CHECK_ZERO
+    #undef REG_BIOP
+    #undef REG_COMPARE
+    #undef REG_COMPARE_IMM
+    #undef REG_CHECK_ZERO
+}
+
+void C_Emitter::emit_function(Function_Definition *fn, const std::string &name) {
+    auto code = decode_instructions(fn->code());
+
+    std::unordered_set<size_t> targets;
+    bool self_tail_call = false;
+    for (auto &inst : code) {
+        if (is_jump(inst.op)) targets.insert(inst.target);
+        if (inst.op == Opcode::Tail_Call && interp->functions.table[inst.value] == fn && !fn->varargs) self_tail_call = true;
+    }
+
+    line("// %.*s", fn->name.size(), fn->name.c_str());
+    line("static void %s(uint16_t arg_size) {", name.c_str());
+    line("    uint8_t *bp = fox_sp - arg_size;");
+    line("    uint8_t *sp = fox_sp;");
+    line("    fox_enter();");
+    if (self_tail_call) line("start:");
+    if (fn->frame_size) line("    fox_check_stack(bp + %u);", fn->frame_size);
+
+    for (size_t i = 0; i < code.size(); i++) {
+        if (targets.count(i)) line("L%zu:", i);
+        emit_instruction(fn, code[i]);
+    }
+    line("}");
+    line("");
+}
+
+void emit_c(Interpreter *interp, Module *module, const char *path) {
+    C_Emitter e;
+    e.interp = interp;
+
+    for (auto fn : interp->functions.table) {
+        e.pointer_names[fn] = function_name(fn);
+    }
+    for (auto &[_, defn] : interp->types.structs) {
+        e.pointer_names[&defn] = "&" + struct_name(&defn);
+    }
+    for (auto &[_, defn] : interp->types.enums) {
+        e.pointer_names[&defn] = "&" + enum_name(&defn);
+    }
+
+    // only the types something prints need printers
+    std::vector<Function_Definition *> functions = { &module->top_level };
+    functions.insert(functions.end(), interp->functions.table.begin(), interp->functions.table.end());
+    for (auto fn : functions) {
+        for (auto &inst : decode_instructions(fn->code())) {
+            if (inst.op != Opcode::Lit_Pointer) continue;
+            auto pointer = reinterpret_cast<void *>(inst.value);
+            for (auto &[_, defn] : interp->types.structs) {
+                if (pointer == &defn) e.need_printer(&defn);
+            }
+            for (auto &[_, defn] : interp->types.enums) {
+                if (pointer == &defn) e.need_printer(&defn);
+            }
+        }
+    }
+
+    e.line("// Generated by fox --emit-c from %.*s", module->module_path.size(), module->module_path.c_str());
+    e.line("#include \"fox_runtime.h\"");
+    e.line("");
+    e.emit_data_section("fox_constants", interp->constants_section());
+    e.emit_data_section("fox_str_constants", interp->str_constants_section());
+
+    e.line("static void fox_top_level(uint16_t arg_size);");
+    for (auto fn : interp->functions.table) {
+        e.line("static void %s(uint16_t arg_size);", function_name(fn).c_str());
+    }
+    e.line("");
+
+    e.emit_printers();
+
+    e.emit_function(&module->top_level, "fox_top_level");
+    for (auto fn : interp->functions.table) {
+        e.emit_function(fn, function_name(fn));
+    }
+
+    e.line("int main(void) {");
+    e.line("    (void)fox_constants;");
+    e.line("    (void)fox_str_constants;");
+    e.line("    fox_top_level(0);");
+    e.line("    return 0;");
+    e.line("}");
+
+    std::ofstream file(path, std::ios::binary);
+    verify(file.is_open(), Code_Location{ 0, 0, "<emit_c>" }, "'%s' could not be opened.", path);
+    file << e.out;
+    verify(file.good(), Code_Location{ 0, 0, "<emit_c>" }, "Could not write to '%s'.", path);
+}
@@ -0,0 +1,21 @@
+//
+//  emit_c.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+struct Interpreter;
+struct Module;
+
+//
+// Writes a C translation unit to `path` that does what running the module's
+// compiled bytecode would. Every function becomes a C function that works on
+// the same byte stack as the VM, one statement per instruction, and the
+// builtins come from runtime/fox_runtime.h, so the output only needs a C
+// compiler pointed at that directory.
+//
+void emit_c(Interpreter *interp, Module *module, const char *path);
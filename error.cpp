@@ -10,14 +10,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <mutex>
+
+// Only the first thread to hit an error reports it, any others wait here for the exit.
+static std::mutex error_lock;
+static bool errors_recoverable = false;
+
+void set_errors_recoverable(bool recoverable) {
+    errors_recoverable = recoverable;
+}
 
 static void internal_error_impl(const char *err_type, const char *file, size_t line, const char *err_msg, va_list args) {
+    error_lock.lock();
     fprintf(stderr, "%s:%zu: %s", file, line, err_type);
     vfprintf(stderr, err_msg, args);
     fprintf(stderr, "\n");
 }
 
 static void error_impl(Code_Location loc, const char *err, va_list args) {
+    error_lock.lock();
     fprintf(stderr, "%s:%zu:%zu: Error: ", loc.filename, loc.l0 + 1, loc.c0 + 1);
     vfprintf(stderr, err, args);
     fprintf(stderr, "\n");
@@ -34,6 +45,10 @@ void error(Code_Location loc, const char *err, ...) {
 void verror(Code_Location loc, const char *err, va_list args) {
     error_impl(loc, err, args);
     va_end(args);
+    if (errors_recoverable) {
+        error_lock.unlock();
+        throw Recoverable_Error {};
+    }
     exit(EXIT_FAILURE);
 }
 
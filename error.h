@@ -12,6 +12,12 @@
 #include <stddef.h>
 #include "definitions.h"
 
+// Thrown by error() and verror(), after reporting the error, in place of exiting while errors are recoverable.
+struct Recoverable_Error {};
+
+// Used by --watch so an error in one version of a program doesn't stop the next from being compiled.
+void set_errors_recoverable(bool recoverable);
+
 [[noreturn]] void error(Code_Location loc, const char *err, ...);
 [[noreturn]] void verror(Code_Location loc, const char *err, va_list args);
 
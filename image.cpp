@@ -0,0 +1,824 @@
+//
+//  image.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "image.h"
+
+#include <fstream>
+#include <string.h>
+
+#define MAP_IMAGES defined(__unix__) || defined(__APPLE__)
+
+#if MAP_IMAGES
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "bytecode.h"
+#include "error.h"
+#include "interpreter.h"
+
+static constexpr uint32_t Image_Magic = 0x43584F46; // "FOXC"
+static constexpr uint32_t Image_Version = 3;
+static constexpr size_t Image_Alignment = 16; // of every section, so constants are as aligned as in a vector
+static constexpr uint64_t No_Module = UINT64_MAX;
+
+// What the address at a relocation's offset in the bytecode points to.
+enum class Relocation_Kind : uint8_t {
+    Function, // by Function_Index
+    Struct,   // by UUID
+    Enum,     // by UUID
+};
+
+uint64_t hash_bytes(const void *data, size_t size) {
+    // FNV-1a
+    auto bytes = reinterpret_cast<const uint8_t *>(data);
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+static uint64_t hash_file(const char *path, bool &found) {
+    std::ifstream file(path, std::ios::binary);
+    found = file.is_open();
+    if (!found) return 0;
+
+    std::vector<char> source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return hash_bytes(source.data(), source.size());
+}
+
+//
+// Writing
+//
+
+struct Image_Writer {
+    Interpreter *interp;
+    std::vector<uint8_t> out;
+    bool ok = true; // cleared by anything an image can't hold
+
+    // definitions whose addresses the bytecode can hold
+    std::unordered_map<const void *, std::pair<Relocation_Kind, uint64_t>> addresses;
+
+    template<typename T>
+    void write(T value) {
+        auto bytes = reinterpret_cast<const uint8_t *>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    void write_bytes(const void *data, size_t size) {
+        write<uint64_t>(size);
+        out.resize((out.size() + Image_Alignment - 1) / Image_Alignment * Image_Alignment);
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    void write_string(const String &s) { write_bytes(s.c_str(), s.size()); }
+    void write_string(const std::string &s) { write_bytes(s.data(), s.size()); }
+    void write_string(Symbol s) { write_bytes(s.c_str(), s.size()); }
+
+    void write_type(const Value_Type &type);
+    void write_type_ptr(const Value_Type *type);
+    void write_methods(const std::unordered_map<Symbol, Method> &methods);
+    void write_code(Function_Definition *fn);
+    void write_function(Function_Definition *fn);
+};
+
+void Image_Writer::write_type(const Value_Type &type) {
+    write(type.kind);
+    write<uint8_t>(type.is_mut);
+
+    switch (type.kind) {
+        case Value_Type_Kind::Unresolved_Type:
+            ok = false;
+            break;
+        case Value_Type_Kind::Ptr:
+            write_type_ptr(type.data.ptr.child_type);
+            break;
+        case Value_Type_Kind::Array:
+            write<uint64_t>(type.data.array.count);
+            write_type_ptr(type.data.array.element_type);
+            break;
+        case Value_Type_Kind::Slice:
+            write_type_ptr(type.data.slice.element_type);
+            break;
+        case Value_Type_Kind::Tuple:
+            write<uint64_t>(type.data.tuple.child_types.size());
+            for (auto &child : type.data.tuple.child_types) {
+                write_type(child);
+            }
+            break;
+        case Value_Type_Kind::Range:
+            write<uint8_t>(type.data.range.inclusive);
+            write_type_ptr(type.data.range.child_type);
+            break;
+        case Value_Type_Kind::Struct:
+            write<uint64_t>(type.data.struct_.defn->uuid);
+            break;
+        case Value_Type_Kind::Enum:
+            write<uint64_t>(type.data.enum_.defn->uuid);
+            break;
+        case Value_Type_Kind::Trait:
+            write<uint64_t>(type.data.trait.defn->uuid);
+            write_type_ptr(type.data.trait.real_type);
+            break;
+        case Value_Type_Kind::Function:
+            write_type_ptr(type.data.func.return_type);
+            write<uint64_t>(type.data.func.arg_types.size());
+            for (auto &arg : type.data.func.arg_types) {
+                write_type(arg);
+            }
+            break;
+        case Value_Type_Kind::Type:
+            write_type_ptr(type.data.type.type);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void Image_Writer::write_type_ptr(const Value_Type *type) {
+    write<uint8_t>(type != nullptr);
+    if (type) write_type(*type);
+}
+
+void Image_Writer::write_methods(const std::unordered_map<Symbol, Method> &methods) {
+    write<uint64_t>(methods.size());
+    for (auto &[id, method] : methods) {
+        write_string(id);
+        write<uint8_t>(method.is_static);
+        write<uint64_t>(method.uuid);
+    }
+}
+
+void Image_Writer::write_code(Function_Definition *fn) {
+    write<uint16_t>(fn->frame_size);
+    write_bytes(fn->instructions.data(), fn->instructions.size());
+
+    // Every pointer in the bytecode is the last 8 bytes of its instruction.
+    std::vector<std::pair<uint32_t, std::pair<Relocation_Kind, uint64_t>>> relocations;
+    for (size_t pc = 0; pc < fn->instructions.size(); pc += instruction_size(static_cast<Opcode>(fn->instructions[pc]))) {
+        auto op = static_cast<Opcode>(fn->instructions[pc]);
+        switch (operand_layout(op)) {
+            case Operand_Layout::Word:
+            case Operand_Layout::Size_Dst_Word:
+            case Operand_Layout::Address_Word:
+            case Operand_Layout::Dst_Src_Word:
+                break;
+            default:
+                continue;
+        }
+
+        size_t offset = pc + instruction_size(op) - sizeof(uint64_t);
+        void *pointer;
+        memcpy(&pointer, &fn->instructions[offset], sizeof(pointer));
+
+        auto it = addresses.find(pointer);
+        if (it != addresses.end()) {
+            relocations.push_back({ static_cast<uint32_t>(offset), it->second });
+        } else if (op == Opcode::Lit_Pointer && pointer) {
+            ok = false;
+        }
+    }
+
+    write<uint64_t>(relocations.size());
+    for (auto &[offset, target] : relocations) {
+        write<uint32_t>(offset);
+        write(target.first);
+        write<uint64_t>(target.second);
+    }
+}
+
+void Image_Writer::write_function(Function_Definition *fn) {
+    write<uint64_t>(fn->uuid);
+    write<uint64_t>(fn->module ? fn->module->uuid : No_Module);
+    write<uint8_t>(fn->varargs);
+    write_string(fn->name);
+    write_type(fn->type);
+    write<uint64_t>(fn->param_names.size());
+    for (auto &name : fn->param_names) {
+        write_string(name);
+    }
+    write_code(fn);
+}
+
+bool save_image(Interpreter *interp, Module *module, const char *path) {
+    Image_Writer w;
+    w.interp = interp;
+
+    for (auto fn : interp->functions.table) {
+        w.addresses[fn] = { Relocation_Kind::Function, fn->index };
+    }
+    for (auto &[uuid, defn] : interp->types.structs) {
+        w.addresses[&defn] = { Relocation_Kind::Struct, uuid };
+    }
+    for (auto &[uuid, defn] : interp->types.enums) {
+        w.addresses[&defn] = { Relocation_Kind::Enum, uuid };
+    }
+
+    // the key, everything load_image() checks before it changes anything
+    w.write(Image_Magic);
+    w.write(Image_Version);
+    size_t checksum_offset = w.out.size();
+    w.write<uint64_t>(0); // of everything after it, filled in once it's all written
+    w.write<uint64_t>(interp->inline_threshold);
+    w.write<uint8_t>(interp->peephole);
+    w.write<uint8_t>(interp->register_vm);
+    w.write<uint8_t>(interp->ssa);
+
+    w.write<uint64_t>(interp->sources.size());
+    for (auto &source : interp->sources) {
+        w.write_string(source.path);
+        w.write<uint64_t>(source.hash);
+    }
+
+    std::vector<std::string> builtin_names(interp->builtins.table.size());
+    for (auto &[id, builtin] : interp->builtins.builtins) {
+        builtin_names[builtin.index] = id.str();
+    }
+    w.write<uint64_t>(builtin_names.size());
+    for (auto &id : builtin_names) {
+        w.write_string(id);
+    }
+
+    // the program
+    w.write<uint64_t>(interp->current_uuid);
+    w.write_bytes(interp->constants.data(), interp->constants.size());
+    w.write_bytes(interp->str_constants.data(), interp->str_constants.size());
+
+    w.write<uint64_t>(interp->modules.modules.size());
+    for (auto &[uuid, mod] : interp->modules.modules) {
+        w.write<uint64_t>(uuid);
+        w.write_string(mod.module_path);
+        w.write<uint64_t>(mod.members.size());
+        for (auto &[id, member] : mod.members) {
+            w.write_string(id);
+            w.write<uint8_t>(member.kind);
+            w.write<uint64_t>(member.uuid);
+        }
+    }
+
+    // Definitions refer to each other by UUID so they all get created before any of their types are read.
+    w.write<uint64_t>(interp->types.traits.size());
+    for (auto &[uuid, defn] : interp->types.traits) {
+        w.write<uint64_t>(uuid);
+        w.write<uint64_t>(defn.module ? defn.module->uuid : No_Module);
+        w.write_string(defn.name);
+    }
+    w.write<uint64_t>(interp->types.structs.size());
+    for (auto &[uuid, defn] : interp->types.structs) {
+        w.write<uint64_t>(uuid);
+        w.write<uint64_t>(defn.module ? defn.module->uuid : No_Module);
+        w.write_string(defn.name);
+        w.write<uint16_t>(defn.size);
+    }
+    w.write<uint64_t>(interp->types.enums.size());
+    for (auto &[uuid, defn] : interp->types.enums) {
+        w.write<uint64_t>(uuid);
+        w.write<uint64_t>(defn.module ? defn.module->uuid : No_Module);
+        w.write_string(defn.name);
+        w.write<uint16_t>(defn.size);
+        w.write<uint8_t>(defn.is_sumtype);
+    }
+
+    for (auto &[_, defn] : interp->types.traits) {
+        w.write<uint64_t>(defn.methods.size());
+        for (auto &method : defn.methods) {
+            w.write<uint8_t>(method.variadic);
+            w.write<uint8_t>(method.is_method);
+            w.write_string(method.name);
+            w.write_type(method.return_type);
+            w.write<uint64_t>(method.params.size());
+            for (auto &param : method.params) {
+                w.write_string(param.name);
+                w.write_type(param.type);
+            }
+        }
+    }
+    for (auto &[_, defn] : interp->types.structs) {
+        w.write<uint64_t>(defn.fields.size());
+        for (auto &field : defn.fields) {
+            w.write<uint16_t>(field.offset);
+            w.write_string(field.id);
+            w.write_type(field.type);
+        }
+        w.write_methods(defn.methods);
+    }
+    for (auto &[_, defn] : interp->types.enums) {
+        w.write<uint64_t>(defn.variants.size());
+        for (auto &variant : defn.variants) {
+            w.write<runtime::Int>(variant.tag);
+            w.write_string(variant.id);
+            w.write<uint64_t>(variant.payload.size());
+            for (auto &field : variant.payload) {
+                w.write<uint16_t>(field.offset);
+                w.write_type(field.type);
+            }
+        }
+        w.write_methods(defn.methods);
+    }
+
+    // in Functions::table order so Call_Direct's indices stay the same
+    w.write<uint64_t>(interp->functions.table.size());
+    for (auto fn : interp->functions.table) {
+        w.write_function(fn);
+    }
+
+    w.write<uint64_t>(module->uuid);
+    w.write_code(&module->top_level);
+
+    if (!w.ok) return false;
+
+    size_t payload = checksum_offset + sizeof(uint64_t);
+    uint64_t checksum = hash_bytes(w.out.data() + payload, w.out.size() - payload);
+    memcpy(w.out.data() + checksum_offset, &checksum, sizeof(checksum));
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    file.write(reinterpret_cast<const char *>(w.out.data()), w.out.size());
+    return file.good();
+}
+
+//
+// Reading
+//
+
+struct Image_Reader {
+    Interpreter *interp;
+    const uint8_t *start;
+    const uint8_t *it;
+    const uint8_t *end;
+    bool ok = true; // cleared by reading past the end
+
+    template<typename T>
+    T read() {
+        T value {};
+        if (static_cast<size_t>(end - it) < sizeof(T)) {
+            ok = false;
+            it = end;
+            return value;
+        }
+        memcpy(&value, it, sizeof(T));
+        it += sizeof(T);
+        return value;
+    }
+
+    const uint8_t *read_bytes(size_t &size) {
+        size = read<uint64_t>();
+        size_t offset = it - start;
+        size_t padding = (offset + Image_Alignment - 1) / Image_Alignment * Image_Alignment - offset;
+        if (static_cast<size_t>(end - it) < padding) {
+            ok = false;
+            size = 0;
+            it = end;
+        }
+        it += padding;
+        if (static_cast<size_t>(end - it) < size) {
+            ok = false;
+            size = 0;
+            it = end;
+        }
+        const uint8_t *bytes = it;
+        it += size;
+        return bytes;
+    }
+
+    std::string read_std_string() {
+        size_t size;
+        auto bytes = read_bytes(size);
+        return std::string(reinterpret_cast<const char *>(bytes), size);
+    }
+
+    String read_string() {
+        size_t size;
+        auto bytes = read_bytes(size);
+        return String::copy(reinterpret_cast<const char *>(bytes), size);
+    }
+
+    Symbol read_symbol() {
+        size_t size;
+        auto bytes = read_bytes(size);
+        return Symbol::intern(reinterpret_cast<const char *>(bytes), size);
+    }
+
+    // Counts are checked against what's left so a bad one can't ask for a huge allocation.
+    size_t read_count() {
+        size_t count = read<uint64_t>();
+        if (count > static_cast<size_t>(end - it)) {
+            ok = false;
+            return 0;
+        }
+        return count;
+    }
+
+    Module *read_module() {
+        return interp->modules.get_module_by_uuid(read<uint64_t>());
+    }
+
+    Value_Type read_type();
+    Value_Type *read_type_ptr();
+    Array<Value_Type> read_types();
+    void read_methods(std::unordered_map<Symbol, Method> &methods);
+    void read_code(Function_Definition *fn);
+};
+
+Value_Type Image_Reader::read_type() {
+    Value_Type type;
+    type.kind = read<Value_Type_Kind>();
+    type.is_mut = read<uint8_t>();
+
+    switch (type.kind) {
+        case Value_Type_Kind::Ptr:
+            type.data.ptr.child_type = read_type_ptr();
+            break;
+        case Value_Type_Kind::Array:
+            type.data.array.count = read<uint64_t>();
+            type.data.array.element_type = read_type_ptr();
+            break;
+        case Value_Type_Kind::Slice:
+            type.data.slice.element_type = read_type_ptr();
+            break;
+        case Value_Type_Kind::Tuple:
+            type.data.tuple.child_types = read_types();
+            break;
+        case Value_Type_Kind::Range:
+            type.data.range.inclusive = read<uint8_t>();
+            type.data.range.child_type = read_type_ptr();
+            break;
+        case Value_Type_Kind::Struct:
+            type.data.struct_.defn = interp->types.get_struct_by_uuid(read<uint64_t>());
+            ok = ok && type.data.struct_.defn;
+            break;
+        case Value_Type_Kind::Enum:
+            type.data.enum_.defn = interp->types.get_enum_by_uuid(read<uint64_t>());
+            ok = ok && type.data.enum_.defn;
+            break;
+        case Value_Type_Kind::Trait:
+            type.data.trait.defn = interp->types.get_trait_by_uuid(read<uint64_t>());
+            ok = ok && type.data.trait.defn;
+            type.data.trait.real_type = read_type_ptr();
+            break;
+        case Value_Type_Kind::Function:
+            type.data.func.return_type = read_type_ptr();
+            type.data.func.arg_types = read_types();
+            break;
+        case Value_Type_Kind::Type:
+            type.data.type.type = read_type_ptr();
+            break;
+
+        case Value_Type_Kind::None:
+        case Value_Type_Kind::Void:
+        case Value_Type_Kind::Byte:
+        case Value_Type_Kind::Bool:
+        case Value_Type_Kind::Char:
+        case Value_Type_Kind::Int:
+        case Value_Type_Kind::Float:
+        case Value_Type_Kind::Str:
+            break;
+
+        default:
+            ok = false;
+            break;
+    }
+
+    return type;
+}
+
+Value_Type *Image_Reader::read_type_ptr() {
+    if (!read<uint8_t>() || !ok) return nullptr;
+    Value_Type *type = Mem.make<Value_Type>().as_ptr();
+    *type = read_type();
+    return type;
+}
+
+Array<Value_Type> Image_Reader::read_types() {
+    size_t count = read_count();
+    auto types = Array<Value_Type>::with_size(count);
+    for (auto &type : types) {
+        type = read_type();
+    }
+    return types;
+}
+
+void Image_Reader::read_methods(std::unordered_map<Symbol, Method> &methods) {
+    size_t count = read_count();
+    for (size_t i = 0; i < count; i++) {
+        Symbol id = read_symbol();
+        Method method;
+        method.is_static = read<uint8_t>();
+        method.uuid = read<uint64_t>();
+        methods[id] = method;
+    }
+}
+
+void Image_Reader::read_code(Function_Definition *fn) {
+    fn->frame_size = read<uint16_t>();
+    size_t size;
+    auto code = read_bytes(size);
+    fn->image_instructions = Byte_Span(code, size);
+
+    size_t count = read_count();
+    for (size_t i = 0; i < count && ok; i++) {
+        size_t offset = read<uint32_t>();
+        auto kind = read<Relocation_Kind>();
+        uint64_t target = read<uint64_t>();
+
+        void *pointer = nullptr;
+        switch (kind) {
+            case Relocation_Kind::Function:
+                if (target < interp->functions.table.size()) pointer = interp->functions.table[target];
+                break;
+            case Relocation_Kind::Struct:
+                pointer = interp->types.get_struct_by_uuid(target);
+                break;
+            case Relocation_Kind::Enum:
+                pointer = interp->types.get_enum_by_uuid(target);
+                break;
+        }
+
+        if (!pointer || offset + sizeof(pointer) > size) {
+            ok = false;
+            break;
+        }
+        // the image is mapped writable until load_image() is done with it
+        memcpy(const_cast<uint8_t *>(code) + offset, &pointer, sizeof(pointer));
+    }
+}
+
+//
+// The image is mapped copy-on-write so relocations can be patched into it, only
+// the pages they're on get copied, then made read-only. Where there's no mmap
+// it's read into memory instead.
+//
+static Byte_Span map_image(const char *path) {
+#if MAP_IMAGES
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return {};
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return {};
+    }
+    
+    size_t size = static_cast<size_t>(st.st_size);
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) return {};
+    return Byte_Span(static_cast<uint8_t *>(memory), size);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return {};
+    
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    auto memory = new uint8_t[size];
+    file.read(reinterpret_cast<char *>(memory), size);
+    if (!file.good()) {
+        delete[] memory;
+        return {};
+    }
+    return Byte_Span(memory, size);
+#endif
+}
+
+static void protect_image(Byte_Span image) {
+#if MAP_IMAGES
+    mprotect(const_cast<uint8_t *>(image.data()), image.size(), PROT_READ);
+#else
+    (void)image;
+#endif
+}
+
+static void unmap_image(Byte_Span image) {
+#if MAP_IMAGES
+    munmap(const_cast<uint8_t *>(image.data()), image.size());
+#else
+    delete[] image.data();
+#endif
+}
+
+void unload_image(Interpreter *interp) {
+    if (!interp->image.data()) return;
+    
+    for (auto fn : interp->functions.table) {
+        fn->image_instructions = {};
+    }
+    for (auto &[_, module] : interp->modules.modules) {
+        module.top_level.image_instructions = {};
+    }
+    unmap_image(interp->image);
+    interp->image = {};
+    interp->image_constants = {};
+    interp->image_str_constants = {};
+}
+
+// Checks everything the image depends on without changing the interpreter.
+static bool image_is_current(Image_Reader &r) {
+    if (r.read<uint32_t>() != Image_Magic) return false;
+    if (r.read<uint32_t>() != Image_Version) return false;
+    
+    // a truncated or corrupted image is as good as no image
+    uint64_t checksum = r.read<uint64_t>();
+    if (!r.ok || hash_bytes(r.it, r.end - r.it) != checksum) return false;
+    
+    if (r.read<uint64_t>() != r.interp->inline_threshold) return false;
+    if (r.read<uint8_t>() != r.interp->peephole) return false;
+    if (r.read<uint8_t>() != r.interp->register_vm) return false;
+    if (r.read<uint8_t>() != r.interp->ssa) return false;
+
+    size_t num_sources = r.read_count();
+    for (size_t i = 0; i < num_sources && r.ok; i++) {
+        std::string source_path = r.read_std_string();
+        uint64_t hash = r.read<uint64_t>();
+
+        bool found;
+        if (hash_file(source_path.c_str(), found) != hash || !found) return false;
+        r.interp->sources.push_back({ source_path, hash });
+    }
+
+    size_t num_builtins = r.read_count();
+    if (num_builtins != r.interp->builtins.table.size()) return false;
+    for (size_t i = 0; i < num_builtins && r.ok; i++) {
+        auto builtin = r.interp->builtins.get_builtin(r.read_symbol());
+        if (!builtin || builtin->index != i) return false;
+    }
+
+    return r.ok;
+}
+
+Module *load_image(Interpreter *interp, const char *path) {
+    internal_verify(interp->modules.modules.empty(), "Loaded an image into an interpreter that has already compiled something.");
+
+    Byte_Span image = map_image(path);
+    if (!image.data()) return nullptr;
+
+    Image_Reader r;
+    r.interp = interp;
+    r.start = image.data();
+    r.it = image.data();
+    r.end = image.data() + image.size();
+
+    if (!image_is_current(r)) {
+        interp->sources.clear();
+        unmap_image(image);
+        return nullptr;
+    }
+
+    // From here on the interpreter is being filled in, so a bad image can't fall back to compiling.
+    interp->current_uuid = r.read<uint64_t>();
+    size_t size;
+    auto constants = r.read_bytes(size);
+    interp->image_constants = Byte_Span(constants, size);
+    auto str_constants = r.read_bytes(size);
+    interp->image_str_constants = Byte_Span(str_constants, size);
+
+    size_t num_modules = r.read_count();
+    for (size_t i = 0; i < num_modules && r.ok; i++) {
+        Module mod;
+        mod.uuid = r.read<uint64_t>();
+        mod.module_path = r.read_string();
+        mod.top_level.name = Symbol::intern(mod.module_path);
+        size_t num_members = r.read_count();
+        for (size_t j = 0; j < num_members; j++) {
+            Symbol id = r.read_symbol();
+            Module::Member member;
+            member.kind = static_cast<decltype(member.kind)>(r.read<uint8_t>());
+            member.uuid = r.read<uint64_t>();
+            mod.members[id] = member;
+        }
+        interp->modules.add_module(mod);
+    }
+
+    std::vector<Trait_Definition *> traits;
+    size_t num_traits = r.read_count();
+    for (size_t i = 0; i < num_traits && r.ok; i++) {
+        Trait_Definition defn;
+        defn.uuid = r.read<uint64_t>();
+        defn.module = r.read_module();
+        defn.name = r.read_symbol();
+        traits.push_back(interp->types.add_trait(defn));
+    }
+    std::vector<Struct_Definition *> structs;
+    size_t num_structs = r.read_count();
+    for (size_t i = 0; i < num_structs && r.ok; i++) {
+        Struct_Definition defn;
+        defn.uuid = r.read<uint64_t>();
+        defn.module = r.read_module();
+        defn.name = r.read_symbol();
+        defn.size = r.read<uint16_t>();
+        structs.push_back(interp->types.add_struct(defn));
+    }
+    std::vector<Enum_Definition *> enums;
+    size_t num_enums = r.read_count();
+    for (size_t i = 0; i < num_enums && r.ok; i++) {
+        Enum_Definition defn;
+        defn.uuid = r.read<uint64_t>();
+        defn.module = r.read_module();
+        defn.name = r.read_symbol();
+        defn.size = r.read<uint16_t>();
+        defn.is_sumtype = r.read<uint8_t>();
+        enums.push_back(interp->types.add_enum(defn));
+    }
+
+    for (auto defn : traits) {
+        size_t num_methods = r.read_count();
+        for (size_t i = 0; i < num_methods && r.ok; i++) {
+            Trait_Method method;
+            method.variadic = r.read<uint8_t>();
+            method.is_method = r.read<uint8_t>();
+            method.name = r.read_symbol();
+            method.return_type = r.read_type();
+            size_t num_params = r.read_count();
+            for (size_t j = 0; j < num_params && r.ok; j++) {
+                Trait_Method::Parameter param;
+                param.name = r.read_symbol();
+                param.type = r.read_type();
+                method.params.push_back(param);
+            }
+            defn->methods.push_back(method);
+        }
+    }
+    for (auto defn : structs) {
+        size_t num_fields = r.read_count();
+        for (size_t i = 0; i < num_fields && r.ok; i++) {
+            Struct_Field field;
+            field.offset = r.read<uint16_t>();
+            field.id = r.read_symbol();
+            field.type = r.read_type();
+            defn->fields.push_back(field);
+        }
+        r.read_methods(defn->methods);
+    }
+    for (auto defn : enums) {
+        size_t num_variants = r.read_count();
+        for (size_t i = 0; i < num_variants && r.ok; i++) {
+            Enum_Variant variant;
+            variant.tag = r.read<runtime::Int>();
+            variant.id = r.read_symbol();
+            size_t num_payload = r.read_count();
+            for (size_t j = 0; j < num_payload && r.ok; j++) {
+                Enum_Payload_Field field;
+                field.offset = r.read<uint16_t>();
+                field.type = r.read_type();
+                variant.payload.push_back(field);
+            }
+            defn->variants.push_back(variant);
+        }
+        r.read_methods(defn->methods);
+    }
+
+    // Every function is added before any code is read so relocations can point forwards.
+    size_t num_functions = r.read_count();
+    std::vector<const uint8_t *> code_starts;
+    for (size_t i = 0; i < num_functions && r.ok; i++) {
+        Function_Definition defn;
+        defn.uuid = r.read<uint64_t>();
+        defn.module = r.read_module();
+        defn.varargs = r.read<uint8_t>();
+        defn.name = r.read_symbol();
+        defn.type = r.read_type();
+        size_t num_params = r.read_count();
+        for (size_t j = 0; j < num_params && r.ok; j++) {
+            defn.param_names.push_back(r.read_symbol());
+        }
+        interp->functions.add_func(defn);
+
+        // skip the code for now
+        code_starts.push_back(r.it);
+        r.read<uint16_t>();
+        r.read_bytes(size);
+        size_t num_relocations = r.read_count();
+        for (size_t j = 0; j < num_relocations; j++) {
+            r.read<uint32_t>();
+            r.read<Relocation_Kind>();
+            r.read<uint64_t>();
+        }
+    }
+
+    Module *module = r.read_module();
+    if (module) {
+        r.read_code(&module->top_level);
+    }
+    auto rest = r.it;
+
+    for (size_t i = 0; i < code_starts.size() && r.ok; i++) {
+        r.it = code_starts[i];
+        r.read_code(interp->functions.table[i]);
+    }
+
+    verify(r.ok && module && rest == r.end, Code_Location{ 0, 0, "<load_image>" }, "'%s' is corrupt. Delete it to compile from source again.", path);
+    
+    protect_image(image);
+    interp->image = image;
+    return module;
+}
@@ -0,0 +1,45 @@
+//
+//  image.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct Interpreter;
+struct Module;
+
+//
+// A compiled program saved next to its source as a .foxc image so the next run
+// can skip tokenizing, parsing, typechecking and optimizing. The image holds
+// the bytecode of every function, the struct/enum/trait definitions, the
+// modules and their members and both constant sections. The addresses of
+// definitions baked into the bytecode are stored as relocations and patched
+// when the image is loaded.
+//
+// Loading maps the image and runs its bytecode and constants in place, nothing
+// is copied out of it apart from the definitions, so it stays mapped until
+// unload_image().
+//
+
+uint64_t hash_bytes(const void *data, size_t size);
+
+// Returns false, without writing anything, if the program refers to something an image can't hold.
+bool save_image(Interpreter *interp, Module *module, const char *path);
+
+//
+// Loads the image at `path` into `interp`, which mustn't have compiled anything
+// yet, and returns its main module. Returns nullptr if there's no image, it
+// was written by a different version or with different options, it's been
+// truncated or corrupted, or any of the sources it was compiled from have
+// changed since.
+//
+Module *load_image(Interpreter *interp, const char *path);
+
+// Unmaps the image the program was loaded from, if it was, once nothing is going to run.
+void unload_image(Interpreter *interp);
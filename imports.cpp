@@ -0,0 +1,93 @@
+//
+//  imports.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "imports.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include "ast.h"
+#include "interpreter.h"
+
+#define PRINT_DEBUG_DIAGNOSTICS 1 && defined(DEBUG)
+
+struct Import_Queue {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::string> pending;
+    std::unordered_set<std::string> seen;
+    size_t parsing = 0; // taken off pending but not finished yet
+
+    // Call with the mutex held.
+    void add_imports(const Parsed_Module &parsed) {
+        for (auto &node : parsed.ast->nodes) {
+            if (node->kind != Untyped_AST_Kind::Import_Decl) continue;
+            
+            auto import = node.cast<Untyped_AST_Import_Declaration>();
+            std::string file = import->filepath();
+            if (seen.insert(file).second) {
+                pending.push_back(file);
+            }
+        }
+    }
+};
+
+static void parse_on_worker(Interpreter *interp, Import_Queue &queue, Mem_Allocator *main_mem, String_Allocator *main_smem) {
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    while (true) {
+        queue.changed.wait(lock, [&]() { return !queue.pending.empty() || queue.parsing == 0; });
+        if (queue.pending.empty()) break;
+        
+        std::string file = queue.pending.back();
+        queue.pending.pop_back();
+        queue.parsing++;
+        
+        lock.unlock();
+        auto parsed = parse_module(file.c_str());
+        lock.lock();
+        
+        interp->parsed_modules[file] = parsed;
+        queue.add_imports(parsed);
+        queue.parsing--;
+        queue.changed.notify_all();
+    }
+    
+    // The main thread is waiting in join() so it isn't using its allocators.
+    main_mem->adopt(Mem);
+    main_smem->adopt(SMem);
+}
+
+void parse_imports(Interpreter *interp, const char *path) {
+    size_t jobs = interp->jobs ? interp->jobs : std::thread::hardware_concurrency();
+#if PRINT_DEBUG_DIAGNOSTICS
+    // keeps the token and AST dumps in order
+    jobs = 1;
+#endif
+    
+    // On one thread it's quicker to parse each module as it's imported, while
+    // its tokens and AST are still in cache, than to parse them all up front.
+    if (jobs <= 1) return;
+    
+    Import_Queue queue;
+    queue.seen.insert(path);
+    
+    auto parsed = parse_module(path);
+    interp->parsed_modules[path] = parsed;
+    queue.add_imports(parsed);
+    if (queue.pending.empty()) return;
+    
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < jobs; i++) {
+        workers.emplace_back(parse_on_worker, interp, std::ref(queue), &Mem, &SMem);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
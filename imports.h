@@ -0,0 +1,22 @@
+//
+//  imports.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+struct Interpreter;
+
+//
+// Parses the file at `path` and every module it imports, directly or through
+// other modules, ahead of typechecking. Independent modules are tokenized and
+// parsed in parallel on Interpreter::jobs threads and the results are left in
+// Interpreter::parsed_modules for compile_module() to pick up, so only
+// typechecking and compiling happen one module at a time. Imports that aren't
+// at the top level of a file are left for compile_module() to find, as is
+// everything when there's only one thread to parse on.
+//
+void parse_imports(Interpreter *interp, const char *path);
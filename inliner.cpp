@@ -0,0 +1,169 @@
+//
+//  inliner.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "inliner.h"
+
+#include "bytecode.h"
+#include "definitions.h"
+#include "error.h"
+#include "interpreter.h"
+
+// instructions whose address is relative to the stack bottom
+static bool addresses_frame(Opcode op) {
+    switch (op) {
+        case Opcode::Push_Pointer:
+        case Opcode::Push_Value:
+        case Opcode::Flush:
+        case Opcode::Flush_Value:
+        case Opcode::Inc_Local:
+        case Opcode::Add_Local:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool is_inlinable(const Function_Definition *fn, const std::vector<Instruction> &code, size_t threshold) {
+    if (fn->varargs || code.empty() || code.size() > threshold) return false;
+
+    // functions that were never compiled have no code to copy
+    if (code.back().op != Opcode::Return) return false;
+
+    for (auto &inst : code) {
+        switch (inst.op) {
+            // would take over the caller's frame
+            case Opcode::Tail_Call:
+                return false;
+            case Opcode::Call_Direct:
+                if (inst.value == fn->index) return false;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+struct Inliner {
+    const Callees &callees;
+    std::vector<std::vector<Instruction>> bodies; // indexed by Function_Index, as compiled
+    std::vector<bool> inlinable; // indexed by Function_Index
+
+    std::vector<Instruction> out;
+    std::vector<bool> resolved; // the jump at out[i] already targets an index into `out`
+
+    Inliner(Interpreter *interp, const Callees &callees, size_t threshold) : callees(callees) {
+        auto &table = interp->functions.table;
+        bodies.reserve(table.size());
+        inlinable.reserve(table.size());
+        for (auto fn : table) {
+            if (!fn) {
+                bodies.emplace_back();
+                inlinable.push_back(false);
+                continue;
+            }
+            // --watch keeps the code as compiled for functions that have been optimized already
+            bodies.push_back(decode_instructions(fn->unoptimized.empty() ? fn->instructions : fn->unoptimized));
+            inlinable.push_back(is_inlinable(fn, bodies.back(), threshold));
+        }
+    }
+
+    void push(const Instruction &inst, bool is_resolved) {
+        out.push_back(inst);
+        resolved.push_back(is_resolved);
+    }
+
+    // copies `body` into `out` as if its frame started at `base`, returns false if it can't be
+    bool splice(const std::vector<Instruction> &body, int base) {
+        for (auto &inst : body) {
+            if (addresses_frame(inst.op) && base + inst.address > UINT16_MAX) return false;
+        }
+
+        // where each instruction of the body ends up, a Return that isn't last also needs a jump to the end
+        std::vector<size_t> positions(body.size() + 1);
+        size_t position = out.size();
+        for (size_t k = 0; k < body.size(); k++) {
+            positions[k] = position;
+            position += body[k].op == Opcode::Return && k + 1 < body.size() ? 2 : 1;
+        }
+        positions[body.size()] = position;
+
+        for (size_t k = 0; k < body.size(); k++) {
+            Instruction inst = body[k];
+
+            if (inst.op == Opcode::Return) {
+                inst.op = Opcode::Flush_Value;
+                inst.address = static_cast<Address>(base);
+                push(inst, true);
+
+                if (k + 1 < body.size()) {
+                    Instruction jump;
+                    jump.op = Opcode::Jump;
+                    jump.target = positions[body.size()];
+                    push(jump, true);
+                }
+                continue;
+            }
+
+            if (addresses_frame(inst.op)) inst.address += base;
+            if (is_jump(inst.op)) inst.target = positions[inst.target];
+            push(inst, true);
+        }
+        return true;
+    }
+
+    size_t inline_calls(Function_Definition *fn, int entry_depth) {
+        auto code = decode_instructions(fn->instructions);
+        auto depths = stack_depths(code, entry_depth, callees);
+
+        out.clear();
+        resolved.clear();
+
+        size_t inlined = 0;
+        std::vector<size_t> new_indices(code.size() + 1);
+        for (size_t i = 0; i < code.size(); i++) {
+            auto &inst = code[i];
+            new_indices[i] = out.size();
+
+            // the arguments are the callee's frame so it starts where they do
+            if (inst.op == Opcode::Call_Direct && depths[i] != Unknown_Depth && inlinable[inst.value]) {
+                if (splice(bodies[inst.value], depths[i] - inst.size)) {
+                    inlined++;
+                    continue;
+                }
+            }
+
+            push(inst, false);
+        }
+        new_indices[code.size()] = out.size();
+
+        if (inlined == 0) return 0;
+
+        for (size_t i = 0; i < out.size(); i++) {
+            if (is_jump(out[i].op) && !resolved[i]) out[i].target = new_indices[out[i].target];
+        }
+
+        encode_instructions(out, fn->instructions);
+        return inlined;
+    }
+};
+
+size_t inline_functions(Interpreter *interp, Module *module, size_t threshold) {
+    Callees callees(interp);
+    Inliner inliner(interp, callees, threshold);
+
+    size_t inlined = 0;
+    if (!module->top_level.optimized) {
+        inlined += inliner.inline_calls(&module->top_level, 0);
+    }
+    for (auto fn : interp->functions.table) {
+        if (!fn || fn->optimized) continue;
+        inlined += inliner.inline_calls(fn, fn->type.data.func.arg_size());
+    }
+    return inlined;
+}
@@ -0,0 +1,24 @@
+//
+//  inliner.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+#include <stddef.h>
+
+struct Interpreter;
+struct Module;
+
+//
+// Replaces Call_Direct with a copy of the callee's code wherever the callee is
+// at most `threshold` instructions long, isn't variadic and doesn't call
+// itself. The callee's frame addresses are shifted to where its frame would
+// have started and its Returns become a Flush_Value to that address. Callees
+// are copied as they were compiled, so inlining only ever goes one level deep.
+// Returns how many calls were inlined.
+//
+size_t inline_functions(Interpreter *interp, Module *module, size_t threshold);
@@ -8,12 +8,21 @@
 
 #include "interpreter.h"
 
+#include "bytecode.h"
 #include "compiler.h"
+#include "emit_c.h"
 #include "error.h"
+#include "image.h"
+#include "imports.h"
+#include "inliner.h"
+#include "peephole.h"
+#include "registers.h"
 #include "tokenizer.h"
 #include "parser.h"
+#include "watch.h"
 
 #include <assert.h>
+#include <chrono>
 #include <fstream>
 
 #define PRINT_DEBUG_DIAGNOSTICS  1 && defined(DEBUG)
@@ -21,6 +30,12 @@
 #define TYPECHECK                1 || defined(NDEBUG)
 #define COMPILE_AST              1 || defined(NDEBUG)
 #define RUN_VIRTUAL_MACHINE      1 || defined(NDEBUG)
+#define FORK_RUNS                defined(__unix__) || defined(__APPLE__)
+
+#if FORK_RUNS
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 Interpreter::Interpreter() {
     load_builtins(this);
@@ -42,36 +57,224 @@ static String read_entire_file(const char *path) {
     return source;
 }
 
-void Interpreter::interpret(const char *path) {
-    Module *module = compile_module(const_cast<char *>(path));
+// Tokenizes the file without parsing it, over and over for at least a second.
+static void print_tokenizer_throughput(const char *path) {
+    String source = read_entire_file(path);
     
+    size_t passes = 0;
+    size_t tokens = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed;
+    do {
+        Token_Stream stream(source, path);
+        while (stream.next().kind != Token_Kind::Eof) {
+            tokens++;
+        }
+        passes++;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 1.0);
+    
+    double megabytes = static_cast<double>(source.size()) * passes / (1024.0 * 1024.0);
+    fprintf(stderr, "Tokenized %zu bytes, %zu tokens, %zu times in %.2f s: %.1f MB/s\n",
+            source.size(), tokens / passes, passes, elapsed.count(), megabytes / elapsed.count());
+}
+
+static void peephole_optimize_module(Interpreter *interp, Module *module) {
 #if PRINT_DEBUG_DIAGNOSTICS
     printf("------\n");
-    printf("<MAIN>:\n");
-    print_code(module->top_level.instructions, constants, str_constants);
+    printf("Peephole:\n");
+#endif
     
-    for (auto &[_, fn] : functions.funcs) {
-        printf("\n%.*s#%zu%s:\n", fn.name.size(), fn.name.c_str(), fn.uuid, fn.type.debug_str());
-        print_code(fn.instructions, constants, str_constants);
+    Callees callees(interp);
+    Peephole_Stats stats;
+    if (!module->top_level.optimized) {
+        stats = peephole_optimize(&module->top_level, 0, callees);
+#if PRINT_DEBUG_DIAGNOSTICS
+        printf("<MAIN>: %zu -> %zu instructions\n", stats.instructions_before, stats.instructions_after);
+#endif
     }
+    
+    for (auto &[_, fn] : interp->functions.funcs) {
+        if (fn.optimized) continue;
+        stats = peephole_optimize(&fn, fn.type.data.func.arg_size(), callees);
+#if PRINT_DEBUG_DIAGNOSTICS
+        printf("%.*s#%zu: %zu -> %zu instructions\n", fn.name.size(), fn.name.c_str(), fn.uuid, stats.instructions_before, stats.instructions_after);
 #endif
+    }
     
-#if COMPILE_AST && RUN_VIRTUAL_MACHINE
+    (void)stats;
+}
+
+static void shorten_jumps_in_module(Interpreter *interp, Module *module) {
+    if (!module->top_level.optimized) {
+        shorten_jumps(&module->top_level);
+    }
+    for (auto &[_, fn] : interp->functions.funcs) {
+        if (!fn.optimized) shorten_jumps(&fn);
+    }
+}
+
+static void print_bytecode_sizes(Interpreter *interp, Module *module) {
+    size_t total = module->top_level.code().size();
+    fprintf(stderr, "<MAIN>: %zu bytes\n", module->top_level.code().size());
+    for (auto &[_, fn] : interp->functions.funcs) {
+        fprintf(stderr, "%.*s#%zu: %zu bytes\n", fn.name.size(), fn.name.c_str(), fn.uuid, fn.code().size());
+        total += fn.code().size();
+    }
+    fprintf(stderr, "total: %zu bytes\n", total);
+}
+
+static void optimize_module(Interpreter *interp, Module *module) {
+    if (interp->inline_threshold > 0) {
+        size_t inlined = inline_functions(interp, module, interp->inline_threshold);
+#if PRINT_DEBUG_DIAGNOSTICS
+        printf("------\n");
+        printf("Inlined %zu calls.\n", inlined);
+#endif
+        (void)inlined;
+    }
+    if (interp->peephole) {
+        peephole_optimize_module(interp, module);
+    } else {
+        shorten_jumps_in_module(interp, module);
+    }
+    if (interp->register_vm) {
+        translate_to_registers(interp, module);
+    }
+    
+    module->top_level.optimized = true;
+    for (auto &[_, fn] : interp->functions.funcs) {
+        fn.optimized = true;
+    }
+}
+
+static void run_module(Interpreter *interp, Module *module) {
 #if PRINT_DEBUG_DIAGNOSTICS
     printf("------\n");
 #endif
     
-    auto vm = VM { constants, str_constants };
+    auto vm = VM { interp->constants_section(), interp->str_constants_section(), interp->builtins.table, interp->functions.table, interp->max_call_depth };
+    vm.jit_threshold = interp->jit ? interp->jit_threshold : 0;
     vm.call(&module->top_level, 0);
     vm.run();
     
+#if COUNT_DISPATCHES
+    fprintf(stderr, "%zu instructions dispatched.\n", vm.dispatch_count);
+#endif
+    
 #if PRINT_DEBUG_DIAGNOSTICS || PRINT_STACK
     printf("------\n");
     vm.print_stack();
 #endif
+}
+
+static void run_watched_module(Interpreter *interp, Module *module) {
+#if FORK_RUNS
+    // in a child process so nothing the program does, like panicking, can take the watcher down with it
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0) {
+        set_errors_recoverable(false);
+        run_module(interp, module);
+        exit(EXIT_SUCCESS);
+    }
+    if (pid > 0) {
+        int status;
+        waitpid(pid, &status, 0);
+        return;
+    }
+#endif
+    
+    try {
+        run_module(interp, module);
+    } catch (const Recoverable_Error &) {}
+}
+
+//
+// Compiles and runs the program, then does it again every time one of its
+// sources changes. Only the modules a change could affect are compiled again,
+// see update_program(). Errors are reported without exiting so a later change
+// can fix them.
+//
+static void watch_program(Interpreter *interp, const char *path) {
+    set_errors_recoverable(true);
+    
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        size_t compiled = interp->modules_compiled;
+        if (Module *module = update_program(interp, path)) {
+            prepare_to_optimize(interp, module);
+            optimize_module(interp, module);
+            
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            fprintf(stderr, "Compiled %zu of %zu modules in %.2f ms.\n", interp->modules_compiled - compiled, interp->sources.size(), elapsed.count());
+            
+            if (interp->report_bytecode_sizes) {
+                print_bytecode_sizes(interp, module);
+            }
+            run_watched_module(interp, module);
+        }
+        
+        fprintf(stderr, "Watching %zu files for changes...\n", interp->sources.size());
+        wait_for_change(interp);
+    }
+}
+
+void Interpreter::interpret(const char *path) {
+    if (report_tokenizer_throughput) {
+        print_tokenizer_throughput(path);
+        return;
+    }
+    
+#if COMPILE_AST
+    if (watch) {
+        watch_program(this, path);
+        return;
+    }
+    
+    // file.fox -> file.foxc
+    std::string image_path = std::string(path) + "c";
+    Module *module = cache ? load_image(this, image_path.c_str()) : nullptr;
+    if (!module) {
+        parse_imports(this, path);
+        module = compile_module(const_cast<char *>(path));
+        optimize_module(this, module);
+        if (cache && !save_image(this, module, image_path.c_str())) {
+            fprintf(stderr, "Warning: '%s' couldn't be cached.\n", path);
+        }
+    }
+    
+    if (report_bytecode_sizes) {
+        print_bytecode_sizes(this, module);
+    }
+#else
+    Module *module = compile_module(const_cast<char *>(path));
+#endif
     
-#endif // COMPILE_AST && RUN_VIRTUAL_MACHINE
+#if PRINT_DEBUG_DIAGNOSTICS
+    printf("------\n");
+    printf("<MAIN>:\n");
+    print_code(module->top_level.code(), constants_section(), str_constants_section());
+    
+    for (auto &[_, fn] : functions.funcs) {
+        printf("\n%.*s#%zu%s:\n", fn.name.size(), fn.name.c_str(), fn.uuid, fn.type.debug_str());
+        print_code(fn.code(), constants_section(), str_constants_section());
+    }
+#endif
+    
+#if COMPILE_AST
+    if (emit_c_path) {
+        emit_c(this, module, emit_c_path);
+        return;
+    }
+#endif
+    
+#if COMPILE_AST && RUN_VIRTUAL_MACHINE
+    run_module(this, module);
+#endif
 
+    unload_image(this);
     Mem.clear();
     SMem.clear();
 }
@@ -80,6 +283,8 @@ Module *Interpreter::create_module(String module_path) {
     Module mod;
     mod.uuid = next_uuid();
     mod.module_path = module_path;
+    mod.top_level.name = Symbol::intern(module_path);
+    mod.pass = pass;
     Module *new_mod = modules.add_module(mod);
     internal_verify(new_mod, "Module couldn't be successfully added to registry.");
     return new_mod;
@@ -96,30 +301,58 @@ Module *Interpreter::get_or_create_module(String module_path) {
     return create_module(module_path);
 }
 
-Module *Interpreter::compile_module(String module_path) {
-    if (auto m = get_module(module_path)) {
-        return m;
-    }
-    
-    String source = read_entire_file(module_path.c_str());
-    auto tokens = tokenize(source, module_path.c_str());
-    
+Parsed_Module parse_module(const char *path) {
+    // tokens point at the path so it has to outlive the caller's copy
+    String filename = String::copy(path);
+    String source = read_entire_file(filename.c_str());
 #if PRINT_DEBUG_DIAGNOSTICS
     printf("------\n");
-    for (size_t i = 0; i < tokens.size(); i++) {
+    auto all_tokens = tokenize(source, filename.c_str());
+    for (size_t i = 0; i < all_tokens.size(); i++) {
         printf("%04zu: ", i);
-        tokens[i].print();
+        all_tokens[i].print();
     }
 #endif
     
+    Token_Stream tokens(source, filename.c_str());
     auto ast = parse(tokens);
     
 #if PRINT_DEBUG_DIAGNOSTICS
     printf("------\n");
     ast->print();
 #endif
+    
+    return { hash_bytes(source.c_str(), source.size()), ast };
+}
+
+Module *Interpreter::compile_module(String module_path) {
+    if (auto m = get_module(module_path)) {
+        if (watch) update_module(this, m);
+        return m;
+    }
+    
+    // added before parsing so --watch still notices the file being fixed if it doesn't parse
+    Source_File *source = add_source(module_path.str());
+    
+    Parsed_Module parsed;
+    auto it = parsed_modules.find(module_path.str());
+    if (it != parsed_modules.end()) {
+        parsed = it->second;
+        parsed_modules.erase(it);
+    } else {
+        parsed = parse_module(module_path.c_str());
+    }
+    source->hash = parsed.hash;
 
     Module *module = create_module(module_path);
+    module->source_hash = parsed.hash;
+    build_module(module, parsed.ast);
+    
+    return module;
+}
+
+void Interpreter::build_module(Module *module, Ref<Untyped_AST_Multiary> ast) {
+    module->stale = true;
     
 #if TYPECHECK
     auto typed_ast = typecheck(*this, module, ast);
@@ -136,41 +369,58 @@ Module *Interpreter::compile_module(String module_path) {
 #endif // COMPILE_AST
 #endif // TYPECHECK
     
-    return module;
+    module->stale = false;
+    modules_compiled++;
+    if (watch) {
+        update_interfaces(this, module);
+    }
+}
+
+Source_File *Interpreter::add_source(const std::string &path) {
+    for (auto &source : sources) {
+        if (source.path == path) return &source;
+    }
+    sources.push_back({ path, 0 });
+    return &sources.back();
 }
 
 UUID Interpreter::next_uuid() {
     return current_uuid++;
 }
 
+Byte_Span Interpreter::constants_section() const {
+    return image.data() ? image_constants : Byte_Span(constants);
+}
+
+Byte_Span Interpreter::str_constants_section() const {
+    return image.data() ? image_str_constants : Byte_Span(str_constants);
+}
+
 void Module::add_struct_member(Struct_Definition *defn) {
-    std::string sid = defn->name.str();
-    internal_verify(members.find(sid) == members.end(), "Attempted to add struct member with a duplicate name '%s'", sid.c_str());
+    internal_verify(members.find(defn->name) == members.end(), "Attempted to add struct member with a duplicate name '%s'", defn->name.c_str());
     
-    members[sid] = { Member::Struct, defn->uuid };
+    members[defn->name] = { Member::Struct, defn->uuid };
 }
 
 void Module::add_enum_member(Enum_Definition *defn) {
-    std::string sid = defn->name.str();
-    internal_verify(members.find(sid) == members.end(), "Attempted to add enum member with a duplicate name '%s'", sid.c_str());
+    internal_verify(members.find(defn->name) == members.end(), "Attempted to add enum member with a duplicate name '%s'", defn->name.c_str());
     
-    members[sid] = { Member::Enum, defn->uuid };
+    members[defn->name] = { Member::Enum, defn->uuid };
 }
 
 void Module::add_func_member(Function_Definition *defn) {
-    std::string sid = defn->name.str();
-    internal_verify(members.find(sid) == members.end(), "Attempted to add function member with a duplicate name '%s'", sid.c_str());
+    internal_verify(members.find(defn->name) == members.end(), "Attempted to add function member with a duplicate name '%s'", defn->name.c_str());
     
-    members[sid] = { Member::Function, defn->uuid };
+    members[defn->name] = { Member::Function, defn->uuid };
 }
 
-void Module::add_submodule(const std::string &id, Module *module) {
+void Module::add_submodule(Symbol id, Module *module) {
     internal_verify(members.find(id) == members.end(), "Attempted to add submodule with a duplicate name '%s'", id.c_str());
     
     members[id] = { Member::Submodule, module->uuid };
 }
 
-bool Module::find_member_by_id(const std::string &id, Member &out_member) {
+bool Module::find_member_by_id(Symbol id, Member &out_member) {
     auto it = members.find(id);
     if (it == members.end()) return false;
     out_member = it->second;
@@ -223,8 +473,18 @@ Trait_Definition *Types::get_trait_by_uuid(UUID uuid) {
 
 Function_Definition *Functions::add_func(const Function_Definition &defn) {
     internal_verify(funcs.find(defn.uuid) == funcs.end(), "Function with duplicate UUID detected: #%zu", defn.uuid);
-    funcs[defn.uuid] = std::move(defn);
-    return &funcs[defn.uuid];
+    internal_verify(table.size() <= UINT32_MAX, "Too many functions for a Function_Index.");
+    Function_Definition *fn = &funcs[defn.uuid];
+    *fn = defn;
+    fn->index = static_cast<Function_Index>(table.size());
+    table.push_back(fn);
+    return fn;
+}
+
+void Functions::remove_func(Function_Definition *fn) {
+    // its index stays taken as code elsewhere still addresses the table by index
+    table[fn->index] = nullptr;
+    funcs.erase(fn->uuid);
 }
 
 Function_Definition *Functions::get_func_by_uuid(UUID uuid) {
@@ -257,13 +517,16 @@ Module *Modules::get_module_by_path(String path) {
     return it->second;
 }
 
-void Builtins::add_builtin(const std::string &id, Builtin_Definition builtin) {
+void Builtins::add_builtin(Symbol id, Builtin_Definition builtin) {
     internal_verify(builtins.find(id) == builtins.end(), "Attempted to add a builtin with a duplicate name: '%s'.", id.c_str());
+    internal_verify(table.size() <= UINT16_MAX, "Too many builtins for a Builtin_Index.");
+    builtin.index = static_cast<Builtin_Index>(table.size());
+    table.push_back(builtin.builtin);
     builtins[id] = builtin;
 }
 
-Builtin_Definition *Builtins::get_builtin(const std::string &id) {
+Builtin_Definition *Builtins::get_builtin(Symbol id) {
     auto it = builtins.find(id);
     if (it == builtins.end()) return nullptr;
-    return &builtins[id];
+    return &it->second;
 }
@@ -12,6 +12,7 @@
 #include "definitions.h"
 #include "vm.h"
 
+#include <atomic>
 #include <unordered_map>
 #include <string>
 
@@ -26,16 +27,30 @@ struct Module {
         UUID uuid;
     };
     
+    // An imported module and the interface_hash it had when this one was compiled against it.
+    struct Import {
+        Module *module;
+        uint64_t interface_hash;
+    };
+    
     UUID uuid;
     Function_Definition top_level;
     String module_path;
-    std::unordered_map<std::string, Member> members;
+    std::unordered_map<Symbol, Member> members;
+    
+    // What --watch needs to know to recompile only the modules that have changed, see watch.h.
+    uint64_t source_hash = 0;
+    uint64_t interface_hash = 0;
+    std::vector<Import> imports;
+    std::unordered_map<Symbol, Member> compiled_members; // members as of the last compile that succeeded
+    size_t pass = 0; // the last Interpreter::pass that brought the module up to date
+    bool stale = false; // set while it's compiling, so still set if that failed
     
     void add_struct_member(Struct_Definition *defn);
     void add_enum_member(Enum_Definition *defn);
     void add_func_member(Function_Definition *defn);
-    void add_submodule(const std::string &id, Module *module);
-    bool find_member_by_id(const std::string &id, Member &out_member);
+    void add_submodule(Symbol id, Module *module);
+    bool find_member_by_id(Symbol id, Member &out_member);
     void merge(Module *other);
 };
 
@@ -54,8 +69,10 @@ struct Types {
 
 struct Functions {
     std::unordered_map<UUID, Function_Definition> funcs;
+    std::vector<Function_Definition *> table; // indexed by Call_Direct, nullptr where --watch dropped a function
     
     Function_Definition *add_func(const Function_Definition &defn);
+    void remove_func(Function_Definition *fn);
     Function_Definition *get_func_by_uuid(UUID uuid);
 };
 
@@ -69,14 +86,45 @@ struct Modules {
 };
 
 struct Builtins {
-    std::unordered_map<std::string, Builtin_Definition> builtins;
+    std::unordered_map<Symbol, Builtin_Definition> builtins;
+    std::vector<Builtin> table; // indexed by Call_Builtin
     
-    void add_builtin(const std::string &id, Builtin_Definition builtin);
-    Builtin_Definition *get_builtin(const std::string &id);
+    void add_builtin(Symbol id, Builtin_Definition builtin);
+    Builtin_Definition *get_builtin(Symbol id);
+};
+
+struct Source_File {
+    std::string path;
+    uint64_t hash;
 };
 
+struct Untyped_AST_Multiary;
+
+struct Parsed_Module {
+    uint64_t hash; // of the source
+    Ref<Untyped_AST_Multiary> ast;
+};
+
+// Reads, tokenizes and parses a file. Uses nothing shared so it can run on any thread.
+Parsed_Module parse_module(const char *path);
+
 struct Interpreter {
-    UUID current_uuid = 0;
+    std::atomic<UUID> current_uuid = 0;
+    size_t max_call_depth = Call_Stack::Default_Max_Depth;
+    bool peephole = true;
+    size_t inline_threshold = 16; // largest function, in instructions, that gets inlined. 0 turns inlining off
+    bool register_vm = false;
+    bool ssa = false; // compile function bodies through the SSA form where they fit in it
+    bool jit = false;
+    size_t jit_threshold = 1000; // calls and loop iterations before a function is compiled to native code
+    bool report_bytecode_sizes = false;
+    bool report_tokenizer_throughput = false; // tokenize the file for a second and report MB/s instead of running it
+    const char *emit_c_path = nullptr; // writes the program out as C instead of running it
+    bool cache = false; // reuse, or write, a compiled image of the program next to its source
+    size_t jobs = 0; // threads imports are parsed on, 0 for one per core
+    bool watch = false; // compile and run again whenever a source changes
+    size_t pass = 0; // bumped each time --watch brings the program up to date
+    size_t modules_compiled = 0; // so far, for --watch to report how many each pass needed
     Types types;
     Functions functions;
     Builtins builtins;
@@ -84,6 +132,15 @@ struct Interpreter {
     
     Data_Section constants;
     Data_Section str_constants;
+    Data_Section_Index constants_index; // so the compiler finds a constant it's already added without searching for it
+    Data_Section_Index str_constants_index;
+    std::vector<Source_File> sources; // every file compiled, for checking a cached image is current
+    std::unordered_map<std::string, Parsed_Module> parsed_modules; // parsed ahead of typechecking by parse_imports()
+    
+    // Set when the program was loaded from a .foxc image. Its sections are used in place of the ones above.
+    Byte_Span image;
+    Byte_Span image_constants;
+    Byte_Span image_str_constants;
     
     Interpreter();
     
@@ -92,5 +149,9 @@ struct Interpreter {
     Module *get_module(String module_path);
     Module *get_or_create_module(String module_path);
     Module *compile_module(String module_path);
+    void build_module(Module *module, Ref<Untyped_AST_Multiary> ast);
+    Source_File *add_source(const std::string &path);
     UUID next_uuid();
+    Byte_Span constants_section() const;
+    Byte_Span str_constants_section() const;
 };
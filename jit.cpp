@@ -0,0 +1,1117 @@
+//
+//  jit.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "jit.h"
+
+#if JIT
+
+#include <algorithm>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "bytecode.h"
+#include "definitions.h"
+#include "error.h"
+
+//
+// What the translated code needs from the VM. It's filled in every time native
+// code is entered so nothing goes stale if the data sections move.
+//
+struct Native_Context {
+    uint8_t *globals;       // the bottom of the VM's stack
+    uint8_t *stack_end;
+    const uint8_t *constants;
+    const uint8_t *str_constants;
+    VM *vm;
+};
+
+// Returns the pc of the instruction it stopped at.
+using Native_Entry = uint32_t (*)(Native_Context *context, uint8_t *bp, uint8_t **sp, const uint8_t *start);
+
+static constexpr uint32_t No_Entry = UINT32_MAX;
+
+struct Native_Code {
+    uint8_t *memory;
+    size_t size;
+    std::vector<uint32_t> entries; // byte offset of an instruction -> offset of its native code
+};
+
+enum Reg : uint8_t {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15,
+};
+
+enum Xmm : uint8_t {
+    XMM0, XMM1, XMM2,
+};
+
+enum Condition : uint8_t {
+    CC_B = 0x2,
+    CC_AE = 0x3,
+    CC_E = 0x4,
+    CC_NE = 0x5,
+    CC_BE = 0x6,
+    CC_A = 0x7,
+    CC_P = 0xA,
+    CC_L = 0xC,
+    CC_GE = 0xD,
+    CC_LE = 0xE,
+    CC_G = 0xF,
+};
+
+//
+// The translated code keeps the VM's state in callee saved registers so calls
+// out to C don't disturb it. rax, rcx, rdx, r8-r11 and the xmm registers are
+// scratch within an instruction, rdi and rsi hold the pointers an instruction
+// copies to and from.
+//
+static constexpr Reg SP = RBX;
+static constexpr Reg BP = R12;
+static constexpr Reg STACK_END = R13;
+static constexpr Reg GLOBALS = R14;
+static constexpr Reg CONTEXT = R15;
+
+static bool fits_i32(int64_t value) {
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+static bool fits_i8(int64_t value) {
+    return value >= INT8_MIN && value <= INT8_MAX;
+}
+
+// Just the x86-64 encodings the translation uses.
+struct Assembler {
+    std::vector<uint8_t> code;
+
+    size_t here() const { return code.size(); }
+
+    void byte(uint8_t b) { code.push_back(b); }
+
+    template<typename T>
+    void value(T v) {
+        uint8_t bytes[sizeof(T)];
+        memcpy(bytes, &v, sizeof(T));
+        code.insert(code.end(), bytes, bytes + sizeof(T));
+    }
+
+    void patch_rel32(size_t at, size_t target) {
+        int32_t rel = static_cast<int32_t>(target - (at + 4));
+        memcpy(&code[at], &rel, sizeof(rel));
+    }
+
+    void rex(bool w, int reg, int base) {
+        uint8_t r = 0x40 | (w << 3) | ((reg & 8) >> 1) | ((base & 8) >> 3);
+        if (r != 0x40) byte(r);
+    }
+
+    // ModRM (and SIB) for [base + disp]
+    void mem(int reg, int base, int32_t disp) {
+        int mod = disp == 0 && (base & 7) != RBP ? 0 : fits_i8(disp) ? 1 : 2;
+        byte((mod << 6) | ((reg & 7) << 3) | (base & 7));
+        if ((base & 7) == RSP) byte(0x24);
+        if (mod == 1) byte(static_cast<uint8_t>(disp));
+        if (mod == 2) value<int32_t>(disp);
+    }
+
+    void op_mem(std::initializer_list<uint8_t> opcode, bool w, int reg, int base, int32_t disp, uint8_t prefix = 0) {
+        if (prefix) byte(prefix);
+        rex(w, reg, base);
+        for (uint8_t b : opcode) byte(b);
+        mem(reg, base, disp);
+    }
+
+    void op_reg(std::initializer_list<uint8_t> opcode, bool w, int reg, int rm, uint8_t prefix = 0) {
+        if (prefix) byte(prefix);
+        rex(w, reg, rm);
+        for (uint8_t b : opcode) byte(b);
+        byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+    }
+
+    void push(Reg r) { rex(false, 0, r); byte(0x50 + (r & 7)); }
+    void pop(Reg r) { rex(false, 0, r); byte(0x58 + (r & 7)); }
+    void ret() { byte(0xC3); }
+
+    // loads of 1 and 2 bytes are zero extended
+    void load(Size size, Reg reg, Reg base, int32_t disp) {
+        switch (size) {
+            case 8: op_mem({ 0x8B }, true, reg, base, disp); break;
+            case 4: op_mem({ 0x8B }, false, reg, base, disp); break;
+            case 2: op_mem({ 0x0F, 0xB7 }, false, reg, base, disp); break;
+            case 1: op_mem({ 0x0F, 0xB6 }, false, reg, base, disp); break;
+            default: internal_error("Invalid load size in Assembler::load(): %u.", size);
+        }
+    }
+
+    // only al, cl, dl and r8b-r15b can be stored as bytes
+    void store(Size size, Reg base, int32_t disp, Reg reg) {
+        switch (size) {
+            case 8: op_mem({ 0x89 }, true, reg, base, disp); break;
+            case 4: op_mem({ 0x89 }, false, reg, base, disp); break;
+            case 2: op_mem({ 0x89 }, false, reg, base, disp, 0x66); break;
+            case 1: op_mem({ 0x88 }, false, reg, base, disp); break;
+            default: internal_error("Invalid store size in Assembler::store(): %u.", size);
+        }
+    }
+
+    // stores of 8 bytes need the value to fit in a sign extended 32 bit immediate
+    void store_imm(Size size, Reg base, int32_t disp, uint64_t v) {
+        switch (size) {
+            case 8: op_mem({ 0xC7 }, true, 0, base, disp); value<int32_t>(static_cast<int32_t>(v)); break;
+            case 4: op_mem({ 0xC7 }, false, 0, base, disp); value<uint32_t>(static_cast<uint32_t>(v)); break;
+            case 2: op_mem({ 0xC7 }, false, 0, base, disp, 0x66); value<uint16_t>(static_cast<uint16_t>(v)); break;
+            case 1: op_mem({ 0xC6 }, false, 0, base, disp); byte(static_cast<uint8_t>(v)); break;
+            default: internal_error("Invalid store size in Assembler::store_imm(): %u.", size);
+        }
+    }
+
+    void mov(Reg dst, Reg src) { op_reg({ 0x89 }, true, src, dst); }
+
+    void mov_imm(Reg reg, uint64_t v) {
+        if (v <= UINT32_MAX) {
+            rex(false, 0, reg);
+            byte(0xB8 + (reg & 7));
+            value<uint32_t>(static_cast<uint32_t>(v));
+        } else {
+            rex(true, 0, reg);
+            byte(0xB8 + (reg & 7));
+            value<uint64_t>(v);
+        }
+    }
+
+    void lea(Reg reg, Reg base, int32_t disp) { op_mem({ 0x8D }, true, reg, base, disp); }
+
+    // add (0), or (1), and (4), sub (5), xor (6) and cmp (7) with an immediate
+    void alu_imm(int ext, Reg rm, int32_t imm) {
+        if (fits_i8(imm)) {
+            op_reg({ 0x83 }, true, ext, rm);
+            byte(static_cast<uint8_t>(imm));
+        } else {
+            op_reg({ 0x81 }, true, ext, rm);
+            value<int32_t>(imm);
+        }
+    }
+
+    void alu_imm_mem(int ext, Reg base, int32_t disp, int32_t imm) {
+        if (fits_i8(imm)) {
+            op_mem({ 0x83 }, true, ext, base, disp);
+            byte(static_cast<uint8_t>(imm));
+        } else {
+            op_mem({ 0x81 }, true, ext, base, disp);
+            value<int32_t>(imm);
+        }
+    }
+
+    void add_imm(Reg reg, int32_t imm) { if (imm != 0) alu_imm(0, reg, imm); }
+    void sub_imm(Reg reg, int32_t imm) { if (imm != 0) alu_imm(5, reg, imm); }
+
+    void imul_imm(Reg dst, Reg src, int32_t imm) {
+        op_reg({ 0x69 }, true, dst, src);
+        value<int32_t>(imm);
+    }
+
+    void test(Reg a, Reg b) { op_reg({ 0x85 }, true, b, a); }
+    void setcc(Condition cc, Reg reg) { op_reg({ 0x0F, static_cast<uint8_t>(0x90 + cc) }, false, 0, reg); }
+
+    size_t jcc(Condition cc) {
+        byte(0x0F);
+        byte(0x80 + cc);
+        value<int32_t>(0);
+        return here() - 4;
+    }
+
+    size_t jmp() {
+        byte(0xE9);
+        value<int32_t>(0);
+        return here() - 4;
+    }
+
+    void call(const void *fn) {
+        mov_imm(RAX, reinterpret_cast<uint64_t>(fn));
+        op_reg({ 0xFF }, false, 2, RAX);
+    }
+
+    void sse_mem(uint8_t prefix, uint8_t op, int xmm, Reg base, int32_t disp, bool w = false) {
+        op_mem({ 0x0F, op }, w, xmm, base, disp, prefix);
+    }
+
+    void sse_reg(uint8_t prefix, uint8_t op, int dst, int src, bool w = false) {
+        op_reg({ 0x0F, op }, w, dst, src, prefix);
+    }
+
+    void movsd_load(Xmm xmm, Reg base, int32_t disp) { sse_mem(0xF2, 0x10, xmm, base, disp); }
+    void movsd_store(Reg base, int32_t disp, Xmm xmm) { sse_mem(0xF2, 0x11, xmm, base, disp); }
+};
+
+static uint8_t *native_call_builtin(Native_Context *context, uint8_t *sp, uint32_t index, uint32_t arg_size) {
+    Stack &stack = context->vm->stack;
+    stack._top = static_cast<int>(sp - stack._buffer);
+    Address arg_start = stack._top - arg_size;
+    context->vm->builtins[index](stack, arg_start);
+    return stack._buffer + stack._top;
+}
+
+// the same comparisons as Opcode::Str_Equal and Opcode::Str_Not_Equal
+static uint8_t *native_str_equal(uint8_t *sp, uint32_t negate) {
+    runtime::String a, b;
+    memcpy(&b, sp - sizeof(runtime::String), sizeof(runtime::String));
+    memcpy(&a, sp - 2 * sizeof(runtime::String), sizeof(runtime::String));
+    bool c = negate ?
+        a.len == b.len && memcmp(a.s, b.s, a.len) != 0 :
+        a.len == b.len && memcmp(a.s, b.s, a.len) == 0;
+    sp -= 2 * sizeof(runtime::String);
+    *sp = c;
+    return sp + sizeof(runtime::Bool);
+}
+
+struct Jit_Translator {
+    Assembler a;
+    const std::vector<Instruction> &code;
+    const std::vector<uint32_t> &pcs;
+    std::vector<size_t> labels;
+    std::vector<std::pair<size_t, size_t>> jumps; // where a rel32 is, the instruction it goes to
+    std::vector<std::pair<size_t, uint32_t>> exits; // where a rel32 is, the pc it leaves at
+    size_t exit = 0;
+    uint32_t pc = 0;
+
+    Jit_Translator(const std::vector<Instruction> &code, const std::vector<uint32_t> &pcs)
+      : code(code), pcs(pcs), labels(code.size(), 0) {}
+
+    void jump_to(size_t rel32, size_t target) { jumps.push_back({ rel32, target }); }
+
+    // leaves for the interpreter at the current instruction if the condition holds
+    void exit_if(Condition cc) { exits.push_back({ a.jcc(cc), pc }); }
+
+    void exit_here() {
+        a.mov_imm(RAX, pc);
+        a.patch_rel32(a.jmp(), exit);
+    }
+
+    // leaves for the interpreter if moving the stack top by `delta` would overflow, the VM reports it
+    void check_stack(int delta) {
+        if (delta <= 0) return;
+        a.lea(RAX, SP, delta);
+        a.op_reg({ 0x3B }, true, RAX, STACK_END);
+        exit_if(CC_A);
+    }
+
+    //
+    // memmove() of `size` bytes. Small copies load everything before storing
+    // so they're safe to overlap. `dst` can't be rsi and `src` can't be rdi.
+    //
+    void copy(Reg dst, int32_t dst_disp, Reg src, int32_t src_disp, Size size) {
+        if (size <= 32) {
+            static const Reg scratch[] = { RAX, RCX, RDX, R8, R9, R10, R11 };
+            Size widths[7];
+            int count = 0;
+            for (Size offset = 0; offset < size;) {
+                Size width = size - offset >= 8 ? 8 : size - offset >= 4 ? 4 : size - offset >= 2 ? 2 : 1;
+                widths[count] = width;
+                a.load(width, scratch[count++], src, src_disp + offset);
+                offset += width;
+            }
+            Size offset = 0;
+            for (int i = 0; i < count; i++) {
+                a.store(widths[i], dst, dst_disp + offset, scratch[i]);
+                offset += widths[i];
+            }
+        } else {
+            a.lea(RDI, dst, dst_disp);
+            a.lea(RSI, src, src_disp);
+            a.mov_imm(RDX, size);
+            a.call(reinterpret_cast<const void *>(&memmove));
+        }
+    }
+
+    void zero(Reg dst, int32_t disp, Size size) {
+        if (size <= 64) {
+            for (Size offset = 0; offset < size;) {
+                Size width = size - offset >= 8 ? 8 : size - offset >= 4 ? 4 : size - offset >= 2 ? 2 : 1;
+                a.store_imm(width, dst, disp + offset, 0);
+                offset += width;
+            }
+        } else {
+            a.lea(RDI, dst, disp);
+            a.op_reg({ 0x31 }, false, RSI, RSI);
+            a.mov_imm(RDX, size);
+            a.call(reinterpret_cast<const void *>(&memset));
+        }
+    }
+
+    // sets ZF if the `size` bytes at both places are the same
+    void compare_bytes(Reg x, int32_t x_disp, Reg y, int32_t y_disp, Size size) {
+        switch (size) {
+            case 1: a.load(1, RAX, x, x_disp); a.op_mem({ 0x3A }, false, RAX, y, y_disp); break;
+            case 2: a.load(2, RAX, x, x_disp); a.op_mem({ 0x3B }, false, RAX, y, y_disp, 0x66); break;
+            case 4: a.load(4, RAX, x, x_disp); a.op_mem({ 0x3B }, false, RAX, y, y_disp); break;
+            case 8: a.load(8, RAX, x, x_disp); a.op_mem({ 0x3B }, true, RAX, y, y_disp); break;
+            default:
+                a.lea(RDI, x, x_disp);
+                a.lea(RSI, y, y_disp);
+                a.mov_imm(RDX, size);
+                a.call(reinterpret_cast<const void *>(&memcmp));
+                a.op_reg({ 0x85 }, false, RAX, RAX);
+                break;
+        }
+    }
+
+    // reg op= imm through rcx, for immediates that don't fit in the instruction. `op` takes reg, r/m
+    void int_op_imm(std::initializer_list<uint8_t> op, Reg reg, uint64_t imm) {
+        a.mov_imm(RCX, imm);
+        a.op_reg(op, true, reg, RCX);
+    }
+
+    void push_int(Reg reg) {
+        a.store(8, SP, 0, reg);
+        a.add_imm(SP, 8);
+    }
+
+    // a op= b on the two Ints on top of the stack
+    void int_binary(std::initializer_list<uint8_t> op) {
+        a.load(8, RAX, SP, -16);
+        a.op_mem(op, true, RAX, SP, -8);
+        a.store(8, SP, -16, RAX);
+        a.sub_imm(SP, 8);
+    }
+
+    void int_divide(bool mod) {
+        a.load(8, RCX, SP, -8);
+        a.test(RCX, RCX);
+        exit_if(CC_E);
+        a.load(8, RAX, SP, -16);
+        a.byte(0x48); a.byte(0x99); // cqo
+        a.op_reg({ 0xF7 }, true, 7, RCX); // idiv rcx
+        a.store(8, SP, -16, mod ? RDX : RAX);
+        a.sub_imm(SP, 8);
+    }
+
+    void int_compare(Condition cc) {
+        a.load(8, RAX, SP, -16);
+        a.op_mem({ 0x3B }, true, RAX, SP, -8);
+        a.setcc(cc, RAX);
+        a.store(1, SP, -16, RAX);
+        a.sub_imm(SP, 15);
+    }
+
+    void byte_binary(uint8_t op) {
+        a.load(1, RAX, SP, -2);
+        a.op_mem({ op }, false, RAX, SP, -1);
+        a.store(1, SP, -2, RAX);
+        a.sub_imm(SP, 1);
+    }
+
+    void byte_divide(bool mod) {
+        a.load(1, RAX, SP, -2);
+        a.load(1, RCX, SP, -1);
+        a.op_reg({ 0x85 }, false, RCX, RCX);
+        exit_if(CC_E);
+        a.op_reg({ 0x31 }, false, RDX, RDX);
+        a.op_reg({ 0xF7 }, false, 6, RCX); // div ecx
+        a.store(1, SP, -2, mod ? RDX : RAX);
+        a.sub_imm(SP, 1);
+    }
+
+    void byte_compare(Condition cc) {
+        a.load(1, RAX, SP, -2);
+        a.op_mem({ 0x3A }, false, RAX, SP, -1);
+        a.setcc(cc, RAX);
+        a.store(1, SP, -2, RAX);
+        a.sub_imm(SP, 1);
+    }
+
+    // leaves for the interpreter if the Float at [base + disp] is zero
+    void exit_if_float_zero(Reg base, int32_t disp) {
+        a.movsd_load(XMM1, base, disp);
+        a.sse_reg(0x66, 0x57, XMM2, XMM2); // xorpd
+        a.sse_reg(0x66, 0x2E, XMM1, XMM2); // ucomisd
+        // NaN isn't zero
+        a.byte(0x7A);
+        a.byte(0x06);
+        exit_if(CC_E);
+    }
+
+    void float_binary(uint8_t op, bool divide = false) {
+        if (divide) exit_if_float_zero(SP, -8);
+        a.movsd_load(XMM0, SP, -16);
+        a.sse_mem(0xF2, op, XMM0, SP, -8);
+        a.movsd_store(SP, -16, XMM0);
+        a.sub_imm(SP, 8);
+    }
+
+    // ucomisd sets the flags like an unsigned compare so a NaN fails every test
+    void float_compare(Condition cc, bool swap) {
+        a.movsd_load(XMM0, SP, swap ? -8 : -16);
+        a.movsd_load(XMM1, SP, swap ? -16 : -8);
+        a.sse_reg(0x66, 0x2E, XMM0, XMM1);
+        a.setcc(cc, RAX);
+        a.store(1, SP, -16, RAX);
+        a.sub_imm(SP, 15);
+    }
+
+    void jump_if_top(bool expected, bool pop, size_t target) {
+        if (pop) {
+            a.load(1, RAX, SP, -1);
+            a.sub_imm(SP, 1);
+            a.op_reg({ 0x84 }, false, RAX, RAX);
+        } else {
+            a.op_mem({ 0x80 }, false, 7, SP, -1);
+            a.byte(0);
+        }
+        jump_to(a.jcc(expected ? CC_NE : CC_E), target);
+    }
+
+    void reg_int_binary(const Instruction &inst, uint8_t op) {
+        a.load(8, RAX, BP, inst.a);
+        a.op_mem({ op }, true, RAX, BP, inst.b);
+        a.store(8, BP, inst.address, RAX);
+    }
+
+    void reg_int_divide(const Instruction &inst, bool mod) {
+        a.load(8, RCX, BP, inst.b);
+        a.test(RCX, RCX);
+        exit_if(CC_E);
+        a.load(8, RAX, BP, inst.a);
+        a.byte(0x48); a.byte(0x99); // cqo
+        a.op_reg({ 0xF7 }, true, 7, RCX);
+        a.store(8, BP, inst.address, mod ? RDX : RAX);
+    }
+
+    void reg_int_compare(const Instruction &inst, Condition cc) {
+        a.load(8, RAX, BP, inst.a);
+        a.op_mem({ 0x3B }, true, RAX, BP, inst.b);
+        a.setcc(cc, RAX);
+        a.store(1, BP, inst.address, RAX);
+    }
+
+    void reg_int_compare_imm(const Instruction &inst, Condition cc) {
+        a.load(8, RAX, BP, inst.a);
+        auto imm = static_cast<int64_t>(inst.value);
+        if (fits_i32(imm)) {
+            a.alu_imm(7, RAX, static_cast<int32_t>(imm));
+        } else {
+            int_op_imm({ 0x3B }, RAX, inst.value);
+        }
+        a.setcc(cc, RAX);
+        a.store(1, BP, inst.address, RAX);
+    }
+
+    void reg_float_binary(const Instruction &inst, uint8_t op, bool divide = false) {
+        if (divide) exit_if_float_zero(BP, inst.b);
+        a.movsd_load(XMM0, BP, inst.a);
+        a.sse_mem(0xF2, op, XMM0, BP, inst.b);
+        a.movsd_store(BP, inst.address, XMM0);
+    }
+
+    void reg_float_compare(const Instruction &inst, Condition cc, bool swap) {
+        a.movsd_load(XMM0, BP, swap ? inst.b : inst.a);
+        a.movsd_load(XMM1, BP, swap ? inst.a : inst.b);
+        a.sse_reg(0x66, 0x2E, XMM0, XMM1);
+        a.setcc(cc, RAX);
+        a.store(1, BP, inst.address, RAX);
+    }
+
+    void add_imm_mem(Reg base, int32_t disp, uint64_t imm) {
+        if (fits_i32(static_cast<int64_t>(imm))) {
+            a.alu_imm_mem(0, base, disp, static_cast<int32_t>(imm));
+        } else {
+            a.mov_imm(RCX, imm);
+            a.op_mem({ 0x01 }, true, RCX, base, disp);
+        }
+    }
+
+    void mul_imm(Reg reg, uint64_t imm) {
+        if (fits_i32(static_cast<int64_t>(imm))) {
+            a.imul_imm(reg, reg, static_cast<int32_t>(imm));
+        } else {
+            int_op_imm({ 0x0F, 0xAF }, reg, imm);
+        }
+    }
+
+    void prologue();
+    void translate(size_t i);
+    Native_Code *finish();
+};
+
+//
+// uint32_t entry(Native_Context *context, uint8_t *bp, uint8_t **sp, const uint8_t *start)
+// saves the callee saved registers, loads the VM's state into them and jumps
+// to `start`. Leaving through `exit` writes the stack top back through `sp`
+// and returns the pc in eax.
+//
+void Jit_Translator::prologue() {
+    a.push(RBP);
+    a.push(RBX);
+    a.push(R12);
+    a.push(R13);
+    a.push(R14);
+    a.push(R15);
+    // keeps the stack 16 byte aligned for calls and leaves room for `sp`
+    a.sub_imm(RSP, 24);
+    a.store(8, RSP, 0, RDX);
+    a.mov(CONTEXT, RDI);
+    a.mov(BP, RSI);
+    a.load(8, SP, RDX, 0);
+    a.load(8, GLOBALS, CONTEXT, offsetof(Native_Context, globals));
+    a.load(8, STACK_END, CONTEXT, offsetof(Native_Context, stack_end));
+    a.op_reg({ 0xFF }, false, 4, RCX); // jmp rcx
+
+    exit = a.here();
+    a.load(8, RDX, RSP, 0);
+    a.store(8, RDX, 0, SP);
+    a.add_imm(RSP, 24);
+    a.pop(R15);
+    a.pop(R14);
+    a.pop(R13);
+    a.pop(R12);
+    a.pop(RBX);
+    a.pop(RBP);
+    a.ret();
+}
+
+void Jit_Translator::translate(size_t i) {
+    const Instruction &inst = code[i];
+    Size size = inst.size;
+
+    switch (inst.op) {
+        // Literals
+        case Opcode::Lit_True:
+        case Opcode::Lit_False:
+        case Opcode::Lit_0b:
+        case Opcode::Lit_1b:
+        case Opcode::Lit_Byte: {
+            uint8_t b = inst.op == Opcode::Lit_True || inst.op == Opcode::Lit_1b ? 1 :
+                        inst.op == Opcode::Lit_Byte ? static_cast<uint8_t>(inst.value) : 0;
+            check_stack(1);
+            a.store_imm(1, SP, 0, b);
+            a.add_imm(SP, 1);
+        } break;
+        case Opcode::Lit_Char:
+            check_stack(4);
+            a.store_imm(4, SP, 0, inst.value);
+            a.add_imm(SP, 4);
+            break;
+        case Opcode::Lit_0:
+        case Opcode::Lit_1:
+        case Opcode::Lit_Int:
+        case Opcode::Lit_Float:
+        case Opcode::Lit_Pointer: {
+            uint64_t v = inst.op == Opcode::Lit_0 ? 0 : inst.op == Opcode::Lit_1 ? 1 : inst.value;
+            check_stack(8);
+            if (fits_i32(static_cast<int64_t>(v))) {
+                a.store_imm(8, SP, 0, v);
+            } else {
+                a.mov_imm(RCX, v);
+                a.store(8, SP, 0, RCX);
+            }
+            a.add_imm(SP, 8);
+        } break;
+
+        // Constants
+        case Opcode::Load_Const:
+            check_stack(size);
+            a.load(8, RSI, CONTEXT, offsetof(Native_Context, constants));
+            int_op_imm({ 0x03 }, RSI, inst.value);
+            copy(SP, 0, RSI, 0, size);
+            a.add_imm(SP, size);
+            break;
+        case Opcode::Load_Const_String:
+            check_stack(sizeof(runtime::String));
+            a.load(8, RSI, CONTEXT, offsetof(Native_Context, str_constants));
+            int_op_imm({ 0x03 }, RSI, inst.value);
+            a.load(8, RCX, RSI, 0);
+            a.add_imm(RSI, sizeof(size_t));
+            a.store(8, SP, offsetof(runtime::String, s), RSI);
+            a.store(8, SP, offsetof(runtime::String, len), RCX);
+            a.add_imm(SP, sizeof(runtime::String));
+            break;
+
+        // Arithmetic
+        case Opcode::Int_Add: int_binary({ 0x03 }); break;
+        case Opcode::Int_Sub: int_binary({ 0x2B }); break;
+        case Opcode::Int_Mul: int_binary({ 0x0F, 0xAF }); break;
+        case Opcode::Int_Div: int_divide(false); break;
+        case Opcode::Int_Mod: int_divide(true); break;
+        case Opcode::Int_Neg: a.op_mem({ 0xF7 }, true, 3, SP, -8); break;
+        case Opcode::Int_Inc:
+        case Opcode::Int_Dec:
+            a.load(8, RAX, SP, -8);
+            a.sub_imm(SP, 8);
+            a.op_mem({ 0xFF }, true, inst.op == Opcode::Int_Inc ? 0 : 1, RAX, 0);
+            break;
+
+        case Opcode::Byte_Add: byte_binary(0x02); break;
+        case Opcode::Byte_Sub: byte_binary(0x2A); break;
+        case Opcode::Byte_Mul:
+            a.load(1, RAX, SP, -2);
+            a.load(1, RCX, SP, -1);
+            a.op_reg({ 0x0F, 0xAF }, false, RAX, RCX);
+            a.store(1, SP, -2, RAX);
+            a.sub_imm(SP, 1);
+            break;
+        case Opcode::Byte_Div: byte_divide(false); break;
+        case Opcode::Byte_Mod: byte_divide(true); break;
+        case Opcode::Byte_Neg: a.op_mem({ 0xF6 }, false, 3, SP, -1); break;
+        case Opcode::Byte_Inc:
+        case Opcode::Byte_Dec:
+            a.load(8, RAX, SP, -8);
+            a.sub_imm(SP, 8);
+            a.op_mem({ 0xFE }, false, inst.op == Opcode::Byte_Inc ? 0 : 1, RAX, 0);
+            break;
+
+        case Opcode::Float_Add: float_binary(0x58); break;
+        case Opcode::Float_Sub: float_binary(0x5C); break;
+        case Opcode::Float_Mul: float_binary(0x59); break;
+        case Opcode::Float_Div: float_binary(0x5E, true); break;
+        case Opcode::Float_Neg:
+            a.op_mem({ 0x0F, 0xBA }, true, 7, SP, -8); // btc
+            a.byte(63);
+            break;
+
+        // Bitwise
+        case Opcode::Bit_Not: a.op_mem({ 0xF7 }, true, 2, SP, -8); break;
+        case Opcode::Shift_Left:
+        case Opcode::Shift_Right:
+            a.load(8, RCX, SP, -8);
+            a.sub_imm(SP, 8);
+            a.op_mem({ 0xD3 }, true, inst.op == Opcode::Shift_Left ? 4 : 7, SP, -8);
+            break;
+        case Opcode::Bit_And: int_binary({ 0x23 }); break;
+        case Opcode::Xor: int_binary({ 0x33 }); break;
+        case Opcode::Bit_Or: int_binary({ 0x0B }); break;
+
+        // Logic
+        case Opcode::And:
+        case Opcode::Or:
+            a.load(1, RAX, SP, -2);
+            a.load(1, RCX, SP, -1);
+            a.op_reg({ 0x85 }, false, RAX, RAX);
+            a.setcc(CC_NE, RAX);
+            a.op_reg({ 0x85 }, false, RCX, RCX);
+            a.setcc(CC_NE, RCX);
+            a.op_reg({ static_cast<uint8_t>(inst.op == Opcode::And ? 0x20 : 0x08) }, false, RCX, RAX);
+            a.store(1, SP, -2, RAX);
+            a.sub_imm(SP, 1);
+            break;
+        case Opcode::Not:
+            a.op_mem({ 0x80 }, false, 7, SP, -1);
+            a.byte(0);
+            a.op_mem({ 0x0F, 0x94 }, false, 0, SP, -1); // sete
+            break;
+
+        // Relational
+        case Opcode::Equal:
+        case Opcode::Not_Equal:
+            check_stack(1 - 2 * size);
+            compare_bytes(SP, -2 * size, SP, -size, size);
+            a.setcc(inst.op == Opcode::Equal ? CC_E : CC_NE, RAX);
+            a.store(1, SP, -2 * size, RAX);
+            a.sub_imm(SP, 2 * size - 1);
+            break;
+        case Opcode::Str_Equal:
+        case Opcode::Str_Not_Equal:
+            a.mov(RDI, SP);
+            a.mov_imm(RSI, inst.op == Opcode::Str_Not_Equal);
+            a.call(reinterpret_cast<const void *>(&native_str_equal));
+            a.mov(SP, RAX);
+            break;
+
+        case Opcode::Int_Less_Than:       int_compare(CC_L); break;
+        case Opcode::Int_Less_Equal:      int_compare(CC_LE); break;
+        case Opcode::Int_Greater_Than:    int_compare(CC_G); break;
+        case Opcode::Int_Greater_Equal:   int_compare(CC_GE); break;
+        case Opcode::Byte_Less_Than:      byte_compare(CC_B); break;
+        case Opcode::Byte_Less_Equal:     byte_compare(CC_BE); break;
+        case Opcode::Byte_Greater_Than:   byte_compare(CC_A); break;
+        case Opcode::Byte_Greater_Equal:  byte_compare(CC_AE); break;
+        case Opcode::Float_Less_Than:     float_compare(CC_A, true); break;
+        case Opcode::Float_Less_Equal:    float_compare(CC_AE, true); break;
+        case Opcode::Float_Greater_Than:  float_compare(CC_A, false); break;
+        case Opcode::Float_Greater_Equal: float_compare(CC_AE, false); break;
+
+        // Stack
+        case Opcode::Move:
+        case Opcode::Move_Push_Pointer: {
+            a.load(8, RDI, SP, -8);
+            a.sub_imm(SP, 8);
+            a.lea(RAX, SP, -size);
+            a.op_reg({ 0x3B }, true, RDI, RAX);
+            size_t same = a.jcc(CC_E);
+            if (inst.op == Opcode::Move_Push_Pointer) a.store(8, RSP, 8, RDI);
+            copy(RDI, 0, SP, -size, size);
+            a.sub_imm(SP, size);
+            if (inst.op == Opcode::Move_Push_Pointer) a.load(8, RDI, RSP, 8);
+            a.patch_rel32(same, a.here());
+            if (inst.op == Opcode::Move_Push_Pointer) push_int(RDI);
+        } break;
+        case Opcode::Copy: {
+            a.load(8, RDI, SP, -8);
+            a.load(8, RSI, SP, -16);
+            a.sub_imm(SP, 16);
+            a.op_reg({ 0x3B }, true, RDI, RSI);
+            size_t same = a.jcc(CC_E);
+            copy(RDI, 0, RSI, 0, size);
+            a.patch_rel32(same, a.here());
+        } break;
+        case Opcode::Load:
+            check_stack(size - 8);
+            a.load(8, RSI, SP, -8);
+            a.sub_imm(SP, 8);
+            copy(SP, 0, RSI, 0, size);
+            a.add_imm(SP, size);
+            break;
+        case Opcode::Push_Pointer:
+        case Opcode::Push_Global_Pointer:
+            check_stack(8);
+            a.lea(RAX, inst.op == Opcode::Push_Pointer ? BP : GLOBALS, inst.address);
+            push_int(RAX);
+            break;
+        case Opcode::Push_Value:
+        case Opcode::Push_Global_Value:
+            check_stack(size);
+            copy(SP, 0, inst.op == Opcode::Push_Value ? BP : GLOBALS, inst.address, size);
+            a.add_imm(SP, size);
+            break;
+        case Opcode::Pop:
+            a.sub_imm(SP, size);
+            break;
+        case Opcode::Allocate:
+            check_stack(size);
+            a.add_imm(SP, size);
+            break;
+        case Opcode::Clear_Allocate:
+            check_stack(size);
+            zero(SP, 0, size);
+            a.add_imm(SP, size);
+            break;
+        case Opcode::Flush:
+            a.lea(SP, BP, inst.address);
+            break;
+        case Opcode::Flush_Value:
+            copy(BP, inst.address, SP, -size, size);
+            a.lea(SP, BP, inst.address + size);
+            break;
+
+        // Branching
+        case Opcode::Jump:
+        case Opcode::Loop:
+        case Opcode::Jump_Long:
+        case Opcode::Loop_Long:
+            jump_to(a.jmp(), inst.target);
+            break;
+        case Opcode::Jump_True:
+        case Opcode::Jump_True_Long:          jump_if_top(true, true, inst.target); break;
+        case Opcode::Jump_False:
+        case Opcode::Jump_False_Long:         jump_if_top(false, true, inst.target); break;
+        case Opcode::Jump_True_No_Pop:
+        case Opcode::Jump_True_No_Pop_Long:   jump_if_top(true, false, inst.target); break;
+        case Opcode::Jump_False_No_Pop:
+        case Opcode::Jump_False_No_Pop_Long:  jump_if_top(false, false, inst.target); break;
+
+        // Invocation
+        case Opcode::Call_Builtin:
+            a.mov(RDI, CONTEXT);
+            a.mov(RSI, SP);
+            a.mov_imm(RDX, inst.value);
+            a.mov_imm(RCX, size);
+            a.call(reinterpret_cast<const void *>(&native_call_builtin));
+            a.mov(SP, RAX);
+            break;
+
+        // Cast
+        case Opcode::Cast_Byte_Int:
+        case Opcode::Cast_Bool_Int:
+            check_stack(7);
+            a.load(1, RAX, SP, -1);
+            if (inst.op == Opcode::Cast_Bool_Int) {
+                a.op_reg({ 0x85 }, false, RAX, RAX);
+                a.setcc(CC_NE, RAX);
+            }
+            a.store(8, SP, -1, RAX);
+            a.add_imm(SP, 7);
+            break;
+        case Opcode::Cast_Byte_Float:
+            check_stack(7);
+            a.load(1, RAX, SP, -1);
+            a.sse_reg(0xF2, 0x2A, XMM0, RAX, true); // cvtsi2sd
+            a.movsd_store(SP, -1, XMM0);
+            a.add_imm(SP, 7);
+            break;
+        case Opcode::Cast_Char_Int:
+            check_stack(4);
+            a.load(4, RAX, SP, -4);
+            a.store(8, SP, -4, RAX);
+            a.add_imm(SP, 4);
+            break;
+        case Opcode::Cast_Int_Float:
+            a.sse_mem(0xF2, 0x2A, XMM0, SP, -8, true);
+            a.movsd_store(SP, -8, XMM0);
+            break;
+        case Opcode::Cast_Float_Int:
+            a.sse_mem(0xF2, 0x2C, RAX, SP, -8, true); // cvttsd2si
+            a.store(8, SP, -8, RAX);
+            break;
+
+        // Fused
+        case Opcode::Int_Add_Imm:
+            add_imm_mem(SP, -8, inst.value);
+            break;
+        case Opcode::Int_Mul_Imm:
+            a.load(8, RAX, SP, -8);
+            mul_imm(RAX, inst.value);
+            a.store(8, SP, -8, RAX);
+            break;
+        case Opcode::Inc_Local:
+            a.op_mem({ 0xFF }, true, 0, BP, inst.address);
+            break;
+        case Opcode::Add_Local:
+            add_imm_mem(BP, inst.address, inst.value);
+            break;
+        case Opcode::Load_Indexed:
+            check_stack(size - 16);
+            a.load(8, RCX, SP, -8);
+            a.load(8, RSI, SP, -16);
+            mul_imm(RCX, size);
+            a.op_reg({ 0x01 }, true, RCX, RSI);
+            a.sub_imm(SP, 16);
+            copy(SP, 0, RSI, 0, size);
+            a.add_imm(SP, size);
+            break;
+        case Opcode::Load_Field_Indirect:
+            check_stack(size - 8);
+            a.load(8, RSI, SP, -8);
+            a.sub_imm(SP, 8);
+            copy(SP, 0, RSI, inst.address, size);
+            a.add_imm(SP, size);
+            break;
+        case Opcode::Int_Lt_Jump_False:
+        case Opcode::Int_Le_Jump_False:
+        case Opcode::Int_Lt_Jump_False_Long:
+        case Opcode::Int_Le_Jump_False_Long: {
+            bool lt = inst.op == Opcode::Int_Lt_Jump_False || inst.op == Opcode::Int_Lt_Jump_False_Long;
+            a.load(8, RAX, SP, -16);
+            a.sub_imm(SP, 16);
+            a.op_mem({ 0x3B }, true, RAX, SP, 8);
+            jump_to(a.jcc(lt ? CC_GE : CC_G), inst.target);
+        } break;
+
+        // Register
+        case Opcode::Reg_Move:
+            copy(BP, inst.address, BP, inst.a, size);
+            break;
+        case Opcode::Reg_Move_Global:
+            copy(BP, inst.address, GLOBALS, inst.a, size);
+            break;
+        case Opcode::Reg_Address:
+        case Opcode::Reg_Global_Address:
+            a.lea(RAX, inst.op == Opcode::Reg_Address ? BP : GLOBALS, inst.a);
+            a.store(8, BP, inst.address, RAX);
+            break;
+        case Opcode::Reg_Set:
+            if (size > sizeof(uint64_t)) {
+                exit_here();
+                break;
+            }
+            if (size == 8 && !fits_i32(static_cast<int64_t>(inst.value))) {
+                a.mov_imm(RCX, inst.value);
+                a.store(8, BP, inst.address, RCX);
+                break;
+            }
+            for (Size offset = 0; offset < size;) {
+                Size width = size - offset >= 8 ? 8 : size - offset >= 4 ? 4 : size - offset >= 2 ? 2 : 1;
+                a.store_imm(width, BP, inst.address + offset, inst.value >> (offset * 8));
+                offset += width;
+            }
+            break;
+        case Opcode::Reg_Load:
+            a.load(8, RSI, BP, inst.a);
+            copy(BP, inst.address, RSI, 0, size);
+            break;
+        case Opcode::Reg_Load_Indexed:
+            a.load(8, RSI, BP, inst.a);
+            a.load(8, RCX, BP, inst.b);
+            mul_imm(RCX, size);
+            a.op_reg({ 0x01 }, true, RCX, RSI);
+            copy(BP, inst.address, RSI, 0, size);
+            break;
+        case Opcode::Reg_Store:
+            a.load(8, RDI, BP, inst.address);
+            copy(RDI, 0, BP, inst.a, size);
+            break;
+
+        case Opcode::Reg_Int_Add: reg_int_binary(inst, 0x03); break;
+        case Opcode::Reg_Int_Sub: reg_int_binary(inst, 0x2B); break;
+        case Opcode::Reg_Int_Mul:
+            a.load(8, RAX, BP, inst.a);
+            a.op_mem({ 0x0F, 0xAF }, true, RAX, BP, inst.b);
+            a.store(8, BP, inst.address, RAX);
+            break;
+        case Opcode::Reg_Int_Div: reg_int_divide(inst, false); break;
+        case Opcode::Reg_Int_Mod: reg_int_divide(inst, true); break;
+        case Opcode::Reg_Int_Neg:
+            a.load(8, RAX, BP, inst.a);
+            a.op_reg({ 0xF7 }, true, 3, RAX);
+            a.store(8, BP, inst.address, RAX);
+            break;
+        case Opcode::Reg_Int_Add_Imm:
+        case Opcode::Reg_Int_Mul_Imm:
+            a.load(8, RAX, BP, inst.a);
+            if (inst.op == Opcode::Reg_Int_Mul_Imm) {
+                mul_imm(RAX, inst.value);
+            } else if (fits_i32(static_cast<int64_t>(inst.value))) {
+                a.add_imm(RAX, static_cast<int32_t>(inst.value));
+            } else {
+                int_op_imm({ 0x03 }, RAX, inst.value);
+            }
+            a.store(8, BP, inst.address, RAX);
+            break;
+        case Opcode::Reg_Int_Inc:
+        case Opcode::Reg_Int_Dec:
+            a.op_mem({ 0xFF }, true, inst.op == Opcode::Reg_Int_Inc ? 0 : 1, BP, inst.address);
+            break;
+
+        case Opcode::Reg_Float_Add: reg_float_binary(inst, 0x58); break;
+        case Opcode::Reg_Float_Sub: reg_float_binary(inst, 0x5C); break;
+        case Opcode::Reg_Float_Mul: reg_float_binary(inst, 0x59); break;
+        case Opcode::Reg_Float_Div: reg_float_binary(inst, 0x5E, true); break;
+
+        case Opcode::Reg_Not:
+            a.op_mem({ 0x80 }, false, 7, BP, inst.a);
+            a.byte(0);
+            a.setcc(CC_E, RAX);
+            a.store(1, BP, inst.address, RAX);
+            break;
+        case Opcode::Reg_Equal:
+        case Opcode::Reg_Not_Equal:
+            compare_bytes(BP, inst.a, BP, inst.b, size);
+            a.setcc(inst.op == Opcode::Reg_Equal ? CC_E : CC_NE, RAX);
+            a.store(1, BP, inst.address, RAX);
+            break;
+
+        case Opcode::Reg_Int_Less_Than:          reg_int_compare(inst, CC_L); break;
+        case Opcode::Reg_Int_Less_Equal:         reg_int_compare(inst, CC_LE); break;
+        case Opcode::Reg_Int_Greater_Than:       reg_int_compare(inst, CC_G); break;
+        case Opcode::Reg_Int_Greater_Equal:      reg_int_compare(inst, CC_GE); break;
+        case Opcode::Reg_Int_Less_Than_Imm:      reg_int_compare_imm(inst, CC_L); break;
+        case Opcode::Reg_Int_Less_Equal_Imm:     reg_int_compare_imm(inst, CC_LE); break;
+        case Opcode::Reg_Int_Greater_Than_Imm:   reg_int_compare_imm(inst, CC_G); break;
+        case Opcode::Reg_Int_Greater_Equal_Imm:  reg_int_compare_imm(inst, CC_GE); break;
+        case Opcode::Reg_Int_Equal_Imm:          reg_int_compare_imm(inst, CC_E); break;
+        case Opcode::Reg_Int_Not_Equal_Imm:      reg_int_compare_imm(inst, CC_NE); break;
+        case Opcode::Reg_Float_Less_Than:        reg_float_compare(inst, CC_A, true); break;
+        case Opcode::Reg_Float_Less_Equal:       reg_float_compare(inst, CC_AE, true); break;
+        case Opcode::Reg_Float_Greater_Than:     reg_float_compare(inst, CC_A, false); break;
+        case Opcode::Reg_Float_Greater_Equal:    reg_float_compare(inst, CC_AE, false); break;
+
+        case Opcode::Reg_Jump_True:
+        case Opcode::Reg_Jump_False:
+        case Opcode::Reg_Jump_True_Long:
+        case Opcode::Reg_Jump_False_Long: {
+            bool expected = inst.op == Opcode::Reg_Jump_True || inst.op == Opcode::Reg_Jump_True_Long;
+            a.op_mem({ 0x80 }, false, 7, BP, inst.address);
+            a.byte(0);
+            jump_to(a.jcc(expected ? CC_NE : CC_E), inst.target);
+        } break;
+
+        //
+        // Calls and returns change frames, which only the interpreter does. It
+        // comes back into the native code of whichever frame it lands in.
+        //
+        default:
+            exit_here();
+            break;
+    }
+}
+
+Native_Code *Jit_Translator::finish() {
+    for (auto [rel32, target] : jumps) {
+        internal_verify(target < labels.size(), "Jump out of the function in Jit_Translator::finish().");
+        a.patch_rel32(rel32, labels[target]);
+    }
+
+    // one stub per instruction that can leave, they're out of the way of the code that doesn't
+    std::vector<std::pair<uint32_t, size_t>> stubs;
+    for (auto [rel32, pc] : exits) {
+        auto it = std::find_if(stubs.begin(), stubs.end(), [&](auto &stub) { return stub.first == pc; });
+        if (it == stubs.end()) {
+            stubs.push_back({ pc, a.here() });
+            a.mov_imm(RAX, pc);
+            a.patch_rel32(a.jmp(), exit);
+            it = stubs.end() - 1;
+        }
+        a.patch_rel32(rel32, it->second);
+    }
+
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (a.code.size() + page - 1) / page * page;
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return nullptr;
+    memcpy(memory, a.code.data(), a.code.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return nullptr;
+    }
+
+    auto native = new Native_Code;
+    native->memory = static_cast<uint8_t *>(memory);
+    native->size = size;
+    native->entries.assign(pcs.empty() ? 0 : pcs.back() + instruction_size(code.back().op), No_Entry);
+    for (size_t i = 0; i < code.size(); i++) {
+        native->entries[pcs[i]] = static_cast<uint32_t>(labels[i]);
+    }
+    return native;
+}
+
+Native_Code *jit_compile(Function_Definition *fn) {
+    Byte_Span bytes = fn->code();
+    auto code = decode_instructions(bytes);
+
+    // decoding shortens jumps so the byte offsets come from the original code
+    std::vector<uint32_t> pcs;
+    for (size_t pc = 0; pc < bytes.size(); pc += instruction_size(static_cast<Opcode>(bytes[pc]))) {
+        pcs.push_back(static_cast<uint32_t>(pc));
+    }
+    internal_verify(pcs.size() == code.size(), "Decoded %zu instructions from %zu in jit_compile().", code.size(), pcs.size());
+
+    Jit_Translator t(code, pcs);
+    t.prologue();
+    for (size_t i = 0; i < code.size(); i++) {
+        t.labels[i] = t.a.here();
+        t.pc = pcs[i];
+        t.translate(i);
+    }
+    return t.finish();
+}
+
+void run_native(VM &vm, Call_Frame &frame) {
+    Native_Code *native = frame.function->native;
+    Native_Context context = {
+        vm.stack._buffer,
+        vm.stack._buffer + Stack::Size,
+        vm.constants.data(),
+        vm.str_constants.data(),
+        &vm,
+    };
+
+    uint8_t *sp = vm.stack._buffer + vm.stack._top;
+    auto entry = reinterpret_cast<Native_Entry>(native->memory);
+    frame.pc = entry(&context, vm.stack._buffer + frame.stack_bottom, &sp, native->memory + native->entries[frame.pc]);
+    vm.stack._top = static_cast<int>(sp - vm.stack._buffer);
+}
+
+#else
+
+Native_Code *jit_compile(Function_Definition *fn) {
+    return nullptr;
+}
+
+void run_native(VM &vm, Call_Frame &frame) {
+    internal_error("run_native() called without a JIT.");
+}
+
+#endif // JIT
@@ -0,0 +1,32 @@
+//
+//  jit.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+#include "vm.h"
+
+//
+// A baseline JIT that translates a function's bytecode, instruction by
+// instruction, into x86-64 code working on the same stack as the VM. It's only
+// built for x86-64 Linux, elsewhere jit_compile() never produces anything and
+// every function stays interpreted.
+//
+#define JIT defined(__x86_64__) && defined(__linux__)
+
+struct Native_Code;
+
+// Returns nullptr where there's no JIT or the code couldn't be mapped executable.
+Native_Code *jit_compile(Function_Definition *fn);
+
+//
+// Runs the native code of the function in `frame` from frame.pc until it gets
+// to something it leaves to the interpreter: calls, returns, instructions it
+// doesn't translate and anything that's about to raise an error. frame.pc and
+// the stack top are left pointing at that instruction.
+//
+void run_native(VM &vm, Call_Frame &frame);
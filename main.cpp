@@ -21,13 +21,74 @@
 //
 
 #include <iostream>
+#include <string.h>
 
 #include "interpreter.h"
 
 int main(int argc, const char * argv[]) {
-    if (argc > 1) {
-        Interpreter interp;
-        interp.interpret(argv[1]);
+    Interpreter interp;
+    const char *path = nullptr;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--max-call-depth") == 0 && i + 1 < argc) {
+            long long depth = atoll(argv[++i]);
+            if (depth <= 0) {
+                printf("Error: '--max-call-depth' must be a positive integer.\n");
+                return EXIT_FAILURE;
+            }
+            interp.max_call_depth = static_cast<size_t>(depth);
+        } else if (strcmp(argv[i], "--inline-threshold") == 0 && i + 1 < argc) {
+            long long threshold = atoll(argv[++i]);
+            if (threshold < 0) {
+                printf("Error: '--inline-threshold' must be zero or a positive integer.\n");
+                return EXIT_FAILURE;
+            }
+            interp.inline_threshold = static_cast<size_t>(threshold);
+        } else if (strcmp(argv[i], "--jit-threshold") == 0 && i + 1 < argc) {
+            long long threshold = atoll(argv[++i]);
+            if (threshold <= 0) {
+                printf("Error: '--jit-threshold' must be a positive integer.\n");
+                return EXIT_FAILURE;
+            }
+            interp.jit = true;
+            interp.jit_threshold = static_cast<size_t>(threshold);
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            interp.jit = true;
+        } else if (strcmp(argv[i], "--no-peephole") == 0) {
+            interp.peephole = false;
+        } else if (strcmp(argv[i], "--ssa") == 0) {
+            interp.ssa = true;
+        } else if (strcmp(argv[i], "--register-vm") == 0) {
+            interp.register_vm = true;
+        } else if (strcmp(argv[i], "--emit-c") == 0 && i + 1 < argc) {
+            interp.emit_c_path = argv[++i];
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            long long jobs = atoll(argv[++i]);
+            if (jobs <= 0) {
+                printf("Error: '--jobs' must be a positive integer.\n");
+                return EXIT_FAILURE;
+            }
+            interp.jobs = static_cast<size_t>(jobs);
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            interp.cache = true;
+        } else if (strcmp(argv[i], "--watch") == 0) {
+            interp.watch = true;
+        } else if (strcmp(argv[i], "--bytecode-sizes") == 0) {
+            interp.report_bytecode_sizes = true;
+        } else if (strcmp(argv[i], "--tokenizer-throughput") == 0) {
+            interp.report_tokenizer_throughput = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    
+    if (interp.watch && (interp.cache || interp.emit_c_path)) {
+        printf("Error: '--watch' can't be used with '--cache' or '--emit-c'.\n");
+        return EXIT_FAILURE;
+    }
+    
+    if (path) {
+        interp.interpret(path);
     } else {
         printf("Error: No path given. Fox needs to know what to compile to run.\n");
     }
@@ -53,9 +53,19 @@ void String_Allocator::clear() {
     for (Chunk b : blocks) {
         free(b);
     }
+    for (Chunk b : adopted) {
+        free(b);
+    }
     blocks.clear();
+    adopted.clear();
     current = 0;
 }
+
+void String_Allocator::adopt(String_Allocator &other) {
+    adopted.splice_after(adopted.before_begin(), other.blocks);
+    adopted.splice_after(adopted.before_begin(), other.adopted);
+    other.current = 0;
+}
     
 void String_Allocator::allocate_chunk(size_t size) {
     size_t alloc_size = Minimum_Chunk_Size;
@@ -110,12 +120,24 @@ void Mem_Allocator::clear() {
     for (Bucket b : buckets) {
         free(b);
     }
+    for (Bucket b : adopted) {
+        free(b);
+    }
     buckets.clear();
+    adopted.clear();
     current = nullptr;
     previous = nullptr;
     end_of_current_bucket = nullptr;
 }
 
+void Mem_Allocator::adopt(Mem_Allocator &other) {
+    adopted.splice_after(adopted.before_begin(), other.buckets);
+    adopted.splice_after(adopted.before_begin(), other.adopted);
+    other.current = nullptr;
+    other.previous = nullptr;
+    other.end_of_current_bucket = nullptr;
+}
+
 void Mem_Allocator::allocate_bucket(size_t size) {
     size_t alloc_size = Minimum_Bucket_Size;
     if (alloc_size < size) alloc_size = size;
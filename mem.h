@@ -13,6 +13,26 @@
 #include <vector>
 #include <forward_list>
 
+template<typename T, typename = void>
+struct has_kind_tag : std::false_type {};
+template<typename T>
+struct has_kind_tag<T, std::void_t<decltype(&T::is_kind)>> : std::true_type {};
+
+//
+// AST nodes are tagged with their kind and each node type says which kinds
+// it's built as with a static `is_kind()`, so casting to one checks the tag
+// instead of going through RTTI. Anything without one uses dynamic_cast.
+//
+template<typename U, typename T>
+U *kind_cast(T *ptr) {
+    using Target = std::remove_const_t<U>;
+    if constexpr (has_kind_tag<Target>::value) {
+        return ptr && Target::is_kind(ptr->kind) ? static_cast<U *>(ptr) : nullptr;
+    } else {
+        return dynamic_cast<U *>(ptr);
+    }
+}
+
 template<typename T>
 class Ref {
     T *ptr;
@@ -91,13 +111,13 @@ public:
 public:
     template<typename U>
     Ref<U> cast() {
-        U *p = dynamic_cast<U *>(ptr);
+        U *p = kind_cast<U>(ptr);
         return Ref<U>(p);
     }
     
     template<typename U>
     const Ref<U> cast() const {
-        U *p = dynamic_cast<U *>(ptr);
+        U *p = kind_cast<U>(ptr);
         return Ref<U>(p);
     }
     
@@ -111,6 +131,7 @@ class String_Allocator {
     
     size_t current;
     std::forward_list<Chunk> blocks;
+    std::forward_list<Chunk> adopted; // taken from other allocators, never allocated from
     
 public:
     String_Allocator() = default;
@@ -125,13 +146,19 @@ public:
     bool deallocate(char *s);
     bool deallocate(char *s, size_t size);
     void clear();
+    void adopt(String_Allocator &other);
     
 private:
     void allocate_chunk(size_t size);
     Chunk current_chunk();
 };
 
-inline String_Allocator SMem{};
+//
+// Mem and SMem are per thread so modules can be parsed on several threads at
+// once. What a thread allocated has to be handed to the main thread's
+// allocators with adopt() before the thread exits, or it's freed with them.
+//
+inline thread_local String_Allocator SMem{};
 
 class Mem_Allocator {
     static constexpr size_t Minimum_Bucket_Size = 1024;
@@ -141,6 +168,7 @@ class Mem_Allocator {
     uint8_t *previous;
     uint8_t *end_of_current_bucket;
     std::forward_list<Bucket> buckets;
+    std::forward_list<Bucket> adopted; // taken from other allocators, never allocated from
     
 public:
     Mem_Allocator() = default;
@@ -150,6 +178,7 @@ public:
     
 public:
     void clear();
+    void adopt(Mem_Allocator &other);
     
     template<typename T>
     Ref<T> allocate(size_t n) {
@@ -180,7 +209,7 @@ private:
     void allocate_bucket(size_t size);
 };
 
-inline Mem_Allocator Mem{};
+inline thread_local Mem_Allocator Mem{};
 
 template<typename = void> struct remove_ref;
 template<typename T> struct remove_ref<Ref<T>> { using type = T; };
@@ -127,13 +127,12 @@ Precedence operator+(Precedence p, int step) {
 }
 
 struct Parser {
-    const std::vector<Token> &tokens;
-    size_t current;
+    Token_Stream &tokens;
     
-    Parser(const std::vector<Token> &tokens) : tokens(tokens), current(0) {}
+    Parser(Token_Stream &tokens) : tokens(tokens) {}
     
-    bool has_more() const {
-        return current < tokens.size() - 1;
+    bool has_more() {
+        return peek().kind != Token_Kind::Eof;
     }
 
     Code_Location current_location() {
@@ -141,26 +140,19 @@ struct Parser {
     }
 
     Code_Location previous_location() {
-        return tokens[current - 1].location;
+        return tokens.previous().location;
     }
     
     Token peek() {
-        return tokens[current];
+        return tokens.peek();
     }
     
     Token peek(size_t n) {
-        if (current + n >= tokens.size()) {
-            return tokens.back();
-        }
-        return tokens[current + n];
+        return tokens.peek(n);
     }
     
     Token next() {
-        auto t = peek();
-        if (current < tokens.size()) {
-            current++;
-        }
-        return t;
+        return tokens.next();
     }
     
     bool check(Token_Kind kind) {
@@ -200,7 +192,7 @@ struct Parser {
         auto token = next();
         switch (token.kind) {
             case Token_Kind::Ident: {
-                auto id = token.data.s;
+                auto id = token.data.id;
                 if (id == "void"  ||
                     id == "bool"  ||
                     id == "byte"  ||
@@ -255,7 +247,7 @@ struct Parser {
     }
     
     bool check_beginning_of_generic_specification() {
-        size_t reset_point = current;
+        size_t reset_point = tokens.save();
         bool is_beginning_of_generic_spec = true;
         
         if (!match(Token_Kind::Left_Angle)) {
@@ -266,14 +258,14 @@ struct Parser {
             is_beginning_of_generic_spec = false;
         }
         
-        current = reset_point;
+        tokens.restore(reset_point);
         return is_beginning_of_generic_spec;
     }
     
     bool check_identifier(const char *id, size_t n = 0) {
-        auto tok = tokens[current + n];
+        auto tok = peek(n);
         if (tok.kind != Token_Kind::Ident) return false;
-        return tok.data.s == id;
+        return tok.data.id == id;
     }
 
     bool check_labelled_loop() {
@@ -323,7 +315,7 @@ struct Parser {
         // Untyped_AST_Kind kind = Untyped_AST_Kind::Fn_Decl;
         bool is_method = false;
         
-        String id = expect(Token_Kind::Ident, "Expected identifier after 'fn' keyword").data.s.clone();
+        Symbol id = expect(Token_Kind::Ident, "Expected identifier after 'fn' keyword").data.id;
         
         if (match(Token_Kind::Left_Angle)) {
             todo("Generic functions not yet implemented.");
@@ -345,13 +337,13 @@ struct Parser {
             auto id_tok = expect(Token_Kind::Ident, "Expected identifier of parameter.");
             
             auto self_type = Mem.make<Value_Type>().as_ptr();
-            *self_type = value_types::unresolved("Self", id_tok.location);
+            *self_type = value_types::unresolved(Symbol::intern("Self"), id_tok.location);
             auto value_type = Mem.make<Value_Type>();
             *value_type = value_types::ptr_to(self_type);
             value_type->data.ptr.child_type->is_mut = is_mut;
             auto sig = Mem.make<Untyped_AST_Type_Signature>(value_type, id_tok.location);
             
-            auto target = Mem.make<Untyped_AST_Pattern_Ident>(false, id_tok.data.s.clone(), id_tok.location);
+            auto target = Mem.make<Untyped_AST_Pattern_Ident>(false, id_tok.data.id, id_tok.location);
             
             auto param = Mem.make<Untyped_AST_Binary>(
                 Untyped_AST_Kind::Binding,
@@ -376,7 +368,7 @@ struct Parser {
             
             bool is_mut = match(Token_Kind::Mut);
             auto id_tok = expect(Token_Kind::Ident, "Expected parameter name.");
-            auto target = Mem.make<Untyped_AST_Pattern_Ident>(is_mut, id_tok.data.s.clone(), id_tok.location);
+            auto target = Mem.make<Untyped_AST_Pattern_Ident>(is_mut, id_tok.data.id, id_tok.location);
             
             auto colon_tok = expect(Token_Kind::Colon, "Expected ':' before parameters type.");
             
@@ -420,7 +412,7 @@ struct Parser {
     }
     
     Ref<Untyped_AST> parse_struct_declaration(Token token) {
-        String id = expect(Token_Kind::Ident, "Expected identifier after 'struct' keyword.").data.s.clone();
+        Symbol id = expect(Token_Kind::Ident, "Expected identifier after 'struct' keyword.").data.id;
         auto decl = Mem.make<Untyped_AST_Struct_Declaration>(id, token.location);
         
         expect(Token_Kind::Left_Curly, "Expected '{' in struct declaration.");
@@ -429,7 +421,7 @@ struct Parser {
             if (check_terminating_delimeter()) break;
             
             bool force_mut = match(Token_Kind::Mut);
-            String field_id = expect(Token_Kind::Ident, "Expected identifier of field in struct declaration.").data.s.clone();
+            Symbol field_id = expect(Token_Kind::Ident, "Expected identifier of field in struct declaration.").data.id;
             expect(Token_Kind::Colon, "Expected ':' after field identifier.");
             
             auto type = parse_type_signature();
@@ -445,7 +437,7 @@ struct Parser {
     }
     
     Ref<Untyped_AST> parse_enum_declaration(Token token) {
-        String id = expect(Token_Kind::Ident, "Expected identifier after 'enum' keyword.").data.s.clone();
+        Symbol id = expect(Token_Kind::Ident, "Expected identifier after 'enum' keyword.").data.id;
         
         auto decl = Mem.make<Untyped_AST_Enum_Declaration>(id, token.location);
         
@@ -454,7 +446,7 @@ struct Parser {
         do {
             if (check_terminating_delimeter()) break;
             
-            String variant_id = expect(Token_Kind::Ident, "Expected name of enum variant.").data.s.clone();
+            Symbol variant_id = expect(Token_Kind::Ident, "Expected name of enum variant.").data.id;
             
             Ref<Untyped_AST_Multiary> payload = nullptr;
             if (match(Token_Kind::Left_Paren)) {
@@ -481,7 +473,7 @@ struct Parser {
     }
 
     Ref<Untyped_AST_Trait_Declaration> parse_trait_declaration(Token token) {
-        String id = expect(Token_Kind::Ident, "Expected identifier after 'trait' keyword.").data.s.clone();
+        Symbol id = expect(Token_Kind::Ident, "Expected identifier after 'trait' keyword.").data.id;
         auto body = parse_block();
 
         return Mem.make<Untyped_AST_Trait_Declaration>(id, body, token.location);
@@ -508,7 +500,7 @@ struct Parser {
         Ref<Untyped_AST_Ident> rename_id = nullptr;
         if (match(Token_Kind::As)) {
             if (match(Token_Kind::Star)) {
-                rename_id = Mem.make<Untyped_AST_Ident>(String {"*"}, previous_location());
+                rename_id = Mem.make<Untyped_AST_Ident>(Symbol::intern("*"), previous_location());
             } else {
                 auto expr = parse_expression();
                 verify(expr->kind == Untyped_AST_Kind::Ident, expr->location, "Expected identifier after 'as' keyword.");
@@ -616,7 +608,7 @@ struct Parser {
                 p = Mem.make<Untyped_AST_Pattern_Underscore>(n.location);
             } break;
             case Token_Kind::Ident: {
-                auto id_str = n.data.s.clone();
+                auto id_str = n.data.id;
                 
                 if (!(check(Token_Kind::Left_Curly) ||
                       check(Token_Kind::Left_Paren) ||
@@ -656,7 +648,7 @@ struct Parser {
                 }
             } break;
             case Token_Kind::Mut: {
-                auto id = expect(Token_Kind::Ident, "Expected identifier after 'mut' keyword.").data.s.clone();
+                auto id = expect(Token_Kind::Ident, "Expected identifier after 'mut' keyword.").data.id;
                 p = Mem.make<Untyped_AST_Pattern_Ident>(true, id, n.location);
             } break;
             case Token_Kind::Left_Paren: {
@@ -678,7 +670,7 @@ struct Parser {
                 //      we need it to parse the expression properly.
                 //      This is a hack and can probably be done better.
                 //
-                current--;
+                tokens.back_up();
                 
                 auto value = parse_expression();
                 p = Mem.make<Untyped_AST_Pattern_Value>(value, value->location);
@@ -696,14 +688,14 @@ struct Parser {
             lhs = prev;
         } else {
             auto id_tok = expect(Token_Kind::Ident, "Expected identifier to begin symbol.");
-            lhs = Mem.make<Untyped_AST_Ident>(id_tok.data.s.clone(), id_tok.location);
+            lhs = Mem.make<Untyped_AST_Ident>(id_tok.data.id, id_tok.location);
         }
         
         if (match(Token_Kind::Double_Colon)) {
             rhs = parse_symbol();
         } else if (check(Token_Kind::Ident)) {
             auto id_tok = expect(Token_Kind::Ident, "Expected identifier to begin symbol.");
-            rhs = Mem.make<Untyped_AST_Ident>(id_tok.data.s.clone(), id_tok.location);
+            rhs = Mem.make<Untyped_AST_Ident>(id_tok.data.id, id_tok.location);
         }
         
         Ref<Untyped_AST_Symbol> sym;
@@ -721,7 +713,7 @@ struct Parser {
         auto token = next();
         switch (token.kind) {
             case Token_Kind::Ident: {
-                auto id = token.data.s;
+                auto id = token.data.id;
                 if (id == "void") {
                     type->kind = Value_Type_Kind::Void;
                 } else if (id == "byte") {
@@ -737,7 +729,7 @@ struct Parser {
                 } else if (id == "str") {
                     type->kind = Value_Type_Kind::Str;
                 } else {
-                    auto ident = Mem.make<Untyped_AST_Ident>(id.clone(), token.location);
+                    auto ident = Mem.make<Untyped_AST_Ident>(id, token.location);
                     
                     Ref<Untyped_AST_Symbol> sym;
                     if (check(Token_Kind::Double_Colon)) {
@@ -806,7 +798,7 @@ struct Parser {
         Ref<Untyped_AST> else_ = nullptr;
         if (match(Token_Kind::Else)) {
             if (match(Token_Kind::If)) {
-                else_ = parse_if_statement(peek(-1)); // @WARNING: This relies on integer overflow
+                else_ = parse_if_statement(tokens.previous());
             } else {
                 else_ = parse_block();
             }
@@ -818,7 +810,7 @@ struct Parser {
     Ref<Untyped_AST_While> parse_while_statement(Token token, std::optional<Token> label_token) {
         Ref<Untyped_AST_Ident> label = nullptr;
         if (label_token.has_value()) {
-            auto label_str = label_token->data.s.clone();
+            auto label_str = label_token->data.id;
             label = Mem.make<Untyped_AST_Ident>(label_str, label_token->location);
         }
         auto cond = parse_expression();
@@ -829,7 +821,7 @@ struct Parser {
     Ref<Untyped_AST> parse_for_statement(Token token, std::optional<Token> label_token) {
         Ref<Untyped_AST_Ident> label = nullptr;
         if (label_token.has_value()) {
-            auto label_str = label_token->data.s.clone();
+            auto label_str = label_token->data.id;
             label = Mem.make<Untyped_AST_Ident>(label_str, label_token->location);
         }
 
@@ -840,10 +832,10 @@ struct Parser {
 
         auto target = parse_pattern();
         
-        String counter = "";
+        Symbol counter {};
         if (match(Token_Kind::Comma)) {
             auto counter_tok = expect(Token_Kind::Ident, "Expected identifier of counter variable of for-loop.");
-            counter = counter_tok.data.s.clone();
+            counter = counter_tok.data.id;
         }
         
         expect(Token_Kind::In, "Expected 'in' keyword in for-loop.");
@@ -900,10 +892,10 @@ struct Parser {
         bool is_break = token.kind == Token_Kind::Break;
         const char *control_str = is_break ? "break" : "continue";
 
-        auto label = String{};
+        auto label = Symbol{};
         if (match(Token_Kind::Left_Paren)) {
             auto label_tok = expect(Token_Kind::Ident, "Expected identifier in parenetheses of %s statement.", control_str);
-            label = label_tok.data.s.clone();
+            label = label_tok.data.id;
             expect(Token_Kind::Right_Paren, "Expected ')' after identifer in parentheses of %s statement.", control_str);
         }
 
@@ -961,7 +953,7 @@ struct Parser {
                 
             // literals
             case Token_Kind::Ident:
-                a = Mem.make<Untyped_AST_Ident>(token.data.s.clone(), token.location);
+                a = Mem.make<Untyped_AST_Ident>(token.data.id, token.location);
                 if (check_beginning_of_struct_literal()) {
                     a = parse_struct_literal(a);
                 } else if (check_beginning_of_generic_specification()) {
@@ -1203,7 +1195,7 @@ struct Parser {
             dot = Mem.make<Untyped_AST_Binary>(kind, lhs, rhs, location);
         } else {
             verify(check(Token_Kind::Ident), peek().location, "Expected an identifier after '.'.");
-            auto id_str = next().data.s.clone();
+            auto id_str = next().data.id;
             if (match(Token_Kind::Left_Paren)) {
                 dot = parse_dot_call_operator(lhs, id_str, location);
             } else {
@@ -1215,7 +1207,7 @@ struct Parser {
     
     Ref<Untyped_AST> parse_dot_call_operator(
         Ref<Untyped_AST> receiver,
-        String method_id,
+        Symbol method_id,
         Code_Location location)
     {
         auto args = parse_comma_separated_expressions(previous_location());
@@ -1297,7 +1289,7 @@ struct Parser {
     }
     
     Ref<Untyped_AST> parse_builtin(Code_Location location) {
-        auto id_str = expect(Token_Kind::Ident, "Expected identifier of builtin after '@'.").data.s.clone();
+        auto id_str = expect(Token_Kind::Ident, "Expected identifier of builtin after '@'.").data.id;
         
         Ref<Untyped_AST> parsed;
         if (id_str == "size_of") {
@@ -1371,7 +1363,7 @@ struct Parser {
     }
 };
 
-Ref<Untyped_AST_Multiary> parse(const std::vector<Token> &tokens) {
+Ref<Untyped_AST_Multiary> parse(Token_Stream &tokens) {
     auto p = Parser { tokens };
     auto nodes = Mem.make<Untyped_AST_Multiary>(Untyped_AST_Kind::Block, p.current_location());
     
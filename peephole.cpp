@@ -0,0 +1,268 @@
+//
+//  peephole.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "peephole.h"
+
+#include "bytecode.h"
+#include "dead_code.h"
+#include "definitions.h"
+
+static constexpr int Max_Jump_Chain = 16;
+
+static bool int_literal(const Instruction &inst, runtime::Int &out_value) {
+    switch (inst.op) {
+        case Opcode::Lit_0:
+            out_value = 0;
+            return true;
+        case Opcode::Lit_1:
+            out_value = 1;
+            return true;
+        case Opcode::Lit_Int:
+            out_value = static_cast<runtime::Int>(inst.value);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool is_unconditional_jump(Opcode op) {
+    return op == Opcode::Jump || op == Opcode::Loop;
+}
+
+// where a jump to `target` ends up once it's followed through any jumps it lands on
+static size_t thread_jump(const std::vector<Instruction> &code, size_t target) {
+    for (int i = 0; i < Max_Jump_Chain; i++) {
+        if (target >= code.size() || !is_unconditional_jump(code[target].op)) {
+            return target;
+        }
+        target = code[target].target;
+    }
+    // probably a loop of jumps, leave it be
+    return SIZE_MAX;
+}
+
+static Instruction make_instruction(Opcode op, Size size = 0, Address address = 0, uint64_t value = 0) {
+    Instruction inst;
+    inst.op = op;
+    inst.size = size;
+    inst.address = address;
+    inst.value = value;
+    return inst;
+}
+
+struct Peephole {
+    const std::vector<Instruction> &code;
+    std::vector<bool> is_target;
+    std::vector<Instruction> out;
+
+    Peephole(const std::vector<Instruction> &code) : code(code), is_target(code.size() + 1, false) {
+        for (auto &inst : code) {
+            if (is_jump(inst.op)) is_target[inst.target] = true;
+        }
+    }
+
+    // the `count` instructions from i can be treated as one unit, nothing jumps into the middle of them
+    bool run(size_t i, size_t count) const {
+        if (i + count > code.size()) return false;
+        for (size_t k = i + 1; k < i + count; k++) {
+            if (is_target[k]) return false;
+        }
+        return true;
+    }
+
+    //
+    // Matches the instructions starting at i against the patterns below, writes
+    // their replacement to `out` and returns how many instructions were
+    // replaced. Returns 0 if nothing matched.
+    //
+    size_t rewrite(size_t i) {
+        auto &inst = code[i];
+        runtime::Int imm;
+
+        // x += 1 => Int_Inc(&x)
+        if (run(i, 4) &&
+            (inst.op == Opcode::Push_Value || inst.op == Opcode::Push_Global_Value) &&
+            inst.size == sizeof(runtime::Int) &&
+            code[i + 1].op == Opcode::Int_Add_Imm &&
+            (code[i + 1].value == 1 || code[i + 1].value == static_cast<uint64_t>(-1)))
+        {
+            Opcode push_pointer = inst.op == Opcode::Push_Value ? Opcode::Push_Pointer : Opcode::Push_Global_Pointer;
+            auto &pointer = code[i + 2];
+            auto &move = code[i + 3];
+            if (pointer.op == push_pointer && pointer.address == inst.address &&
+                move.op == Opcode::Move && move.size == sizeof(runtime::Int))
+            {
+                out.push_back(make_instruction(push_pointer, 0, inst.address));
+                out.push_back(make_instruction(code[i + 1].value == 1 ? Opcode::Int_Inc : Opcode::Int_Dec));
+                return 4;
+            }
+        }
+
+        // x += n => Add_Local(&x, n) for locals
+        if (run(i, 4) &&
+            inst.op == Opcode::Push_Value && inst.size == sizeof(runtime::Int) &&
+            code[i + 1].op == Opcode::Int_Add_Imm &&
+            code[i + 2].op == Opcode::Push_Pointer && code[i + 2].address == inst.address &&
+            code[i + 3].op == Opcode::Move && code[i + 3].size == sizeof(runtime::Int))
+        {
+            out.push_back(make_instruction(Opcode::Add_Local, 0, inst.address, code[i + 1].value));
+            return 4;
+        }
+
+        if (inst.op == Opcode::Push_Pointer || inst.op == Opcode::Push_Global_Pointer) {
+            bool is_global = inst.op == Opcode::Push_Global_Pointer;
+            if (!is_global && run(i, 2) && code[i + 1].op == Opcode::Int_Inc) {
+                out.push_back(make_instruction(Opcode::Inc_Local, 0, inst.address));
+                return 2;
+            }
+            if (run(i, 2) && code[i + 1].op == Opcode::Load) {
+                out.push_back(make_instruction(is_global ? Opcode::Push_Global_Value : Opcode::Push_Value, code[i + 1].size, inst.address));
+                return 2;
+            }
+            if (run(i, 2) && code[i + 1].op == Opcode::Int_Add_Imm) {
+                int64_t address = inst.address + static_cast<runtime::Int>(code[i + 1].value);
+                if (address >= 0 && address <= UINT16_MAX) {
+                    out.push_back(make_instruction(inst.op, 0, static_cast<Address>(address)));
+                    return 2;
+                }
+            }
+        }
+
+        if (int_literal(inst, imm) && run(i, 2)) {
+            switch (code[i + 1].op) {
+                case Opcode::Int_Add:
+                    if (imm != 0) out.push_back(make_instruction(Opcode::Int_Add_Imm, 0, 0, imm));
+                    return 2;
+                case Opcode::Int_Sub:
+                    if (imm != 0) out.push_back(make_instruction(Opcode::Int_Add_Imm, 0, 0, -imm));
+                    return 2;
+                case Opcode::Int_Mul:
+                    if (imm != 1) out.push_back(make_instruction(Opcode::Int_Mul_Imm, 0, 0, imm));
+                    return 2;
+                default:
+                    break;
+            }
+        }
+
+        if (inst.op == Opcode::Lit_Int && (inst.value == 0 || inst.value == 1)) {
+            out.push_back(make_instruction(inst.value == 0 ? Opcode::Lit_0 : Opcode::Lit_1));
+            return 1;
+        }
+
+        // Load(pointer + offset)
+        if (inst.op == Opcode::Int_Add_Imm && run(i, 2) && code[i + 1].op == Opcode::Load &&
+            static_cast<runtime::Int>(inst.value) >= 0 && inst.value <= UINT16_MAX)
+        {
+            out.push_back(make_instruction(Opcode::Load_Field_Indirect, code[i + 1].size, static_cast<Address>(inst.value)));
+            return 2;
+        }
+
+        // Load(data + index * size)
+        if (inst.op == Opcode::Int_Mul_Imm && run(i, 3) &&
+            code[i + 1].op == Opcode::Int_Add &&
+            code[i + 2].op == Opcode::Load && code[i + 2].size == inst.value)
+        {
+            out.push_back(make_instruction(Opcode::Load_Indexed, code[i + 2].size));
+            return 3;
+        }
+
+        if ((inst.op == Opcode::Int_Less_Than || inst.op == Opcode::Int_Less_Equal) &&
+            run(i, 2) && code[i + 1].op == Opcode::Jump_False)
+        {
+            Instruction jump = code[i + 1];
+            jump.op = inst.op == Opcode::Int_Less_Than ? Opcode::Int_Lt_Jump_False : Opcode::Int_Le_Jump_False;
+            out.push_back(jump);
+            return 2;
+        }
+
+        if (inst.op == Opcode::Int_Add_Imm || inst.op == Opcode::Int_Mul_Imm) {
+            bool is_add = inst.op == Opcode::Int_Add_Imm;
+            if (run(i, 2) && code[i + 1].op == inst.op) {
+                auto a = static_cast<runtime::Int>(inst.value);
+                auto b = static_cast<runtime::Int>(code[i + 1].value);
+                out.push_back(make_instruction(inst.op, 0, 0, is_add ? a + b : a * b));
+                return 2;
+            }
+            if (inst.value == (is_add ? 0 : 1)) {
+                return 1;
+            }
+        }
+
+        // the second flush decides where the stack ends up
+        if (inst.op == Opcode::Flush && i + 1 < code.size() && code[i + 1].op == Opcode::Flush) {
+            return 1;
+        }
+
+        if (is_jump(inst.op)) {
+            size_t target = thread_jump(code, inst.target);
+            if (target == SIZE_MAX) return 0;
+
+            // conditional jumps can only go forwards
+            if (!is_unconditional_jump(inst.op) && target <= i) return 0;
+
+            if (is_unconditional_jump(inst.op) && target == i + 1) {
+                return 1;
+            }
+            if (target != inst.target) {
+                Instruction jump = inst;
+                jump.target = target;
+                out.push_back(jump);
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+};
+
+// returns false once there's nothing left to rewrite
+static bool peephole_pass(std::vector<Instruction> &code) {
+    Peephole p(code);
+
+    bool changed = false;
+    std::vector<size_t> new_indices(code.size() + 1);
+    size_t i = 0;
+    while (i < code.size()) {
+        size_t first = p.out.size();
+        size_t replaced = p.rewrite(i);
+        if (replaced == 0) {
+            p.out.push_back(code[i]);
+            replaced = 1;
+        } else {
+            changed = true;
+        }
+
+        // anything that jumped into a removed instruction now lands on whatever follows it
+        for (size_t k = i; k < i + replaced; k++) {
+            new_indices[k] = first;
+        }
+        i += replaced;
+    }
+    new_indices[code.size()] = p.out.size();
+
+    for (auto &inst : p.out) {
+        if (is_jump(inst.op)) inst.target = new_indices[inst.target];
+    }
+
+    code = std::move(p.out);
+    return changed;
+}
+
+Peephole_Stats peephole_optimize(Function_Definition *fn, int entry_depth, const Callees &callees) {
+    auto code = decode_instructions(fn->instructions);
+
+    Peephole_Stats stats;
+    stats.instructions_before = code.size();
+
+    // each pass can uncover work for the other
+    while (peephole_pass(code) || eliminate_dead_code(code, entry_depth, callees));
+
+    stats.instructions_after = code.size();
+    encode_instructions(code, fn->instructions);
+    return stats;
+}
@@ -0,0 +1,27 @@
+//
+//  peephole.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+#include <stddef.h>
+
+struct Function_Definition;
+struct Callees;
+
+struct Peephole_Stats {
+    size_t instructions_before;
+    size_t instructions_after;
+};
+
+//
+// Rewrites short runs of a function's stack code into cheaper equivalents,
+// e.g. Push_Pointer followed by Load becomes a single Push_Value and jumps to
+// jumps go straight to where the chain ends. Dead code is removed along the
+// way, see eliminate_dead_code(). Runs until nothing else changes.
+//
+Peephole_Stats peephole_optimize(Function_Definition *fn, int entry_depth, const Callees &callees);
@@ -1,3 +1,18 @@
+newoption {
+	trigger = "threaded-dispatch",
+	description = "Build the VM with threaded (computed goto) dispatch. Requires GCC or Clang."
+}
+
+newoption {
+	trigger = "count-dispatches",
+	description = "Report how many instructions the VM dispatched when a program finishes."
+}
+
+newoption {
+	trigger = "avx2",
+	description = "Let the tokenizer skip through source 32 bytes at a time with AVX2 rather than 16 with SSE2. Needs a CPU with AVX2."
+}
+
 workspace "Fox"
 	configurations { "Debug", "Release" }
 
@@ -14,6 +29,10 @@ project "Fox"
 
     includedirs { "utfcpp" }
 
+	-- imports are parsed on several threads
+	filter "system:linux"
+		links { "pthread" }
+
 	filter "configurations:Debug"
 		defines { "DEBUG" }
 		symbols "On"
@@ -21,3 +40,16 @@ project "Fox"
 	filter "configurations:Release"
 		defines { "NDEBUG" }
 		optimize "On"
+
+	filter "options:threaded-dispatch"
+		defines { "FOX_THREADED_DISPATCH" }
+
+	-- stops GCC from merging the per-opcode dispatch jumps back into one
+	filter { "options:threaded-dispatch", "toolset:gcc" }
+		buildoptions { "-fno-crossjumping" }
+
+	filter "options:count-dispatches"
+		defines { "FOX_COUNT_DISPATCHES" }
+
+	filter "options:avx2"
+		buildoptions { "-mavx2" }
@@ -0,0 +1,744 @@
+//
+//  registers.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "registers.h"
+
+#include "bytecode.h"
+#include "error.h"
+#include "interpreter.h"
+
+//
+// A value the stack code would have pushed that hasn't been written to its
+// slot yet. Most of them are consumed by the next instruction, which can then
+// read the source directly instead of a copy of it.
+//
+struct Pending_Value {
+    enum Kind : uint8_t {
+        Slot,
+        Global,
+        Slot_Address,
+        Global_Address,
+        Immediate,
+    } kind;
+    Address position;
+    Size size;
+    Address source;
+    uint64_t immediate;
+};
+
+// how many bytes a register instruction writes to its destination, 0 if it isn't one that has a destination
+static int register_result_size(const Instruction &inst) {
+    switch (inst.op) {
+        case Opcode::Reg_Move:
+        case Opcode::Reg_Move_Global:
+        case Opcode::Reg_Load:
+        case Opcode::Reg_Load_Indexed:
+        case Opcode::Reg_Set:
+            return inst.size;
+        case Opcode::Reg_Address:
+        case Opcode::Reg_Global_Address:
+            return sizeof(runtime::Pointer);
+        case Opcode::Reg_Int_Add:
+        case Opcode::Reg_Int_Sub:
+        case Opcode::Reg_Int_Mul:
+        case Opcode::Reg_Int_Div:
+        case Opcode::Reg_Int_Mod:
+        case Opcode::Reg_Int_Neg:
+        case Opcode::Reg_Int_Add_Imm:
+        case Opcode::Reg_Int_Mul_Imm:
+        case Opcode::Reg_Float_Add:
+        case Opcode::Reg_Float_Sub:
+        case Opcode::Reg_Float_Mul:
+        case Opcode::Reg_Float_Div:
+            return sizeof(runtime::Int);
+        case Opcode::Reg_Not:
+        case Opcode::Reg_Equal:
+        case Opcode::Reg_Not_Equal:
+        case Opcode::Reg_Int_Less_Than:
+        case Opcode::Reg_Int_Less_Equal:
+        case Opcode::Reg_Int_Greater_Than:
+        case Opcode::Reg_Int_Greater_Equal:
+        case Opcode::Reg_Int_Less_Than_Imm:
+        case Opcode::Reg_Int_Less_Equal_Imm:
+        case Opcode::Reg_Int_Greater_Than_Imm:
+        case Opcode::Reg_Int_Greater_Equal_Imm:
+        case Opcode::Reg_Int_Equal_Imm:
+        case Opcode::Reg_Int_Not_Equal_Imm:
+        case Opcode::Reg_Float_Less_Than:
+        case Opcode::Reg_Float_Less_Equal:
+        case Opcode::Reg_Float_Greater_Than:
+        case Opcode::Reg_Float_Greater_Equal:
+            return sizeof(runtime::Bool);
+        default:
+            return 0;
+    }
+}
+
+static bool overlaps(int a, int a_size, int b, int b_size) {
+    return a < b + b_size && b < a + a_size;
+}
+
+struct Register_Translator {
+    std::vector<Instruction> out;
+    std::vector<Pending_Value> pending;
+    int depth = 0;
+    int synced_depth = 0; // the depth the VM's stack top is actually at
+    int frame_size = 0;
+    size_t block_start = 0;
+
+    void emit(const Instruction &inst) {
+        out.push_back(inst);
+    }
+
+    void emit(Opcode op, Size size, Address address, Address a = 0, Address b = 0, uint64_t value = 0) {
+        Instruction inst;
+        inst.op = op;
+        inst.size = size;
+        inst.address = address;
+        inst.a = a;
+        inst.b = b;
+        inst.value = value;
+        out.push_back(inst);
+    }
+
+    void push(Pending_Value::Kind kind, Size size, Address source, uint64_t immediate = 0) {
+        pending.push_back({ kind, static_cast<Address>(depth), size, source, immediate });
+    }
+
+    void materialize(const Pending_Value &v) {
+        // when the stack top is already there a plain push does the same job
+        if (synced_depth == v.position) {
+            switch (v.kind) {
+                case Pending_Value::Slot:
+                    emit(Opcode::Push_Value, v.size, v.source);
+                    break;
+                case Pending_Value::Global:
+                    emit(Opcode::Push_Global_Value, v.size, v.source);
+                    break;
+                case Pending_Value::Slot_Address:
+                    emit(Opcode::Push_Pointer, 0, v.source);
+                    break;
+                case Pending_Value::Global_Address:
+                    emit(Opcode::Push_Global_Pointer, 0, v.source);
+                    break;
+                case Pending_Value::Immediate: {
+                    Opcode op = v.size == sizeof(runtime::Byte) ? Opcode::Lit_Byte :
+                                v.size == sizeof(runtime::Char) ? Opcode::Lit_Char :
+                                                                  Opcode::Lit_Int;
+                    emit(op, 0, 0, 0, 0, v.immediate);
+                } break;
+            }
+            synced_depth += v.size;
+            return;
+        }
+
+        write(v, v.position);
+    }
+
+    // writes a pending value to `dst` rather than where it was pushed
+    void write(const Pending_Value &v, Address dst) {
+        switch (v.kind) {
+            case Pending_Value::Slot:
+                if (v.source != dst) {
+                    emit(Opcode::Reg_Move, v.size, dst, v.source);
+                }
+                break;
+            case Pending_Value::Global:
+                emit(Opcode::Reg_Move_Global, v.size, dst, v.source);
+                break;
+            case Pending_Value::Slot_Address:
+                emit(Opcode::Reg_Address, 0, dst, v.source);
+                break;
+            case Pending_Value::Global_Address:
+                emit(Opcode::Reg_Global_Address, 0, dst, v.source);
+                break;
+            case Pending_Value::Immediate:
+                emit(Opcode::Reg_Set, v.size, dst, 0, 0, v.immediate);
+                break;
+        }
+    }
+
+    template<typename Predicate>
+    void materialize_where(Predicate predicate) {
+        size_t kept = 0;
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (predicate(pending[i])) {
+                materialize(pending[i]);
+            } else {
+                pending[kept++] = pending[i];
+            }
+        }
+        pending.resize(kept);
+    }
+
+    void flush_pending() {
+        materialize_where([](const Pending_Value &) { return true; });
+    }
+
+    // anything that hasn't been written yet but lives in [address, address + size)
+    void materialize_slots(int address, int size) {
+        materialize_where([=](const Pending_Value &v) {
+            return overlaps(v.position, v.size, address, size);
+        });
+    }
+
+    // must happen before [address, address + size) is written to
+    void clobber(int address, int size) {
+        materialize_where([=](const Pending_Value &v) {
+            bool reads_memory = v.kind == Pending_Value::Slot || v.kind == Pending_Value::Global;
+            return overlaps(v.position, v.size, address, size) ||
+                   (reads_memory && overlaps(v.source, v.size, address, size));
+        });
+    }
+
+    // values at or above `address` have been popped
+    void discard_from(int address) {
+        materialize_where([=](const Pending_Value &v) {
+            return v.position < address && v.position + v.size > address;
+        });
+        while (!pending.empty() && pending.back().position >= address) {
+            pending.pop_back();
+        }
+    }
+
+    // have the instruction that just produced the value at `position` write it to `dst` instead
+    bool retarget_last(int position, int size, Address dst) {
+        if (out.size() <= block_start) return false;
+        
+        auto &last = out.back();
+        if (last.address != position || register_result_size(last) != size) return false;
+        
+        last.address = dst;
+        return true;
+    }
+
+    void sync() {
+        flush_pending();
+        if (synced_depth != depth) {
+            emit(Opcode::Flush, 0, static_cast<Address>(depth));
+            synced_depth = depth;
+        }
+    }
+
+    Pending_Value *find_pending(int position, int size) {
+        if (pending.empty()) return nullptr;
+        auto &v = pending.back();
+        if (v.position != position || v.size != size) return nullptr;
+        return &v;
+    }
+
+    // the slot an operand can be read from once it's taken off the stack
+    Address take_slot(int position, int size) {
+        if (auto v = find_pending(position, size)) {
+            Pending_Value value = *v;
+            pending.pop_back();
+            if (value.kind == Pending_Value::Slot) {
+                return value.source;
+            }
+            materialize(value);
+        } else {
+            materialize_slots(position, size);
+        }
+        return static_cast<Address>(position);
+    }
+
+    bool take_immediate(int position, int size, uint64_t &out_immediate) {
+        auto v = find_pending(position, size);
+        if (!v || v->kind != Pending_Value::Immediate) return false;
+        out_immediate = v->immediate;
+        pending.pop_back();
+        return true;
+    }
+};
+
+// `size` is for instructions that take a size operand like Reg_Equal
+static void translate_binary(Register_Translator &t, Opcode op, Opcode imm_op, int arg_size, int ret_size, Size size = 0) {
+    int rhs_position = t.depth - arg_size;
+    int lhs_position = t.depth - 2 * arg_size;
+
+    uint64_t imm;
+    bool has_imm = imm_op != Opcode::None && t.take_immediate(rhs_position, arg_size, imm);
+    Address rhs = has_imm ? 0 : t.take_slot(rhs_position, arg_size);
+    Address lhs = t.take_slot(lhs_position, arg_size);
+    t.clobber(lhs_position, ret_size);
+
+    Address dst = static_cast<Address>(lhs_position);
+    if (has_imm) {
+        t.emit(imm_op, 0, dst, lhs, 0, imm);
+    } else {
+        t.emit(op, size, dst, lhs, rhs);
+    }
+}
+
+static void translate_unary(Register_Translator &t, Opcode op, int size) {
+    int position = t.depth - size;
+    Address src = t.take_slot(position, size);
+    t.clobber(position, size);
+    t.emit(op, 0, static_cast<Address>(position), src);
+}
+
+static void translate_immediate(Register_Translator &t, Opcode op, uint64_t imm) {
+    int position = t.depth - sizeof(runtime::Int);
+    Address src = t.take_slot(position, sizeof(runtime::Int));
+    t.clobber(position, sizeof(runtime::Int));
+    t.emit(op, 0, static_cast<Address>(position), src, 0, imm);
+}
+
+// an address plus a constant offset is just another address
+static bool offset_address(Pending_Value &base, runtime::Int offset) {
+    if (base.kind != Pending_Value::Slot_Address && base.kind != Pending_Value::Global_Address) return false;
+
+    int64_t address = base.source + offset;
+    if (address < 0 || address > UINT16_MAX) return false;
+
+    base.source = static_cast<Address>(address);
+    return true;
+}
+
+static bool fold_address_offset(Register_Translator &t) {
+    constexpr int Word_Size = sizeof(runtime::Int);
+    if (t.pending.size() < 2) return false;
+
+    auto &base = t.pending[t.pending.size() - 2];
+    auto &offset = t.pending.back();
+    if (base.position != t.depth - 2 * Word_Size || offset.position != t.depth - Word_Size) return false;
+    if (offset.kind != Pending_Value::Immediate) return false;
+    if (!offset_address(base, static_cast<runtime::Int>(offset.immediate))) return false;
+
+    t.pending.pop_back();
+    return true;
+}
+
+static void translate_load(Register_Translator &t, Size size, Address offset) {
+    constexpr int Pointer_Size = sizeof(runtime::Pointer);
+    
+    int position = t.depth - Pointer_Size;
+    auto pointer = t.find_pending(position, Pointer_Size);
+    if (pointer && offset_address(*pointer, offset)) {
+        auto kind = pointer->kind == Pending_Value::Slot_Address ? Pending_Value::Slot : Pending_Value::Global;
+        Address source = pointer->source;
+        t.pending.pop_back();
+        t.materialize_slots(source, size);
+        t.pending.push_back({ kind, static_cast<Address>(position), size, source, 0 });
+        return;
+    }
+    
+    Address src = t.take_slot(position, Pointer_Size);
+    if (offset != 0) {
+        t.clobber(position, Pointer_Size);
+        t.emit(Opcode::Reg_Int_Add_Imm, 0, static_cast<Address>(position), src, 0, offset);
+        src = static_cast<Address>(position);
+    }
+    // the pointer could point at anything so nothing can be left pending
+    t.flush_pending();
+    t.emit(Opcode::Reg_Load, size, static_cast<Address>(position), src);
+}
+
+// `reg_jump` is Reg_Jump_True or Reg_Jump_False, the condition is on top of the stack
+static void translate_conditional_jump(Register_Translator &t, const Instruction &inst, Opcode reg_jump, const std::vector<int> &depths) {
+    constexpr int Bool_Size = sizeof(runtime::Bool);
+    
+    Address cond = t.take_slot(t.depth - Bool_Size, Bool_Size);
+    t.flush_pending();
+    t.depth -= Bool_Size;
+    if (depths[inst.target] == Unknown_Depth) t.sync();
+    
+    Instruction jump = inst;
+    jump.op = reg_jump;
+    jump.address = cond;
+    t.emit(jump);
+}
+
+// `after` is the depth once the instruction has run
+static void translate_instruction(Register_Translator &t, const std::vector<Instruction> &code, size_t i, const std::vector<int> &depths, int after) {
+    constexpr int Bool_Size = sizeof(runtime::Bool);
+    constexpr int Word_Size = sizeof(runtime::Int);
+    constexpr int Pointer_Size = sizeof(runtime::Pointer);
+
+    auto &inst = code[i];
+    switch (inst.op) {
+        case Opcode::Lit_True:
+        case Opcode::Lit_1b:
+            t.push(Pending_Value::Immediate, sizeof(runtime::Byte), 0, 1);
+            break;
+        case Opcode::Lit_False:
+        case Opcode::Lit_0b:
+            t.push(Pending_Value::Immediate, sizeof(runtime::Byte), 0, 0);
+            break;
+        case Opcode::Lit_0:
+            t.push(Pending_Value::Immediate, Word_Size, 0, 0);
+            break;
+        case Opcode::Lit_1:
+            t.push(Pending_Value::Immediate, Word_Size, 0, 1);
+            break;
+        case Opcode::Lit_Char:
+            t.push(Pending_Value::Immediate, sizeof(runtime::Char), 0, inst.value);
+            break;
+        case Opcode::Lit_Byte:
+            t.push(Pending_Value::Immediate, sizeof(runtime::Byte), 0, inst.value);
+            break;
+        case Opcode::Lit_Int:
+        case Opcode::Lit_Float:
+        case Opcode::Lit_Pointer:
+            t.push(Pending_Value::Immediate, Word_Size, 0, inst.value);
+            break;
+
+        case Opcode::Push_Value:
+            t.materialize_slots(inst.address, inst.size);
+            t.push(Pending_Value::Slot, inst.size, inst.address);
+            break;
+        case Opcode::Push_Global_Value:
+            t.materialize_slots(inst.address, inst.size);
+            t.push(Pending_Value::Global, inst.size, inst.address);
+            break;
+        case Opcode::Push_Pointer:
+            // anything from here up might be read through the pointer
+            t.materialize_slots(inst.address, Stack::Size);
+            t.push(Pending_Value::Slot_Address, Pointer_Size, inst.address);
+            break;
+        case Opcode::Push_Global_Pointer:
+            t.materialize_slots(inst.address, Stack::Size);
+            t.push(Pending_Value::Global_Address, Pointer_Size, inst.address);
+            break;
+
+        case Opcode::Load:
+            translate_load(t, inst.size, 0);
+            break;
+        case Opcode::Load_Field_Indirect:
+            translate_load(t, inst.size, inst.address);
+            break;
+        case Opcode::Load_Indexed: {
+            int index_position = t.depth - Word_Size;
+            int pointer_position = index_position - Pointer_Size;
+            Address index = t.take_slot(index_position, Word_Size);
+            Address pointer = t.take_slot(pointer_position, Pointer_Size);
+            t.flush_pending();
+            t.emit(Opcode::Reg_Load_Indexed, inst.size, static_cast<Address>(pointer_position), pointer, index);
+        } break;
+        case Opcode::Copy: {
+            int dest_position = t.depth - Pointer_Size;
+            int src_position = dest_position - Pointer_Size;
+            auto dest = t.find_pending(dest_position, Pointer_Size);
+            if (!dest || dest->kind != Pending_Value::Slot_Address) {
+                t.sync();
+                t.emit(inst);
+                t.synced_depth = after;
+                break;
+            }
+            
+            Address dst = dest->source;
+            t.pending.pop_back();
+            t.clobber(dst, inst.size);
+            
+            auto src = t.find_pending(src_position, Pointer_Size);
+            if (src && src->kind == Pending_Value::Slot_Address) {
+                Address source = src->source;
+                t.pending.pop_back();
+                t.materialize_slots(source, inst.size);
+                if (source != dst) {
+                    t.emit(Opcode::Reg_Move, inst.size, dst, source);
+                }
+            } else {
+                Address pointer = t.take_slot(src_position, Pointer_Size);
+                t.flush_pending();
+                t.emit(Opcode::Reg_Load, inst.size, dst, pointer);
+            }
+        } break;
+        case Opcode::Move: {
+            int pointer_position = t.depth - Pointer_Size;
+            int value_position = pointer_position - inst.size;
+            auto pointer = t.find_pending(pointer_position, Pointer_Size);
+            if (pointer && pointer->kind == Pending_Value::Slot_Address) {
+                Address dst = pointer->source;
+                t.pending.pop_back();
+                t.clobber(dst, inst.size);
+
+                if (auto v = t.find_pending(value_position, inst.size)) {
+                    Pending_Value value = *v;
+                    t.pending.pop_back();
+                    t.write(value, dst);
+                } else {
+                    t.materialize_slots(value_position, inst.size);
+                    if (!t.retarget_last(value_position, inst.size, dst)) {
+                        t.emit(Opcode::Reg_Move, inst.size, dst, static_cast<Address>(value_position));
+                    }
+                }
+            } else {
+                // writing through an arbitrary pointer could change any pending value
+                Address pointer_slot = t.take_slot(pointer_position, Pointer_Size);
+                Address src = t.take_slot(value_position, inst.size);
+                t.flush_pending();
+                t.emit(Opcode::Reg_Store, inst.size, pointer_slot, src);
+            }
+        } break;
+
+        case Opcode::Int_Add:
+            if (!fold_address_offset(t)) {
+                translate_binary(t, Opcode::Reg_Int_Add, Opcode::Reg_Int_Add_Imm, Word_Size, Word_Size);
+            }
+            break;
+        case Opcode::Int_Sub: {
+            uint64_t imm;
+            if (t.take_immediate(t.depth - Word_Size, Word_Size, imm)) {
+                // x - imm => x + -imm
+                int position = t.depth - 2 * Word_Size;
+                Address lhs = t.take_slot(position, Word_Size);
+                t.clobber(position, Word_Size);
+                auto negated = static_cast<uint64_t>(-static_cast<runtime::Int>(imm));
+                t.emit(Opcode::Reg_Int_Add_Imm, 0, static_cast<Address>(position), lhs, 0, negated);
+            } else {
+                translate_binary(t, Opcode::Reg_Int_Sub, Opcode::None, Word_Size, Word_Size);
+            }
+        } break;
+        case Opcode::Int_Mul:
+            translate_binary(t, Opcode::Reg_Int_Mul, Opcode::None, Word_Size, Word_Size);
+            break;
+        case Opcode::Int_Add_Imm: {
+            auto base = t.find_pending(t.depth - Pointer_Size, Pointer_Size);
+            if (!base || !offset_address(*base, static_cast<runtime::Int>(inst.value))) {
+                translate_immediate(t, Opcode::Reg_Int_Add_Imm, inst.value);
+            }
+        } break;
+        case Opcode::Int_Mul_Imm:
+            translate_immediate(t, Opcode::Reg_Int_Mul_Imm, inst.value);
+            break;
+        case Opcode::Int_Div:
+            translate_binary(t, Opcode::Reg_Int_Div, Opcode::None, Word_Size, Word_Size);
+            break;
+        case Opcode::Int_Mod:
+            translate_binary(t, Opcode::Reg_Int_Mod, Opcode::None, Word_Size, Word_Size);
+            break;
+        case Opcode::Int_Neg:
+            translate_unary(t, Opcode::Reg_Int_Neg, Word_Size);
+            break;
+        case Opcode::Float_Add:
+            translate_binary(t, Opcode::Reg_Float_Add, Opcode::None, Word_Size, Word_Size);
+            break;
+        case Opcode::Float_Sub:
+            translate_binary(t, Opcode::Reg_Float_Sub, Opcode::None, Word_Size, Word_Size);
+            break;
+        case Opcode::Float_Mul:
+            translate_binary(t, Opcode::Reg_Float_Mul, Opcode::None, Word_Size, Word_Size);
+            break;
+        case Opcode::Float_Div:
+            translate_binary(t, Opcode::Reg_Float_Div, Opcode::None, Word_Size, Word_Size);
+            break;
+        case Opcode::Not:
+            translate_unary(t, Opcode::Reg_Not, Bool_Size);
+            break;
+
+        case Opcode::Int_Less_Than:
+            translate_binary(t, Opcode::Reg_Int_Less_Than, Opcode::Reg_Int_Less_Than_Imm, Word_Size, Bool_Size);
+            break;
+        case Opcode::Int_Less_Equal:
+            translate_binary(t, Opcode::Reg_Int_Less_Equal, Opcode::Reg_Int_Less_Equal_Imm, Word_Size, Bool_Size);
+            break;
+        case Opcode::Int_Greater_Than:
+            translate_binary(t, Opcode::Reg_Int_Greater_Than, Opcode::Reg_Int_Greater_Than_Imm, Word_Size, Bool_Size);
+            break;
+        case Opcode::Int_Greater_Equal:
+            translate_binary(t, Opcode::Reg_Int_Greater_Equal, Opcode::Reg_Int_Greater_Equal_Imm, Word_Size, Bool_Size);
+            break;
+        case Opcode::Float_Less_Than:
+            translate_binary(t, Opcode::Reg_Float_Less_Than, Opcode::None, Word_Size, Bool_Size);
+            break;
+        case Opcode::Float_Less_Equal:
+            translate_binary(t, Opcode::Reg_Float_Less_Equal, Opcode::None, Word_Size, Bool_Size);
+            break;
+        case Opcode::Float_Greater_Than:
+            translate_binary(t, Opcode::Reg_Float_Greater_Than, Opcode::None, Word_Size, Bool_Size);
+            break;
+        case Opcode::Float_Greater_Equal:
+            translate_binary(t, Opcode::Reg_Float_Greater_Equal, Opcode::None, Word_Size, Bool_Size);
+            break;
+
+        case Opcode::Equal:
+        case Opcode::Not_Equal: {
+            if (inst.size == Word_Size) {
+                bool is_equal = inst.op == Opcode::Equal;
+                translate_binary(
+                    t,
+                    is_equal ? Opcode::Reg_Equal : Opcode::Reg_Not_Equal,
+                    is_equal ? Opcode::Reg_Int_Equal_Imm : Opcode::Reg_Int_Not_Equal_Imm,
+                    Word_Size,
+                    Bool_Size,
+                    Word_Size
+                );
+                break;
+            }
+            
+            int rhs_position = t.depth - inst.size;
+            int lhs_position = t.depth - 2 * inst.size;
+            Address rhs = t.take_slot(rhs_position, inst.size);
+            Address lhs = t.take_slot(lhs_position, inst.size);
+            t.clobber(lhs_position, Bool_Size);
+            Opcode op = inst.op == Opcode::Equal ? Opcode::Reg_Equal : Opcode::Reg_Not_Equal;
+            t.emit(op, inst.size, static_cast<Address>(lhs_position), lhs, rhs);
+        } break;
+
+        case Opcode::Int_Inc:
+        case Opcode::Int_Dec: {
+            auto pointer = t.find_pending(t.depth - Pointer_Size, Pointer_Size);
+            if (pointer && pointer->kind == Pending_Value::Slot_Address) {
+                Address slot = pointer->source;
+                t.pending.pop_back();
+                t.clobber(slot, Word_Size);
+                t.emit(inst.op == Opcode::Int_Inc ? Opcode::Reg_Int_Inc : Opcode::Reg_Int_Dec, 0, slot);
+            } else {
+                t.sync();
+                t.emit(inst);
+                t.synced_depth = after;
+            }
+        } break;
+        case Opcode::Inc_Local:
+        case Opcode::Add_Local:
+            // already addresses its operand directly
+            t.clobber(inst.address, Word_Size);
+            t.emit(inst);
+            break;
+
+        case Opcode::Jump_True:
+            translate_conditional_jump(t, inst, Opcode::Reg_Jump_True, depths);
+            break;
+        case Opcode::Jump_False:
+            translate_conditional_jump(t, inst, Opcode::Reg_Jump_False, depths);
+            break;
+        case Opcode::Int_Lt_Jump_False:
+        case Opcode::Int_Le_Jump_False: {
+            bool is_less = inst.op == Opcode::Int_Lt_Jump_False;
+            translate_binary(
+                t,
+                is_less ? Opcode::Reg_Int_Less_Than : Opcode::Reg_Int_Less_Equal,
+                is_less ? Opcode::Reg_Int_Less_Than_Imm : Opcode::Reg_Int_Less_Equal_Imm,
+                Word_Size,
+                Bool_Size
+            );
+            t.depth -= 2 * Word_Size - Bool_Size;
+            translate_conditional_jump(t, inst, Opcode::Reg_Jump_False, depths);
+        } break;
+        case Opcode::Jump_True_No_Pop:
+        case Opcode::Jump_False_No_Pop: {
+            t.flush_pending();
+            if (depths[inst.target] == Unknown_Depth) t.sync();
+
+            Instruction jump = inst;
+            jump.op = inst.op == Opcode::Jump_True_No_Pop ? Opcode::Reg_Jump_True : Opcode::Reg_Jump_False;
+            jump.address = static_cast<Address>(t.depth - Bool_Size);
+            t.emit(jump);
+        } break;
+        case Opcode::Jump:
+        case Opcode::Loop:
+            t.flush_pending();
+            if (depths[inst.target] == Unknown_Depth) t.sync();
+            t.emit(inst);
+            break;
+
+        case Opcode::Pop:
+            t.discard_from(t.depth - inst.size);
+            break;
+        case Opcode::Flush:
+            t.discard_from(inst.address);
+            break;
+        case Opcode::Flush_Value: {
+            int position = t.depth - inst.size;
+            if (position == inst.address) {
+                t.discard_from(position + inst.size);
+                break;
+            }
+
+            // everything between the value and where it's going is dead
+            if (auto v = t.find_pending(position, inst.size)) {
+                Pending_Value value = *v;
+                t.pending.pop_back();
+                t.discard_from(inst.address);
+                t.clobber(inst.address, inst.size);
+                t.write(value, inst.address);
+            } else {
+                t.materialize_slots(position, inst.size);
+                t.discard_from(inst.address);
+                t.clobber(inst.address, inst.size);
+                if (!t.retarget_last(position, inst.size, inst.address)) {
+                    t.emit(Opcode::Reg_Move, inst.size, inst.address, static_cast<Address>(position));
+                }
+            }
+        } break;
+        case Opcode::Allocate:
+            // the slots are uninitialized so there's nothing to write
+            break;
+
+        default:
+            t.sync();
+            t.emit(inst);
+            t.synced_depth = after;
+            break;
+    }
+}
+
+static void translate_function(Function_Definition *fn, int entry_depth, const Callees &callees) {
+    auto code = decode_instructions(fn->instructions);
+
+    auto depths = stack_depths(code, entry_depth, callees);
+
+    std::vector<bool> is_target(code.size() + 1, false);
+    for (auto &inst : code) {
+        if (is_jump(inst.op)) is_target[inst.target] = true;
+    }
+
+    Register_Translator t;
+    t.depth = entry_depth;
+    t.synced_depth = entry_depth;
+
+    std::vector<size_t> new_indices(code.size() + 1);
+    for (size_t i = 0; i < code.size(); i++) {
+        int depth = depths[i];
+
+        if (is_target[i]) {
+            // values can't be left pending across the edge into a block
+            if (i > 0 && falls_through(code[i - 1].op) && t.depth != Unknown_Depth) {
+                t.flush_pending();
+                if (depth == Unknown_Depth) t.sync();
+            }
+            t.synced_depth = Unknown_Depth;
+            t.block_start = t.out.size();
+        }
+
+        new_indices[i] = t.out.size();
+        t.depth = depth;
+
+        int after = depth_after(code, i, depth, callees);
+        if (depth == Unknown_Depth) {
+            t.emit(code[i]);
+            t.synced_depth = after;
+        } else {
+            translate_instruction(t, code, i, depths, after);
+        }
+
+        t.depth = after;
+        t.frame_size = std::max(t.frame_size, std::max(depth, after));
+    }
+    new_indices[code.size()] = t.out.size();
+
+    for (auto &inst : t.out) {
+        if (is_jump(inst.op)) inst.target = new_indices[inst.target];
+    }
+
+    encode_instructions(t.out, fn->instructions);
+    fn->frame_size = static_cast<Size>(t.frame_size);
+}
+
+void translate_to_registers(Interpreter *interp, Module *module) {
+    Callees callees(interp);
+
+    if (!module->top_level.optimized) {
+        translate_function(&module->top_level, 0, callees);
+    }
+    for (auto &[_, fn] : interp->functions.funcs) {
+        if (fn.optimized) continue;
+        translate_function(&fn, fn.type.data.func.arg_size(), callees);
+    }
+}
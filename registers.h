@@ -0,0 +1,21 @@
+//
+//  registers.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+struct Interpreter;
+struct Module;
+
+//
+// Rewrites the stack code of a module's top level and of every function into
+// register code. Values stay where the stack code would have put them, but
+// wherever the depth of the stack is known statically the pushes and pops are
+// replaced by instructions that name their operands' frame slots directly.
+// Anything that isn't translated keeps running as stack code.
+//
+void translate_to_registers(Interpreter *interp, Module *module);
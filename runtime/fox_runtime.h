@@ -0,0 +1,201 @@
+//
+//  fox_runtime.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+//
+// The runtime C files written by `fox --emit-c` are compiled against. It holds
+// the same stack the VM runs on and the builtins, written in C so nothing from
+// the compiler has to be linked in. Compile the output with:
+//     cc -O2 -I path/to/fox/runtime out.c -o out
+//
+
+#ifndef FOX_RUNTIME_H
+#define FOX_RUNTIME_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FOX_STACK_SIZE 65535
+
+// the same default as the VM, one call per byte of the stack
+#ifndef FOX_MAX_CALL_DEPTH
+#define FOX_MAX_CALL_DEPTH FOX_STACK_SIZE
+#endif
+
+typedef void (*Fox_Function)(uint16_t arg_size);
+
+// What <puts-struct> and <puts-enum> get instead of a Struct_Definition or Enum_Definition.
+typedef struct {
+    uint16_t size;
+    void (*print)(const uint8_t *value);
+} Fox_Type;
+
+typedef struct {
+    char *s;
+    int64_t len;
+} Fox_String;
+
+static uint8_t fox_stack[FOX_STACK_SIZE];
+static uint8_t *fox_sp = fox_stack;
+static size_t fox_depth = 0;
+
+static inline void fox_error(const char *err) {
+    fprintf(stderr, "<NO-LOC>:1:1: Error: %s\n", err);
+    exit(EXIT_FAILURE);
+}
+
+static inline void fox_check_stack(const uint8_t *top) {
+    if (top > fox_stack + FOX_STACK_SIZE) fox_error("Stack overflow. Ran out of stack memory.");
+}
+
+static inline void fox_enter(void) {
+    if (++fox_depth > FOX_MAX_CALL_DEPTH) {
+        fprintf(stderr, "<NO-LOC>:1:1: Error: Stack overflow at a call depth of %d. Exceeded the maximum call depth.\n", FOX_MAX_CALL_DEPTH);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static inline void fox_check_zero(int zero, const char *op) {
+    if (zero) {
+        fprintf(stderr, "<NO-LOC>:1:1: Error: Second operand detected as zero which is disallowed for operator %s.\n", op);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Every value lives on the byte stack so it's read and written through memcpy() like the VM does.
+#define FOX_ACCESSORS(name, type) \
+    static inline type fox_##name(const uint8_t *p) { type v; memcpy(&v, p, sizeof(type)); return v; } \
+    static inline void fox_set_##name(uint8_t *p, type v) { memcpy(p, &v, sizeof(type)); }
+
+FOX_ACCESSORS(bool, uint8_t)
+FOX_ACCESSORS(byte, uint8_t)
+FOX_ACCESSORS(char, uint32_t)
+FOX_ACCESSORS(int, int64_t)
+FOX_ACCESSORS(float, double)
+FOX_ACCESSORS(ptr, void *)
+FOX_ACCESSORS(addr, uint8_t *)
+FOX_ACCESSORS(str, Fox_String)
+
+#undef FOX_ACCESSORS
+
+// str_constants holds each string's length followed by its bytes
+static inline Fox_String fox_str_constant(uint8_t *constant) {
+    size_t len;
+    memcpy(&len, constant, sizeof(size_t));
+    Fox_String s = { (char *)constant + sizeof(size_t), (int64_t)len };
+    return s;
+}
+
+// Ints wrap on overflow like they do in the VM.
+static inline int64_t fox_add(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+static inline int64_t fox_sub(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+static inline int64_t fox_mul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+static inline int64_t fox_neg(int64_t a) { return (int64_t)(0 - (uint64_t)a); }
+static inline int64_t fox_shl(int64_t a, int64_t b) { return (int64_t)((uint64_t)a << b); }
+
+static inline int fox_str_equal(Fox_String a, Fox_String b) {
+    return a.len == b.len && memcmp(a.s, b.s, (size_t)a.len) == 0;
+}
+
+static inline int fox_str_not_equal(Fox_String a, Fox_String b) {
+    return a.len == b.len && memcmp(a.s, b.s, (size_t)a.len) != 0;
+}
+
+// Builtins
+static inline void fox_print_byte(const uint8_t *p) { printf("%d", fox_byte(p)); }
+static inline void fox_print_bool(const uint8_t *p) { printf("%s", fox_bool(p) ? "true" : "false"); }
+static inline void fox_print_int(const uint8_t *p) { printf("%lld", (long long)fox_int(p)); }
+static inline void fox_print_float(const uint8_t *p) { printf("%f", fox_float(p)); }
+
+static inline void fox_print_str(const uint8_t *p) {
+    Fox_String s = fox_str(p);
+    printf("%.*s", (int)s.len, s.s);
+}
+
+static inline void fox_print_char(const uint8_t *p) {
+    uint32_t c = fox_char(p);
+    char buf[5] = { 0 };
+    if (c < 0x80) {
+        buf[0] = (char)c;
+    } else if (c < 0x800) {
+        buf[0] = (char)(0xC0 | (c >> 6));
+        buf[1] = (char)(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+        buf[0] = (char)(0xE0 | (c >> 12));
+        buf[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        buf[2] = (char)(0x80 | (c & 0x3F));
+    } else {
+        buf[0] = (char)(0xF0 | (c >> 18));
+        buf[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+        buf[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+        buf[3] = (char)(0x80 | (c & 0x3F));
+    }
+    printf("%s", buf);
+}
+
+static inline uint8_t *fox_builtin_alloc(uint8_t *sp) {
+    int64_t size = fox_int(sp - 8);
+    fox_set_ptr(sp - 8, malloc((size_t)size));
+    return sp;
+}
+
+static inline uint8_t *fox_builtin_free_ptr(uint8_t *sp) {
+    free(fox_ptr(sp - 8));
+    return sp - 8;
+}
+
+static inline uint8_t *fox_builtin_free_slice(uint8_t *sp) {
+    free(fox_ptr(sp - 16));
+    return sp - 16;
+}
+
+static inline uint8_t *fox_builtin_free_str(uint8_t *sp) {
+    free(fox_str(sp - sizeof(Fox_String)).s);
+    return sp - sizeof(Fox_String);
+}
+
+static inline uint8_t *fox_builtin_panic(uint8_t *sp) {
+    Fox_String err = fox_str(sp - sizeof(Fox_String));
+    printf("Panic! %.*s\n", (int)err.len, err.s);
+    exit(EXIT_FAILURE);
+    return sp;
+}
+
+#define FOX_PUTS(name, size) \
+    static inline uint8_t *fox_builtin_puts_##name(uint8_t *sp) { fox_print_##name(sp - (size)); return sp - (size); } \
+    static inline uint8_t *fox_builtin_print_##name(uint8_t *sp) { sp = fox_builtin_puts_##name(sp); printf("\n"); return sp; }
+
+FOX_PUTS(byte, 1)
+FOX_PUTS(bool, 1)
+FOX_PUTS(char, 4)
+FOX_PUTS(int, 8)
+FOX_PUTS(float, 8)
+FOX_PUTS(str, sizeof(Fox_String))
+
+#undef FOX_PUTS
+
+static inline uint8_t *fox_builtin_puts_type(uint8_t *sp) {
+    const Fox_Type *type = (const Fox_Type *)fox_ptr(sp - 8);
+    sp -= 8 + type->size;
+    type->print(sp);
+    return sp;
+}
+
+static inline uint8_t *fox_builtin_print_type(uint8_t *sp) {
+    sp = fox_builtin_puts_type(sp);
+    printf("\n");
+    return sp;
+}
+
+#define fox_builtin_puts_struct fox_builtin_puts_type
+#define fox_builtin_puts_enum fox_builtin_puts_type
+#define fox_builtin_print_struct fox_builtin_print_type
+#define fox_builtin_print_enum fox_builtin_print_type
+
+#endif // FOX_RUNTIME_H
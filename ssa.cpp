@@ -0,0 +1,392 @@
+//
+//  ssa.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "ssa.h"
+
+#include <map>
+
+#include "error.h"
+
+SSA_Value_Id SSA_Function::add(SSA_Value value) {
+    values.push_back(std::move(value));
+    return static_cast<SSA_Value_Id>(values.size() - 1);
+}
+
+SSA_Value_Id SSA_Function::resolve(SSA_Value_Id id) const {
+    while (id != SSA_No_Value && values[id].replaced_by != SSA_No_Value) {
+        id = values[id].replaced_by;
+    }
+    return id;
+}
+
+std::vector<SSA_Block_Id> SSA_Function::reverse_postorder() const {
+    std::vector<SSA_Block_Id> order;
+    std::vector<bool> visited(blocks.size(), false);
+
+    // (block, successors visited so far)
+    std::vector<std::pair<SSA_Block_Id, int>> stack;
+    stack.push_back({ 0, 0 });
+    visited[0] = true;
+    while (!stack.empty()) {
+        auto &[b, next] = stack.back();
+        auto &block = blocks[b];
+        int succ_count = block.exit == SSA_Block::Exit::Jump ? 1 : block.exit == SSA_Block::Exit::Branch ? 2 : 0;
+        if (next < succ_count) {
+            // the last successor is visited first so the first ends up right after the block
+            SSA_Block_Id succ = block.succs[succ_count - 1 - next++];
+            if (!visited[succ]) {
+                visited[succ] = true;
+                stack.push_back({ succ, 0 });
+            }
+        } else {
+            order.push_back(b);
+            stack.pop_back();
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+bool has_side_effects(const SSA_Value &value) {
+    switch (value.op) {
+        case SSA_Op::Store_Global:
+        case SSA_Op::Call:
+        case SSA_Op::Call_Builtin:
+            return true;
+        case SSA_Op::Binary:
+            return value.kind == Typed_AST_Kind::Division || value.kind == Typed_AST_Kind::Mod;
+        default:
+            return false;
+    }
+}
+
+// values that give the same result whenever their operands are the same
+static bool is_redundant_if_repeated(const SSA_Value &value) {
+    switch (value.op) {
+        case SSA_Op::Const:
+        case SSA_Op::Unary:
+        case SSA_Op::Binary:
+        case SSA_Op::Cast:
+            return true;
+        default:
+            return false;
+    }
+}
+
+struct SSA_Optimizer {
+    SSA_Function &fn;
+    SSA_Stats stats;
+
+    SSA_Optimizer(SSA_Function &fn) : fn(fn) {}
+
+    void replace(SSA_Value_Id id, SSA_Value_Id replacement) {
+        fn.values[id].removed = true;
+        fn.values[id].replaced_by = replacement;
+    }
+
+    // points every use at what it was replaced by and forgets removed values
+    void compact() {
+        for (auto &value : fn.values) {
+            for (auto &arg : value.args) arg = fn.resolve(arg);
+        }
+        for (auto &block : fn.blocks) {
+            block.value = fn.resolve(block.value);
+            auto is_removed = [&](SSA_Value_Id id) { return fn.values[id].removed; };
+            block.phis.erase(std::remove_if(block.phis.begin(), block.phis.end(), is_removed), block.phis.end());
+            block.values.erase(std::remove_if(block.values.begin(), block.values.end(), is_removed), block.values.end());
+        }
+    }
+
+    void remove_edge(SSA_Block_Id pred, SSA_Block_Id succ) {
+        auto &block = fn.blocks[succ];
+        auto it = std::find(block.preds.begin(), block.preds.end(), pred);
+        internal_verify(it != block.preds.end(), "Removing an edge that doesn't exist in remove_edge().");
+        size_t k = it - block.preds.begin();
+        block.preds.erase(it);
+        for (SSA_Value_Id phi : block.phis) {
+            auto &args = fn.values[phi].args;
+            args.erase(args.begin() + k);
+        }
+    }
+
+    //
+    // Copies and phis whose operands are all the same value (or the phi
+    // itself, around a loop that doesn't change the variable) are replaced by
+    // that value.
+    //
+    bool propagate_copies() {
+        bool changed = false;
+        bool again = true;
+        while (again) {
+            again = false;
+            for (SSA_Value_Id id = 0; id < fn.values.size(); id++) {
+                auto &value = fn.values[id];
+                if (value.removed) continue;
+
+                SSA_Value_Id same = SSA_No_Value;
+                if (value.op == SSA_Op::Copy) {
+                    same = fn.resolve(value.args[0]);
+                } else if (value.op == SSA_Op::Phi) {
+                    bool trivial = true;
+                    for (SSA_Value_Id arg : value.args) {
+                        arg = fn.resolve(arg);
+                        if (arg == id || arg == same) continue;
+                        if (same != SSA_No_Value) {
+                            trivial = false;
+                            break;
+                        }
+                        same = arg;
+                    }
+                    if (!trivial) same = SSA_No_Value;
+                }
+
+                if (same != SSA_No_Value) {
+                    replace(id, same);
+                    stats.copies_propagated++;
+                    changed = again = true;
+                }
+            }
+        }
+        return changed;
+    }
+
+    // operators on constants become constants, branches on constants become jumps
+    bool fold_constants() {
+        bool changed = false;
+        for (auto &value : fn.values) {
+            if (value.removed) continue;
+            if (value.op != SSA_Op::Unary && value.op != SSA_Op::Binary && value.op != SSA_Op::Cast) continue;
+
+            bool all_constant = true;
+            for (SSA_Value_Id arg : value.args) {
+                if (fn.values[fn.resolve(arg)].op != SSA_Op::Const) all_constant = false;
+            }
+            if (!all_constant) continue;
+
+            auto &a = fn.values[fn.resolve(value.args[0])].constant;
+            Constant_Value result;
+            bool folded = false;
+            switch (value.op) {
+                case SSA_Op::Unary:
+                    folded = fold_unary(value.kind, a, result);
+                    break;
+                case SSA_Op::Binary:
+                    folded = fold_binary(value.kind, a, fn.values[fn.resolve(value.args[1])].constant, result);
+                    break;
+                case SSA_Op::Cast:
+                    folded = fold_cast(value.kind, a, result);
+                    break;
+                default:
+                    break;
+            }
+            if (!folded) continue;
+
+            value.op = SSA_Op::Const;
+            value.constant = result;
+            value.args.clear();
+            stats.values_folded++;
+            changed = true;
+        }
+
+        for (SSA_Block_Id b = 0; b < fn.blocks.size(); b++) {
+            auto &block = fn.blocks[b];
+            if (block.exit != SSA_Block::Exit::Branch) continue;
+
+            auto &cond = fn.values[fn.resolve(block.value)];
+            if (cond.op != SSA_Op::Const) continue;
+
+            bool taken = cond.constant.get<runtime::Bool>();
+            SSA_Block_Id target = block.succs[taken ? 0 : 1];
+            remove_edge(b, block.succs[taken ? 1 : 0]);
+            block.exit = SSA_Block::Exit::Jump;
+            block.succs[0] = target;
+            block.value = SSA_No_Value;
+            changed = true;
+        }
+        return changed;
+    }
+
+    // blocks nothing reaches are dropped along with their edges into reachable blocks
+    bool remove_unreachable_blocks() {
+        std::vector<bool> reachable(fn.blocks.size(), false);
+        for (SSA_Block_Id b : fn.reverse_postorder()) reachable[b] = true;
+
+        bool changed = false;
+        for (SSA_Block_Id b = 0; b < fn.blocks.size(); b++) {
+            auto &block = fn.blocks[b];
+            if (reachable[b]) {
+                auto preds = block.preds;
+                for (SSA_Block_Id pred : preds) {
+                    if (!reachable[pred]) remove_edge(pred, b);
+                }
+                continue;
+            }
+            if (block.values.empty() && block.phis.empty() && block.exit == SSA_Block::Exit::None) continue;
+
+            for (SSA_Value_Id id : block.phis) fn.values[id].removed = true;
+            for (SSA_Value_Id id : block.values) fn.values[id].removed = true;
+            block.phis.clear();
+            block.values.clear();
+            block.preds.clear();
+            block.exit = SSA_Block::Exit::None;
+            block.value = SSA_No_Value;
+            changed = true;
+        }
+        return changed;
+    }
+
+    //
+    // The Cooper, Harvey and Kennedy dominator algorithm. idom[b] is the block
+    // that immediately dominates b, the entry dominates itself and unreachable
+    // blocks are SSA_No_Value.
+    //
+    std::vector<SSA_Block_Id> dominators(const std::vector<SSA_Block_Id> &order) {
+        std::vector<size_t> position(fn.blocks.size(), SIZE_MAX);
+        for (size_t i = 0; i < order.size(); i++) position[order[i]] = i;
+
+        std::vector<SSA_Block_Id> idom(fn.blocks.size(), SSA_No_Value);
+        idom[0] = 0;
+
+        auto intersect = [&](SSA_Block_Id a, SSA_Block_Id b) {
+            while (a != b) {
+                while (position[a] > position[b]) a = idom[a];
+                while (position[b] > position[a]) b = idom[b];
+            }
+            return a;
+        };
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = 1; i < order.size(); i++) {
+                SSA_Block_Id b = order[i];
+                SSA_Block_Id new_idom = SSA_No_Value;
+                for (SSA_Block_Id pred : fn.blocks[b].preds) {
+                    if (idom[pred] == SSA_No_Value) continue;
+                    new_idom = new_idom == SSA_No_Value ? pred : intersect(pred, new_idom);
+                }
+                if (new_idom != idom[b]) {
+                    idom[b] = new_idom;
+                    changed = true;
+                }
+            }
+        }
+        return idom;
+    }
+
+    //
+    // A value that repeats one computed in a dominating block, or earlier in
+    // the same block, is replaced by it. The table of available values is
+    // scoped to the dominator tree so it only holds values that dominate the
+    // block being looked at.
+    //
+    bool eliminate_common_subexpressions() {
+        auto order = fn.reverse_postorder();
+        auto idom = dominators(order);
+
+        std::vector<std::vector<SSA_Block_Id>> children(fn.blocks.size());
+        for (SSA_Block_Id b : order) {
+            if (b != 0) children[idom[b]].push_back(b);
+        }
+
+        using Key = std::vector<uint64_t>;
+        std::map<Key, SSA_Value_Id> available;
+        bool changed = false;
+
+        auto key_of = [&](const SSA_Value &value) {
+            Key key = {
+                static_cast<uint64_t>(value.op),
+                static_cast<uint64_t>(value.kind),
+                static_cast<uint64_t>(value.type),
+                value.constant.bits,
+            };
+            for (SSA_Value_Id arg : value.args) key.push_back(fn.resolve(arg));
+            return key;
+        };
+
+        auto visit = [&](auto &visit, SSA_Block_Id b) -> void {
+            std::vector<Key> added;
+            for (SSA_Value_Id id : fn.blocks[b].values) {
+                auto &value = fn.values[id];
+                if (value.removed || !is_redundant_if_repeated(value)) continue;
+
+                Key key = key_of(value);
+                auto it = available.find(key);
+                if (it != available.end()) {
+                    replace(id, it->second);
+                    stats.subexpressions_eliminated++;
+                    changed = true;
+                } else {
+                    available[key] = id;
+                    added.push_back(key);
+                }
+            }
+            for (SSA_Block_Id child : children[b]) visit(visit, child);
+            for (auto &key : added) available.erase(key);
+        };
+        visit(visit, 0);
+
+        return changed;
+    }
+
+    // values that nothing with a side effect, no branch and no return depends on are removed
+    bool eliminate_dead_values() {
+        std::vector<bool> live(fn.values.size(), false);
+        std::vector<SSA_Value_Id> work;
+        auto mark = [&](SSA_Value_Id id) {
+            id = fn.resolve(id);
+            if (id != SSA_No_Value && !live[id]) {
+                live[id] = true;
+                work.push_back(id);
+            }
+        };
+
+        for (auto &block : fn.blocks) {
+            for (SSA_Value_Id id : block.values) {
+                if (!fn.values[id].removed && has_side_effects(fn.values[id])) mark(id);
+            }
+            if (block.exit == SSA_Block::Exit::Branch || block.exit == SSA_Block::Exit::Return) mark(block.value);
+        }
+        while (!work.empty()) {
+            SSA_Value_Id id = work.back();
+            work.pop_back();
+            for (SSA_Value_Id arg : fn.values[id].args) mark(arg);
+        }
+
+        bool changed = false;
+        for (auto &block : fn.blocks) {
+            for (auto *ids : { &block.phis, &block.values }) {
+                for (SSA_Value_Id id : *ids) {
+                    if (fn.values[id].removed || live[id]) continue;
+                    fn.values[id].removed = true;
+                    stats.values_removed++;
+                    changed = true;
+                }
+            }
+        }
+        return changed;
+    }
+};
+
+SSA_Stats optimize_ssa(SSA_Function &fn) {
+    SSA_Optimizer o(fn);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        changed |= o.propagate_copies();
+        changed |= o.fold_constants();
+        changed |= o.remove_unreachable_blocks();
+        o.compact();
+        changed |= o.eliminate_common_subexpressions();
+        changed |= o.eliminate_dead_values();
+        o.compact();
+    }
+    return o.stats;
+}
@@ -0,0 +1,112 @@
+//
+//  ssa.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+#include <vector>
+
+#include "bytecode.h"
+#include "compiler.h"
+
+//
+// A small SSA form for function bodies, between the typed AST and the stack
+// code. Every value is assigned once, variables become the values written to
+// them and where control flow joins a phi picks between the values that reach
+// it. Only functions made of scalar values, locals, globals, the arithmetic,
+// comparison and cast operators, direct calls, ifs and loops can be built, the
+// rest are compiled straight from the AST like before.
+//
+
+using SSA_Value_Id = uint32_t;
+using SSA_Block_Id = uint32_t;
+
+static constexpr SSA_Value_Id SSA_No_Value = UINT32_MAX;
+
+enum class SSA_Op : uint8_t {
+    Const,          // constant
+    Param,          // the argument at `address`
+    Phi,            // one arg per predecessor, in the order of the block's preds
+    Copy,           // args[0]
+    Unary,          // kind, args[0]
+    Binary,         // kind, args[0], args[1]
+    Cast,           // kind, args[0]
+    Load_Global,    // the global at `address`
+    Store_Global,   // args[0] into the global at `address`
+    Call,           // Function_Index `index` with args
+    Call_Builtin,   // Builtin_Index `index` with args
+};
+
+struct SSA_Value {
+    SSA_Op op;
+    Typed_AST_Kind kind = Typed_AST_Kind::Byte; // operator of Unary, Binary and Cast
+    Value_Type_Kind type = Value_Type_Kind::None; // None for calls that return void
+    Size size = 0;
+    SSA_Block_Id block = 0;
+    Address address = 0;
+    uint64_t index = 0;
+    Constant_Value constant;
+    std::vector<SSA_Value_Id> args;
+    bool removed = false;
+    SSA_Value_Id replaced_by = SSA_No_Value; // set when it's removed in favour of another value
+};
+
+struct SSA_Block {
+    enum class Exit : uint8_t {
+        None,       // falls off the end of the function
+        Jump,       // to succs[0]
+        Branch,     // to succs[0] if `value` is true, succs[1] if not
+        Return,     // `value`, SSA_No_Value if void
+    };
+
+    std::vector<SSA_Value_Id> phis;
+    std::vector<SSA_Value_Id> values;
+    std::vector<SSA_Block_Id> preds;
+    Exit exit = Exit::None;
+    SSA_Value_Id value = SSA_No_Value;
+    SSA_Block_Id succs[2] = {};
+};
+
+struct SSA_Function {
+    Size param_size = 0;
+    Size return_size = 0;
+    std::vector<SSA_Value> values;
+    std::vector<SSA_Block> blocks; // blocks[0] is the entry
+
+    SSA_Value_Id add(SSA_Value value);
+
+    // what a removed value was replaced by
+    SSA_Value_Id resolve(SSA_Value_Id id) const;
+
+    // blocks control can reach from the entry, in reverse postorder
+    std::vector<SSA_Block_Id> reverse_postorder() const;
+};
+
+// has to run even if nothing uses its value, division can fail at runtime so counts too
+bool has_side_effects(const SSA_Value &value);
+
+// Returns false if the body uses something that can't be built, `out_fn` is left half built.
+bool build_ssa(Compiler &c, Typed_AST_Fn_Declaration &decl, SSA_Function &out_fn);
+
+struct SSA_Stats {
+    size_t copies_propagated = 0;
+    size_t values_folded = 0;
+    size_t subexpressions_eliminated = 0;
+    size_t values_removed = 0;
+};
+
+// Constant folding, copy propagation, common subexpression elimination and dead code elimination until nothing changes.
+SSA_Stats optimize_ssa(SSA_Function &fn);
+
+// Returns false if some path falls off the end of a function that returns a value.
+bool emit_ssa(const SSA_Function &fn, std::vector<Instruction> &out_code);
+
+//
+// Builds, optimizes and emits the body of `decl` into c.function. Returns false
+// without emitting anything if the body can't be built.
+//
+bool compile_function_ssa(Compiler &c, Typed_AST_Fn_Declaration &decl);
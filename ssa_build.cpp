@@ -0,0 +1,716 @@
+//
+//  ssa_build.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "ssa.h"
+
+#include "definitions.h"
+#include "interpreter.h"
+
+static bool is_scalar(Value_Type_Kind kind) {
+    switch (kind) {
+        case Value_Type_Kind::Byte:
+        case Value_Type_Kind::Bool:
+        case Value_Type_Kind::Char:
+        case Value_Type_Kind::Int:
+        case Value_Type_Kind::Float:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool is_void(const Value_Type &type) {
+    return type.kind == Value_Type_Kind::None || type.kind == Value_Type_Kind::Void;
+}
+
+//
+// Builds the SSA form straight from the AST, following "Simple and Efficient
+// Construction of Static Single Assignment Form" (Braun et al.). Each block
+// remembers the value last written to each variable. Reading a variable a block
+// doesn't write looks through its predecessors and puts a phi where they could
+// disagree. A block is sealed once all its predecessors are known, until then
+// the phis it needs are left incomplete.
+//
+struct SSA_Builder {
+    struct Variable_Info {
+        Value_Type_Kind type;
+        Size size;
+    };
+
+    struct Loop {
+        Symbol label;
+        SSA_Block_Id continue_block;
+        SSA_Block_Id break_block;
+    };
+
+    Compiler &c;
+    SSA_Function &fn;
+    SSA_Block_Id current = 0;
+
+    std::vector<Variable_Info> variables;
+    std::vector<std::unordered_map<Symbol, int>> scopes;
+    std::vector<std::unordered_map<int, SSA_Value_Id>> definitions; // indexed by block
+    std::vector<std::unordered_map<int, SSA_Value_Id>> incomplete_phis; // indexed by block
+    std::vector<bool> sealed; // indexed by block
+    std::vector<Loop> loops;
+
+    SSA_Builder(Compiler &c, SSA_Function &fn) : c(c), fn(fn) {}
+
+    SSA_Block_Id new_block() {
+        fn.blocks.emplace_back();
+        definitions.emplace_back();
+        incomplete_phis.emplace_back();
+        sealed.push_back(false);
+        return static_cast<SSA_Block_Id>(fn.blocks.size() - 1);
+    }
+
+    bool is_terminated() const {
+        return fn.blocks[current].exit != SSA_Block::Exit::None;
+    }
+
+    // code after a return, break or continue goes in a block nothing jumps to
+    void start_unreachable_block() {
+        current = new_block();
+        sealed[current] = true;
+    }
+
+    void jump(SSA_Block_Id target) {
+        auto &block = fn.blocks[current];
+        block.exit = SSA_Block::Exit::Jump;
+        block.succs[0] = target;
+        fn.blocks[target].preds.push_back(current);
+    }
+
+    void branch(SSA_Value_Id cond, SSA_Block_Id if_true, SSA_Block_Id if_false) {
+        auto &block = fn.blocks[current];
+        block.exit = SSA_Block::Exit::Branch;
+        block.value = cond;
+        block.succs[0] = if_true;
+        block.succs[1] = if_false;
+        fn.blocks[if_true].preds.push_back(current);
+        fn.blocks[if_false].preds.push_back(current);
+    }
+
+    SSA_Value_Id add(SSA_Value value) {
+        value.block = current;
+        SSA_Value_Id id = fn.add(std::move(value));
+        fn.blocks[current].values.push_back(id);
+        return id;
+    }
+
+    SSA_Value_Id add_constant(const Constant_Value &constant) {
+        SSA_Value value;
+        value.op = SSA_Op::Const;
+        value.type = constant.kind;
+        value.size = Value_Type{ constant.kind }.size();
+        value.constant = constant;
+        return add(value);
+    }
+
+    SSA_Value_Id add_zero(const Variable_Info &info) {
+        Constant_Value zero;
+        zero.kind = info.type;
+        return add_constant(zero);
+    }
+
+    //
+    // Variables
+    //
+
+    int declare_variable(Symbol id, Value_Type_Kind type, Size size) {
+        int variable = static_cast<int>(variables.size());
+        variables.push_back({ type, size });
+        scopes.back()[id] = variable;
+        return variable;
+    }
+
+    int find_variable(Symbol id) const {
+        for (auto it = scopes.rbegin(); it != scopes.rend(); it++) {
+            auto found = it->find(id);
+            if (found != it->end()) return found->second;
+        }
+        return -1;
+    }
+
+    void write_variable(int variable, SSA_Block_Id block, SSA_Value_Id value) {
+        definitions[block][variable] = value;
+    }
+
+    SSA_Value_Id new_phi(int variable, SSA_Block_Id block) {
+        SSA_Value phi;
+        phi.op = SSA_Op::Phi;
+        phi.type = variables[variable].type;
+        phi.size = variables[variable].size;
+        phi.block = block;
+        SSA_Value_Id id = fn.add(phi);
+        fn.blocks[block].phis.push_back(id);
+        return id;
+    }
+
+    SSA_Value_Id read_variable(int variable, SSA_Block_Id block) {
+        auto it = definitions[block].find(variable);
+        if (it != definitions[block].end()) return it->second;
+
+        SSA_Value_Id value;
+        auto &preds = fn.blocks[block].preds;
+        if (!sealed[block]) {
+            value = new_phi(variable, block);
+            incomplete_phis[block][variable] = value;
+        } else if (preds.size() == 1) {
+            value = read_variable(variable, preds[0]);
+        } else if (preds.empty()) {
+            // only in blocks nothing reaches, the value never gets used
+            SSA_Block_Id old = current;
+            current = block;
+            value = add_zero(variables[variable]);
+            current = old;
+        } else {
+            value = new_phi(variable, block);
+            write_variable(variable, block, value);
+            add_phi_operands(variable, value);
+        }
+        write_variable(variable, block, value);
+        return value;
+    }
+
+    void add_phi_operands(int variable, SSA_Value_Id phi) {
+        SSA_Block_Id block = fn.values[phi].block;
+        for (SSA_Block_Id pred : fn.blocks[block].preds) {
+            SSA_Value_Id operand = read_variable(variable, pred);
+            fn.values[phi].args.push_back(operand);
+        }
+    }
+
+    void seal_block(SSA_Block_Id block) {
+        sealed[block] = true;
+        for (auto [variable, phi] : incomplete_phis[block]) {
+            add_phi_operands(variable, phi);
+        }
+        incomplete_phis[block].clear();
+    }
+
+    //
+    // Expressions, each returns SSA_No_Value if it can't be built
+    //
+
+    // @print and @puts of a scalar pass it on its own instead of in a Multiary
+    bool build_args(Typed_AST &node, std::vector<SSA_Value_Id> &out_args) {
+        auto args = kind_cast<Typed_AST_Multiary>(&node);
+        if (!args) {
+            SSA_Value_Id value = build_expression(node);
+            if (value == SSA_No_Value) return false;
+            out_args.push_back(value);
+            return true;
+        }
+        for (auto &arg : args->nodes) {
+            SSA_Value_Id value = build_expression(*arg);
+            if (value == SSA_No_Value) return false;
+            out_args.push_back(value);
+        }
+        return true;
+    }
+
+    SSA_Value_Id build_ident(Typed_AST_Ident &ident) {
+        int variable = find_variable(ident.id);
+        if (variable >= 0) return read_variable(variable, current);
+
+        Constant_Value constant;
+        if (c.fold(ident, constant)) return add_constant(constant);
+
+        auto [status, v] = c.find_variable(ident.id);
+        if (status != Find_Variable_Result::Found_Global) return SSA_No_Value;
+
+        SSA_Value load;
+        load.op = SSA_Op::Load_Global;
+        load.type = v->type.kind;
+        load.size = v->type.size();
+        load.address = v->address;
+        return add(load);
+    }
+
+    // `a and b` is `if a { b } else { false }`, `a or b` is `if a { true } else { b }`
+    SSA_Value_Id build_logical_operator(Typed_AST_Binary &b) {
+        SSA_Value_Id lhs = build_expression(*b.lhs);
+        if (lhs == SSA_No_Value) return SSA_No_Value;
+
+        int result = static_cast<int>(variables.size());
+        variables.push_back({ Value_Type_Kind::Bool, value_types::Bool.size() });
+        write_variable(result, current, lhs);
+
+        SSA_Block_Id rhs_block = new_block();
+        SSA_Block_Id join = new_block();
+        if (b.kind == Typed_AST_Kind::And) {
+            branch(lhs, rhs_block, join);
+        } else {
+            branch(lhs, join, rhs_block);
+        }
+        seal_block(rhs_block);
+
+        current = rhs_block;
+        SSA_Value_Id rhs = build_expression(*b.rhs);
+        if (rhs == SSA_No_Value) return SSA_No_Value;
+        write_variable(result, current, rhs);
+        jump(join);
+
+        seal_block(join);
+        current = join;
+        return read_variable(result, current);
+    }
+
+    SSA_Value_Id build_call(Typed_AST_Binary &call) {
+        if (!is_void(call.type) && !is_scalar(call.type.kind)) return SSA_No_Value;
+
+        SSA_Value value;
+        value.type = is_void(call.type) ? Value_Type_Kind::None : call.type.kind;
+        value.size = is_void(call.type) ? 0 : call.type.size();
+
+        if (call.kind == Typed_AST_Kind::Builtin_Call) {
+            auto builtin = call.lhs.cast<Typed_AST_Builtin>();
+            if (!builtin) return SSA_No_Value;
+            value.op = SSA_Op::Call_Builtin;
+            value.index = builtin->defn->index;
+        } else {
+            auto uuid = call.lhs.cast<Typed_AST_UUID>();
+            if (!uuid || uuid->type.kind != Value_Type_Kind::Function) return SSA_No_Value;
+            Function_Definition *defn = c.interp->functions.get_func_by_uuid(uuid->uuid);
+            if (!defn || defn->varargs) return SSA_No_Value;
+            value.op = SSA_Op::Call;
+            value.index = defn->index;
+        }
+
+        if (!build_args(*call.rhs, value.args)) return SSA_No_Value;
+        for (SSA_Value_Id arg : value.args) {
+            if (!is_scalar(fn.values[arg].type)) return SSA_No_Value;
+        }
+        return add(value);
+    }
+
+    SSA_Value_Id build_expression(Typed_AST &node) {
+        switch (node.kind) {
+            case Typed_AST_Kind::Byte:
+            case Typed_AST_Kind::Bool:
+            case Typed_AST_Kind::Char:
+            case Typed_AST_Kind::Int:
+            case Typed_AST_Kind::Float: {
+                Constant_Value constant;
+                if (!c.fold(node, constant)) return SSA_No_Value;
+                return add_constant(constant);
+            }
+
+            case Typed_AST_Kind::Ident:
+                if (!is_scalar(node.type.kind)) return SSA_No_Value;
+                return build_ident(static_cast<Typed_AST_Ident &>(node));
+
+            case Typed_AST_Kind::Negation:
+            case Typed_AST_Kind::Not: {
+                auto &u = static_cast<Typed_AST_Unary &>(node);
+                if (node.kind == Typed_AST_Kind::Negation &&
+                    u.sub->type.kind != Value_Type_Kind::Int &&
+                    u.sub->type.kind != Value_Type_Kind::Float)
+                {
+                    return SSA_No_Value;
+                }
+                SSA_Value value;
+                value.op = SSA_Op::Unary;
+                value.kind = node.kind;
+                value.type = node.type.kind;
+                value.size = node.type.size();
+                SSA_Value_Id sub = build_expression(*u.sub);
+                if (sub == SSA_No_Value) return SSA_No_Value;
+                value.args.push_back(sub);
+                return add(value);
+            }
+
+            case Typed_AST_Kind::And:
+            case Typed_AST_Kind::Or:
+                return build_logical_operator(static_cast<Typed_AST_Binary &>(node));
+
+            case Typed_AST_Kind::Addition:
+            case Typed_AST_Kind::Subtraction:
+            case Typed_AST_Kind::Multiplication:
+            case Typed_AST_Kind::Division:
+            case Typed_AST_Kind::Mod:
+            case Typed_AST_Kind::Equal:
+            case Typed_AST_Kind::Not_Equal:
+            case Typed_AST_Kind::Less:
+            case Typed_AST_Kind::Less_Eq:
+            case Typed_AST_Kind::Greater:
+            case Typed_AST_Kind::Greater_Eq: {
+                auto &b = static_cast<Typed_AST_Binary &>(node);
+                if (!is_scalar(b.lhs->type.kind)) return SSA_No_Value;
+                bool is_equality = node.kind == Typed_AST_Kind::Equal || node.kind == Typed_AST_Kind::Not_Equal;
+                if (!is_equality && binary_opcode(node.kind, b.lhs->type.kind) == Opcode::None) return SSA_No_Value;
+
+                SSA_Value value;
+                value.op = SSA_Op::Binary;
+                value.kind = node.kind;
+                value.type = node.type.kind;
+                value.size = node.type.size();
+                SSA_Value_Id lhs = build_expression(*b.lhs);
+                if (lhs == SSA_No_Value) return SSA_No_Value;
+                SSA_Value_Id rhs = build_expression(*b.rhs);
+                if (rhs == SSA_No_Value) return SSA_No_Value;
+                value.args = { lhs, rhs };
+                return add(value);
+            }
+
+            case Typed_AST_Kind::Cast_Byte_Int:
+            case Typed_AST_Kind::Cast_Byte_Float:
+            case Typed_AST_Kind::Cast_Bool_Int:
+            case Typed_AST_Kind::Cast_Char_Int:
+            case Typed_AST_Kind::Cast_Int_Float:
+            case Typed_AST_Kind::Cast_Float_Int: {
+                SSA_Value value;
+                value.op = SSA_Op::Cast;
+                value.kind = node.kind;
+                value.type = node.type.kind;
+                value.size = node.type.size();
+                SSA_Value_Id sub = build_expression(*static_cast<Typed_AST_Cast &>(node).expr);
+                if (sub == SSA_No_Value) return SSA_No_Value;
+                value.args.push_back(sub);
+                return add(value);
+            }
+
+            case Typed_AST_Kind::Function_Call:
+            case Typed_AST_Kind::Builtin_Call:
+                return build_call(static_cast<Typed_AST_Binary &>(node));
+
+            default:
+                return SSA_No_Value;
+        }
+    }
+
+    // branches on `cond`, `and`, `or` and `not` become branches of their own instead of values
+    bool build_condition(Typed_AST &cond, SSA_Block_Id if_true, SSA_Block_Id if_false) {
+        switch (cond.kind) {
+            case Typed_AST_Kind::And:
+            case Typed_AST_Kind::Or: {
+                auto &b = static_cast<Typed_AST_Binary &>(cond);
+                SSA_Block_Id rhs_block = new_block();
+                bool is_and = cond.kind == Typed_AST_Kind::And;
+                if (!build_condition(*b.lhs, is_and ? rhs_block : if_true, is_and ? if_false : rhs_block)) return false;
+                seal_block(rhs_block);
+                current = rhs_block;
+                return build_condition(*b.rhs, if_true, if_false);
+            }
+            case Typed_AST_Kind::Not:
+                return build_condition(*static_cast<Typed_AST_Unary &>(cond).sub, if_false, if_true);
+
+            default: {
+                SSA_Value_Id value = build_expression(cond);
+                if (value == SSA_No_Value) return false;
+                branch(value, if_true, if_false);
+                return true;
+            }
+        }
+    }
+
+    //
+    // Statements, each returns false if it can't be built
+    //
+
+    bool build_block(Typed_AST_Multiary &block) {
+        scopes.emplace_back();
+        for (auto &node : block.nodes) {
+            if (!build_statement(*node)) return false;
+        }
+        scopes.pop_back();
+        return true;
+    }
+
+    bool build_let(Typed_AST_Let &let) {
+        if (let.is_const || let.target->bindings.size() != 1) return false;
+
+        auto &binding = let.target->bindings[0];
+        if (!is_scalar(binding.type.kind)) return false;
+
+        SSA_Value_Id value;
+        if (let.initializer) {
+            value = build_expression(*let.initializer);
+            if (value == SSA_No_Value) return false;
+        } else {
+            value = add_zero({ binding.type.kind, binding.type.size() });
+        }
+
+        int variable = declare_variable(binding.id, binding.type.kind, binding.type.size());
+        write_variable(variable, current, value);
+        return true;
+    }
+
+    bool build_assignment(Typed_AST_Binary &assignment) {
+        auto ident = assignment.lhs.cast<Typed_AST_Ident>();
+        if (!ident || !is_scalar(ident->type.kind)) return false;
+
+        SSA_Value_Id value = build_expression(*assignment.rhs);
+        if (value == SSA_No_Value) return false;
+
+        int variable = find_variable(ident->id);
+        if (variable >= 0) {
+            SSA_Value copy;
+            copy.op = SSA_Op::Copy;
+            copy.type = variables[variable].type;
+            copy.size = variables[variable].size;
+            copy.args.push_back(value);
+            write_variable(variable, current, add(copy));
+            return true;
+        }
+
+        auto [status, v] = c.find_variable(ident->id);
+        if (status != Find_Variable_Result::Found_Global) return false;
+
+        SSA_Value store;
+        store.op = SSA_Op::Store_Global;
+        store.address = v->address;
+        store.size = v->type.size();
+        store.args.push_back(value);
+        add(store);
+        return true;
+    }
+
+    bool build_if(Typed_AST_If &node) {
+        if (!is_void(node.type)) return false;
+
+        SSA_Block_Id then_block = new_block();
+        SSA_Block_Id else_block = node.else_ ? new_block() : 0;
+        SSA_Block_Id join = new_block();
+        if (!build_condition(*node.cond, then_block, node.else_ ? else_block : join)) return false;
+        seal_block(then_block);
+
+        current = then_block;
+        if (!build_statement(*node.then)) return false;
+        if (!is_terminated()) jump(join);
+
+        if (node.else_) {
+            seal_block(else_block);
+            current = else_block;
+            if (!build_statement(*node.else_)) return false;
+            if (!is_terminated()) jump(join);
+        }
+
+        seal_block(join);
+        current = join;
+        return true;
+    }
+
+    // the header is sealed once the body has added its back edges
+    bool build_loop_body(Symbol label, Typed_AST_Multiary &body, SSA_Block_Id body_block, SSA_Block_Id continue_block, SSA_Block_Id exit) {
+        loops.push_back({ label, continue_block, exit });
+        current = body_block;
+        if (!build_block(body)) return false;
+        if (!is_terminated()) jump(continue_block);
+        loops.pop_back();
+        return true;
+    }
+
+    bool build_while(Typed_AST_While &node) {
+        SSA_Block_Id header = new_block();
+        jump(header);
+        current = header;
+
+        SSA_Block_Id body = new_block();
+        SSA_Block_Id exit = new_block();
+        if (!build_condition(*node.condition, body, exit)) return false;
+        seal_block(body);
+
+        Symbol label = node.label ? node.label->id : Symbol{};
+        if (!build_loop_body(label, *node.body, body, header, exit)) return false;
+
+        seal_block(header);
+        seal_block(exit);
+        current = exit;
+        return true;
+    }
+
+    bool build_forever(Typed_AST_Forever &node) {
+        SSA_Block_Id header = new_block();
+        SSA_Block_Id exit = new_block();
+        jump(header);
+
+        Symbol label = node.label ? node.label->id : Symbol{};
+        if (!build_loop_body(label, *node.body, header, header, exit)) return false;
+
+        seal_block(header);
+        seal_block(exit);
+        current = exit;
+        return true;
+    }
+
+    bool build_for_range(Typed_AST_For &node) {
+        auto range = node.iterable.cast<Typed_AST_Binary>();
+        if (!range || node.target->bindings.size() != 1) return false;
+        if (range->lhs->type.kind != Value_Type_Kind::Int) return false;
+
+        scopes.emplace_back();
+
+        SSA_Value_Id start = build_expression(*range->lhs);
+        if (start == SSA_No_Value) return false;
+
+        auto &binding = node.target->bindings[0];
+        int target = declare_variable(binding.id, Value_Type_Kind::Int, value_types::Int.size());
+        write_variable(target, current, start);
+
+        int counter = -1;
+        if (node.counter != "") {
+            counter = declare_variable(node.counter, Value_Type_Kind::Int, value_types::Int.size());
+            Constant_Value zero;
+            zero.set<runtime::Int>(Value_Type_Kind::Int, 0);
+            write_variable(counter, current, add_constant(zero));
+        }
+
+        SSA_Value_Id end = build_expression(*range->rhs);
+        if (end == SSA_No_Value) return false;
+
+        SSA_Block_Id header = new_block();
+        jump(header);
+        current = header;
+
+        SSA_Value test;
+        test.op = SSA_Op::Binary;
+        test.kind = node.iterable->type.data.range.inclusive ? Typed_AST_Kind::Less_Eq : Typed_AST_Kind::Less;
+        test.type = Value_Type_Kind::Bool;
+        test.size = value_types::Bool.size();
+        test.args = { read_variable(target, current), end };
+        SSA_Value_Id cond = add(test);
+
+        SSA_Block_Id body = new_block();
+        SSA_Block_Id latch = new_block();
+        SSA_Block_Id exit = new_block();
+        branch(cond, body, exit);
+        seal_block(body);
+
+        Symbol label = node.label ? node.label->id : Symbol{};
+        if (!build_loop_body(label, *node.body, body, latch, exit)) return false;
+
+        seal_block(latch);
+        current = latch;
+        Constant_Value one;
+        one.set<runtime::Int>(Value_Type_Kind::Int, 1);
+        for (int variable : { counter, target }) {
+            if (variable < 0) continue;
+            SSA_Value increment;
+            increment.op = SSA_Op::Binary;
+            increment.kind = Typed_AST_Kind::Addition;
+            increment.type = Value_Type_Kind::Int;
+            increment.size = value_types::Int.size();
+            increment.args = { read_variable(variable, current), add_constant(one) };
+            write_variable(variable, current, add(increment));
+        }
+        jump(header);
+
+        seal_block(header);
+        seal_block(exit);
+        current = exit;
+
+        scopes.pop_back();
+        return true;
+    }
+
+    bool build_loop_control(Typed_AST_Loop_Control &control) {
+        if (loops.empty()) return false;
+
+        Loop *loop = &loops.back();
+        if (control.label.size() != 0) {
+            loop = nullptr;
+            for (auto &l : loops) {
+                if (l.label == control.label) loop = &l;
+            }
+            if (!loop) return false;
+        }
+
+        jump(control.kind == Typed_AST_Kind::Break ? loop->break_block : loop->continue_block);
+        start_unreachable_block();
+        return true;
+    }
+
+    bool build_return(Typed_AST_Return &ret) {
+        if (ret.variadic) return false;
+
+        SSA_Value_Id value = SSA_No_Value;
+        if (ret.sub) {
+            value = build_expression(*ret.sub);
+            if (value == SSA_No_Value) return false;
+        }
+
+        auto &block = fn.blocks[current];
+        block.exit = SSA_Block::Exit::Return;
+        block.value = value;
+        start_unreachable_block();
+        return true;
+    }
+
+    bool build_statement(Typed_AST &node) {
+        switch (node.kind) {
+            case Typed_AST_Kind::Block:
+                return build_block(static_cast<Typed_AST_Multiary &>(node));
+            case Typed_AST_Kind::Let:
+                return build_let(static_cast<Typed_AST_Let &>(node));
+            case Typed_AST_Kind::Assignment:
+                return build_assignment(static_cast<Typed_AST_Binary &>(node));
+            case Typed_AST_Kind::If:
+                return build_if(static_cast<Typed_AST_If &>(node));
+            case Typed_AST_Kind::While:
+                return build_while(static_cast<Typed_AST_While &>(node));
+            case Typed_AST_Kind::Forever:
+                return build_forever(static_cast<Typed_AST_Forever &>(node));
+            case Typed_AST_Kind::For_Range:
+                return build_for_range(static_cast<Typed_AST_For &>(node));
+            case Typed_AST_Kind::Break:
+            case Typed_AST_Kind::Continue:
+                return build_loop_control(static_cast<Typed_AST_Loop_Control &>(node));
+            case Typed_AST_Kind::Return:
+                return build_return(static_cast<Typed_AST_Return &>(node));
+
+            default:
+                // an expression whose value goes unused
+                return build_expression(node) != SSA_No_Value;
+        }
+    }
+};
+
+bool build_ssa(Compiler &c, Typed_AST_Fn_Declaration &decl, SSA_Function &out_fn) {
+    Function_Definition *defn = decl.defn;
+    if (defn->varargs) return false;
+
+    auto &func = defn->type.data.func;
+    bool returns_void = is_void(*func.return_type);
+    if (!returns_void && !is_scalar(func.return_type->kind)) return false;
+    out_fn.param_size = func.arg_size();
+    out_fn.return_size = returns_void ? 0 : func.return_type->size();
+
+    SSA_Builder b(c, out_fn);
+    b.current = b.new_block();
+    b.sealed[b.current] = true;
+    b.scopes.emplace_back();
+
+    Address address = 0;
+    for (size_t i = 0; i < defn->param_names.size(); i++) {
+        auto &type = func.arg_types[i];
+        if (!is_scalar(type.kind)) return false;
+
+        SSA_Value param;
+        param.op = SSA_Op::Param;
+        param.type = type.kind;
+        param.size = type.size();
+        param.address = address;
+        int variable = b.declare_variable(defn->param_names[i], type.kind, type.size());
+        b.write_variable(variable, b.current, b.add(param));
+        address += type.size();
+    }
+
+    for (auto &node : decl.body->nodes) {
+        if (!b.build_statement(*node)) return false;
+    }
+
+    // falling off the end is only allowed when there's nothing to return
+    if (!b.is_terminated()) {
+        auto &block = out_fn.blocks[b.current];
+        block.exit = SSA_Block::Exit::Return;
+        if (!returns_void) block.exit = SSA_Block::Exit::None;
+    }
+    return true;
+}
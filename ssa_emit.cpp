@@ -0,0 +1,556 @@
+//
+//  ssa_emit.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "ssa.h"
+
+#include "definitions.h"
+#include "error.h"
+#include "interpreter.h"
+
+#define PRINT_SSA_STATS 1 && defined(DEBUG)
+
+//
+// Lowers the SSA form back into stack code. A value used once, later in its
+// own block, can usually be left on the stack for its user like the direct
+// emitter does. Everything else that's used is stored to a slot in the frame
+// after the parameters, phis included, and the copies into a phi's slot go on
+// the edges that lead to it. Constants are pushed wherever they're used and
+// parameters are read from where the caller put them.
+//
+struct SSA_Emitter {
+    const SSA_Function &fn;
+    std::vector<Instruction> &out;
+
+    std::vector<size_t> uses;           // indexed by value
+    std::vector<bool> resident;         // indexed by value, left on the stack for its only user
+    std::vector<Address> slots;         // indexed by value
+    std::vector<SSA_Value_Id> shares_slot_with; // indexed by value, itself unless its slot belongs to another value
+    std::vector<std::vector<bool>> live_out; // indexed by block then value
+    std::vector<size_t> block_starts;   // indexed by block
+    std::vector<std::pair<size_t, SSA_Block_Id>> fixups; // jumps at out[first] that go to block `second`
+    std::vector<SSA_Block_Id> order;
+    std::vector<size_t> positions;      // indexed by block, where it is in `order`
+
+    SSA_Emitter(const SSA_Function &fn, std::vector<Instruction> &out) : fn(fn), out(out) {}
+
+    void emit(Opcode op, Size size = 0, Address address = 0, uint64_t value = 0) {
+        Instruction inst;
+        inst.op = op;
+        inst.size = size;
+        inst.address = address;
+        inst.value = value;
+        out.push_back(inst);
+    }
+
+    void emit_jump(Opcode op, SSA_Block_Id target) {
+        fixups.push_back({ out.size(), target });
+        emit(op);
+    }
+
+    template <typename F>
+    void for_each_successor(const SSA_Block &block, F f) {
+        if (block.exit == SSA_Block::Exit::Jump) f(block.succs[0]);
+        if (block.exit == SSA_Block::Exit::Branch) {
+            f(block.succs[0]);
+            f(block.succs[1]);
+        }
+    }
+
+    // the arg of each phi in `succ` that comes from `pred`
+    std::vector<std::pair<SSA_Value_Id, SSA_Value_Id>> edge_copies(SSA_Block_Id pred, SSA_Block_Id succ) {
+        std::vector<std::pair<SSA_Value_Id, SSA_Value_Id>> copies;
+        auto &block = fn.blocks[succ];
+        auto it = std::find(block.preds.begin(), block.preds.end(), pred);
+        internal_verify(it != block.preds.end(), "Missing edge in SSA_Emitter::edge_copies().");
+        size_t k = it - block.preds.begin();
+        for (SSA_Value_Id phi : block.phis) {
+            SSA_Value_Id source = fn.values[phi].args[k];
+            if (source == phi) continue;
+            if (!shares_slot_with.empty() && needs_slot(source) && slot_owner(source) == slot_owner(phi)) continue;
+            copies.push_back({ phi, source });
+        }
+        return copies;
+    }
+
+    void count_uses() {
+        uses.assign(fn.values.size(), 0);
+        for (SSA_Block_Id b : order) {
+            auto &block = fn.blocks[b];
+            for (SSA_Value_Id id : block.values) {
+                for (SSA_Value_Id arg : fn.values[id].args) uses[arg]++;
+            }
+            if (block.value != SSA_No_Value) uses[block.value]++;
+            for_each_successor(block, [&](SSA_Block_Id succ) {
+                for (auto [phi, source] : edge_copies(b, succ)) uses[source]++;
+            });
+        }
+    }
+
+    //
+    // Picks the values that can stay on the stack. Evaluating a block in order
+    // has to find each value's stack args on top of the stack, in order and
+    // before its other args, and leave nothing behind but the terminator's
+    // value. Values that break that are stored instead and the block is tried
+    // again.
+    //
+    void choose_resident_values() {
+        resident.assign(fn.values.size(), false);
+
+        std::vector<bool> used_by_phi(fn.values.size(), false);
+        for (SSA_Block_Id b : order) {
+            for_each_successor(fn.blocks[b], [&](SSA_Block_Id succ) {
+                for (auto [phi, source] : edge_copies(b, succ)) used_by_phi[source] = true;
+            });
+        }
+
+        for (SSA_Block_Id b : order) {
+            auto &block = fn.blocks[b];
+            std::vector<bool> used_here(fn.values.size(), false);
+            for (SSA_Value_Id id : block.values) {
+                for (SSA_Value_Id arg : fn.values[id].args) used_here[arg] = true;
+            }
+            if (block.value != SSA_No_Value) used_here[block.value] = true;
+
+            for (SSA_Value_Id id : block.values) {
+                auto &value = fn.values[id];
+                if (value.op == SSA_Op::Const || value.op == SSA_Op::Param || value.size == 0) continue;
+                resident[id] = uses[id] == 1 && used_here[id] && !used_by_phi[id];
+            }
+        }
+
+        for (SSA_Block_Id b : order) {
+            while (!simulate_block(fn.blocks[b])) {}
+        }
+    }
+
+    // returns false after un-marking whatever was in the wrong place
+    bool simulate_block(const SSA_Block &block) {
+        std::vector<SSA_Value_Id> stack;
+        auto fail = [&](const std::vector<SSA_Value_Id> &ids) {
+            for (SSA_Value_Id id : ids) resident[id] = false;
+            return false;
+        };
+
+        for (SSA_Value_Id id : block.values) {
+            auto &args = fn.values[id].args;
+
+            size_t on_stack = 0;
+            while (on_stack < args.size() && resident[args[on_stack]]) on_stack++;
+            for (size_t k = on_stack; k < args.size(); k++) {
+                if (resident[args[k]]) return fail({ args[k] });
+            }
+
+            bool in_order = stack.size() >= on_stack;
+            for (size_t k = 0; in_order && k < on_stack; k++) {
+                in_order = stack[stack.size() - on_stack + k] == args[k];
+            }
+            if (!in_order) {
+                stack.insert(stack.end(), args.begin(), args.begin() + on_stack);
+                return fail(stack);
+            }
+
+            stack.resize(stack.size() - on_stack);
+            if (resident[id]) stack.push_back(id);
+        }
+
+        if (block.value != SSA_No_Value && resident[block.value]) {
+            if (stack.size() != 1 || stack.back() != block.value) {
+                stack.push_back(block.value);
+                return fail(stack);
+            }
+        } else if (!stack.empty()) {
+            return fail(stack);
+        }
+        return true;
+    }
+
+    // the phi args that `pred` passes to `succ`, including ones that copy a phi into itself
+    template <typename F>
+    void for_each_phi_arg(SSA_Block_Id pred, SSA_Block_Id succ, F f) {
+        auto &block = fn.blocks[succ];
+        size_t k = std::find(block.preds.begin(), block.preds.end(), pred) - block.preds.begin();
+        for (SSA_Value_Id phi : block.phis) f(phi, fn.values[phi].args[k]);
+    }
+
+    // which values are still needed when control leaves each block, phi args count as used at the end of the edge's block
+    void compute_liveness() {
+        live_out.assign(fn.blocks.size(), std::vector<bool>(fn.values.size(), false));
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto it = order.rbegin(); it != order.rend(); it++) {
+                SSA_Block_Id b = *it;
+                std::vector<bool> live(fn.values.size(), false);
+                for_each_successor(fn.blocks[b], [&](SSA_Block_Id succ) {
+                    auto in = live_in(succ);
+                    for (SSA_Value_Id id = 0; id < in.size(); id++) {
+                        if (in[id]) live[id] = true;
+                    }
+                    for_each_phi_arg(b, succ, [&](SSA_Value_Id, SSA_Value_Id arg) { live[arg] = true; });
+                });
+                if (live != live_out[b]) {
+                    live_out[b] = std::move(live);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    std::vector<bool> live_in(SSA_Block_Id b) {
+        auto &block = fn.blocks[b];
+        auto live = live_out[b];
+        if (block.value != SSA_No_Value) live[block.value] = true;
+        for (auto it = block.values.rbegin(); it != block.values.rend(); it++) {
+            live[*it] = false;
+            for (SSA_Value_Id arg : fn.values[*it].args) live[arg] = true;
+        }
+        for (SSA_Value_Id phi : block.phis) live[phi] = false;
+        return live;
+    }
+
+    // whether `id` is still needed after the value at `position` in block `b` runs, -1 is the start of the block
+    bool is_live_after(SSA_Value_Id id, SSA_Block_Id b, int position) {
+        auto &block = fn.blocks[b];
+        auto &value = fn.values[id];
+        if (value.block == b && value.op != SSA_Op::Phi) {
+            int defined_at = static_cast<int>(std::find(block.values.begin(), block.values.end(), id) - block.values.begin());
+            if (defined_at > position) return false;
+        }
+
+        if (live_out[b][id] || block.value == id) return true;
+        for (size_t i = position + 1; i < block.values.size(); i++) {
+            auto &args = fn.values[block.values[i]].args;
+            if (std::find(args.begin(), args.end(), id) != args.end()) return true;
+        }
+        return false;
+    }
+
+    bool interferes(SSA_Value_Id a, SSA_Value_Id b) {
+        auto defined_at = [&](SSA_Value_Id id) {
+            auto &block = fn.blocks[fn.values[id].block];
+            if (fn.values[id].op == SSA_Op::Phi) return -1;
+            return static_cast<int>(std::find(block.values.begin(), block.values.end(), id) - block.values.begin());
+        };
+        return is_live_after(a, fn.values[b].block, defined_at(b)) || is_live_after(b, fn.values[a].block, defined_at(a));
+    }
+
+    SSA_Value_Id slot_owner(SSA_Value_Id id) {
+        while (shares_slot_with[id] != id) id = shares_slot_with[id];
+        return id;
+    }
+
+    bool needs_slot(SSA_Value_Id id) {
+        auto &value = fn.values[id];
+        if (value.op == SSA_Op::Const || value.op == SSA_Op::Param) return false;
+        return !resident[id] && uses[id] != 0 && value.size != 0;
+    }
+
+    //
+    // A phi and the values copied into it share a slot wherever neither is
+    // still needed where the other is defined, the copy then has nothing left
+    // to do. That's what turns `i = i + 1` at the bottom of a loop back into a
+    // single store.
+    //
+    void share_phi_slots() {
+        shares_slot_with.resize(fn.values.size());
+        for (SSA_Value_Id id = 0; id < fn.values.size(); id++) shares_slot_with[id] = id;
+        compute_liveness();
+
+        std::vector<std::vector<SSA_Value_Id>> members(fn.values.size());
+        for (SSA_Value_Id id = 0; id < fn.values.size(); id++) members[id] = { id };
+
+        for (SSA_Block_Id b : order) {
+            for_each_successor(fn.blocks[b], [&](SSA_Block_Id succ) {
+                for_each_phi_arg(b, succ, [&](SSA_Value_Id phi, SSA_Value_Id source) {
+                    if (!needs_slot(phi) || !needs_slot(source)) return;
+
+                    SSA_Value_Id a = slot_owner(phi);
+                    SSA_Value_Id c = slot_owner(source);
+                    if (a == c || fn.values[a].size != fn.values[c].size) return;
+
+                    for (SSA_Value_Id x : members[a]) {
+                        for (SSA_Value_Id y : members[c]) {
+                            if (interferes(x, y)) return;
+                        }
+                    }
+
+                    shares_slot_with[c] = a;
+                    members[a].insert(members[a].end(), members[c].begin(), members[c].end());
+                    members[c].clear();
+                });
+            });
+        }
+    }
+
+    void assign_slots() {
+        slots.assign(fn.values.size(), 0);
+        Address top = static_cast<Address>(fn.param_size);
+        auto assign = [&](SSA_Value_Id id) {
+            if (!needs_slot(id) || slot_owner(id) != id) return;
+
+            // keeps ints and floats aligned
+            Size size = fn.values[id].size;
+            top = static_cast<Address>((top + size - 1) / size * size);
+            slots[id] = top;
+            top += size;
+        };
+
+        for (SSA_Block_Id b : order) {
+            for (SSA_Value_Id id : fn.blocks[b].phis) assign(id);
+        }
+        for (SSA_Block_Id b : order) {
+            for (SSA_Value_Id id : fn.blocks[b].values) assign(id);
+        }
+        for (SSA_Value_Id id = 0; id < fn.values.size(); id++) {
+            if (needs_slot(id)) slots[id] = slots[slot_owner(id)];
+        }
+
+        if (top > fn.param_size) emit(Opcode::Clear_Allocate, top - fn.param_size);
+    }
+
+    void emit_constant(const Constant_Value &constant) {
+        switch (constant.kind) {
+            case Value_Type_Kind::Byte: {
+                auto b = constant.get<runtime::Byte>();
+                if (b == 0 || b == 1) {
+                    emit(b == 0 ? Opcode::Lit_0b : Opcode::Lit_1b);
+                } else {
+                    emit(Opcode::Lit_Byte, 0, 0, b);
+                }
+            } break;
+            case Value_Type_Kind::Bool:
+                emit(constant.get<runtime::Bool>() ? Opcode::Lit_True : Opcode::Lit_False);
+                break;
+            case Value_Type_Kind::Char:
+                emit(Opcode::Lit_Char, 0, 0, static_cast<uint32_t>(constant.get<runtime::Char>()));
+                break;
+            case Value_Type_Kind::Int: {
+                auto n = constant.get<runtime::Int>();
+                if (n == 0 || n == 1) {
+                    emit(n == 0 ? Opcode::Lit_0 : Opcode::Lit_1);
+                } else {
+                    emit(Opcode::Lit_Int, 0, 0, constant.bits);
+                }
+            } break;
+            case Value_Type_Kind::Float:
+                emit(Opcode::Lit_Float, 0, 0, constant.bits);
+                break;
+
+            default:
+                internal_error("Invalid Value_Type_Kind in SSA_Emitter::emit_constant(): %d", constant.kind);
+        }
+    }
+
+    // pushes a value that isn't already on the stack
+    void push_value(SSA_Value_Id id) {
+        auto &value = fn.values[id];
+        if (value.op == SSA_Op::Const) {
+            emit_constant(value.constant);
+        } else if (value.op == SSA_Op::Param) {
+            emit(Opcode::Push_Value, value.size, value.address);
+        } else {
+            internal_verify(!resident[id], "Pushing a value that's on the stack in SSA_Emitter::push_value().");
+            emit(Opcode::Push_Value, value.size, slots[id]);
+        }
+    }
+
+    void store_value(SSA_Value_Id id) {
+        emit(Opcode::Push_Pointer, 0, slots[id]);
+        emit(Opcode::Move, fn.values[id].size);
+    }
+
+    void emit_value(SSA_Value_Id id) {
+        auto &value = fn.values[id];
+        if (value.op == SSA_Op::Const || value.op == SSA_Op::Param) return;
+
+        for (SSA_Value_Id arg : value.args) {
+            if (!resident[arg]) push_value(arg);
+        }
+
+        Size arg_size = 0;
+        for (SSA_Value_Id arg : value.args) arg_size += fn.values[arg].size;
+
+        switch (value.op) {
+            case SSA_Op::Unary:
+                if (value.kind == Typed_AST_Kind::Not) {
+                    emit(Opcode::Not);
+                } else {
+                    emit(value.type == Value_Type_Kind::Int ? Opcode::Int_Neg : Opcode::Float_Neg);
+                }
+                break;
+            case SSA_Op::Binary:
+                if (value.kind == Typed_AST_Kind::Equal || value.kind == Typed_AST_Kind::Not_Equal) {
+                    emit(value.kind == Typed_AST_Kind::Equal ? Opcode::Equal : Opcode::Not_Equal, fn.values[value.args[0]].size);
+                } else {
+                    Opcode op = binary_opcode(value.kind, fn.values[value.args[0]].type);
+                    internal_verify(op != Opcode::None, "Invalid binary operator in SSA_Emitter::emit_value(): %d", value.kind);
+                    emit(op);
+                }
+                break;
+            case SSA_Op::Cast:
+                emit(cast_opcode(value.kind));
+                break;
+            case SSA_Op::Load_Global:
+                emit(Opcode::Push_Global_Value, value.size, value.address);
+                break;
+            case SSA_Op::Store_Global:
+                emit(Opcode::Push_Global_Pointer, 0, value.address);
+                emit(Opcode::Move, value.size);
+                return;
+            case SSA_Op::Call:
+                emit(Opcode::Call_Direct, arg_size, 0, value.index);
+                break;
+            case SSA_Op::Call_Builtin:
+                emit(Opcode::Call_Builtin, arg_size, 0, value.index);
+                break;
+
+            default:
+                internal_error("Invalid SSA_Op in SSA_Emitter::emit_value(): %d", value.op);
+        }
+
+        if (resident[id] || value.size == 0) return;
+        if (uses[id] == 0) {
+            emit(Opcode::Pop, value.size);
+        } else {
+            store_value(id);
+        }
+    }
+
+    // pushes every source before storing any so phis that read each other get the old values
+    void emit_copies(const std::vector<std::pair<SSA_Value_Id, SSA_Value_Id>> &copies) {
+        for (auto [phi, source] : copies) push_value(source);
+        for (auto it = copies.rbegin(); it != copies.rend(); it++) store_value(it->first);
+    }
+
+    bool is_next(SSA_Block_Id b, SSA_Block_Id target) {
+        return positions[target] == positions[b] + 1;
+    }
+
+    void emit_block(SSA_Block_Id b) {
+        auto &block = fn.blocks[b];
+        block_starts[b] = out.size();
+
+        // a call left on top of the stack by the last instruction emitted
+        SSA_Value_Id last_call = SSA_No_Value;
+        for (SSA_Value_Id id : block.values) {
+            size_t before = out.size();
+            emit_value(id);
+            if (out.size() == before) continue;
+
+            bool is_call = fn.values[id].op == SSA_Op::Call && resident[id];
+            last_call = is_call ? id : SSA_No_Value;
+        }
+
+        switch (block.exit) {
+            case SSA_Block::Exit::Return: {
+                if (block.value == SSA_No_Value) {
+                    emit(Opcode::Return, 0);
+                    break;
+                }
+
+                // the call can take over this frame
+                if (block.value == last_call) {
+                    out.back().op = Opcode::Tail_Call;
+                    break;
+                }
+
+                if (!resident[block.value]) push_value(block.value);
+                emit(Opcode::Return, fn.values[block.value].size);
+            } break;
+
+            case SSA_Block::Exit::Jump: {
+                SSA_Block_Id target = block.succs[0];
+                auto copies = edge_copies(b, target);
+                emit_copies(copies);
+                if (!is_next(b, target)) emit_jump(Opcode::Jump, target);
+            } break;
+
+            case SSA_Block::Exit::Branch: {
+                if (!resident[block.value]) push_value(block.value);
+
+                SSA_Block_Id if_true = block.succs[0];
+                SSA_Block_Id if_false = block.succs[1];
+                auto true_copies = edge_copies(b, if_true);
+                auto false_copies = edge_copies(b, if_false);
+
+                // conditional jumps only go forwards, anything else goes through a stub
+                bool direct = false_copies.empty() && positions[if_false] > positions[b];
+                if (!direct && true_copies.empty() && positions[if_true] > positions[b]) {
+                    emit_jump(Opcode::Jump_True, if_true);
+                    emit_copies(false_copies);
+                    if (!is_next(b, if_false)) emit_jump(Opcode::Jump, if_false);
+                    break;
+                }
+
+                size_t jump_false = out.size();
+                if (direct) {
+                    emit_jump(Opcode::Jump_False, if_false);
+                } else {
+                    emit(Opcode::Jump_False);
+                }
+
+                emit_copies(true_copies);
+                if (!direct || !is_next(b, if_true)) emit_jump(Opcode::Jump, if_true);
+
+                if (!direct) {
+                    out[jump_false].target = out.size();
+                    emit_copies(false_copies);
+                    if (!is_next(b, if_false)) emit_jump(Opcode::Jump, if_false);
+                }
+            } break;
+
+            case SSA_Block::Exit::None:
+                internal_error("Emitting a block without an exit in SSA_Emitter::emit_block().");
+        }
+    }
+};
+
+bool emit_ssa(const SSA_Function &fn, std::vector<Instruction> &out_code) {
+    SSA_Emitter e(fn, out_code);
+    e.order = fn.reverse_postorder();
+    for (SSA_Block_Id b : e.order) {
+        if (fn.blocks[b].exit == SSA_Block::Exit::None) return false;
+    }
+
+    e.positions.assign(fn.blocks.size(), SIZE_MAX);
+    for (size_t i = 0; i < e.order.size(); i++) e.positions[e.order[i]] = i;
+
+    out_code.clear();
+    e.count_uses();
+    e.choose_resident_values();
+    e.share_phi_slots();
+    e.assign_slots();
+
+    e.block_starts.assign(fn.blocks.size(), 0);
+    for (SSA_Block_Id b : e.order) e.emit_block(b);
+
+    for (auto [index, target] : e.fixups) out_code[index].target = e.block_starts[target];
+    return true;
+}
+
+bool compile_function_ssa(Compiler &c, Typed_AST_Fn_Declaration &decl) {
+    SSA_Function fn;
+    if (!build_ssa(c, decl, fn)) return false;
+
+    SSA_Stats stats = optimize_ssa(fn);
+
+    std::vector<Instruction> code;
+    if (!emit_ssa(fn, code)) return false;
+
+    encode_instructions(code, c.function->instructions);
+
+#if PRINT_SSA_STATS
+    printf("%.*s: %zu copies propagated, %zu folded, %zu subexpressions eliminated, %zu values removed\n",
+           decl.defn->name.size(), decl.defn->name.c_str(),
+           stats.copies_propagated, stats.values_folded, stats.subexpressions_eliminated, stats.values_removed);
+#else
+    (void)stats;
+#endif
+    return true;
+}
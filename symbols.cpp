@@ -0,0 +1,105 @@
+//
+//  symbols.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "symbols.h"
+
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+
+struct Symbol_Entry {
+    const char *data;
+    size_t size;
+};
+
+//
+// Entries live in fixed size chunks that never move, so a thread can read the
+// entry of a Symbol it's been given while another thread is interning. Only
+// interning takes the lock.
+//
+static constexpr size_t Chunk_Size = 4096;
+static constexpr size_t Max_Chunks = 4096;
+
+static Symbol_Entry first_chunk[Chunk_Size] = { { "", 0 } }; // 0 is the empty identifier
+static Symbol_Entry *chunks[Max_Chunks] = { first_chunk };
+static uint32_t symbol_count = 1;
+
+static std::mutex symbols_lock;
+static std::unordered_map<std::string_view, uint32_t> symbol_ids;
+
+static const Symbol_Entry &entry(uint32_t id) {
+    return chunks[id / Chunk_Size][id % Chunk_Size];
+}
+
+Symbol Symbol::intern(const char *data, size_t size) {
+    Symbol symbol;
+    if (size == 0) return symbol;
+    
+    std::lock_guard<std::mutex> guard(symbols_lock);
+    
+    auto it = symbol_ids.find(std::string_view(data, size));
+    if (it != symbol_ids.end()) {
+        symbol._id = it->second;
+        return symbol;
+    }
+    
+    uint32_t id = symbol_count++;
+    internal_verify(id / Chunk_Size < Max_Chunks, "Too many symbols, limit is %zu.", Chunk_Size * Max_Chunks);
+    if (id % Chunk_Size == 0) {
+        chunks[id / Chunk_Size] = new Symbol_Entry[Chunk_Size];
+    }
+    
+    // interned for as long as the program runs
+    char *copy = static_cast<char *>(malloc(size + 1));
+    memcpy(copy, data, size);
+    copy[size] = '\0';
+    chunks[id / Chunk_Size][id % Chunk_Size] = { copy, size };
+    symbol_ids[std::string_view(copy, size)] = id;
+    
+    symbol._id = id;
+    return symbol;
+}
+
+Symbol Symbol::intern(const char *data) {
+    return intern(data, strlen(data));
+}
+
+Symbol Symbol::intern(const String &s) {
+    return intern(s.c_str(), s.size());
+}
+
+const char *Symbol::c_str() const {
+    return entry(_id).data;
+}
+
+size_t Symbol::size() const {
+    return entry(_id).size;
+}
+
+std::string Symbol::str() const {
+    auto &e = entry(_id);
+    return { e.data, e.size };
+}
+
+String Symbol::string() const {
+    auto &e = entry(_id);
+    return { const_cast<char *>(e.data), e.size };
+}
+
+bool Symbol::operator==(const char *other) const {
+    auto &e = entry(_id);
+    return strncmp(e.data, other, e.size) == 0 && other[e.size] == '\0';
+}
+
+bool Symbol::operator!=(const char *other) const {
+    return !(*this == other);
+}
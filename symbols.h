@@ -0,0 +1,53 @@
+//
+//  symbols.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+#include "String.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+
+//
+// An identifier interned in the symbol table. Identifiers are interned as
+// they're tokenized, so every identifier spelt the same way is the same
+// Symbol and looking one up by name is hashing and comparing an integer.
+// Interning is thread-safe as imports are tokenized on several threads.
+//
+// A default Symbol is the empty identifier.
+//
+class Symbol {
+    uint32_t _id = 0;
+
+public:
+    Symbol() = default;
+
+    static Symbol intern(const char *data, size_t size);
+    static Symbol intern(const char *data);
+    static Symbol intern(const String &s);
+
+    uint32_t id() const { return _id; }
+    const char *c_str() const;
+    size_t size() const;
+    std::string str() const;
+    String string() const; // a String over the interned characters, don't free it
+
+    bool operator==(Symbol other) const { return _id == other._id; }
+    bool operator!=(Symbol other) const { return _id != other._id; }
+    bool operator==(const char *other) const;
+    bool operator!=(const char *other) const;
+};
+
+namespace std {
+    template<>
+    struct hash<Symbol> {
+        size_t operator()(Symbol s) const { return s.id(); }
+    };
+}
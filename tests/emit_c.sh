@@ -0,0 +1,48 @@
+#!/bin/sh
+# Compiles every example to C with --emit-c, builds it against the runtime and
+# checks it prints what running the example with fox does. Run from the
+# repository root. FOX and CC pick the fox binary and C compiler to use.
+
+FOX=${FOX:-fox}
+CC=${CC:-cc}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+passed=0
+failed=0
+skipped=0
+for example in examples/*.fox; do
+	"$FOX" "$example" > "$tmp/expected.txt" 2>&1
+
+	if ! "$FOX" --emit-c "$tmp/out.c" "$example" > "$tmp/emit.txt" 2>&1; then
+		# it doesn't compile at all, as long as it fails the same way either way
+		if cmp -s "$tmp/emit.txt" "$tmp/expected.txt"; then
+			echo "skipped $example, it doesn't compile"
+			skipped=$((skipped + 1))
+		else
+			echo "FAILED $example, --emit-c failed:"
+			cat "$tmp/emit.txt"
+			failed=$((failed + 1))
+		fi
+		continue
+	fi
+
+	if ! "$CC" -O1 -I runtime "$tmp/out.c" -o "$tmp/out" -lm > "$tmp/cc.txt" 2>&1; then
+		echo "FAILED $example, the C didn't build:"
+		cat "$tmp/cc.txt"
+		failed=$((failed + 1))
+		continue
+	fi
+
+	"$tmp/out" > "$tmp/actual.txt" 2>&1
+	if cmp -s "$tmp/actual.txt" "$tmp/expected.txt"; then
+		passed=$((passed + 1))
+	else
+		echo "FAILED $example, the output differs:"
+		diff "$tmp/expected.txt" "$tmp/actual.txt"
+		failed=$((failed + 1))
+	fi
+done
+
+echo "$passed passed, $failed failed, $skipped skipped"
+[ "$failed" -eq 0 ]
@@ -12,6 +12,12 @@
 #include "utf8.h"
 #include "mem.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 void Token::print() const {
     switch (kind) {
         case Token_Kind::Eof:
@@ -42,7 +48,7 @@ void Token::print() const {
             printf("String \"%.*s\"", data.s.size(), data.s.c_str());
             break;
         case Token_Kind::Ident:
-            printf("Ident `%.*s`", data.s.size(), data.s.c_str());
+            printf("Ident `%.*s`", data.id.size(), data.id.c_str());
             break;
         case Token_Kind::Semi:
             printf("Semi");
@@ -256,13 +262,125 @@ static Token err_token(const char *err, ...) {
     return t;
 }
 
+//
+// Runs of ASCII whitespace, identifier characters and the insides of comments and
+// string literals are skipped a block of bytes at a time, 32 with AVX2, 16 with SSE2
+// and one at a time otherwise. A run stops at the first byte that isn't ASCII and the
+// tokenizer decodes that character the slow way.
+//
+enum Char_Class : uint8_t {
+    Whitespace   = 1 << 0,
+    Ident_Body   = 1 << 1,
+    Comment_Body = 1 << 2, // anything but the newline that ends the comment
+    String_Body  = 1 << 3, // anything but '"', '\\' and newlines
+};
+
+static constexpr uint8_t ascii_class(uint8_t c) {
+    uint8_t cls = 0;
+    if (c >= 0x80) return cls;
+    if (c == ' ' || (c >= '\t' && c <= '\r')) cls |= Whitespace;
+    if (c == '_' || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) cls |= Ident_Body;
+    if (c != '\n') cls |= Comment_Body;
+    if (c != '\n' && c != '"' && c != '\\') cls |= String_Body;
+    return cls;
+}
+
+struct Char_Classes {
+    uint8_t of[256];
+    
+    constexpr Char_Classes() : of() {
+        for (int c = 0; c < 256; c++) {
+            of[c] = ascii_class(c);
+        }
+    }
+};
+
+static constexpr Char_Classes char_classes;
+
+#if defined(__AVX2__)
+using Block = __m256i;
+using Block_Bits = uint32_t;
+
+static inline Block load_block(const char *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+static inline Block splat(char c) { return _mm256_set1_epi8(c); }
+static inline Block equal(Block a, Block b) { return _mm256_cmpeq_epi8(a, b); }
+static inline Block either(Block a, Block b) { return _mm256_or_si256(a, b); }
+static inline Block minimum(Block a, Block b) { return _mm256_min_epu8(a, b); }
+static inline Block subtract(Block a, Block b) { return _mm256_sub_epi8(a, b); }
+static inline Block_Bits bits(Block b) { return static_cast<Block_Bits>(_mm256_movemask_epi8(b)); }
+#define FOX_LEX_BLOCKS 1
+#elif defined(__SSE2__)
+using Block = __m128i;
+using Block_Bits = uint32_t;
+
+static inline Block load_block(const char *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+static inline Block splat(char c) { return _mm_set1_epi8(c); }
+static inline Block equal(Block a, Block b) { return _mm_cmpeq_epi8(a, b); }
+static inline Block either(Block a, Block b) { return _mm_or_si128(a, b); }
+static inline Block minimum(Block a, Block b) { return _mm_min_epu8(a, b); }
+static inline Block subtract(Block a, Block b) { return _mm_sub_epi8(a, b); }
+static inline Block_Bits bits(Block b) { return static_cast<Block_Bits>(_mm_movemask_epi8(b)); }
+#define FOX_LEX_BLOCKS 1
+#endif
+
+#if FOX_LEX_BLOCKS
+static constexpr size_t Block_Size = sizeof(Block);
+static constexpr Block_Bits All_Bits = static_cast<Block_Bits>((1ull << Block_Size) - 1);
+
+// lo <= byte <= hi, comparing as unsigned so bytes past ASCII are never in range
+static inline Block in_range(Block b, char lo, char hi) {
+    auto offset = subtract(b, splat(lo));
+    return equal(minimum(offset, splat(hi - lo)), offset);
+}
+
+// a bit set for each byte in the block that's in the class
+template<Char_Class cls>
+static inline Block_Bits in_class(Block b) {
+    if constexpr (cls == Whitespace) {
+        return bits(either(equal(b, splat(' ')), in_range(b, '\t', '\r')));
+    } else if constexpr (cls == Ident_Body) {
+        auto letter = in_range(either(b, splat(0x20)), 'a', 'z');
+        auto digit = in_range(b, '0', '9');
+        return bits(either(either(letter, digit), equal(b, splat('_'))));
+    } else if constexpr (cls == Comment_Body) {
+        return ~(bits(equal(b, splat('\n'))) | bits(b)) & All_Bits;
+    } else {
+        auto end = either(either(equal(b, splat('"')), equal(b, splat('\\'))), equal(b, splat('\n')));
+        return ~(bits(end) | bits(b)) & All_Bits;
+    }
+}
+#endif
+
+// how many bytes from p on are in the class
+template<Char_Class cls>
+static size_t span(const char *p, const char *end) {
+    const char *it = p;
+#if FOX_LEX_BLOCKS
+    while (static_cast<size_t>(end - it) >= Block_Size) {
+        auto in = in_class<cls>(load_block(it));
+        if (in != All_Bits) {
+            return (it - p) + __builtin_ctz(~in);
+        }
+        it += Block_Size;
+    }
+#endif
+    while (it != end && (char_classes.of[static_cast<uint8_t>(*it)] & cls)) {
+        it++;
+    }
+    return it - p;
+}
+
+static bool is_ascii(char c) {
+    return static_cast<uint8_t>(c) < 0x80;
+}
+
 struct Tokenizer {
     char *cur;
     char *end;
     const char *filename;
     size_t current_line;
     size_t current_column;
-    std::vector<Token> tokens;
+    Token_Kind previous = Token_Kind::Eof; // nothing's been tokenized yet
     
     bool has_more() const {
         return cur != end;
@@ -277,7 +395,12 @@ struct Tokenizer {
     }
     
     char32_t next() {
-        char32_t c = utf8::next(cur, end);
+        char32_t c;
+        if (cur != end && is_ascii(*cur)) {
+            c = *cur++;
+        } else {
+            c = utf8::next(cur, end);
+        }
         current_column++;
         if (c == '\n') {
             current_line++;
@@ -287,6 +410,7 @@ struct Tokenizer {
     }
     
     char32_t peek() const {
+        if (is_ascii(*cur)) return *cur;
         return utf8::unchecked::peek_next(cur);
     }
     
@@ -345,21 +469,38 @@ struct Tokenizer {
         return true;
     }
     
+    // for runs that are all ASCII and have no newlines in them
+    void skip(size_t n) {
+        cur += n;
+        current_column += n;
+    }
+    
     void skip_whitespace() {
-        while ((isspace(peek()) || check("//")) && has_more()) {
-            if (check("//")) {
-                while (!check('\n') && has_more()) {
-                    // keep getting next until we've passed the new line
-                    next();
+        while (has_more()) {
+            size_t n = span<Whitespace>(cur, end);
+            for (size_t i = 0; i < n; i++) {
+                current_column++;
+                if (cur[i] == '\n') {
+                    current_line++;
+                    current_column = 0;
                 }
             }
-            if (!check('\0')) next();
+            cur += n;
+            
+            if (!has_more() || !check("//")) break;
+            
+            // leaves the new line for the next run of whitespace
+            while (true) {
+                skip(span<Comment_Body>(cur, end));
+                if (!has_more() || check('\n')) break;
+                next();
+            }
         }
     }
 };
 
-static bool might_evaluate_to_a_tuple(Token tok) {
-    switch (tok.kind) {
+static bool might_evaluate_to_a_tuple(Token_Kind kind) {
+    switch (kind) {
         case Token_Kind::Ident:
         case Token_Kind::Right_Paren:
         case Token_Kind::Right_Bracket:
@@ -373,11 +514,8 @@ static bool is_beginning_of_number(Tokenizer &t) {
         return true;
     
     bool result = false;
-    if (t.tokens.empty()) {
-        result = t.check('.') && isdigit(t.peek(1));
-    } else if (t.check('.')) {
-        auto previous = t.tokens.back();
-        bool maybe_tuple = might_evaluate_to_a_tuple(previous);
+    if (t.check('.')) {
+        bool maybe_tuple = might_evaluate_to_a_tuple(t.previous);
         result = !maybe_tuple && isdigit(t.peek(1));
     }
     
@@ -526,7 +664,11 @@ static Token string(Tokenizer &t) {
     char *word = t.cur;
     char *word_end = t.cur;
     bool escape_sequences = false;
-    while (!t.check('"')) {
+    while (true) {
+        t.skip(span<String_Body>(t.cur, t.end));
+        word_end = t.cur;
+        if (t.check('"')) break;
+        
         if (t.check('\\')) {
             escape_sequences = true;
             t.next();
@@ -669,7 +811,8 @@ static Token punctuation(Tokenizer &t) {
 }
 
 static bool is_ident_continue(char32_t c) {
-    return c == '_' || !(ispunct(c) || isspace(c) || isblank(c) || iscntrl(c));
+    if (c < 0x80) return char_classes.of[c] & Ident_Body;
+    return !(ispunct(c) || isspace(c) || isblank(c) || iscntrl(c));
 }
 
 static bool is_ident_begin(char32_t c) {
@@ -677,10 +820,14 @@ static bool is_ident_begin(char32_t c) {
 }
 
 static Token identifier_or_keyword(Tokenizer &t) {
-    bool raw = t.match("r#");
+    bool raw = t.check("r#");
+    if (raw) t.skip(2);
     char *_word = t.cur;
     char *_word_end = t.cur;
-    while (is_ident_continue(t.peek())) {
+    while (true) {
+        t.skip(span<Ident_Body>(t.cur, t.end));
+        _word_end = t.cur;
+        if (is_ascii(*t.cur) || !is_ident_continue(t.peek())) break;
         t.next();
         _word_end = t.cur;
     }
@@ -690,7 +837,7 @@ static Token identifier_or_keyword(Tokenizer &t) {
     
     if (raw) {
         tok.kind = Token_Kind::Ident;
-        tok.data.s = word;
+        tok.data.id = Symbol::intern(word);
     } else if (word == "_") {
         tok.kind = Token_Kind::Underscore;
     } else if (word == "true") {
@@ -747,7 +894,7 @@ static Token identifier_or_keyword(Tokenizer &t) {
         tok.kind = Token_Kind::Vararg;
     } else {
         tok.kind = Token_Kind::Ident;
-        tok.data.s = word;
+        tok.data.id = Symbol::intern(word);
     }
     
     return tok;
@@ -772,16 +919,87 @@ static Token next_token(Tokenizer &t) {
     return tok;
 }
 
-std::vector<Token> tokenize(String source, const char *filename) {
-    auto t = Tokenizer { source.begin(), source.end(), filename };
+static Token scan_token(Tokenizer &t) {
+    t.skip_whitespace();
+    if (!t.has_more()) {
+        return eof_token(t.current_location());
+    }
     
-    while (true) {
-        t.skip_whitespace();
-        if (!t.has_more()) break;
-        t.tokens.push_back(next_token(t));
+    auto tok = next_token(t);
+    t.previous = tok.kind;
+    return tok;
+}
+
+Token_Stream::Token_Stream(String source, const char *filename) {
+    tokenizer = new Tokenizer { source.begin(), source.end(), filename };
+    ring.resize(Initial_Capacity);
+}
+
+Token_Stream::~Token_Stream() {
+    delete tokenizer;
+}
+
+Token Token_Stream::peek(size_t n) {
+    if (current + n >= scanned) {
+        scan(current + n + 1);
+    }
+    return ring[(current + n) & (ring.size() - 1)];
+}
+
+Token Token_Stream::next() {
+    auto t = peek();
+    if (t.kind != Token_Kind::Eof) {
+        current++;
+    }
+    return t;
+}
+
+Token Token_Stream::previous() const {
+    internal_verify(current > 0, "Asked for the token before the first one.");
+    return ring[(current - 1) & (ring.size() - 1)];
+}
+
+void Token_Stream::back_up() {
+    internal_verify(current > 0, "Tried to back up before the first token.");
+    current--;
+}
+
+size_t Token_Stream::save() {
+    internal_verify(saved == Nothing_Saved, "Token_Stream::save() called while another save is active.");
+    saved = current;
+    return saved;
+}
+
+void Token_Stream::restore(size_t saved) {
+    internal_verify(saved == this->saved, "Restored a Token_Stream to a point that wasn't saved.");
+    current = saved;
+    this->saved = Nothing_Saved;
+}
+
+void Token_Stream::scan(size_t count) {
+    while (scanned < count) {
+        // keeps the previous token and anything saved
+        size_t first_kept = std::min(saved, current > 0 ? current - 1 : 0);
+        if (scanned - first_kept == ring.size()) {
+            std::vector<Token> grown(ring.size() * 2);
+            for (size_t i = first_kept; i < scanned; i++) {
+                grown[i & (grown.size() - 1)] = ring[i & (ring.size() - 1)];
+            }
+            ring = std::move(grown);
+        }
+        
+        ring[scanned & (ring.size() - 1)] = scan_token(*tokenizer);
+        scanned++;
     }
+}
+
+std::vector<Token> tokenize(String source, const char *filename) {
+    auto t = Tokenizer { source.begin(), source.end(), filename };
     
-    t.tokens.push_back(eof_token(t.current_location()));
+    std::vector<Token> tokens;
+    do {
+        tokens.push_back(scan_token(t));
+    } while (tokens.back().kind != Token_Kind::Eof);
     
-    return t.tokens;
+    return tokens;
 }
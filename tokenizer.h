@@ -8,6 +8,7 @@
 
 #pragma once
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 #include "String.h"
 #include "definitions.h"
@@ -103,6 +104,9 @@ union Token_Data {
     double f;
     char32_t c;
     String s;
+    Symbol id; // of identifiers
+
+    Token_Data() : i(0) {}
 };
 
 struct Token {
@@ -113,4 +117,39 @@ struct Token {
     void print() const;
 };
 
+//
+// Tokenizes a source file as the parser asks for tokens rather than all at
+// once. Tokens that have been peeked at are kept in a ring buffer, which
+// only grows when the parser looks further ahead than it holds, along with
+// the token before the current one.
+//
+struct Token_Stream {
+    Token_Stream(String source, const char *filename);
+    ~Token_Stream();
+    Token_Stream(const Token_Stream &) = delete;
+    Token_Stream &operator=(const Token_Stream &) = delete;
+    
+    Token peek(size_t n = 0);
+    Token next();
+    Token previous() const;
+    void back_up(); // the previous token becomes the current one again
+    
+    // Every token from a save() on is kept until it's restored, one at a time.
+    size_t save();
+    void restore(size_t saved);
+    
+private:
+    static constexpr size_t Initial_Capacity = 16;
+    static constexpr size_t Nothing_Saved = SIZE_MAX;
+    
+    struct Tokenizer *tokenizer;
+    std::vector<Token> ring; // its size is always a power of 2
+    size_t current = 0; // counts of tokens since the start of the file
+    size_t scanned = 0;
+    size_t saved = Nothing_Saved;
+    
+    void scan(size_t count);
+};
+
+// All at once, for the debug token dump.
 std::vector<Token> tokenize(String source, const char *filename);
@@ -10,11 +10,37 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <vector>
 
 using Size = uint16_t;
 using Address = uint16_t;
 using UUID = uint64_t;
 
+// bytecode operands
+using Short_Jump = uint16_t;
+using Long_Jump = uint32_t;
+using Constant_Index = uint32_t;
+using Builtin_Index = uint16_t;
+using Function_Index = uint32_t;
+
+// Bytes owned by something else, a vector or a mapped image.
+class Byte_Span {
+    const uint8_t *_data = nullptr;
+    size_t _size = 0;
+    
+public:
+    Byte_Span() = default;
+    Byte_Span(const uint8_t *data, size_t size) : _data(data), _size(size) {}
+    Byte_Span(const std::vector<uint8_t> &bytes) : _data(bytes.data()), _size(bytes.size()) {}
+    
+    inline const uint8_t *data() const { return _data; }
+    inline size_t size() const { return _size; }
+    inline bool empty() const { return _size == 0; }
+    inline const uint8_t *begin() const { return _data; }
+    inline const uint8_t *end() const { return _data + _size; }
+    inline const uint8_t &operator[](size_t idx) const { return _data[idx]; }
+};
+
 struct utf8char_t {
     char buf[5]; // 5 for null-terminator
     static utf8char_t from_char32(char32_t c);
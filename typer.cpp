@@ -53,17 +53,13 @@ bool Typed_AST_Float::is_constant(Compiler &c) {
     return true;
 }
 
-Typed_AST_Ident::Typed_AST_Ident(String id, Value_Type type, Code_Location location) {
+Typed_AST_Ident::Typed_AST_Ident(Symbol id, Value_Type type, Code_Location location) {
     kind = Typed_AST_Kind::Ident;
     this->type = type;
     this->id = id;
     this->location = location;
 }
 
-Typed_AST_Ident::~Typed_AST_Ident() {
-    id.free();
-}
-
 bool Typed_AST_Ident::is_constant(Compiler &c) {
     auto [status, _] = c.find_variable(id);
     return status == Find_Variable_Result::Found_Constant;
@@ -191,16 +187,12 @@ bool Typed_AST_Return::is_constant(Compiler &c) {
     return sub ? sub->is_constant(c) : true;
 }
 
-Typed_AST_Loop_Control::Typed_AST_Loop_Control(Typed_AST_Kind kind, String label, Code_Location location) {
+Typed_AST_Loop_Control::Typed_AST_Loop_Control(Typed_AST_Kind kind, Symbol label, Code_Location location) {
     this->kind = kind;
     this->label = label;
     this->location = location;
 }
 
-Typed_AST_Loop_Control::~Typed_AST_Loop_Control() {
-    label.free();
-}
-
 bool Typed_AST_Loop_Control::is_constant(Compiler &c) {
     return true;
 }
@@ -336,14 +328,8 @@ Typed_AST_Processed_Pattern::Typed_AST_Processed_Pattern(Code_Location location)
     this->location = location;
 }
 
-Typed_AST_Processed_Pattern::~Typed_AST_Processed_Pattern() {
-    for (auto &b : bindings) {
-        b.id.free();
-    }
-}
-
 void Typed_AST_Processed_Pattern::add_binding(
-    String id,
+    Symbol id,
     Value_Type type,
     bool is_mut)
 {
@@ -382,7 +368,7 @@ void Typed_AST_Match_Pattern::add_value_binding(Ref<Typed_AST> binding, Size off
 }
 
 void Typed_AST_Match_Pattern::add_variable_binding(
-    String id,
+    Symbol id,
     Value_Type type,
     Size offset)
 {
@@ -436,7 +422,7 @@ Typed_AST_For::Typed_AST_For(
     Typed_AST_Kind kind,
     Ref<Typed_AST_Ident> label,
     Ref<Typed_AST_Processed_Pattern> target,
-    String counter,
+    Symbol counter,
     Ref<Typed_AST> iterable,
     Ref<Typed_AST_Multiary> body, 
     Code_Location location)
@@ -450,10 +436,6 @@ Typed_AST_For::Typed_AST_For(
     this->location = location;
 }
 
-Typed_AST_For::~Typed_AST_For() {
-    counter.free();
-}
-
 bool Typed_AST_For::is_constant(Compiler &c) {
     return iterable->is_constant(c) && body->is_constant(c);
 }
@@ -1077,7 +1059,7 @@ struct Typer_Binding {
 };
 
 struct Typer_Scope {
-    std::unordered_map<std::string, Typer_Binding> bindings;
+    std::unordered_map<Symbol, Typer_Binding> bindings;
 };
 
 struct Typer {
@@ -1120,7 +1102,7 @@ struct Typer {
         scopes.pop_front();
     }
     
-    bool find_binding_by_id(const std::string &id, Typer_Binding &out_binding) {
+    bool find_binding_by_id(Symbol id, Typer_Binding &out_binding) {
         for (auto &s : scopes) {
             auto it = s.bindings.find(id);
             if (it == s.bindings.end()) continue;
@@ -1144,7 +1126,7 @@ struct Typer {
     }
     
     bool find_non_variable_binding_by_id_in_parent(
-        const std::string &id,
+        Symbol id,
         Typer_Binding &out_binding)
     {
         for (auto &s : parent->scopes) {
@@ -1162,7 +1144,7 @@ struct Typer {
         return false;
     }
     
-    void put_binding(const std::string &id, Typer_Binding binding, Code_Location location) {
+    void put_binding(Symbol id, Typer_Binding binding, Code_Location location) {
         auto &cs = current_scope();
         
         auto it = cs.bindings.find(id);
@@ -1171,22 +1153,22 @@ struct Typer {
         cs.bindings[id] = binding;
     }
     
-    void bind_variable(const std::string &id, Value_Type type, bool is_mut, Code_Location location) {
+    void bind_variable(Symbol id, Value_Type type, bool is_mut, Code_Location location) {
         type.is_mut = is_mut;
         return put_binding(id, Typer_Binding::variable(type), location);
     }
     
-    void bind_type(const std::string &id, Value_Type type, Code_Location location) {
+    void bind_type(Symbol id, Value_Type type, Code_Location location) {
         internal_verify(type.kind == Value_Type_Kind::Type, "Attempted to bind a type name to something other than a type.");
         return put_binding(id, Typer_Binding::type(type), location);
     }
     
-    void bind_function(const std::string &id, UUID uuid, Value_Type fn_type, Code_Location location) {
+    void bind_function(Symbol id, UUID uuid, Value_Type fn_type, Code_Location location) {
         internal_verify(fn_type.kind == Value_Type_Kind::Function, "Attempted to bind a function name to a non-function Value_Type.");
         return put_binding(id, Typer_Binding::function(uuid, fn_type), location);
     }
     
-    void bind_module(const std::string &id, Module *module, Code_Location location) {
+    void bind_module(Symbol id, Module *module, Code_Location location) {
         return put_binding(id, Typer_Binding::module(module), location);
     }
     
@@ -1248,12 +1230,12 @@ struct Typer {
     {
         switch (pattern->kind) {
             case Untyped_AST_Kind::Pattern_Underscore:
-                out_pp->add_binding("", type, false);
+                out_pp->add_binding(Symbol{}, type, false);
                 break;
             case Untyped_AST_Kind::Pattern_Ident: {
                 auto ip = pattern.cast<Untyped_AST_Pattern_Ident>();
-                out_pp->add_binding(ip->id.clone(), type, ip->is_mut);
-                bind_variable(ip->id.str(), type, ip->is_mut, ip->location);
+                out_pp->add_binding(ip->id, type, ip->is_mut);
+                bind_variable(ip->id, type, ip->is_mut, ip->location);
             } break;
             case Untyped_AST_Kind::Pattern_Tuple: {
                 auto tp = pattern.cast<Untyped_AST_Pattern_Tuple>();
@@ -1308,7 +1290,7 @@ struct Typer {
                 Value_Type id_type = type;
                 id_type.is_mut = ip->is_mut;
                 out_mp->add_variable_binding(ip->id, id_type, offset);
-                bind_variable(ip->id.str(), id_type, ip->is_mut, ip->location);
+                bind_variable(ip->id, id_type, ip->is_mut, ip->location);
             } break;
             case Untyped_AST_Kind::Pattern_Tuple: {
                 auto tp = pattern.cast<Untyped_AST_Pattern_Tuple>();
@@ -1466,9 +1448,8 @@ Ref<Typed_AST> Untyped_AST_Float::typecheck(Typer &t) {
 }
 
 Ref<Typed_AST> Untyped_AST_Ident::typecheck(Typer &t) {
-    auto sid = id.str();
     Typer_Binding binding;
-    verify(t.find_binding_by_id(sid, binding), location, "Unresolved identifier '%s'.", sid.c_str());
+    verify(t.find_binding_by_id(id, binding), location, "Unresolved identifier '%s'.", id.c_str());
     Ref<Typed_AST> ident;
     switch (binding.kind) {
         case Typer_Binding::Type: {
@@ -1496,7 +1477,7 @@ Ref<Typed_AST> Untyped_AST_Ident::typecheck(Typer &t) {
         } break;
             
         default:
-            ident = Mem.make<Typed_AST_Ident>(id.clone(), binding.value_type, location);
+            ident = Mem.make<Typed_AST_Ident>(id, binding.value_type, location);
             break;
     }
 
@@ -1539,7 +1520,7 @@ Ref<Typed_AST> typecheck_ident_in_namespace<Enum_Definition>(
 {
     Ref<Typed_AST> typechecked;
     
-    String variant_id = id->id;
+    Symbol variant_id = id->id;
     auto variant = defn->find_variant(variant_id);
     
     if (variant) {
@@ -1578,7 +1559,7 @@ Ref<Typed_AST> typecheck_ident_in_namespace<Module>(
     Ref<Untyped_AST_Ident> id)
 {
     Module::Member m;
-    verify(module->find_member_by_id(id->id.str(), m), id->location, "'%s' cannot be found in the '%s' module.", module->module_path.c_str());
+    verify(module->find_member_by_id(id->id, m), id->location, "'%s' cannot be found in the '%s' module.", id->id.c_str(), module->module_path.c_str());
     
     Ref<Typed_AST_UUID> typechecked;
     switch (m.kind) {
@@ -1765,15 +1746,15 @@ Ref<Typed_AST> Untyped_AST_Unary::typecheck(Typer &t) {
             Builtin_Definition *defn = nullptr;
             switch (sub->type.kind) {
                 case Value_Type_Kind::Ptr:
-                    defn = t.interp->builtins.get_builtin("<free-ptr>");
+                    defn = t.interp->builtins.get_builtin(Symbol::intern("<free-ptr>"));
                     internal_verify(defn, "Failed to retrieve <free-ptr> builtin.");
                     break;
                 case Value_Type_Kind::Slice:
-                    defn = t.interp->builtins.get_builtin("<free-slice>");
+                    defn = t.interp->builtins.get_builtin(Symbol::intern("<free-slice>"));
                     internal_verify(defn, "Failed to retrieve <free-slice> builtin.");
                     break;
                 case Value_Type_Kind::Str:
-                    defn = t.interp->builtins.get_builtin("<free-str>");
+                    defn = t.interp->builtins.get_builtin(Symbol::intern("<free-str>"));
                     internal_verify(defn, "Failed to retrieve <free-str> builtin.");
                     break;
 
@@ -1816,7 +1797,7 @@ Ref<Typed_AST> Untyped_AST_Return::typecheck(Typer &t) {
 }
 
 Ref<Typed_AST> Untyped_AST_Loop_Control::typecheck(Typer &t) {
-    return Mem.make<Typed_AST_Loop_Control>(to_typed(kind), label.clone(), location);
+    return Mem.make<Typed_AST_Loop_Control>(to_typed(kind), label, location);
 }
 
 enum class Skip_Receiver {
@@ -1853,7 +1834,7 @@ static void typecheck_function_call_arguments(
             
             auto arg_bin = arg_node.cast<Untyped_AST_Binary>();
             auto arg_id_node = arg_bin->lhs.cast<Untyped_AST_Ident>();
-            String arg_id = arg_id_node->id;
+            Symbol arg_id = arg_id_node->id;
             
             arg_pos = -1;
             for (size_t i = 0; i < defn->param_names.size(); i++) {
@@ -2489,7 +2470,7 @@ Ref<Typed_AST> Untyped_AST_Binary::typecheck(Typer &t) {
             verify(type->value_type->kind == Value_Type_Kind::Ptr, type->location, "'@alloc' must return a pointer type.");
             verify(rhs->type.kind == Value_Type_Kind::Int, rhs->location, "'@alloc' requires its second operand to be of type 'int' but was given '%s'.", rhs->type.display_str());
             
-            auto defn = t.interp->builtins.get_builtin("alloc");
+            auto defn = t.interp->builtins.get_builtin(Symbol::intern("alloc"));
             internal_verify(defn, "Could't retrieve '@alloc' builtin.");
             auto alloc = Mem.make<Typed_AST_Builtin>(defn, type->value_type.as_ptr(), location);
             
@@ -2605,9 +2586,8 @@ Ref<Typed_AST> Untyped_AST_Struct_Literal::typecheck(Typer &t) {
 }
 
 Ref<Typed_AST> Untyped_AST_Builtin::typecheck(Typer &t) {
-    auto sid = id.str();
-    auto defn = t.interp->builtins.get_builtin(sid);
-    verify(defn, location, "'@%s' is not a builtin.", sid.c_str());
+    auto defn = t.interp->builtins.get_builtin(id);
+    verify(defn, location, "'@%s' is not a builtin.", id.c_str());
     
     return Mem.make<Typed_AST_Builtin>(defn, nullptr, location);
 }
@@ -2619,42 +2599,42 @@ Ref<Typed_AST> Untyped_AST_Builtin_Printlike::typecheck(Typer &t) {
     Ref<Typed_AST> printlike = nullptr;
     switch (arg->type.kind) {
         case Value_Type_Kind::Byte: {
-            auto defn = t.interp->builtins.get_builtin(is_puts ? "<puts-byte>" : "<print-byte>");
+            auto defn = t.interp->builtins.get_builtin(Symbol::intern(is_puts ? "<puts-byte>" : "<print-byte>"));
             internal_verify(defn, "Failed to retrieve builtin");
             printlike = Mem.make<Typed_AST_Builtin>(defn, nullptr, location);
         } break;
         case Value_Type_Kind::Bool: {
-            auto defn = t.interp->builtins.get_builtin(is_puts ? "<puts-bool>" : "<print-bool>");
+            auto defn = t.interp->builtins.get_builtin(Symbol::intern(is_puts ? "<puts-bool>" : "<print-bool>"));
             internal_verify(defn, "Failed to retrieve builtin");
             printlike = Mem.make<Typed_AST_Builtin>(defn, nullptr, location);
         } break;
         case Value_Type_Kind::Char: {
-            auto defn = t.interp->builtins.get_builtin(is_puts ? "<puts-char>" : "<print-char>");
+            auto defn = t.interp->builtins.get_builtin(Symbol::intern(is_puts ? "<puts-char>" : "<print-char>"));
             internal_verify(defn, "Failed to retrieve builtin");
             printlike = Mem.make<Typed_AST_Builtin>(defn, nullptr, location);
         } break;
         case Value_Type_Kind::Int: {
-            auto defn = t.interp->builtins.get_builtin(is_puts ? "<puts-int>" : "<print-int>");
+            auto defn = t.interp->builtins.get_builtin(Symbol::intern(is_puts ? "<puts-int>" : "<print-int>"));
             internal_verify(defn, "Failed to retrieve builtin");
             printlike = Mem.make<Typed_AST_Builtin>(defn, nullptr, location);
         } break;
         case Value_Type_Kind::Float: {
-            auto defn = t.interp->builtins.get_builtin(is_puts ? "<puts-float>" : "<print-float>");
+            auto defn = t.interp->builtins.get_builtin(Symbol::intern(is_puts ? "<puts-float>" : "<print-float>"));
             internal_verify(defn, "Failed to retrieve builtin");
             printlike = Mem.make<Typed_AST_Builtin>(defn, nullptr, location);
         } break;
         case Value_Type_Kind::Str: {
-            auto defn = t.interp->builtins.get_builtin(is_puts ? "<puts-str>" : "<print-str>");
+            auto defn = t.interp->builtins.get_builtin(Symbol::intern(is_puts ? "<puts-str>" : "<print-str>"));
             internal_verify(defn, "Failed to retrieve builtin");
             printlike = Mem.make<Typed_AST_Builtin>(defn, nullptr, location);
         } break;
         case Value_Type_Kind::Ptr: {
-            auto defn = t.interp->builtins.get_builtin(is_puts ? "<puts-ptr>" : "<print-ptr>");
+            auto defn = t.interp->builtins.get_builtin(Symbol::intern(is_puts ? "<puts-ptr>" : "<print-ptr>"));
             internal_verify(defn, "Failed to retrieve builtin");
             printlike = Mem.make<Typed_AST_Builtin>(defn, nullptr, location);
         } break;
         case Value_Type_Kind::Struct: {
-            auto defn = t.interp->builtins.get_builtin(is_puts ? "<puts-struct>" : "<print-struct>");
+            auto defn = t.interp->builtins.get_builtin(Symbol::intern(is_puts ? "<puts-struct>" : "<print-struct>"));
             internal_verify(defn, "Failed to retrieve builtin");
             printlike = Mem.make<Typed_AST_Builtin>(defn, nullptr, location);
 
@@ -2670,7 +2650,7 @@ Ref<Typed_AST> Untyped_AST_Builtin_Printlike::typecheck(Typer &t) {
             arg = args;
         } break;
         case Value_Type_Kind::Enum: {
-            auto defn = t.interp->builtins.get_builtin(is_puts ? "<puts-enum>" : "<print-enum>");
+            auto defn = t.interp->builtins.get_builtin(Symbol::intern(is_puts ? "<puts-enum>" : "<print-enum>"));
             internal_verify(defn, "Failed to retrieve builtin");
             printlike = Mem.make<Typed_AST_Builtin>(defn, nullptr, location);
 
@@ -2761,7 +2741,7 @@ Ref<Typed_AST> Untyped_AST_Type_Signature::typecheck(Typer &t) {
 Ref<Typed_AST> Untyped_AST_While::typecheck(Typer &t) {
     Ref<Typed_AST_Ident> label = nullptr;
     if (this->label) {
-        label = Mem.make<Typed_AST_Ident>(this->label->id.clone(), value_types::None, this->label->location);
+        label = Mem.make<Typed_AST_Ident>(this->label->id, value_types::None, this->label->location);
     }
 
     auto cond = condition->typecheck(t);
@@ -2777,7 +2757,7 @@ Ref<Typed_AST> Untyped_AST_While::typecheck(Typer &t) {
 Ref<Typed_AST> Untyped_AST_For::typecheck(Typer &t) {
     Ref<Typed_AST_Ident> label = nullptr;
     if (this->label) {
-        label = Mem.make<Typed_AST_Ident>(this->label->id.clone(), value_types::None, this->label->location);
+        label = Mem.make<Typed_AST_Ident>(this->label->id, value_types::None, this->label->location);
     }
 
     auto iterable = this->iterable->typecheck(t);
@@ -2801,7 +2781,7 @@ Ref<Typed_AST> Untyped_AST_For::typecheck(Typer &t) {
     t.bind_pattern(target, *target_type, processed_target);
     
     if (counter != "") {
-        t.bind_variable(counter.str(), value_types::Int, false, location);
+        t.bind_variable(counter, value_types::Int, false, location);
     }
     
     auto body = this->body->typecheck(t);
@@ -2816,7 +2796,7 @@ Ref<Typed_AST> Untyped_AST_For::typecheck(Typer &t) {
             Typed_AST_Kind::For,
         label,
         processed_target,
-        counter.clone(),
+        counter,
         iterable,
         body.cast<Typed_AST_Multiary>(),
         location
@@ -2826,7 +2806,7 @@ Ref<Typed_AST> Untyped_AST_For::typecheck(Typer &t) {
 Ref<Typed_AST> Untyped_AST_Forever::typecheck(Typer &t) {
     Ref<Typed_AST_Ident> label = nullptr;
     if (this->label) {
-        label = Mem.make<Typed_AST_Ident>(this->label->id.clone(), value_types::None, this->label->location);
+        label = Mem.make<Typed_AST_Ident>(this->label->id, value_types::None, this->label->location);
     }
 
     auto body = this->body->typecheck(t).cast<Typed_AST_Multiary>();
@@ -2922,12 +2902,12 @@ Ref<Typed_AST> Untyped_AST_Struct_Declaration::typecheck(Typer &t) {
     Struct_Definition defn;
     defn.module = t.module;
     defn.uuid = t.interp->next_uuid();
-    defn.name = this->id.clone();
+    defn.name = this->id;
     
     Size current_offset = 0;
     for (auto &f : fields) {
         Struct_Field field;
-        field.id = f.id.clone();
+        field.id = f.id;
         verify(!defn.has_field(field.id), location, "Redefinition of field '%.*s'.", field.id.size(), field.id.c_str());
         field.offset = current_offset;
         field.type = t.resolve_value_type(*f.type->value_type);
@@ -2947,8 +2927,8 @@ Ref<Typed_AST> Untyped_AST_Struct_Declaration::typecheck(Typer &t) {
     type.kind = Value_Type_Kind::Type;
     type.data.type.type = struct_type;
     
-    String id = this->id.clone();
-    t.bind_type(id.str(), type, location);
+    Symbol id = this->id;
+    t.bind_type(id, type, location);
     
     return nullptr;
 }
@@ -2958,7 +2938,7 @@ Ref<Typed_AST> Untyped_AST_Enum_Declaration::typecheck(Typer &t) {
     defn.is_sumtype = false;
     defn.module = t.module;
     defn.uuid = t.interp->next_uuid();
-    defn.name = id.clone();
+    defn.name = id;
     defn.size = value_types::Int.size();
     
     bool is_sumtype = false;
@@ -2966,7 +2946,7 @@ Ref<Typed_AST> Untyped_AST_Enum_Declaration::typecheck(Typer &t) {
         auto &v = variants[i];
         Enum_Variant defn_v;
         defn_v.tag = i;
-        defn_v.id = v.id.clone();
+        defn_v.id = v.id;
         
         if (v.payload) {
             is_sumtype = true;
@@ -3027,8 +3007,8 @@ Ref<Typed_AST> Untyped_AST_Enum_Declaration::typecheck(Typer &t) {
     type.kind = Value_Type_Kind::Type;
     type.data.type.type = enum_type;
     
-    String id = this->id.clone();
-    t.bind_type(id.str(), type, location);
+    Symbol id = this->id;
+    t.bind_type(id, type, location);
     
     return nullptr;
 }
@@ -3060,7 +3040,7 @@ static Trait_Method typecheck_trait_fn_decl_header(
         //
         // @COPYPASTE(typecheck_fn_decl_header)
         //
-        String param_name;
+        Symbol param_name;
         Value_Type param_type;
         switch (param->kind) {
             case Untyped_AST_Kind::Assignment:
@@ -3071,7 +3051,7 @@ static Trait_Method typecheck_trait_fn_decl_header(
                 internal_verify(b, "param in trait fn decl header not a binary node.");
 
                 auto id = b->lhs.cast<Untyped_AST_Pattern_Ident>();
-                param_name = id->id.clone();
+                param_name = id->id;
                 param_type = t.resolve_value_type(*b->rhs.cast<Untyped_AST_Type_Signature>()->value_type);
                 param_type.is_mut = id->is_mut;
             } break;
@@ -3095,13 +3075,13 @@ Ref<Typed_AST> Untyped_AST_Trait_Declaration::typecheck(Typer &t) {
     Trait_Definition _defn;
     _defn.module = t.module;
     _defn.uuid = t.interp->next_uuid();
-    _defn.name = id.clone();
+    _defn.name = id;
 
     Trait_Definition *defn = t.interp->types.add_trait(_defn);
 
     t.begin_scope();
     Value_Type *trait_ty = Mem.make<Value_Type>(value_types::trait(defn, nullptr)).as_ptr();
-    t.bind_type("Self", value_types::type_of(trait_ty), location);
+    t.bind_type(Symbol::intern("Self"), value_types::type_of(trait_ty), location);
 
     for (auto node : body->nodes) {
         switch (node->kind) {
@@ -3139,7 +3119,7 @@ static Function_Definition *typecheck_fn_decl_header(
     defn.varargs = decl.varargs;
     defn.uuid = t.interp->next_uuid();
     defn.module = t.module;
-    defn.name = decl.id.clone();
+    defn.name = decl.id;
 
     Value_Type func_type;
     func_type.kind = Value_Type_Kind::Function;
@@ -3163,7 +3143,7 @@ static Function_Definition *typecheck_fn_decl_header(
         //      Sort out default arguments. (If we do default arguments)
         //
 
-        String param_name;
+        Symbol param_name;
         Value_Type param_type;
         switch (param->kind) {
             case Untyped_AST_Kind::Assignment:
@@ -3172,7 +3152,7 @@ static Function_Definition *typecheck_fn_decl_header(
             case Untyped_AST_Kind::Binding: {
                 auto b = param.cast<Untyped_AST_Binary>();
                 auto id = b->lhs.cast<Untyped_AST_Pattern_Ident>();
-                param_name = id->id.clone();
+                param_name = id->id;
                 param_type = *b->rhs->typecheck(t)
                     .cast<Typed_AST_Type_Signature>()->value_type;
                 param_type.is_mut = id->is_mut;
@@ -3206,12 +3186,12 @@ static Ref<Typed_AST_Fn_Declaration> typecheck_fn_decl_body(
 
     new_t.begin_scope();
     
-    new_t.bind_function(defn->name.str(), defn->uuid, defn->type, decl.location);
+    new_t.bind_function(defn->name, defn->uuid, defn->type, decl.location);
     
     for (size_t i = 0; i < defn->param_names.size(); i++) {
-        String param_name = defn->param_names[i];
+        Symbol param_name = defn->param_names[i];
         Value_Type param_type = defn->type.data.func.arg_types[i];
-        new_t.bind_variable(param_name.str(), param_type, param_type.is_mut, decl.params->nodes[i]->location);
+        new_t.bind_variable(param_name, param_type, param_type.is_mut, decl.params->nodes[i]->location);
     }
 
     auto body = decl.body->typecheck(new_t).cast<Typed_AST_Multiary>();
@@ -3238,7 +3218,7 @@ static Typecheck_Fn_Decl_Result typecheck_fn_decl(
 
 Ref<Typed_AST> Untyped_AST_Fn_Declaration::typecheck(Typer &t) {
     auto [defn, typed_decl] = typecheck_fn_decl(t, *this);
-    t.bind_function(id.str(), defn->uuid, defn->type, location);
+    t.bind_function(id, defn->uuid, defn->type, location);
     t.module->add_func_member(defn);
     return typed_decl;
 }
@@ -3250,7 +3230,7 @@ Ref<Typed_AST> Untyped_AST_Fn_Declaration_Header::typecheck(Typer &t) {
 static Ref<Typed_AST_Multiary> typecheck_impl_declaration(
     Typer &t,
     const char *type_name,
-    std::unordered_map<std::string, Method> &methods,
+    std::unordered_map<Symbol, Method> &methods,
     Ref<Untyped_AST_Multiary> body)
 {
     // Prepass so everything can refer to everything else regardless of order
@@ -3270,10 +3250,9 @@ static Ref<Typed_AST_Multiary> typecheck_impl_declaration(
                 auto decl = node.cast<Untyped_AST_Fn_Declaration>();
                 auto defn = typecheck_fn_decl_header(t, *decl);
                 
-                verify(methods.find(defn->name.c_str()) == methods.end(), node->location, "Cannot have two methods of the same name for one type. Reused name '%s'. Type '%s'.", defn->name.c_str(), type_name);
+                verify(methods.find(defn->name) == methods.end(), node->location, "Cannot have two methods of the same name for one type. Reused name '%s'. Type '%s'.", defn->name.c_str(), type_name);
                 
-                auto fn_sid = defn->name.str();
-                methods[fn_sid] = {
+                methods[defn->name] = {
                     node->kind == Untyped_AST_Kind::Fn_Decl,
                     defn->uuid
                 };
@@ -3317,7 +3296,7 @@ Ref<Typed_AST> typecheck_impl_for_type(Typer &t, Untyped_AST_Impl_Declaration &i
                     internal_verify(defn, "Failed to retrieve Struct_Definition from typebook.");
                     
                     t.begin_scope();
-                    t.bind_type("Self", target->type, target->location);
+                    t.bind_type(Symbol::intern("Self"), target->type, target->location);
                     typechecked = typecheck_impl_declaration(t, defn->name.c_str(), defn->methods, impl.body);
                     t.end_scope();
                 } break;
@@ -3326,7 +3305,7 @@ Ref<Typed_AST> typecheck_impl_for_type(Typer &t, Untyped_AST_Impl_Declaration &i
                     internal_verify(defn, "Failed to retrieve Enum_Definition from typebook.");
                     
                     t.begin_scope();
-                    t.bind_type("Self", target->type, target->location);
+                    t.bind_type(Symbol::intern("Self"), target->type, target->location);
                     typechecked = typecheck_impl_declaration(t, defn->name.c_str(), defn->methods, impl.body);
                     t.end_scope();
                 } break;
@@ -3368,23 +3347,8 @@ struct Module_Path {
     }
 };
 
-static Module_Path generate_module_path_from_symbol(Untyped_AST_Symbol &path) {
-    std::stringstream s;
-    Untyped_AST_Symbol *segment = &path;
-    while (true) {
-        if (segment->kind == Untyped_AST_Kind::Ident) {
-            auto id = dynamic_cast<Untyped_AST_Ident *>(segment);
-            s << id->id.c_str() << ".fox";
-            break;
-        }
-        
-        auto path = dynamic_cast<Untyped_AST_Path *>(segment);
-        s << path->lhs->id.c_str() << "/";
-        
-        segment = path->rhs.as_ptr();
-    }
-    
-    std::string cpp_path_str = s.str();
+static Module_Path generate_module_path(const Untyped_AST_Import_Declaration &import) {
+    std::string cpp_path_str = import.filepath();
     String path_str = String {
         SMem.duplicate(cpp_path_str.c_str(), cpp_path_str.size()),
         cpp_path_str.size()
@@ -3413,15 +3377,16 @@ static Module_Path generate_module_path_from_symbol(Untyped_AST_Symbol &path) {
 }
 
 Ref<Typed_AST> Untyped_AST_Import_Declaration::typecheck(Typer &t) {
-    Module_Path module_path = generate_module_path_from_symbol(*path);
+    Module_Path module_path = generate_module_path(*this);
     Module *module = t.interp->compile_module(module_path.filepath);
+    t.module->imports.push_back({ module, module->interface_hash });
     
     if (rename_id) {
         auto module_name = rename_id->id;
         if (module_name == "*") {
             t.bind_module_members(module, path->location);
         } else {
-            t.bind_module(module_name.str(), module, path->location);
+            t.bind_module(module_name, module, path->location);
         }
     } else if (module_path.segments.size() > 1) {
         char *module_path_start = module_path.segments[0].begin();
@@ -3436,7 +3401,7 @@ Ref<Typed_AST> Untyped_AST_Import_Declaration::typecheck(Typer &t) {
             Module *segment_module = t.interp->get_or_create_module(segment_path);
             
             if (previous_module) {
-                std::string segment_name = segment.str();
+                Symbol segment_name = Symbol::intern(segment);
                 
                 Module::Member member;
                 if (previous_module->find_member_by_id(segment_name, member)) {
@@ -3453,7 +3418,7 @@ Ref<Typed_AST> Untyped_AST_Import_Declaration::typecheck(Typer &t) {
         
         internal_verify(previous_module, "'previous_module' is null when it should point to a Module.");
         
-        std::string module_name = module_path.name().str();
+        Symbol module_name = Symbol::intern(module_path.name());
         Module::Member member;
         if (previous_module->find_member_by_id(module_name, member)) {
             verify(member.kind == Module::Member::Submodule, location, "'%s' is not a submodule of '%s'.", module_name.c_str(), previous_module->module_path.c_str());
@@ -3462,9 +3427,9 @@ Ref<Typed_AST> Untyped_AST_Import_Declaration::typecheck(Typer &t) {
         }
         
         internal_verify(parent_module, "'parent_module' is null when it shouldn't be.");
-        t.bind_module(module_path.segments[0].str(), parent_module, path->location);
+        t.bind_module(Symbol::intern(module_path.segments[0]), parent_module, path->location);
     } else {
-        t.bind_module(module_path.name().str(), module, path->location);
+        t.bind_module(Symbol::intern(module_path.name()), module, path->location);
     }
     
     return nullptr;
@@ -3473,7 +3438,7 @@ Ref<Typed_AST> Untyped_AST_Import_Declaration::typecheck(Typer &t) {
 static Ref<Typed_AST> typecheck_dot_call_for_string(
     Typer &t,
     Ref<Typed_AST> receiver,
-    String method_id,
+    Symbol method_id,
     Ref<Untyped_AST_Multiary> args,
     Code_Location location)
 {
@@ -3517,7 +3482,7 @@ static Ref<Typed_AST> typecheck_dot_call_for_string(
 static Ref<Typed_AST> typecheck_dot_call_for_slice(
     Typer &t,
     Ref<Typed_AST> receiver,
-    String method_id,
+    Symbol method_id,
     Ref<Untyped_AST_Multiary> args,
     Code_Location location)
 {
@@ -3557,7 +3522,7 @@ static Ref<Typed_AST> typecheck_dot_call_for_slice(
 static Ref<Typed_AST> typecheck_dot_call_for_struct(
     Typer &t,
     Ref<Typed_AST> receiver,
-    String method_id,
+    Symbol method_id,
     Ref<Untyped_AST_Multiary> args,
     Code_Location location)
 {
@@ -3629,7 +3594,7 @@ static Ref<Typed_AST> typecheck_dot_call_for_struct(
 static Ref<Typed_AST> typecheck_dot_call_for_enum(
     Typer &t,
     Ref<Typed_AST> receiver,
-    String method_id,
+    Symbol method_id,
     Ref<Untyped_AST_Multiary> args,
     Code_Location location)
 {
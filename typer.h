@@ -120,6 +120,7 @@ struct Typed_AST {
 struct Typed_AST_Bool : public Typed_AST {
     bool value;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Bool; }
     Typed_AST_Bool(bool value, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -128,6 +129,7 @@ struct Typed_AST_Bool : public Typed_AST {
 struct Typed_AST_Char : public Typed_AST {
     char32_t value;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Char; }
     Typed_AST_Char(char32_t value, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -136,16 +138,17 @@ struct Typed_AST_Char : public Typed_AST {
 struct Typed_AST_Float : public Typed_AST {
     double value;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Float; }
     Typed_AST_Float(double value, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
 };
 
 struct Typed_AST_Ident : public Typed_AST {
-    String id;
+    Symbol id;
     
-    Typed_AST_Ident(String id, Value_Type type, Code_Location location);
-    ~Typed_AST_Ident() override;
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Ident; }
+    Typed_AST_Ident(Symbol id, Value_Type type, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
 };
@@ -153,6 +156,18 @@ struct Typed_AST_Ident : public Typed_AST {
 struct Typed_AST_UUID : public Typed_AST {
     UUID uuid;
     
+    static bool is_kind(Typed_AST_Kind kind) {
+        switch (kind) {
+            case Typed_AST_Kind::Ident_Struct:
+            case Typed_AST_Kind::Ident_Enum:
+            case Typed_AST_Kind::Ident_Trait:
+            case Typed_AST_Kind::Ident_Func:
+            case Typed_AST_Kind::Ident_Module:
+                return true;
+            default:
+                return false;
+        }
+    }
     Typed_AST_UUID(Typed_AST_Kind kind, UUID uuid, Value_Type type, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -161,6 +176,7 @@ struct Typed_AST_UUID : public Typed_AST {
 struct Typed_AST_Byte : public Typed_AST {
     uint8_t value;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Byte; }
     Typed_AST_Byte(uint8_t value, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -169,6 +185,7 @@ struct Typed_AST_Byte : public Typed_AST {
 struct Typed_AST_Int : public Typed_AST {
     int64_t value;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Int; }
     Typed_AST_Int(int64_t value, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -177,6 +194,7 @@ struct Typed_AST_Int : public Typed_AST {
 struct Typed_AST_Str : public Typed_AST {
     String value;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Str; }
     Typed_AST_Str(String value, Code_Location location);
     ~Typed_AST_Str() override;
     void compile(Compiler &c) override;
@@ -186,6 +204,7 @@ struct Typed_AST_Str : public Typed_AST {
 struct Typed_AST_Ptr : public Typed_AST {
     void *value;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Ptr; }
     Typed_AST_Ptr(void *value, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -195,12 +214,14 @@ struct Builtin_Definition;
 struct Typed_AST_Builtin : public Typed_AST {
     Builtin_Definition *defn;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Builtin; }
     Typed_AST_Builtin(Builtin_Definition *defn, Value_Type *type, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
 };
 
 struct Typed_AST_Nullary : public Typed_AST {
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Allocate; }
     Typed_AST_Nullary(Typed_AST_Kind kind, Value_Type type, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -209,6 +230,20 @@ struct Typed_AST_Nullary : public Typed_AST {
 struct Typed_AST_Unary : public Typed_AST {
     Ref<Typed_AST> sub;
     
+    static bool is_kind(Typed_AST_Kind kind) {
+        switch (kind) {
+            case Typed_AST_Kind::Negation:
+            case Typed_AST_Kind::Not:
+            case Typed_AST_Kind::Address_Of:
+            case Typed_AST_Kind::Address_Of_Mut:
+            case Typed_AST_Kind::Deref:
+            case Typed_AST_Kind::Defer:
+            case Typed_AST_Kind::Return:
+                return true;
+            default:
+                return false;
+        }
+    }
     Typed_AST_Unary(Typed_AST_Kind kind, Value_Type type, Ref<Typed_AST> sub, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -217,16 +252,25 @@ struct Typed_AST_Unary : public Typed_AST {
 struct Typed_AST_Return : public Typed_AST_Unary {
     bool variadic;
 
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Return; }
     Typed_AST_Return(bool variadic, Ref<Typed_AST> sub, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
 };
 
 struct Typed_AST_Loop_Control : public Typed_AST {
-    String label;
+    Symbol label;
 
-    Typed_AST_Loop_Control(Typed_AST_Kind kind, String label, Code_Location location);
-    ~Typed_AST_Loop_Control();
+    static bool is_kind(Typed_AST_Kind kind) {
+        switch (kind) {
+            case Typed_AST_Kind::Break:
+            case Typed_AST_Kind::Continue:
+                return true;
+            default:
+                return false;
+        }
+    }
+    Typed_AST_Loop_Control(Typed_AST_Kind kind, Symbol label, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
 };
@@ -235,6 +279,34 @@ struct Typed_AST_Binary : public Typed_AST {
     Ref<Typed_AST> lhs;
     Ref<Typed_AST> rhs;
     
+    static bool is_kind(Typed_AST_Kind kind) {
+        switch (kind) {
+            case Typed_AST_Kind::Addition:
+            case Typed_AST_Kind::Subtraction:
+            case Typed_AST_Kind::Multiplication:
+            case Typed_AST_Kind::Division:
+            case Typed_AST_Kind::Mod:
+            case Typed_AST_Kind::Assignment:
+            case Typed_AST_Kind::Equal:
+            case Typed_AST_Kind::Not_Equal:
+            case Typed_AST_Kind::Less:
+            case Typed_AST_Kind::Less_Eq:
+            case Typed_AST_Kind::Greater:
+            case Typed_AST_Kind::Greater_Eq:
+            case Typed_AST_Kind::And:
+            case Typed_AST_Kind::Or:
+            case Typed_AST_Kind::Subscript:
+            case Typed_AST_Kind::Negative_Subscript:
+            case Typed_AST_Kind::Range:
+            case Typed_AST_Kind::Inclusive_Range:
+            case Typed_AST_Kind::Function_Call:
+            case Typed_AST_Kind::Builtin_Call:
+            case Typed_AST_Kind::Match_Arm:
+                return true;
+            default:
+                return false;
+        }
+    }
     Typed_AST_Binary(Typed_AST_Kind kind, Value_Type type, Ref<Typed_AST> lhs, Ref<Typed_AST> rhs, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -253,6 +325,16 @@ struct Typed_AST_Ternary : public Typed_AST {
 struct Typed_AST_Multiary : public Typed_AST {
     std::vector<Ref<Typed_AST>> nodes;
     
+    static bool is_kind(Typed_AST_Kind kind) {
+        switch (kind) {
+            case Typed_AST_Kind::Block:
+            case Typed_AST_Kind::Comma:
+            case Typed_AST_Kind::Tuple:
+                return true;
+            default:
+                return false;
+        }
+    }
     Typed_AST_Multiary(Typed_AST_Kind kind, Code_Location location);
     void add(Ref<Typed_AST> node);
     void compile(Compiler &c) override;
@@ -264,6 +346,15 @@ struct Typed_AST_Array : public Typed_AST {
     Ref<Value_Type> array_type;
     Ref<Typed_AST_Multiary> element_nodes;
     
+    static bool is_kind(Typed_AST_Kind kind) {
+        switch (kind) {
+            case Typed_AST_Kind::Array:
+            case Typed_AST_Kind::Slice:
+                return true;
+            default:
+                return false;
+        }
+    }
     Typed_AST_Array(Value_Type type, Typed_AST_Kind kind, size_t count, Ref<Value_Type> array_type, Ref<Typed_AST_Multiary> element_nodes, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -273,6 +364,7 @@ struct Typed_AST_Enum_Literal : public Typed_AST {
     runtime::Int tag;
     Ref<Typed_AST_Multiary> payload;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Enum; }
     Typed_AST_Enum_Literal(Value_Type enum_type, runtime::Int tag, Ref<Typed_AST_Multiary> payload, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -283,6 +375,7 @@ struct Typed_AST_If : public Typed_AST {
     Ref<Typed_AST> then;
     Ref<Typed_AST> else_;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::If; }
     Typed_AST_If(Value_Type type, Ref<Typed_AST> cond, Ref<Typed_AST> then, Ref<Typed_AST> else_, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -291,6 +384,7 @@ struct Typed_AST_If : public Typed_AST {
 struct Typed_AST_Type_Signature : public Typed_AST {
     Ref<Value_Type> value_type;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Type_Signature; }
     Typed_AST_Type_Signature(Ref<Value_Type> value_type, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -298,14 +392,14 @@ struct Typed_AST_Type_Signature : public Typed_AST {
 
 struct Typed_AST_Processed_Pattern : public Typed_AST {
     struct Binding {
-        String id;
+        Symbol id;
         Value_Type type;
     };
     std::vector<Binding> bindings;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Processed_Pattern; }
     Typed_AST_Processed_Pattern(Code_Location location);
-    ~Typed_AST_Processed_Pattern();
-    void add_binding(String id, Value_Type type, bool is_mut);
+    void add_binding(Symbol id, Value_Type type, bool is_mut);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
 };
@@ -323,7 +417,7 @@ struct Typed_AST_Match_Pattern : public Typed_AST {
         union {
             Ref<Typed_AST> value_node;
             struct {
-                String id;
+                Symbol id;
                 Value_Type type;
             } variable_info;
         };
@@ -334,10 +428,11 @@ struct Typed_AST_Match_Pattern : public Typed_AST {
     
     std::vector<Binding> bindings;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Match_Pattern; }
     Typed_AST_Match_Pattern(Code_Location location);
     void add_none_binding();
     void add_value_binding(Ref<Typed_AST> binding, Size offset);
-    void add_variable_binding(String id, Value_Type type, Size offset);
+    void add_variable_binding(Symbol id, Value_Type type, Size offset);
     bool is_simple_value_pattern();
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -348,6 +443,7 @@ struct Typed_AST_While : public Typed_AST {
     Ref<Typed_AST> condition;
     Ref<Typed_AST_Multiary> body;
 
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::While; }
     Typed_AST_While(Ref<Typed_AST_Ident> label, Ref<Typed_AST> condition, Ref<Typed_AST_Multiary> body, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -356,12 +452,20 @@ struct Typed_AST_While : public Typed_AST {
 struct Typed_AST_For : public Typed_AST {
     Ref<Typed_AST_Ident> label;
     Ref<Typed_AST_Processed_Pattern> target;
-    String counter;
+    Symbol counter;
     Ref<Typed_AST> iterable;
     Ref<Typed_AST_Multiary> body;
     
-    Typed_AST_For(Typed_AST_Kind kind, Ref<Typed_AST_Ident> label, Ref<Typed_AST_Processed_Pattern> target, String counter, Ref<Typed_AST> iterable, Ref<Typed_AST_Multiary> body, Code_Location location);
-    ~Typed_AST_For();
+    static bool is_kind(Typed_AST_Kind kind) {
+        switch (kind) {
+            case Typed_AST_Kind::For:
+            case Typed_AST_Kind::For_Range:
+                return true;
+            default:
+                return false;
+        }
+    }
+    Typed_AST_For(Typed_AST_Kind kind, Ref<Typed_AST_Ident> label, Ref<Typed_AST_Processed_Pattern> target, Symbol counter, Ref<Typed_AST> iterable, Ref<Typed_AST_Multiary> body, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
 };
@@ -370,6 +474,7 @@ struct Typed_AST_Forever : public Typed_AST {
     Ref<Typed_AST_Ident> label;
     Ref<Typed_AST_Multiary> body;
 
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Forever; }
     Typed_AST_Forever(Ref<Typed_AST_Ident> label, Ref<Typed_AST_Multiary> body, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -380,6 +485,7 @@ struct Typed_AST_Match : public Typed_AST {
     Ref<Typed_AST> default_arm;
     Ref<Typed_AST_Multiary> arms;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Match; }
     Typed_AST_Match(Ref<Typed_AST> cond, Ref<Typed_AST> default_arm, Ref<Typed_AST_Multiary> arms, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -391,6 +497,7 @@ struct Typed_AST_Let : public Typed_AST {
     Ref<Typed_AST_Type_Signature> specified_type;
     Ref<Typed_AST> initializer;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Let; }
     Typed_AST_Let(bool is_const, Ref<Typed_AST_Processed_Pattern> target, Ref<Typed_AST_Type_Signature> specified_type, Ref<Typed_AST> initializer, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -401,6 +508,7 @@ struct Typed_AST_Field_Access : public Typed_AST {
     Ref<Typed_AST> instance;
     Size field_offset;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Field_Access; }
     Typed_AST_Field_Access(Value_Type type, bool deref, Ref<Typed_AST> instance, Size field_offset, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -410,6 +518,7 @@ struct Typed_AST_Fn_Declaration : public Typed_AST {
     struct Function_Definition *defn;
     Ref<Typed_AST_Multiary> body;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Fn_Decl; }
     Typed_AST_Fn_Declaration(Function_Definition *defn, Ref<Typed_AST_Multiary> body, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -418,6 +527,19 @@ struct Typed_AST_Fn_Declaration : public Typed_AST {
 struct Typed_AST_Cast : public Typed_AST {
     Ref<Typed_AST> expr;
     
+    static bool is_kind(Typed_AST_Kind kind) {
+        switch (kind) {
+            case Typed_AST_Kind::Cast_Byte_Int:
+            case Typed_AST_Kind::Cast_Byte_Float:
+            case Typed_AST_Kind::Cast_Bool_Int:
+            case Typed_AST_Kind::Cast_Char_Int:
+            case Typed_AST_Kind::Cast_Int_Float:
+            case Typed_AST_Kind::Cast_Float_Int:
+                return true;
+            default:
+                return false;
+        }
+    }
     Typed_AST_Cast(Typed_AST_Kind kind, Value_Type type, Ref<Typed_AST> expr, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
@@ -429,6 +551,7 @@ struct Typed_AST_Variadic_Call : public Typed_AST {
     Ref<Typed_AST_Multiary> args;
     Ref<Typed_AST_Multiary> varargs;
     
+    static bool is_kind(Typed_AST_Kind kind) { return kind == Typed_AST_Kind::Variadic_Call; }
     Typed_AST_Variadic_Call(Value_Type type, Size varargs_size, Ref<Typed_AST> func, Ref<Typed_AST_Multiary> args, Ref<Typed_AST_Multiary> varargs, Code_Location location);
     void compile(Compiler &c) override;
     bool is_constant(Compiler &c) override;
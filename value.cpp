@@ -631,7 +631,7 @@ Value_Type unresolved(Untyped_AST_Symbol *symbol) {
     return ty;
 }
 
-Value_Type unresolved(String id, Code_Location location) {
+Value_Type unresolved(Symbol id, Code_Location location) {
     auto id_ndoe = Mem.make<Untyped_AST_Ident>(id, location);
     return unresolved(id_ndoe.as_ptr());
 }
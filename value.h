@@ -13,6 +13,7 @@
 #include "String.h"
 #include "mem.h"
 #include "codelocation.h"
+#include "symbols.h"
 
 struct Untyped_AST_Symbol;
 struct Struct_Definition;
@@ -163,7 +164,7 @@ inline const Value_Type Tuple = { Value_Type_Kind::Tuple };
 inline const Value_Type Range = { Value_Type_Kind::Range };
 
 Value_Type unresolved(Untyped_AST_Symbol *symbol);
-Value_Type unresolved(String id, Code_Location location);
+Value_Type unresolved(Symbol id, Code_Location location);
 Value_Type ptr_to(Value_Type *child_type);
 Value_Type array_of(size_t count, Value_Type *element_type);
 Value_Type slice_of(Value_Type *element_type);
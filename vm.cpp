@@ -16,6 +16,15 @@
 #include "typer.h"
 #include "builtins.h"
 #include "definitions.h"
+#include "jit.h"
+
+//
+// Threaded dispatch uses the labels-as-values extension so each opcode handler
+// jumps straight to the next one instead of going back through a central switch.
+// It's enabled by building with FOX_THREADED_DISPATCH defined, otherwise (or on
+// compilers without the extension) the portable switch loop is used.
+//
+#define THREADED_DISPATCH defined(FOX_THREADED_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
 
 void Stack::alloc(size_t size) {
     verify(_top + size <= Stack::Size, Code_Location{ 0,0,"<NO-LOC>" }, "Out of memory!");
@@ -48,378 +57,868 @@ void *Stack::get(Address address) {
     return &_buffer[address];
 }
 
-VM::VM(Data_Section &constants, Data_Section &str_constants)
+Call_Stack::Call_Stack(size_t max_depth)
+  : _capacity(std::min(max_depth, Initial_Capacity)),
+    _max_depth(max_depth),
+    _frames(new Call_Frame[_capacity])
+{
+}
+
+void Call_Stack::grow() {
+    size_t capacity = std::min(_capacity * 2, _max_depth);
+    Call_Frame *frames = new Call_Frame[capacity];
+    std::copy(_frames.get(), _frames.get() + _count, frames);
+    _frames.reset(frames);
+    _capacity = capacity;
+}
+
+VM::VM(Byte_Span constants, Byte_Span str_constants, const std::vector<Builtin> &builtins, const std::vector<Function_Definition *> &functions, size_t max_call_depth)
   : constants(constants),
-    str_constants(str_constants)
+    str_constants(str_constants),
+    builtins(builtins),
+    functions(functions),
+    frames(max_call_depth)
 {
 }
 
+template<typename T>
+static inline T load_value(const uint8_t *p) {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+template<typename T>
+static inline T read_operand(const uint8_t *&ip) {
+    T value = load_value<T>(ip);
+    ip += sizeof(T);
+    return value;
+}
+
 void VM::run() {
-    #define READ(type, frame) *reinterpret_cast<type *>(&(*frame->instructions)[frame->pc]); frame->pc += sizeof(type)
+    //
+    // The instruction pointer and the top of the stack live in locals while
+    // running. They only get written back to the Call_Frame and Stack when
+    // something outside of this function needs to see them, i.e. calls,
+    // builtins and returns.
+    //
+    #define READ(type) read_operand<type>(ip)
+    #define CHECK_STACK(size) if (sp + (size) > stack_end) stack_overflow("Ran out of stack memory.")
+    #define PUSH_BYTES(data, size) { \
+        CHECK_STACK(size); \
+        memcpy(sp, data, size); \
+        sp += size; \
+    }
+    #define PUSH(type, value) { \
+        type _value = value; \
+        PUSH_BYTES(&_value, sizeof(type)); \
+    }
+    #define POP(type) load_value<type>(sp -= sizeof(type))
+    #define TOP(type) load_value<type>(sp - sizeof(type))
+    #define SAVE_STATE() { \
+        frame->pc = static_cast<int>(ip - frame->instructions.data()); \
+        stack._top = static_cast<int>(sp - stack._buffer); \
+    }
+    #define LOAD_FRAME() { \
+        frame = &frames.top(); \
+        ip = frame->instructions.data() + frame->pc; \
+        bp = stack._buffer + frame->stack_bottom; \
+    }
+#if JIT
+    //
+    // Hands the current frame to its native code if it has any. That runs until
+    // the next call, return or anything it leaves to the interpreter, which
+    // carries on from wherever it stopped.
+    //
+    #define ENTER_NATIVE() if (frame->function->native) { \
+        SAVE_STATE(); \
+        run_native(*this, *frame); \
+        ip = frame->instructions.data() + frame->pc; \
+        sp = stack._buffer + stack._top; \
+    }
+    #define WARM_UP_LOOP() if (jit_threshold) { \
+        warm_up(frame->function); \
+        ENTER_NATIVE(); \
+    }
+#else
+    #define ENTER_NATIVE()
+    #define WARM_UP_LOOP()
+#endif
     #define UNOP(ret_type, arg_type, op) { \
-        arg_type a = stack.pop<arg_type>(); \
-        stack.push<ret_type>(op(a)); \
-    } break
+        arg_type a = POP(arg_type); \
+        PUSH(ret_type, op(a)); \
+    } NEXT
     #define BIOP(ret_type, arg_type, op) { \
-        arg_type b = stack.pop<arg_type>(); \
-        arg_type a = stack.pop<arg_type>(); \
-        stack.push<ret_type>(a op b); \
-    } break
+        arg_type b = POP(arg_type); \
+        arg_type a = POP(arg_type); \
+        PUSH(ret_type, a op b); \
+    } NEXT
     #define BIOP_CHECK_FOR_ZERO(ret_type, arg_type, op, op_str) { \
-        arg_type b = stack.pop<arg_type>(); \
-        arg_type a = stack.pop<arg_type>(); \
+        arg_type b = POP(arg_type); \
+        arg_type a = POP(arg_type); \
         verify(b != 0, Code_Location{ 0,0,"<NO-LOC>" }, "Second operand detected as zero which is disallowed for operator " op_str "."); \
-        stack.push<ret_type>(a op b); \
-    } break
+        PUSH(ret_type, a op b); \
+    } NEXT
+    #define SLOT(type, address) load_value<type>(bp + (address))
+    #define STORE_SLOT(type, address, value) { \
+        type _value = value; \
+        memcpy(bp + (address), &_value, sizeof(type)); \
+    }
+    #define REG_UNOP(ret_type, arg_type, op) { \
+        Address dst = READ(Address); \
+        arg_type a = SLOT(arg_type, READ(Address)); \
+        STORE_SLOT(ret_type, dst, op(a)); \
+    } NEXT
+    #define REG_BIOP(ret_type, arg_type, op) { \
+        Address dst = READ(Address); \
+        arg_type a = SLOT(arg_type, READ(Address)); \
+        arg_type b = SLOT(arg_type, READ(Address)); \
+        STORE_SLOT(ret_type, dst, a op b); \
+    } NEXT
+    #define REG_BIOP_IMM(ret_type, arg_type, op) { \
+        Address dst = READ(Address); \
+        arg_type a = SLOT(arg_type, READ(Address)); \
+        arg_type b = READ(arg_type); \
+        STORE_SLOT(ret_type, dst, a op b); \
+    } NEXT
+    #define REG_BIOP_CHECK_FOR_ZERO(ret_type, arg_type, op, op_str) { \
+        Address dst = READ(Address); \
+        arg_type a = SLOT(arg_type, READ(Address)); \
+        arg_type b = SLOT(arg_type, READ(Address)); \
+        verify(b != 0, Code_Location{ 0,0,"<NO-LOC>" }, "Second operand detected as zero which is disallowed for operator " op_str "."); \
+        STORE_SLOT(ret_type, dst, a op b); \
+    } NEXT
+    #define JUMP(width) { \
+        width jump = READ(width); \
+        ip += jump; \
+    } NEXT
+    #define LOOP(width) { \
+        width jump = READ(width); \
+        ip -= jump; \
+        WARM_UP_LOOP(); \
+    } NEXT
+    #define JUMP_IF(width, cond) { \
+        width jump = READ(width); \
+        if (cond) ip += jump; \
+    } NEXT
+    #define INT_COMPARE_JUMP_FALSE(width, op) { \
+        width jump = READ(width); \
+        runtime::Int b = POP(runtime::Int); \
+        runtime::Int a = POP(runtime::Int); \
+        if (!(a op b)) ip += jump; \
+    } NEXT
+    #define REG_JUMP_IF(width, expected) { \
+        runtime::Bool cond = SLOT(runtime::Bool, READ(Address)); \
+        width jump = READ(width); \
+        if (cond == expected) ip += jump; \
+    } NEXT
+#if COUNT_DISPATCHES
+    #define COUNT_DISPATCH() dispatch_count++
+#else
+    #define COUNT_DISPATCH()
+#endif
+    
+#if THREADED_DISPATCH
+    // must be kept in the same order as the Opcode enum
+    static void *dispatch_table[] = {
+        &&op_None,
+        
+        // Literals
+        &&op_Lit_True, &&op_Lit_False, &&op_Lit_0, &&op_Lit_1, &&op_Lit_0b,
+        &&op_Lit_1b, &&op_Lit_Char, &&op_Lit_Int, &&op_Lit_Byte, &&op_Lit_Float,
+        &&op_Lit_Pointer,
+        
+        // Constants
+        &&op_Load_Const, &&op_Load_Const_String,
+        
+        // Arithmetic
+        &&op_Int_Add, &&op_Int_Sub, &&op_Int_Mul, &&op_Int_Div, &&op_Int_Neg,
+        &&op_Int_Mod, &&op_Int_Inc, &&op_Int_Dec,
+        &&op_Byte_Add, &&op_Byte_Sub, &&op_Byte_Mul, &&op_Byte_Div, &&op_Byte_Neg,
+        &&op_Byte_Mod, &&op_Byte_Inc, &&op_Byte_Dec,
+        &&op_Float_Add, &&op_Float_Sub, &&op_Float_Mul, &&op_Float_Div, &&op_Float_Neg,
+        &&op_Str_Add,
+        
+        // Bitwise
+        &&op_Bit_Not, &&op_Shift_Left, &&op_Shift_Right, &&op_Bit_And, &&op_Xor,
+        &&op_Bit_Or,
+        
+        // Logic
+        &&op_And, &&op_Or, &&op_Not,
+        
+        // Relational
+        &&op_Equal, &&op_Not_Equal, &&op_Str_Equal, &&op_Str_Not_Equal,
+        &&op_Int_Less_Than, &&op_Int_Less_Equal, &&op_Int_Greater_Than, &&op_Int_Greater_Equal,
+        &&op_Byte_Less_Than, &&op_Byte_Less_Equal, &&op_Byte_Greater_Than, &&op_Byte_Greater_Equal,
+        &&op_Float_Less_Than, &&op_Float_Less_Equal, &&op_Float_Greater_Than, &&op_Float_Greater_Equal,
+        
+        // Stack
+        &&op_Move, &&op_Move_Push_Pointer, &&op_Copy, &&op_Load, &&op_Push_Pointer,
+        &&op_Push_Value, &&op_Push_Global_Pointer, &&op_Push_Global_Value, &&op_Pop,
+        &&op_Allocate, &&op_Clear_Allocate, &&op_Flush, &&op_Flush_Value, &&op_Return, &&op_Variadic_Return,
+        
+        // Branching
+        &&op_Jump, &&op_Loop, &&op_Jump_True, &&op_Jump_False, &&op_Jump_True_No_Pop,
+        &&op_Jump_False_No_Pop, &&op_Jump_Long, &&op_Loop_Long, &&op_Jump_True_Long, &&op_Jump_False_Long,
+        &&op_Jump_True_No_Pop_Long, &&op_Jump_False_No_Pop_Long,
+        
+        // Invocation
+        &&op_Call, &&op_Call_Builtin, &&op_Call_Direct, &&op_Tail_Call,
+        
+        // Cast
+        &&op_Cast_Byte_Int, &&op_Cast_Byte_Float, &&op_Cast_Bool_Int, &&op_Cast_Char_Int,
+        &&op_Cast_Int_Float, &&op_Cast_Float_Int,
+        
+        // Fused
+        &&op_Int_Add_Imm, &&op_Int_Mul_Imm, &&op_Inc_Local, &&op_Add_Local, &&op_Load_Indexed, &&op_Load_Field_Indirect,
+        &&op_Int_Lt_Jump_False, &&op_Int_Le_Jump_False, &&op_Int_Lt_Jump_False_Long, &&op_Int_Le_Jump_False_Long,
+        
+        // Register
+        &&op_Reg_Move, &&op_Reg_Move_Global, &&op_Reg_Address, &&op_Reg_Global_Address,
+        &&op_Reg_Set, &&op_Reg_Load, &&op_Reg_Load_Indexed, &&op_Reg_Store,
+        &&op_Reg_Int_Add, &&op_Reg_Int_Sub, &&op_Reg_Int_Mul, &&op_Reg_Int_Div, &&op_Reg_Int_Mod,
+        &&op_Reg_Int_Neg, &&op_Reg_Int_Add_Imm, &&op_Reg_Int_Mul_Imm, &&op_Reg_Int_Inc, &&op_Reg_Int_Dec,
+        &&op_Reg_Float_Add, &&op_Reg_Float_Sub, &&op_Reg_Float_Mul, &&op_Reg_Float_Div,
+        &&op_Reg_Not, &&op_Reg_Equal, &&op_Reg_Not_Equal,
+        &&op_Reg_Int_Less_Than, &&op_Reg_Int_Less_Equal, &&op_Reg_Int_Greater_Than, &&op_Reg_Int_Greater_Equal,
+        &&op_Reg_Int_Less_Than_Imm, &&op_Reg_Int_Less_Equal_Imm, &&op_Reg_Int_Greater_Than_Imm, &&op_Reg_Int_Greater_Equal_Imm,
+        &&op_Reg_Int_Equal_Imm, &&op_Reg_Int_Not_Equal_Imm,
+        &&op_Reg_Float_Less_Than, &&op_Reg_Float_Less_Equal, &&op_Reg_Float_Greater_Than, &&op_Reg_Float_Greater_Equal,
+        &&op_Reg_Jump_True, &&op_Reg_Jump_False, &&op_Reg_Jump_True_Long, &&op_Reg_Jump_False_Long,
+    };
+    static_assert(sizeof(dispatch_table) / sizeof(*dispatch_table) == Opcode_Count, "dispatch_table is out of sync with the Opcode enum.");
+    
+    #define CASE(opcode) op_##opcode
+    #define NEXT { COUNT_DISPATCH(); goto *dispatch_table[READ(uint8_t)]; }
+#else
+    #define CASE(opcode) case Opcode::opcode
+    #define NEXT break
+#endif
     
-    Call_Frame *frame = &frames.top();
-    while (frame->pc < frame->instructions->size()) {
-        Opcode op = READ(Opcode, frame);
+    //
+    // Every instruction stream is terminated by a Return so there's no need
+    // to bounds check the pc on every dispatch.
+    //
+    Call_Frame *frame;
+    const uint8_t *ip;
+    uint8_t *bp;
+    uint8_t *sp = stack._buffer + stack._top;
+    const uint8_t *stack_end = stack._buffer + Stack::Size;
+    LOAD_FRAME();
+    ENTER_NATIVE();
+    
+#if THREADED_DISPATCH
+    NEXT;
+    {
+#else
+    for (;;) {
+        COUNT_DISPATCH();
+        Opcode op = READ(Opcode);
         switch (op) {
+#endif
             // Literals
-            case Opcode::Lit_True: {
-                stack.push<runtime::Bool>(true);
-            } break;
-            case Opcode::Lit_False: {
-                stack.push<runtime::Bool>(false);
-            } break;
-            case Opcode::Lit_0: {
-                stack.push<runtime::Int>(0);
-            } break;
-            case Opcode::Lit_1: {
-                stack.push<runtime::Int>(1);
-            } break;
-            case Opcode::Lit_0b: {
-                stack.push<runtime::Byte>(0);
-            } break;
-            case Opcode::Lit_1b: {
-                stack.push<runtime::Byte>(1);
-            } break;
-            case Opcode::Lit_Char: {
-                runtime::Char c = READ(runtime::Char, frame);
-                stack.push<runtime::Char>(c);
-            } break;
-            case Opcode::Lit_Int: {
-                runtime::Int value = READ(runtime::Int, frame);
-                stack.push<runtime::Int>(value);
-            } break;
-            case Opcode::Lit_Byte: {
-                runtime::Byte value = READ(runtime::Byte, frame);
-                stack.push<runtime::Byte>(value);
-            } break;
-            case Opcode::Lit_Float: {
-                runtime::Float value = READ(runtime::Float, frame);
-                stack.push<runtime::Float>(value);
-            } break;
-            case Opcode::Lit_Pointer: {
-                runtime::Pointer value = READ(runtime::Pointer, frame);
-                stack.push<runtime::Pointer>(value);
-            } break;
+            CASE(Lit_True): {
+                PUSH(runtime::Bool, true);
+            } NEXT;
+            CASE(Lit_False): {
+                PUSH(runtime::Bool, false);
+            } NEXT;
+            CASE(Lit_0): {
+                PUSH(runtime::Int, 0);
+            } NEXT;
+            CASE(Lit_1): {
+                PUSH(runtime::Int, 1);
+            } NEXT;
+            CASE(Lit_0b): {
+                PUSH(runtime::Byte, 0);
+            } NEXT;
+            CASE(Lit_1b): {
+                PUSH(runtime::Byte, 1);
+            } NEXT;
+            CASE(Lit_Char): {
+                runtime::Char c = READ(runtime::Char);
+                PUSH(runtime::Char, c);
+            } NEXT;
+            CASE(Lit_Int): {
+                runtime::Int value = READ(runtime::Int);
+                PUSH(runtime::Int, value);
+            } NEXT;
+            CASE(Lit_Byte): {
+                runtime::Byte value = READ(runtime::Byte);
+                PUSH(runtime::Byte, value);
+            } NEXT;
+            CASE(Lit_Float): {
+                runtime::Float value = READ(runtime::Float);
+                PUSH(runtime::Float, value);
+            } NEXT;
+            CASE(Lit_Pointer): {
+                runtime::Pointer value = READ(runtime::Pointer);
+                PUSH(runtime::Pointer, value);
+            } NEXT;
                 
             // Constants
-            case Opcode::Load_Const: {
-                Size size = READ(Size, frame);
-                size_t constant_index = READ(size_t, frame);
-                void *constant = &constants[constant_index];
-                stack.push(constant, size);
-            } break;
-            case Opcode::Load_Const_String: {
-                size_t constant = READ(size_t, frame);
-                size_t len = *reinterpret_cast<size_t *>(&str_constants[constant]);
-                char *s = reinterpret_cast<char *>(&str_constants[constant + sizeof(size_t)]);
-                stack.push<runtime::String>({ s, static_cast<runtime::Int>(len) });
-            } break;
+            CASE(Load_Const): {
+                Size size = READ(Size);
+                Constant_Index constant_index = READ(Constant_Index);
+                const void *constant = &constants[constant_index];
+                PUSH_BYTES(constant, size);
+            } NEXT;
+            CASE(Load_Const_String): {
+                Constant_Index constant = READ(Constant_Index);
+                size_t len = *reinterpret_cast<const size_t *>(&str_constants[constant]);
+                // strings are never written through, the constants may be mapped read-only
+                char *s = const_cast<char *>(reinterpret_cast<const char *>(&str_constants[constant + sizeof(size_t)]));
+                PUSH(runtime::String, (runtime::String{ s, static_cast<runtime::Int>(len) }));
+            } NEXT;
                 
             // Arithmetic Operations
-            case Opcode::Int_Add:   BIOP(runtime::Int, runtime::Int, +);
-            case Opcode::Int_Sub:   BIOP(runtime::Int, runtime::Int, -);
-            case Opcode::Int_Mul:   BIOP(runtime::Int, runtime::Int, *);
-            case Opcode::Int_Div:   BIOP_CHECK_FOR_ZERO(runtime::Int, runtime::Int, /, "/");
-            case Opcode::Int_Neg:   UNOP(runtime::Int, runtime::Int, -);
-            case Opcode::Int_Mod:   BIOP_CHECK_FOR_ZERO(runtime::Int, runtime::Int, %, "%%");
-            case Opcode::Int_Inc: {
-                runtime::Int *n = stack.pop<runtime::Int *>();
+            CASE(Int_Add):   BIOP(runtime::Int, runtime::Int, +);
+            CASE(Int_Sub):   BIOP(runtime::Int, runtime::Int, -);
+            CASE(Int_Mul):   BIOP(runtime::Int, runtime::Int, *);
+            CASE(Int_Div):   BIOP_CHECK_FOR_ZERO(runtime::Int, runtime::Int, /, "/");
+            CASE(Int_Neg):   UNOP(runtime::Int, runtime::Int, -);
+            CASE(Int_Mod):   BIOP_CHECK_FOR_ZERO(runtime::Int, runtime::Int, %, "%%");
+            CASE(Int_Inc): {
+                runtime::Int *n = POP(runtime::Int *);
                 (*n)++;
-            } break;
-            case Opcode::Int_Dec: {
-                runtime::Int *n = stack.pop<runtime::Int *>();
+            } NEXT;
+            CASE(Int_Dec): {
+                runtime::Int *n = POP(runtime::Int *);
                 (*n)--;
-            } break;
+            } NEXT;
 
-            case Opcode::Byte_Add:   BIOP(runtime::Byte, runtime::Byte, +);
-            case Opcode::Byte_Sub:   BIOP(runtime::Byte, runtime::Byte, -);
-            case Opcode::Byte_Mul:   BIOP(runtime::Byte, runtime::Byte, *);
-            case Opcode::Byte_Div:   BIOP_CHECK_FOR_ZERO(runtime::Byte, runtime::Byte, /, "/");
-            case Opcode::Byte_Neg:   UNOP(runtime::Byte, runtime::Byte, -);
-            case Opcode::Byte_Mod:   BIOP_CHECK_FOR_ZERO(runtime::Byte, runtime::Byte, %, "%%");
-            case Opcode::Byte_Inc: {
-                runtime::Byte *n = stack.pop<runtime::Byte *>();
+            CASE(Byte_Add):   BIOP(runtime::Byte, runtime::Byte, +);
+            CASE(Byte_Sub):   BIOP(runtime::Byte, runtime::Byte, -);
+            CASE(Byte_Mul):   BIOP(runtime::Byte, runtime::Byte, *);
+            CASE(Byte_Div):   BIOP_CHECK_FOR_ZERO(runtime::Byte, runtime::Byte, /, "/");
+            CASE(Byte_Neg):   UNOP(runtime::Byte, runtime::Byte, -);
+            CASE(Byte_Mod):   BIOP_CHECK_FOR_ZERO(runtime::Byte, runtime::Byte, %, "%%");
+            CASE(Byte_Inc): {
+                runtime::Byte *n = POP(runtime::Byte *);
                 (*n)++;
-            } break;
-            case Opcode::Byte_Dec: {
-                runtime::Byte *n = stack.pop<runtime::Byte *>();
+            } NEXT;
+            CASE(Byte_Dec): {
+                runtime::Byte *n = POP(runtime::Byte *);
                 (*n)--;
-            } break;
+            } NEXT;
                 
-            case Opcode::Float_Add: BIOP(runtime::Float, runtime::Float, +);
-            case Opcode::Float_Sub: BIOP(runtime::Float, runtime::Float, -);
-            case Opcode::Float_Mul: BIOP(runtime::Float, runtime::Float, *);
-            case Opcode::Float_Div: BIOP_CHECK_FOR_ZERO(runtime::Float, runtime::Float, /, "/");
-            case Opcode::Float_Neg: UNOP(runtime::Float, runtime::Float, -);
+            CASE(Float_Add): BIOP(runtime::Float, runtime::Float, +);
+            CASE(Float_Sub): BIOP(runtime::Float, runtime::Float, -);
+            CASE(Float_Mul): BIOP(runtime::Float, runtime::Float, *);
+            CASE(Float_Div): BIOP_CHECK_FOR_ZERO(runtime::Float, runtime::Float, /, "/");
+            CASE(Float_Neg): UNOP(runtime::Float, runtime::Float, -);
                 
-            case Opcode::Str_Add:
+            CASE(Str_Add):
                 todo("Str_Add not yet implemented.");
-                break;
+                NEXT;
                 
             // Bitwise Operations
-            case Opcode::Bit_Not:       UNOP(runtime::Int, runtime::Int, ~);
-            case Opcode::Shift_Left:    BIOP(runtime::Int, runtime::Int, <<);
-            case Opcode::Shift_Right:   BIOP(runtime::Int, runtime::Int, >>);
-            case Opcode::Bit_And:       BIOP(runtime::Int, runtime::Int, &);
-            case Opcode::Xor:           BIOP(runtime::Int, runtime::Int, ^);
-            case Opcode::Bit_Or:        BIOP(runtime::Int, runtime::Int, |);
+            CASE(Bit_Not):       UNOP(runtime::Int, runtime::Int, ~);
+            CASE(Shift_Left):    BIOP(runtime::Int, runtime::Int, <<);
+            CASE(Shift_Right):   BIOP(runtime::Int, runtime::Int, >>);
+            CASE(Bit_And):       BIOP(runtime::Int, runtime::Int, &);
+            CASE(Xor):           BIOP(runtime::Int, runtime::Int, ^);
+            CASE(Bit_Or):        BIOP(runtime::Int, runtime::Int, |);
                 
             // Logical Operations
-            case Opcode::And:   BIOP(runtime::Bool, runtime::Bool, &&);
-            case Opcode::Or:    BIOP(runtime::Bool, runtime::Bool, ||);
-            case Opcode::Not:   UNOP(runtime::Bool, runtime::Bool, !);
+            CASE(And):   BIOP(runtime::Bool, runtime::Bool, &&);
+            CASE(Or):    BIOP(runtime::Bool, runtime::Bool, ||);
+            CASE(Not):   UNOP(runtime::Bool, runtime::Bool, !);
                 
             // Equality Operations
-            case Opcode::Equal: {
-                Size size = READ(Size, frame);
-                void *a = stack.pop(size);
-                void *b = stack.pop(size);
+            CASE(Equal): {
+                Size size = READ(Size);
+                sp -= size;
+                void *a = sp;
+                sp -= size;
+                void *b = sp;
                 bool c = memcmp(a, b, size) == 0;
-                stack.push<runtime::Bool>(c);
-            } break;
-            case Opcode::Not_Equal: {
-                Size size = READ(Size, frame);
-                void *a = stack.pop(size);
-                void *b = stack.pop(size);
+                PUSH(runtime::Bool, c);
+            } NEXT;
+            CASE(Not_Equal): {
+                Size size = READ(Size);
+                sp -= size;
+                void *a = sp;
+                sp -= size;
+                void *b = sp;
                 bool c = memcmp(a, b, size) != 0;
-                stack.push<runtime::Bool>(c);
-            } break;
-            case Opcode::Str_Equal: {
-                runtime::String b = stack.pop<runtime::String>();
-                runtime::String a = stack.pop<runtime::String>();
+                PUSH(runtime::Bool, c);
+            } NEXT;
+            CASE(Str_Equal): {
+                runtime::String b = POP(runtime::String);
+                runtime::String a = POP(runtime::String);
                 bool c = a.len == b.len && memcmp(a.s, b.s, a.len) == 0;
-                stack.push<runtime::Bool>(c);
-            } break;
-            case Opcode::Str_Not_Equal: {
-                runtime::String b = stack.pop<runtime::String>();
-                runtime::String a = stack.pop<runtime::String>();
+                PUSH(runtime::Bool, c);
+            } NEXT;
+            CASE(Str_Not_Equal): {
+                runtime::String b = POP(runtime::String);
+                runtime::String a = POP(runtime::String);
                 bool c = a.len == b.len && memcmp(a.s, b.s, a.len) != 0;
-                stack.push<runtime::Bool>(c);
-            } break;
+                PUSH(runtime::Bool, c);
+            } NEXT;
                 
             // Relational Operations
-            case Opcode::Byte_Less_Than:        BIOP(runtime::Bool, runtime::Byte, <);
-            case Opcode::Byte_Less_Equal:       BIOP(runtime::Bool, runtime::Byte, <=);
-            case Opcode::Byte_Greater_Than:     BIOP(runtime::Bool, runtime::Byte, >);
-            case Opcode::Byte_Greater_Equal:    BIOP(runtime::Bool, runtime::Byte, >=);
-            case Opcode::Int_Less_Than:         BIOP(runtime::Bool, runtime::Int, <);
-            case Opcode::Int_Less_Equal:        BIOP(runtime::Bool, runtime::Int, <=);
-            case Opcode::Int_Greater_Than:      BIOP(runtime::Bool, runtime::Int, >);
-            case Opcode::Int_Greater_Equal:     BIOP(runtime::Bool, runtime::Int, >=);
-            case Opcode::Float_Less_Than:       BIOP(runtime::Bool, runtime::Float, <);
-            case Opcode::Float_Less_Equal:      BIOP(runtime::Bool, runtime::Float, <=);
-            case Opcode::Float_Greater_Than:    BIOP(runtime::Bool, runtime::Float, >);
-            case Opcode::Float_Greater_Equal:   BIOP(runtime::Bool, runtime::Float, >=);
+            CASE(Byte_Less_Than):        BIOP(runtime::Bool, runtime::Byte, <);
+            CASE(Byte_Less_Equal):       BIOP(runtime::Bool, runtime::Byte, <=);
+            CASE(Byte_Greater_Than):     BIOP(runtime::Bool, runtime::Byte, >);
+            CASE(Byte_Greater_Equal):    BIOP(runtime::Bool, runtime::Byte, >=);
+            CASE(Int_Less_Than):         BIOP(runtime::Bool, runtime::Int, <);
+            CASE(Int_Less_Equal):        BIOP(runtime::Bool, runtime::Int, <=);
+            CASE(Int_Greater_Than):      BIOP(runtime::Bool, runtime::Int, >);
+            CASE(Int_Greater_Equal):     BIOP(runtime::Bool, runtime::Int, >=);
+            CASE(Float_Less_Than):       BIOP(runtime::Bool, runtime::Float, <);
+            CASE(Float_Less_Equal):      BIOP(runtime::Bool, runtime::Float, <=);
+            CASE(Float_Greater_Than):    BIOP(runtime::Bool, runtime::Float, >);
+            CASE(Float_Greater_Equal):   BIOP(runtime::Bool, runtime::Float, >=);
                 
             // Stack Operations
-            case Opcode::Move: {
-                Size size = READ(Size, frame);
-                runtime::Pointer dest = stack.pop<runtime::Pointer>();
-                void *src = stack.top(size);
+            CASE(Move): {
+                Size size = READ(Size);
+                runtime::Pointer dest = POP(runtime::Pointer);
+                void *src = sp - size;
                 if (dest != src) {
                     memcpy(dest, src, size);
-                    stack.pop(size);
+                    sp -= size;
                 }
-            } break;
-            case Opcode::Move_Push_Pointer: {
-                Size size = READ(Size, frame);
-                runtime::Pointer dest = stack.pop<runtime::Pointer>();
-                void *src = stack.top(size);
+            } NEXT;
+            CASE(Move_Push_Pointer): {
+                Size size = READ(Size);
+                runtime::Pointer dest = POP(runtime::Pointer);
+                void *src = sp - size;
                 if (dest != src) {
                     memcpy(dest, src, size);
-                    stack.pop(size);
+                    sp -= size;
                 }
-                stack.push<runtime::Pointer>(dest);
-            } break;
-            case Opcode::Copy: {
-                Size size = READ(Size, frame);
-                runtime::Pointer dest = stack.pop<runtime::Pointer>();
-                runtime::Pointer src = stack.pop<runtime::Pointer>();
+                PUSH(runtime::Pointer, dest);
+            } NEXT;
+            CASE(Copy): {
+                Size size = READ(Size);
+                runtime::Pointer dest = POP(runtime::Pointer);
+                runtime::Pointer src = POP(runtime::Pointer);
                 if (dest != src) {
                     memcpy(dest, src, size);
                 }
-            } break;
-            case Opcode::Load: {
-                Size size = READ(Size, frame);
-                runtime::Pointer data = stack.pop<runtime::Pointer>();
-                stack.push(data, size);
-            } break;
-            case Opcode::Push_Pointer: {
-                Address address = READ(Address, frame);
-                runtime::Pointer p = stack.get(frame->stack_bottom + address);
-                stack.push<runtime::Pointer>(p);
-            } break;
-            case Opcode::Push_Value: {
-                Size size = READ(Size, frame);
-                Address address = READ(Address, frame);
-                void *data = stack.get(frame->stack_bottom + address);
-                stack.push(data, size);
-            } break;
-            case Opcode::Push_Global_Pointer: {
-                Address address = READ(Address, frame);
-                runtime::Pointer p = stack.get(address);
-                stack.push<runtime::Pointer>(p);
-            } break;
-            case Opcode::Push_Global_Value: {
-                Size size = READ(Size, frame);
-                Address address = READ(Address, frame);
-                void *data = stack.get(address);
-                stack.push(data, size);
-            } break;
-            case Opcode::Pop: {
-                Size size = READ(Size, frame);
-                stack.pop(size);
-            } break;
-            case Opcode::Allocate: {
-                Size size = READ(Size, frame);
-                stack.alloc(size);
-            } break;
-            case Opcode::Clear_Allocate: {
-                Size size = READ(Size, frame);
-                stack.calloc(size);
-            } break;
-            case Opcode::Flush: {
-                Address flush_point = READ(Address, frame);
-                flush_point += frame->stack_bottom;
-                stack._top = static_cast<int>(flush_point);
-            } break;
+            } NEXT;
+            CASE(Load): {
+                Size size = READ(Size);
+                runtime::Pointer data = POP(runtime::Pointer);
+                PUSH_BYTES(data, size);
+            } NEXT;
+            CASE(Push_Pointer): {
+                Address address = READ(Address);
+                PUSH(runtime::Pointer, bp + address);
+            } NEXT;
+            CASE(Push_Value): {
+                Size size = READ(Size);
+                Address address = READ(Address);
+                PUSH_BYTES(bp + address, size);
+            } NEXT;
+            CASE(Push_Global_Pointer): {
+                Address address = READ(Address);
+                PUSH(runtime::Pointer, stack._buffer + address);
+            } NEXT;
+            CASE(Push_Global_Value): {
+                Size size = READ(Size);
+                Address address = READ(Address);
+                PUSH_BYTES(stack._buffer + address, size);
+            } NEXT;
+            CASE(Pop): {
+                Size size = READ(Size);
+                sp -= size;
+            } NEXT;
+            CASE(Allocate): {
+                Size size = READ(Size);
+                CHECK_STACK(size);
+                sp += size;
+            } NEXT;
+            CASE(Clear_Allocate): {
+                Size size = READ(Size);
+                CHECK_STACK(size);
+                memset(sp, 0, size);
+                sp += size;
+            } NEXT;
+            CASE(Flush): {
+                Address flush_point = READ(Address);
+                sp = bp + flush_point;
+            } NEXT;
+            CASE(Flush_Value): {
+                Size size = READ(Size);
+                Address flush_point = READ(Address);
+                memmove(bp + flush_point, sp - size, size);
+                sp = bp + flush_point + size;
+            } NEXT;
             
             // Branching Operations
-            case Opcode::Jump: {
-                size_t jump = READ(size_t, frame);
-                frame->pc += static_cast<int>(jump);
-            } break;
-            case Opcode::Loop: {
-                size_t jump = READ(size_t, frame);
-                frame->pc -= static_cast<int>(jump);
-            } break;
-            case Opcode::Jump_True: {
-                size_t jump = READ(size_t, frame);
-                runtime::Bool cond = stack.pop<runtime::Bool>();
-                if (cond) frame->pc += static_cast<int>(jump);
-            } break;
-            case Opcode::Jump_False: {
-                size_t jump = READ(size_t, frame);
-                runtime::Bool cond = stack.pop<runtime::Bool>();
-                if (!cond) frame->pc += static_cast<int>(jump);
-            } break;
-            case Opcode::Jump_True_No_Pop: {
-                size_t jump = READ(size_t, frame);
-                runtime::Bool cond = stack.top<runtime::Bool>();
-                if (cond) frame->pc += static_cast<int>(jump);
-            } break;
-            case Opcode::Jump_False_No_Pop: {
-                size_t jump = READ(size_t, frame);
-                runtime::Bool cond = stack.top<runtime::Bool>();
-                if (!cond) frame->pc += static_cast<int>(jump);
-            } break;
+            CASE(Jump):                     JUMP(Short_Jump);
+            CASE(Loop):                     LOOP(Short_Jump);
+            CASE(Jump_True):                JUMP_IF(Short_Jump, POP(runtime::Bool));
+            CASE(Jump_False):               JUMP_IF(Short_Jump, !POP(runtime::Bool));
+            CASE(Jump_True_No_Pop):         JUMP_IF(Short_Jump, TOP(runtime::Bool));
+            CASE(Jump_False_No_Pop):        JUMP_IF(Short_Jump, !TOP(runtime::Bool));
+            CASE(Jump_Long):                JUMP(Long_Jump);
+            CASE(Loop_Long):                LOOP(Long_Jump);
+            CASE(Jump_True_Long):           JUMP_IF(Long_Jump, POP(runtime::Bool));
+            CASE(Jump_False_Long):          JUMP_IF(Long_Jump, !POP(runtime::Bool));
+            CASE(Jump_True_No_Pop_Long):    JUMP_IF(Long_Jump, TOP(runtime::Bool));
+            CASE(Jump_False_No_Pop_Long):   JUMP_IF(Long_Jump, !TOP(runtime::Bool));
                 
             // Invocation
-            case Opcode::Call: {
-                Size arg_size = READ(Size, frame);
-                Function_Definition *defn = stack.pop<Function_Definition *>();
+            CASE(Call): {
+                Size arg_size = READ(Size);
+                Function_Definition *defn = POP(Function_Definition *);
+                SAVE_STATE();
                 call(defn, arg_size);
-                frame = &frames.top();
-            } break;
-            case Opcode::Call_Builtin: {
-                Builtin builtin = READ(Builtin, frame);
-                Size arg_size = READ(Size, frame);
+                LOAD_FRAME();
+                ENTER_NATIVE();
+            } NEXT;
+            CASE(Call_Builtin): {
+                Builtin builtin = builtins[READ(Builtin_Index)];
+                Size arg_size = READ(Size);
+                SAVE_STATE();
                 Address arg_start = stack._top - arg_size;
                 builtin(stack, arg_start);
-            } break;
+                sp = stack._buffer + stack._top;
+            } NEXT;
+            CASE(Call_Direct): {
+                Function_Definition *defn = functions[READ(Function_Index)];
+                Size arg_size = READ(Size);
+                SAVE_STATE();
+                call(defn, arg_size);
+                LOAD_FRAME();
+                ENTER_NATIVE();
+            } NEXT;
+            CASE(Tail_Call): {
+                Function_Definition *defn = functions[READ(Function_Index)];
+                Size arg_size = READ(Size);
+                SAVE_STATE();
+                tail_call(defn, arg_size);
+                LOAD_FRAME();
+                sp = stack._buffer + stack._top;
+                ENTER_NATIVE();
+            } NEXT;
                 
             // Cast
-            case Opcode::Cast_Byte_Int: {
-                runtime::Byte value = stack.pop<runtime::Byte>();
-                stack.push(static_cast<runtime::Int>(value));
-            } break;
-            case Opcode::Cast_Byte_Float: {
-                runtime::Byte value = stack.pop<runtime::Byte>();
-                stack.push(static_cast<runtime::Float>(value));
-            } break;
-            case Opcode::Cast_Bool_Int: {
-                runtime::Bool value = stack.pop<runtime::Bool>();
-                stack.push<runtime::Int>(value ? 1 : 0);
-            } break;
-            case Opcode::Cast_Char_Int: {
-                runtime::Char value = stack.pop<runtime::Char>();
-                stack.push(static_cast<runtime::Int>(value));
-            } break;
-            case Opcode::Cast_Int_Float: {
-                runtime::Int value = stack.pop<runtime::Int>();
-                stack.push(static_cast<runtime::Float>(value));
-            } break;
-            case Opcode::Cast_Float_Int: {
-                runtime::Float value = stack.pop<runtime::Float>();
-                stack.push(static_cast<runtime::Int>(value));
-            } break;
+            CASE(Cast_Byte_Int): {
+                runtime::Byte value = POP(runtime::Byte);
+                PUSH(runtime::Int, static_cast<runtime::Int>(value));
+            } NEXT;
+            CASE(Cast_Byte_Float): {
+                runtime::Byte value = POP(runtime::Byte);
+                PUSH(runtime::Float, static_cast<runtime::Float>(value));
+            } NEXT;
+            CASE(Cast_Bool_Int): {
+                runtime::Bool value = POP(runtime::Bool);
+                PUSH(runtime::Int, value ? 1 : 0);
+            } NEXT;
+            CASE(Cast_Char_Int): {
+                runtime::Char value = POP(runtime::Char);
+                PUSH(runtime::Int, static_cast<runtime::Int>(value));
+            } NEXT;
+            CASE(Cast_Int_Float): {
+                runtime::Int value = POP(runtime::Int);
+                PUSH(runtime::Float, static_cast<runtime::Float>(value));
+            } NEXT;
+            CASE(Cast_Float_Int): {
+                runtime::Float value = POP(runtime::Float);
+                PUSH(runtime::Int, static_cast<runtime::Int>(value));
+            } NEXT;
+                
+            // Fused Operations
+            CASE(Int_Add_Imm): {
+                runtime::Int imm = READ(runtime::Int);
+                runtime::Int a = POP(runtime::Int);
+                PUSH(runtime::Int, a + imm);
+            } NEXT;
+            CASE(Int_Mul_Imm): {
+                runtime::Int imm = READ(runtime::Int);
+                runtime::Int a = POP(runtime::Int);
+                PUSH(runtime::Int, a * imm);
+            } NEXT;
+            CASE(Inc_Local): {
+                Address address = READ(Address);
+                STORE_SLOT(runtime::Int, address, SLOT(runtime::Int, address) + 1);
+            } NEXT;
+            CASE(Add_Local): {
+                Address address = READ(Address);
+                runtime::Int imm = READ(runtime::Int);
+                STORE_SLOT(runtime::Int, address, SLOT(runtime::Int, address) + imm);
+            } NEXT;
+            CASE(Load_Indexed): {
+                Size size = READ(Size);
+                runtime::Int index = POP(runtime::Int);
+                auto data = static_cast<uint8_t *>(POP(runtime::Pointer));
+                PUSH_BYTES(data + index * size, size);
+            } NEXT;
+            CASE(Load_Field_Indirect): {
+                Size size = READ(Size);
+                Address offset = READ(Address);
+                auto instance = static_cast<uint8_t *>(POP(runtime::Pointer));
+                PUSH_BYTES(instance + offset, size);
+            } NEXT;
+            CASE(Int_Lt_Jump_False):        INT_COMPARE_JUMP_FALSE(Short_Jump, <);
+            CASE(Int_Le_Jump_False):        INT_COMPARE_JUMP_FALSE(Short_Jump, <=);
+            CASE(Int_Lt_Jump_False_Long):   INT_COMPARE_JUMP_FALSE(Long_Jump, <);
+            CASE(Int_Le_Jump_False_Long):   INT_COMPARE_JUMP_FALSE(Long_Jump, <=);
+                
+            // Register Operations
+            CASE(Reg_Move): {
+                Size size = READ(Size);
+                Address dst = READ(Address);
+                Address src = READ(Address);
+                memmove(bp + dst, bp + src, size);
+            } NEXT;
+            CASE(Reg_Move_Global): {
+                Size size = READ(Size);
+                Address dst = READ(Address);
+                Address src = READ(Address);
+                memmove(bp + dst, stack._buffer + src, size);
+            } NEXT;
+            CASE(Reg_Address): {
+                Address dst = READ(Address);
+                Address src = READ(Address);
+                STORE_SLOT(runtime::Pointer, dst, bp + src);
+            } NEXT;
+            CASE(Reg_Global_Address): {
+                Address dst = READ(Address);
+                Address src = READ(Address);
+                STORE_SLOT(runtime::Pointer, dst, stack._buffer + src);
+            } NEXT;
+            CASE(Reg_Set): {
+                Size size = READ(Size);
+                Address dst = READ(Address);
+                memcpy(bp + dst, ip, size);
+                ip += sizeof(uint64_t);
+            } NEXT;
+            CASE(Reg_Load): {
+                Size size = READ(Size);
+                Address dst = READ(Address);
+                runtime::Pointer src = SLOT(runtime::Pointer, READ(Address));
+                memmove(bp + dst, src, size);
+            } NEXT;
+            CASE(Reg_Load_Indexed): {
+                Size size = READ(Size);
+                Address dst = READ(Address);
+                auto data = static_cast<uint8_t *>(SLOT(runtime::Pointer, READ(Address)));
+                runtime::Int index = SLOT(runtime::Int, READ(Address));
+                memmove(bp + dst, data + index * size, size);
+            } NEXT;
+            CASE(Reg_Store): {
+                Size size = READ(Size);
+                runtime::Pointer dest = SLOT(runtime::Pointer, READ(Address));
+                Address src = READ(Address);
+                memmove(dest, bp + src, size);
+            } NEXT;
+                
+            CASE(Reg_Int_Add):       REG_BIOP(runtime::Int, runtime::Int, +);
+            CASE(Reg_Int_Sub):       REG_BIOP(runtime::Int, runtime::Int, -);
+            CASE(Reg_Int_Mul):       REG_BIOP(runtime::Int, runtime::Int, *);
+            CASE(Reg_Int_Div):       REG_BIOP_CHECK_FOR_ZERO(runtime::Int, runtime::Int, /, "/");
+            CASE(Reg_Int_Mod):       REG_BIOP_CHECK_FOR_ZERO(runtime::Int, runtime::Int, %, "%%");
+            CASE(Reg_Int_Neg):       REG_UNOP(runtime::Int, runtime::Int, -);
+            CASE(Reg_Int_Add_Imm):   REG_BIOP_IMM(runtime::Int, runtime::Int, +);
+            CASE(Reg_Int_Mul_Imm):   REG_BIOP_IMM(runtime::Int, runtime::Int, *);
+            CASE(Reg_Int_Inc): {
+                Address slot = READ(Address);
+                STORE_SLOT(runtime::Int, slot, SLOT(runtime::Int, slot) + 1);
+            } NEXT;
+            CASE(Reg_Int_Dec): {
+                Address slot = READ(Address);
+                STORE_SLOT(runtime::Int, slot, SLOT(runtime::Int, slot) - 1);
+            } NEXT;
+                
+            CASE(Reg_Float_Add):     REG_BIOP(runtime::Float, runtime::Float, +);
+            CASE(Reg_Float_Sub):     REG_BIOP(runtime::Float, runtime::Float, -);
+            CASE(Reg_Float_Mul):     REG_BIOP(runtime::Float, runtime::Float, *);
+            CASE(Reg_Float_Div):     REG_BIOP_CHECK_FOR_ZERO(runtime::Float, runtime::Float, /, "/");
+                
+            CASE(Reg_Not):           REG_UNOP(runtime::Bool, runtime::Bool, !);
+            CASE(Reg_Equal): {
+                Size size = READ(Size);
+                Address dst = READ(Address);
+                Address a = READ(Address);
+                Address b = READ(Address);
+                STORE_SLOT(runtime::Bool, dst, memcmp(bp + a, bp + b, size) == 0);
+            } NEXT;
+            CASE(Reg_Not_Equal): {
+                Size size = READ(Size);
+                Address dst = READ(Address);
+                Address a = READ(Address);
+                Address b = READ(Address);
+                STORE_SLOT(runtime::Bool, dst, memcmp(bp + a, bp + b, size) != 0);
+            } NEXT;
+                
+            CASE(Reg_Int_Less_Than):             REG_BIOP(runtime::Bool, runtime::Int, <);
+            CASE(Reg_Int_Less_Equal):            REG_BIOP(runtime::Bool, runtime::Int, <=);
+            CASE(Reg_Int_Greater_Than):          REG_BIOP(runtime::Bool, runtime::Int, >);
+            CASE(Reg_Int_Greater_Equal):         REG_BIOP(runtime::Bool, runtime::Int, >=);
+            CASE(Reg_Int_Less_Than_Imm):         REG_BIOP_IMM(runtime::Bool, runtime::Int, <);
+            CASE(Reg_Int_Less_Equal_Imm):        REG_BIOP_IMM(runtime::Bool, runtime::Int, <=);
+            CASE(Reg_Int_Greater_Than_Imm):      REG_BIOP_IMM(runtime::Bool, runtime::Int, >);
+            CASE(Reg_Int_Greater_Equal_Imm):     REG_BIOP_IMM(runtime::Bool, runtime::Int, >=);
+            CASE(Reg_Int_Equal_Imm):             REG_BIOP_IMM(runtime::Bool, runtime::Int, ==);
+            CASE(Reg_Int_Not_Equal_Imm):         REG_BIOP_IMM(runtime::Bool, runtime::Int, !=);
+            CASE(Reg_Float_Less_Than):           REG_BIOP(runtime::Bool, runtime::Float, <);
+            CASE(Reg_Float_Less_Equal):          REG_BIOP(runtime::Bool, runtime::Float, <=);
+            CASE(Reg_Float_Greater_Than):        REG_BIOP(runtime::Bool, runtime::Float, >);
+            CASE(Reg_Float_Greater_Equal):       REG_BIOP(runtime::Bool, runtime::Float, >=);
+                
+            CASE(Reg_Jump_True):         REG_JUMP_IF(Short_Jump, true);
+            CASE(Reg_Jump_False):        REG_JUMP_IF(Short_Jump, false);
+            CASE(Reg_Jump_True_Long):    REG_JUMP_IF(Long_Jump, true);
+            CASE(Reg_Jump_False_Long):   REG_JUMP_IF(Long_Jump, false);
 
-            case Opcode::Return: {
-                if (frames.size() - 1 == 0)
+            CASE(Return): {
+                if (frames.size() == 1) {
+                    SAVE_STATE();
                     return;
+                }
                 
-                Size size = READ(Size, frame);
-                void *result = stack.pop(size);
-
-                stack._top = frame->stack_bottom;
+                Size size = READ(Size);
                 
-                stack.push(result, size);
+                // the result may overlap the callee's frame so it has to be moved
+                memmove(bp, sp - size, size);
+                sp = bp + size;
                 
                 frames.pop();
-                frame = &frames.top();
-            } break;    
-            case Opcode::Variadic_Return: {
-                if (frames.size() - 1 == 0)
+                LOAD_FRAME();
+                ENTER_NATIVE();
+            } NEXT;
+            CASE(Variadic_Return): {
+                if (frames.size() == 1) {
+                    SAVE_STATE();
                     return;
+                }
                 
-                Size size = READ(Size, frame);
-                void *result = stack.pop(size);
+                Size size = READ(Size);
                 
-                runtime::Int ret_addr = *reinterpret_cast<runtime::Int *>(stack.get(frame->stack_bottom - static_cast<int>(value_types::Int.size())));
-                ret_addr += value_types::Int.size(); // To pop the ret_addr on the stack as well
-                stack._top = frame->stack_bottom - static_cast<int>(ret_addr);
+                runtime::Int ret_addr = load_value<runtime::Int>(bp - sizeof(runtime::Int));
+                ret_addr += sizeof(runtime::Int); // To pop the ret_addr on the stack as well
+                uint8_t *dest = bp - ret_addr;
                 
-                stack.push(result, size);
+                memmove(dest, sp - size, size);
+                sp = dest + size;
                 
                 frames.pop();
-                frame = &frames.top();
-            } break;
+                LOAD_FRAME();
+                ENTER_NATIVE();
+            } NEXT;
                 
+#if THREADED_DISPATCH
+            CASE(None):
+                internal_error("Unknown opcode: %d.", Opcode::None);
+    }
+#else
             default:
                 internal_error("Unknown opcode: %d.", op);
                 break;
         }
     }
+#endif
     
     #undef READ
+    #undef CHECK_STACK
+    #undef PUSH_BYTES
+    #undef PUSH
+    #undef POP
+    #undef TOP
+    #undef SAVE_STATE
+    #undef LOAD_FRAME
+    #undef ENTER_NATIVE
+    #undef WARM_UP_LOOP
     #undef UNOP
     #undef BIOP
     #undef BIOP_CHECK_FOR_ZERO
+    #undef SLOT
+    #undef STORE_SLOT
+    #undef REG_UNOP
+    #undef REG_BIOP
+    #undef REG_BIOP_IMM
+    #undef REG_BIOP_CHECK_FOR_ZERO
+    #undef JUMP
+    #undef LOOP
+    #undef JUMP_IF
+    #undef INT_COMPARE_JUMP_FALSE
+    #undef REG_JUMP_IF
+    #undef COUNT_DISPATCH
+    #undef CASE
+    #undef NEXT
 }
 
 void VM::call(Function_Definition *fn, int arg_size) {
+    if (frames.full()) {
+        stack_overflow("Exceeded the maximum call depth. Use '--max-call-depth' to raise it.");
+    }
+    
+    // register instructions write to their slots without checking the stack
+    if (static_cast<size_t>(stack._top - arg_size) + fn->frame_size > Stack::Size) {
+        stack_overflow("Ran out of stack memory.");
+    }
+    
+    if (jit_threshold) warm_up(fn);
+    
     Call_Frame frame;
     frame.pc = 0;
     frame.stack_bottom = stack._top - arg_size;
-    frame.instructions = &fn->instructions;
+    frame.function = fn;
+    frame.instructions = fn->code();
     frames.push(frame);
 }
 
+void VM::tail_call(Function_Definition *fn, int arg_size) {
+    Call_Frame &frame = frames.top();
+    
+    // the callee returns to wherever the current function would have returned to,
+    // for variadic functions that's below their varargs
+    int bottom = frame.stack_bottom;
+    if (frame.function->varargs) {
+        runtime::Int ret_addr = load_value<runtime::Int>(stack._buffer + bottom - sizeof(runtime::Int));
+        bottom -= ret_addr + sizeof(runtime::Int);
+    }
+    
+    if (static_cast<size_t>(bottom) + fn->frame_size > Stack::Size) {
+        stack_overflow("Ran out of stack memory.");
+    }
+    
+    if (jit_threshold) warm_up(fn);
+    
+    memmove(stack._buffer + bottom, stack._buffer + stack._top - arg_size, arg_size);
+    stack._top = bottom + arg_size;
+    
+    frame.pc = 0;
+    frame.stack_bottom = bottom;
+    frame.function = fn;
+    frame.instructions = fn->code();
+}
+
+void VM::warm_up(Function_Definition *fn) {
+    if (fn->hotness < jit_threshold && ++fn->hotness == jit_threshold) {
+        fn->native = jit_compile(fn);
+    }
+}
+
+void VM::stack_overflow(const char *reason) {
+    // collapse runs of the same function so deep recursion stays readable
+    std::string chain;
+    for (size_t i = 0; i < frames.size();) {
+        Function_Definition *fn = frames[i].function;
+        
+        size_t repeats = 1;
+        while (i + repeats < frames.size() && frames[i + repeats].function == fn) {
+            repeats++;
+        }
+        
+        chain += "\n    ";
+        chain.append(fn->name.c_str(), fn->name.size());
+        if (repeats > 1) {
+            chain += " (x" + std::to_string(repeats) + ")";
+        }
+        
+        i += repeats;
+    }
+    
+    error(Code_Location{ 0,0,"<NO-LOC>" }, "Stack overflow at a call depth of %zu. %s\nCall chain (most recent call last):%s", frames.size(), reason, chain.c_str());
+}
+
 void VM::print_stack() {
     for (size_t i = 0; i < stack._top; i++) {
         uint8_t byte = stack._buffer[i];
@@ -427,10 +926,30 @@ void VM::print_stack() {
     }
 }
 
-void print_code(std::vector<uint8_t> &code, Data_Section &constants, Data_Section &str_constants) {
+void print_code(Byte_Span code, Byte_Span constants, Byte_Span str_constants) {
     #define IDX "%04zX: "
-    #define READ(type, i) *reinterpret_cast<type *>(&code[i]); i += sizeof(type)
+    #define READ(type, i) *reinterpret_cast<const type *>(&code[i]); i += sizeof(type)
     #define MARK(i) size_t mark = i++
+    #define REG_NAME(op) register_opcode_names[static_cast<size_t>(op) - static_cast<size_t>(Opcode::Reg_Move)]
+    #define PRINT_JUMP(name, width, dir) { \
+        MARK(i); \
+        width jump = READ(width, i); \
+        printf(IDX name " => %zX\n", mark, i dir jump); \
+    } break
+    
+    static const char *register_opcode_names[] = {
+        "Reg_Move", "Reg_Move_Global", "Reg_Address", "Reg_Global_Address", "Reg_Set", "Reg_Load", "Reg_Load_Indexed", "Reg_Store",
+        "Reg_Int_Add", "Reg_Int_Sub", "Reg_Int_Mul", "Reg_Int_Div", "Reg_Int_Mod", "Reg_Int_Neg",
+        "Reg_Int_Add_Imm", "Reg_Int_Mul_Imm", "Reg_Int_Inc", "Reg_Int_Dec",
+        "Reg_Float_Add", "Reg_Float_Sub", "Reg_Float_Mul", "Reg_Float_Div",
+        "Reg_Not", "Reg_Equal", "Reg_Not_Equal",
+        "Reg_Int_Less_Than", "Reg_Int_Less_Equal", "Reg_Int_Greater_Than", "Reg_Int_Greater_Equal",
+        "Reg_Int_Less_Than_Imm", "Reg_Int_Less_Equal_Imm", "Reg_Int_Greater_Than_Imm", "Reg_Int_Greater_Equal_Imm",
+        "Reg_Int_Equal_Imm", "Reg_Int_Not_Equal_Imm",
+        "Reg_Float_Less_Than", "Reg_Float_Less_Equal", "Reg_Float_Greater_Than", "Reg_Float_Greater_Equal",
+        "Reg_Jump_True", "Reg_Jump_False", "Reg_Jump_True_Long", "Reg_Jump_False_Long",
+    };
+    static_assert(sizeof(register_opcode_names) / sizeof(*register_opcode_names) == Opcode_Count - static_cast<size_t>(Opcode::Reg_Move), "register_opcode_names is out of sync with the Opcode enum.");
     
     size_t i = 0;
     while (i < code.size()) {
@@ -491,15 +1010,15 @@ void print_code(std::vector<uint8_t> &code, Data_Section &constants, Data_Sectio
             case Opcode::Load_Const: {
                 MARK(i);
                 Size size = READ(Size, i);
-                size_t constant = READ(size_t, i);
-                printf(IDX "Load_Const %ub [%zu]\n", mark, size * 8, constant);
+                Constant_Index constant = READ(Constant_Index, i);
+                printf(IDX "Load_Const %ub [%u]\n", mark, size * 8, constant);
             } break;
             case Opcode::Load_Const_String: {
                 MARK(i);
-                size_t constant = READ(size_t, i);
-                size_t len = *reinterpret_cast<size_t *>(&str_constants[constant]);
-                char *s = reinterpret_cast<char *>(&str_constants[constant + sizeof(size_t)]);
-                printf(IDX "Load_Const_String [%zu] \"%.*s\"\n", mark, constant, len, s);
+                Constant_Index constant = READ(Constant_Index, i);
+                size_t len = *reinterpret_cast<const size_t *>(&str_constants[constant]);
+                const char *s = reinterpret_cast<const char *>(&str_constants[constant + sizeof(size_t)]);
+                printf(IDX "Load_Const_String [%u] \"%.*s\"\n", mark, constant, (int)len, s);
             } break;
                 
             // Arithmetic
@@ -765,6 +1284,12 @@ void print_code(std::vector<uint8_t> &code, Data_Section &constants, Data_Sectio
                 Address flush_point = READ(Address, i);
                 printf(IDX "Flush => %zu\n", mark, flush_point);
             } break;
+            case Opcode::Flush_Value: {
+                MARK(i);
+                Size size = READ(Size, i);
+                Address flush_point = READ(Address, i);
+                printf(IDX "Flush_Value %ub => %u\n", mark, size * 8, flush_point);
+            } break;
             case Opcode::Return: {
                 MARK(i);
                 Size size = READ(Size, i);
@@ -777,42 +1302,18 @@ void print_code(std::vector<uint8_t> &code, Data_Section &constants, Data_Sectio
             } break;
                 
             // Branching
-            case Opcode::Jump: {
-                MARK(i);
-                size_t jump = READ(size_t, i);
-                size_t dest = mark + jump + 9; // add 9 for instruction
-                printf(IDX "Jump => %zX\n", mark, dest);
-            } break;
-            case Opcode::Loop: {
-                MARK(i);
-                size_t jump = READ(size_t, i);
-                size_t dest = mark - jump + 9; // add 9 for instruction
-                printf(IDX "Loop => %zX\n", mark, dest);
-            } break;
-            case Opcode::Jump_True: {
-                MARK(i);
-                size_t jump = READ(size_t, i);
-                size_t dest = mark + jump + 9; // add 9 for instruction
-                printf(IDX "Jump_True => %zX\n", mark, dest);
-            } break;
-            case Opcode::Jump_False: {
-                MARK(i);
-                size_t jump = READ(size_t, i);
-                size_t dest = mark + jump + 9; // add 9 for instruction
-                printf(IDX "Jump_False => %zX\n", mark, dest);
-            } break;
-            case Opcode::Jump_True_No_Pop: {
-                MARK(i);
-                size_t jump = READ(size_t, i);
-                size_t dest = mark + jump + 9; // add 9 for instruction
-                printf(IDX "Jump_True_No_Pop => %zX\n", mark, dest);
-            } break;
-            case Opcode::Jump_False_No_Pop: {
-                MARK(i);
-                size_t jump = READ(size_t, i);
-                size_t dest = mark + jump + 9; // add 9 for instruction
-                printf(IDX "Jump_False_No_Pop => %zX\n", mark, dest);
-            } break;
+            case Opcode::Jump:                      PRINT_JUMP("Jump", Short_Jump, +);
+            case Opcode::Loop:                      PRINT_JUMP("Loop", Short_Jump, -);
+            case Opcode::Jump_True:                 PRINT_JUMP("Jump_True", Short_Jump, +);
+            case Opcode::Jump_False:                PRINT_JUMP("Jump_False", Short_Jump, +);
+            case Opcode::Jump_True_No_Pop:          PRINT_JUMP("Jump_True_No_Pop", Short_Jump, +);
+            case Opcode::Jump_False_No_Pop:         PRINT_JUMP("Jump_False_No_Pop", Short_Jump, +);
+            case Opcode::Jump_Long:                 PRINT_JUMP("Jump_Long", Long_Jump, +);
+            case Opcode::Loop_Long:                 PRINT_JUMP("Loop_Long", Long_Jump, -);
+            case Opcode::Jump_True_Long:            PRINT_JUMP("Jump_True_Long", Long_Jump, +);
+            case Opcode::Jump_False_Long:           PRINT_JUMP("Jump_False_Long", Long_Jump, +);
+            case Opcode::Jump_True_No_Pop_Long:     PRINT_JUMP("Jump_True_No_Pop_Long", Long_Jump, +);
+            case Opcode::Jump_False_No_Pop_Long:    PRINT_JUMP("Jump_False_No_Pop_Long", Long_Jump, +);
                 
             // Invocation
             case Opcode::Call: {
@@ -822,9 +1323,21 @@ void print_code(std::vector<uint8_t> &code, Data_Section &constants, Data_Sectio
             } break;
             case Opcode::Call_Builtin: {
                 MARK(i);
-                Builtin builtin = READ(Builtin, i);
+                Builtin_Index builtin = READ(Builtin_Index, i);
+                Size arg_size = READ(Size, i);
+                printf(IDX "Call_Builtin #%u %ub\n", mark, builtin, arg_size * 8);
+            } break;
+            case Opcode::Call_Direct: {
+                MARK(i);
+                Function_Index fn = READ(Function_Index, i);
                 Size arg_size = READ(Size, i);
-                printf(IDX "Call_Builtin %p %ub\n", mark, builtin, arg_size * 8);
+                printf(IDX "Call_Direct #%u %ub\n", mark, fn, arg_size * 8);
+            } break;
+            case Opcode::Tail_Call: {
+                MARK(i);
+                Function_Index fn = READ(Function_Index, i);
+                Size arg_size = READ(Size, i);
+                printf(IDX "Tail_Call #%u %ub\n", mark, fn, arg_size * 8);
             } break;
                 
             // Cast
@@ -853,6 +1366,139 @@ void print_code(std::vector<uint8_t> &code, Data_Section &constants, Data_Sectio
                 i++;
                 break;
                 
+            // Fused
+            case Opcode::Int_Add_Imm: {
+                MARK(i);
+                runtime::Int imm = READ(runtime::Int, i);
+                printf(IDX "Int_Add_Imm (%lld)\n", mark, static_cast<long long>(imm));
+            } break;
+            case Opcode::Int_Mul_Imm: {
+                MARK(i);
+                runtime::Int imm = READ(runtime::Int, i);
+                printf(IDX "Int_Mul_Imm (%lld)\n", mark, static_cast<long long>(imm));
+            } break;
+            case Opcode::Inc_Local: {
+                MARK(i);
+                Address address = READ(Address, i);
+                printf(IDX "Inc_Local [%u]\n", mark, address);
+            } break;
+            case Opcode::Add_Local: {
+                MARK(i);
+                Address address = READ(Address, i);
+                runtime::Int imm = READ(runtime::Int, i);
+                printf(IDX "Add_Local [%u] (%lld)\n", mark, address, static_cast<long long>(imm));
+            } break;
+            case Opcode::Load_Indexed: {
+                MARK(i);
+                Size size = READ(Size, i);
+                printf(IDX "Load_Indexed %ub\n", mark, size * 8);
+            } break;
+            case Opcode::Load_Field_Indirect: {
+                MARK(i);
+                Size size = READ(Size, i);
+                Address offset = READ(Address, i);
+                printf(IDX "Load_Field_Indirect %ub +%u\n", mark, size * 8, offset);
+            } break;
+            case Opcode::Int_Lt_Jump_False:         PRINT_JUMP("Int_Lt_Jump_False", Short_Jump, +);
+            case Opcode::Int_Le_Jump_False:         PRINT_JUMP("Int_Le_Jump_False", Short_Jump, +);
+            case Opcode::Int_Lt_Jump_False_Long:    PRINT_JUMP("Int_Lt_Jump_False_Long", Long_Jump, +);
+            case Opcode::Int_Le_Jump_False_Long:    PRINT_JUMP("Int_Le_Jump_False_Long", Long_Jump, +);
+                
+            // Register
+            case Opcode::Reg_Move:
+            case Opcode::Reg_Move_Global:
+            case Opcode::Reg_Load:
+            case Opcode::Reg_Store: {
+                MARK(i);
+                Size size = READ(Size, i);
+                Address dst = READ(Address, i);
+                Address src = READ(Address, i);
+                printf(IDX "%s %ub [%u] <- [%u]\n", mark, REG_NAME(op), size * 8, dst, src);
+            } break;
+            case Opcode::Reg_Address:
+            case Opcode::Reg_Global_Address:
+            case Opcode::Reg_Int_Neg:
+            case Opcode::Reg_Not: {
+                MARK(i);
+                Address dst = READ(Address, i);
+                Address src = READ(Address, i);
+                printf(IDX "%s [%u] <- [%u]\n", mark, REG_NAME(op), dst, src);
+            } break;
+            case Opcode::Reg_Set: {
+                MARK(i);
+                Size size = READ(Size, i);
+                Address dst = READ(Address, i);
+                uint64_t value = READ(uint64_t, i);
+                printf(IDX "Reg_Set %ub [%u] <- (%llu)\n", mark, size * 8, dst, static_cast<unsigned long long>(value));
+            } break;
+            case Opcode::Reg_Int_Inc:
+            case Opcode::Reg_Int_Dec: {
+                MARK(i);
+                Address slot = READ(Address, i);
+                printf(IDX "%s [%u]\n", mark, REG_NAME(op), slot);
+            } break;
+            case Opcode::Reg_Int_Add:
+            case Opcode::Reg_Int_Sub:
+            case Opcode::Reg_Int_Mul:
+            case Opcode::Reg_Int_Div:
+            case Opcode::Reg_Int_Mod:
+            case Opcode::Reg_Float_Add:
+            case Opcode::Reg_Float_Sub:
+            case Opcode::Reg_Float_Mul:
+            case Opcode::Reg_Float_Div:
+            case Opcode::Reg_Int_Less_Than:
+            case Opcode::Reg_Int_Less_Equal:
+            case Opcode::Reg_Int_Greater_Than:
+            case Opcode::Reg_Int_Greater_Equal:
+            case Opcode::Reg_Float_Less_Than:
+            case Opcode::Reg_Float_Less_Equal:
+            case Opcode::Reg_Float_Greater_Than:
+            case Opcode::Reg_Float_Greater_Equal: {
+                MARK(i);
+                Address dst = READ(Address, i);
+                Address a = READ(Address, i);
+                Address b = READ(Address, i);
+                printf(IDX "%s [%u] <- [%u] [%u]\n", mark, REG_NAME(op), dst, a, b);
+            } break;
+            case Opcode::Reg_Int_Add_Imm:
+            case Opcode::Reg_Int_Mul_Imm:
+            case Opcode::Reg_Int_Less_Than_Imm:
+            case Opcode::Reg_Int_Less_Equal_Imm:
+            case Opcode::Reg_Int_Greater_Than_Imm:
+            case Opcode::Reg_Int_Greater_Equal_Imm:
+            case Opcode::Reg_Int_Equal_Imm:
+            case Opcode::Reg_Int_Not_Equal_Imm: {
+                MARK(i);
+                Address dst = READ(Address, i);
+                Address a = READ(Address, i);
+                runtime::Int imm = READ(runtime::Int, i);
+                printf(IDX "%s [%u] <- [%u] (%lld)\n", mark, REG_NAME(op), dst, a, static_cast<long long>(imm));
+            } break;
+            case Opcode::Reg_Load_Indexed:
+            case Opcode::Reg_Equal:
+            case Opcode::Reg_Not_Equal: {
+                MARK(i);
+                Size size = READ(Size, i);
+                Address dst = READ(Address, i);
+                Address a = READ(Address, i);
+                Address b = READ(Address, i);
+                printf(IDX "%s %ub [%u] <- [%u] [%u]\n", mark, REG_NAME(op), size * 8, dst, a, b);
+            } break;
+            case Opcode::Reg_Jump_True:
+            case Opcode::Reg_Jump_False: {
+                MARK(i);
+                Address cond = READ(Address, i);
+                Short_Jump jump = READ(Short_Jump, i);
+                printf(IDX "%s [%u] => %zX\n", mark, REG_NAME(op), cond, i + jump);
+            } break;
+            case Opcode::Reg_Jump_True_Long:
+            case Opcode::Reg_Jump_False_Long: {
+                MARK(i);
+                Address cond = READ(Address, i);
+                Long_Jump jump = READ(Long_Jump, i);
+                printf(IDX "%s [%u] => %zX\n", mark, REG_NAME(op), cond, i + jump);
+            } break;
+                
             default:
                 internal_error("Invalid opcode: %d.", op);
                 break;
@@ -864,4 +1510,6 @@ void print_code(std::vector<uint8_t> &code, Data_Section &constants, Data_Sectio
     #undef IDX
     #undef READ
     #undef MARK
+    #undef REG_NAME
+    #undef PRINT_JUMP
 }
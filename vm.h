@@ -8,12 +8,13 @@
 
 #pragma once
 
-#include <stack>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <string>
 
 #include "String.h"
+#include "builtins.h"
 #include "mem.h"
 #include "typer.h"
 
@@ -119,6 +120,7 @@ enum class Opcode : uint8_t {
     Clear_Allocate, //    BYTE_ZERO,
 //    BYTE_HEAP_ALLOCATE,
     Flush,  // BYTE_FLUSH,
+    Flush_Value,    // Flush that keeps the value on top, what an inlined Return becomes
     Return, // BYTE_RETURN,
     Variadic_Return,
     
@@ -130,9 +132,22 @@ enum class Opcode : uint8_t {
     Jump_True_No_Pop,
     Jump_False_No_Pop,
     
+    //
+    // Jumps are relative to the end of the instruction and normally take a
+    // Short_Jump. The _Long forms take a Long_Jump for when that's too short.
+    //
+    Jump_Long,
+    Loop_Long,
+    Jump_True_Long,
+    Jump_False_Long,
+    Jump_True_No_Pop_Long,
+    Jump_False_No_Pop_Long,
+    
     // INVOCATION
     Call,   //    BYTE_CALL,
     Call_Builtin,   //    BYTE_CALL_NATIVE,
+    Call_Direct,    // callee known at compile time, saves pushing and popping its Function_Definition*
+    Tail_Call,      // Call_Direct that replaces the current frame instead of pushing a new one
     
     // CAST
     Cast_Byte_Int,
@@ -140,17 +155,106 @@ enum class Opcode : uint8_t {
     Cast_Bool_Int,
     Cast_Char_Int,
     Cast_Int_Float,
-    Cast_Float_Int
+    Cast_Float_Int,
+    
+    // FUSED
+    //
+    // Single instruction forms of the sequences that make up most of the
+    // dispatches in typical programs. The compiler emits some of these
+    // directly, peephole_optimize() rewrites whatever else it can find.
+    //
+    Int_Add_Imm,
+    Int_Mul_Imm,
+    Inc_Local,
+    Add_Local,  // Inc_Local by any amount, what pointer bumps and x += n become
+    Load_Indexed,
+    Load_Field_Indirect,
+    Int_Lt_Jump_False,
+    Int_Le_Jump_False,
+    Int_Lt_Jump_False_Long,
+    Int_Le_Jump_False_Long,
+    
+    // REGISTER
+    //
+    // Three-address forms of the common stack operations. Their operands are
+    // frame slots (Addresses from the stack bottom) rather than the top of the
+    // stack. Only translate_to_registers() produces these.
+    //
+    Reg_Move,
+    Reg_Move_Global,
+    Reg_Address,
+    Reg_Global_Address,
+    Reg_Set,
+    Reg_Load,
+    Reg_Load_Indexed,
+    Reg_Store,
+    
+    Reg_Int_Add,
+    Reg_Int_Sub,
+    Reg_Int_Mul,
+    Reg_Int_Div,
+    Reg_Int_Mod,
+    Reg_Int_Neg,
+    Reg_Int_Add_Imm,
+    Reg_Int_Mul_Imm,
+    Reg_Int_Inc,
+    Reg_Int_Dec,
+    
+    Reg_Float_Add,
+    Reg_Float_Sub,
+    Reg_Float_Mul,
+    Reg_Float_Div,
+    
+    Reg_Not,
+    Reg_Equal,
+    Reg_Not_Equal,
+    
+    Reg_Int_Less_Than,
+    Reg_Int_Less_Equal,
+    Reg_Int_Greater_Than,
+    Reg_Int_Greater_Equal,
+    
+    Reg_Int_Less_Than_Imm,
+    Reg_Int_Less_Equal_Imm,
+    Reg_Int_Greater_Than_Imm,
+    Reg_Int_Greater_Equal_Imm,
+    Reg_Int_Equal_Imm,
+    Reg_Int_Not_Equal_Imm,
+    
+    Reg_Float_Less_Than,
+    Reg_Float_Less_Equal,
+    Reg_Float_Greater_Than,
+    Reg_Float_Greater_Equal,
+    
+    Reg_Jump_True,
+    Reg_Jump_False,
+    Reg_Jump_True_Long,
+    Reg_Jump_False_Long,
 };
 
+constexpr size_t Opcode_Count = static_cast<size_t>(Opcode::Reg_Jump_False_Long) + 1;
+
+//
+// Counts every instruction the VM dispatches. Only meant for measuring the
+// effect of bytecode changes so it's off unless FOX_COUNT_DISPATCHES is defined.
+//
+#define COUNT_DISPATCHES defined(FOX_COUNT_DISPATCHES)
+
 struct Call_Frame {
     int pc;
     int stack_bottom;
-    std::vector<uint8_t> *instructions;
+    Function_Definition *function;
+    Byte_Span instructions;
 };
 
 using Data_Section = std::vector<uint8_t>;
-using Call_Stack = std::stack<Call_Frame>;
+
+// Where each constant in a Data_Section starts and how big it is, keyed by a hash of its contents.
+struct Data_Section_Entry {
+    size_t offset;
+    size_t size;
+};
+using Data_Section_Index = std::unordered_multimap<size_t, Data_Section_Entry>;
 
 struct VM;
 struct Stack {
@@ -183,22 +287,58 @@ struct Stack {
     }
 };
 
+//
+// The call frames, allocated as calls get deeper. A call that can return
+// keeps at least a byte of arguments or locals on the stack, so by default
+// any recursion that fits in the stack memory fits here too.
+//
+struct Call_Stack {
+    static constexpr size_t Default_Max_Depth = Stack::Size;
+    static constexpr size_t Initial_Capacity = 256;
+    
+    size_t _count = 0;
+    size_t _capacity;
+    size_t _max_depth;
+    std::unique_ptr<Call_Frame[]> _frames;
+    
+    Call_Stack(size_t max_depth);
+    
+    void push(const Call_Frame &frame) {
+        if (_count == _capacity) grow();
+        _frames[_count++] = frame;
+    }
+    void pop() { _count--; }
+    Call_Frame &top() { return _frames[_count - 1]; }
+    size_t size() const { return _count; }
+    bool full() const { return _count == _max_depth; }
+    Call_Frame &operator[](size_t idx) { return _frames[idx]; }
+    
+    void grow();
+};
+
 //#define WB_SIZE 512
 //using Workbench = uint8_t[WB_SIZE];
 
 struct Compiler;
 struct VM {
-    Data_Section &constants;
-    Data_Section &str_constants;
+    Byte_Span constants;
+    Byte_Span str_constants;
+    const std::vector<Builtin> &builtins;
+    const std::vector<Function_Definition *> &functions;
     Call_Stack frames;
     Stack stack;
+    size_t dispatch_count = 0;
+    size_t jit_threshold = 0; // calls and loop iterations before a function is compiled to native code, 0 never compiles
 //    Workbench workbench;
     
-    VM(Data_Section &constants, Data_Section &str_constants);
+    VM(Byte_Span constants, Byte_Span str_constants, const std::vector<Builtin> &builtins, const std::vector<Function_Definition *> &functions, size_t max_call_depth = Call_Stack::Default_Max_Depth);
     
     void run();
     void call(Function_Definition *fn, int arg_size);
+    void tail_call(Function_Definition *fn, int arg_size);
+    void warm_up(Function_Definition *fn);
+    [[noreturn]] void stack_overflow(const char *reason);
     void print_stack();
 };
 
-void print_code(std::vector<uint8_t> &code, Data_Section &constants, Data_Section &str_constants);
+void print_code(Byte_Span code, Byte_Span constants, Byte_Span str_constants);
@@ -0,0 +1,582 @@
+//
+//  watch.cpp
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#include "watch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string.h>
+#include <thread>
+#include <unordered_set>
+
+#include "bytecode.h"
+#include "error.h"
+#include "image.h"
+#include "interpreter.h"
+
+using Members = std::unordered_map<Symbol, Module::Member>;
+using Methods = std::unordered_map<Symbol, Method>;
+
+// Symbols are numbered in the order they're first seen, so interfaces are sorted by name instead.
+static bool by_name(Symbol a, Symbol b) {
+    return strcmp(a.c_str(), b.c_str()) < 0;
+}
+
+//
+// A type the way a module importing `module` sees it. The module's own types
+// go by name as they get new UUIDs every time it's compiled, anything else by
+// UUID so a type being swapped for another of the same name shows up.
+//
+static void describe_type(std::string &out, const Value_Type &type, Module *module) {
+    auto describe_defn = [&](Symbol name, UUID uuid, Module *owner) {
+        out.append(name.c_str(), name.size());
+        if (owner != module) {
+            out += '#';
+            out += std::to_string(uuid);
+        }
+    };
+
+    if (type.is_mut) {
+        out += "mut ";
+    }
+
+    switch (type.kind) {
+        case Value_Type_Kind::None:
+        case Value_Type_Kind::Unresolved_Type:
+            internal_error("Unresolved type in a module's interface.");
+            break;
+        case Value_Type_Kind::Void:  out += "void";  break;
+        case Value_Type_Kind::Byte:  out += "byte";  break;
+        case Value_Type_Kind::Bool:  out += "bool";  break;
+        case Value_Type_Kind::Char:  out += "char";  break;
+        case Value_Type_Kind::Int:   out += "int";   break;
+        case Value_Type_Kind::Float: out += "float"; break;
+        case Value_Type_Kind::Str:   out += "str";   break;
+        case Value_Type_Kind::Ptr:
+            out += "*";
+            describe_type(out, *type.data.ptr.child_type, module);
+            break;
+        case Value_Type_Kind::Array:
+            out += "[" + std::to_string(type.data.array.count) + "]";
+            describe_type(out, *type.data.array.element_type, module);
+            break;
+        case Value_Type_Kind::Slice:
+            out += "[]";
+            describe_type(out, *type.data.slice.element_type, module);
+            break;
+        case Value_Type_Kind::Tuple:
+            out += "(";
+            for (auto &child : type.data.tuple.child_types) {
+                describe_type(out, child, module);
+                out += ", ";
+            }
+            out += ")";
+            break;
+        case Value_Type_Kind::Range:
+            out += type.data.range.inclusive ? "IRange<" : "Range<";
+            describe_type(out, *type.data.range.child_type, module);
+            out += ">";
+            break;
+        case Value_Type_Kind::Struct: {
+            auto defn = type.data.struct_.defn;
+            describe_defn(defn->name, defn->uuid, defn->module);
+        } break;
+        case Value_Type_Kind::Enum: {
+            auto defn = type.data.enum_.defn;
+            describe_defn(defn->name, defn->uuid, defn->module);
+        } break;
+        case Value_Type_Kind::Trait: {
+            auto defn = type.data.trait.defn;
+            if (auto real_type = type.data.trait.real_type) {
+                out += "<";
+                describe_type(out, *real_type, module);
+                out += " as ";
+                describe_defn(defn->name, defn->uuid, defn->module);
+                out += ">";
+            } else {
+                describe_defn(defn->name, defn->uuid, defn->module);
+            }
+        } break;
+        case Value_Type_Kind::Function:
+            out += "(";
+            for (auto &arg : type.data.func.arg_types) {
+                describe_type(out, arg, module);
+                out += ", ";
+            }
+            out += ") -> ";
+            describe_type(out, *type.data.func.return_type, module);
+            break;
+        case Value_Type_Kind::Type:
+            out += "typeof(";
+            describe_type(out, *type.data.type.type, module);
+            out += ")";
+            break;
+    }
+}
+
+static void describe_function(std::string &out, Function_Definition *fn, Module *module) {
+    out.append(fn->name.c_str(), fn->name.size());
+    out += fn->varargs ? " varargs " : " ";
+    describe_type(out, fn->type, module);
+}
+
+static void describe_methods(std::string &out, Interpreter *interp, const Methods &methods, Module *module, bool own_methods_only) {
+    std::vector<Symbol> names;
+    for (auto &[name, method] : methods) {
+        if (!own_methods_only || interp->functions.get_func_by_uuid(method.uuid)->module == module) {
+            names.push_back(name);
+        }
+    }
+    std::sort(names.begin(), names.end(), by_name);
+
+    for (auto &name : names) {
+        auto &method = methods.at(name);
+        out += method.is_static ? "\n\tstatic fn " : "\n\tfn ";
+        describe_function(out, interp->functions.get_func_by_uuid(method.uuid), module);
+    }
+}
+
+//
+// Everything in `members` an importer's code can depend on: the names and
+// types of functions and methods and the layouts of structs and enums. Methods
+// other modules have added to the module's types are left out when
+// `own_methods_only` is set.
+//
+static std::string describe_interface(Interpreter *interp, Module *module, const Members &members, bool own_methods_only) {
+    std::vector<Symbol> ids;
+    for (auto &[id, _] : members) {
+        ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end(), by_name);
+
+    std::string out;
+    for (auto &id : ids) {
+        auto &member = members.at(id);
+        switch (member.kind) {
+            case Module::Member::Function:
+                out += "fn ";
+                describe_function(out, interp->functions.get_func_by_uuid(member.uuid), module);
+                break;
+
+            case Module::Member::Struct: {
+                auto defn = interp->types.get_struct_by_uuid(member.uuid);
+                out += "struct " + id.str() + " " + std::to_string(defn->size);
+                for (auto &field : defn->fields) {
+                    out += "\n\t";
+                    out.append(field.id.c_str(), field.id.size());
+                    out += " @" + std::to_string(field.offset) + " ";
+                    describe_type(out, field.type, module);
+                }
+                describe_methods(out, interp, defn->methods, module, own_methods_only);
+            } break;
+
+            case Module::Member::Enum: {
+                auto defn = interp->types.get_enum_by_uuid(member.uuid);
+                out += defn->is_sumtype ? "sumtype " : "enum ";
+                out += id.str() + " " + std::to_string(defn->size);
+                for (auto &variant : defn->variants) {
+                    out += "\n\t";
+                    out.append(variant.id.c_str(), variant.id.size());
+                    out += " = " + std::to_string(variant.tag);
+                    for (auto &field : variant.payload) {
+                        out += ", @" + std::to_string(field.offset) + " ";
+                        describe_type(out, field.type, module);
+                    }
+                }
+                describe_methods(out, interp, defn->methods, module, own_methods_only);
+            } break;
+
+            case Module::Member::Submodule:
+                out += "mod " + id.str() + " ";
+                out += interp->modules.get_module_by_uuid(member.uuid)->module_path.str();
+                break;
+        }
+        out += "\n";
+    }
+    return out;
+}
+
+void update_interfaces(Interpreter *interp, Module *module) {
+    std::string interface = describe_interface(interp, module, module->members, false);
+    module->interface_hash = hash_bytes(interface.data(), interface.size());
+
+    // methods added to another module's types are part of its interface
+    std::unordered_set<Module *> extended;
+    auto find_extended = [&](Module *owner, const Methods &methods) {
+        if (owner == module || extended.count(owner)) return;
+        for (auto &[_, method] : methods) {
+            if (interp->functions.get_func_by_uuid(method.uuid)->module == module) {
+                extended.insert(owner);
+                return;
+            }
+        }
+    };
+    for (auto &[_, defn] : interp->types.structs) find_extended(defn.module, defn.methods);
+    for (auto &[_, defn] : interp->types.enums) find_extended(defn.module, defn.methods);
+
+    for (auto owner : extended) {
+        interface = describe_interface(interp, owner, owner->members, false);
+        owner->interface_hash = hash_bytes(interface.data(), interface.size());
+    }
+
+    // an import's interface changing because of what this module added to it doesn't need this module compiled again
+    for (auto &import : module->imports) {
+        import.interface_hash = import.module->interface_hash;
+    }
+}
+
+// Everything a module has defined, whether the compile it came from succeeded or not.
+struct Definitions {
+    std::vector<Function_Definition *> funcs;
+    std::vector<UUID> structs;
+    std::vector<UUID> enums;
+    std::vector<UUID> traits;
+};
+
+static Definitions definitions_of(Interpreter *interp, Module *module) {
+    Definitions defns;
+    for (auto &[_, fn] : interp->functions.funcs) {
+        if (fn.module == module) defns.funcs.push_back(&fn);
+    }
+    for (auto &[uuid, defn] : interp->types.structs) {
+        if (defn.module == module) defns.structs.push_back(uuid);
+    }
+    for (auto &[uuid, defn] : interp->types.enums) {
+        if (defn.module == module) defns.enums.push_back(uuid);
+    }
+    for (auto &[uuid, defn] : interp->types.traits) {
+        if (defn.module == module) defns.traits.push_back(uuid);
+    }
+    return defns;
+}
+
+static void drop_definitions(Interpreter *interp, const Definitions &defns, const std::unordered_set<UUID> &kept) {
+    for (auto fn : defns.funcs) {
+        if (!kept.count(fn->uuid)) interp->functions.remove_func(fn);
+    }
+    for (auto uuid : defns.structs) {
+        if (!kept.count(uuid)) interp->types.structs.erase(uuid);
+    }
+    for (auto uuid : defns.enums) {
+        if (!kept.count(uuid)) interp->types.enums.erase(uuid);
+    }
+    for (auto uuid : defns.traits) {
+        if (!kept.count(uuid)) interp->types.traits.erase(uuid);
+    }
+}
+
+// A method a module has added to a type from another module.
+struct Added_Method {
+    Module *owner;
+    Methods *methods;
+    Symbol name;
+    Method method;
+};
+
+// Takes the methods `module` has added to other modules' types off them, they're added again when it compiles.
+static std::vector<Added_Method> remove_added_methods(Interpreter *interp, Module *module) {
+    std::vector<Added_Method> removed;
+    auto remove_from = [&](Module *owner, Methods &methods) {
+        if (owner == module) return;
+        for (auto it = methods.begin(); it != methods.end();) {
+            if (interp->functions.get_func_by_uuid(it->second.uuid)->module == module) {
+                removed.push_back({ owner, &methods, it->first, it->second });
+                it = methods.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    };
+    for (auto &[_, defn] : interp->types.structs) remove_from(defn.module, defn.methods);
+    for (auto &[_, defn] : interp->types.enums) remove_from(defn.module, defn.methods);
+    return removed;
+}
+
+// Gives the definition everything else refers to the code of the one that's just been compiled in its place.
+static void reuse_function(Function_Definition *old_fn, Function_Definition *new_fn, std::unordered_set<UUID> &kept) {
+    old_fn->instructions = new_fn->instructions;
+    old_fn->unoptimized.clear();
+    old_fn->param_names = new_fn->param_names;
+    kept.insert(old_fn->uuid);
+}
+
+static void reuse_methods(Interpreter *interp, Module *module, Methods &old_methods, const Methods &new_methods, std::unordered_set<UUID> &kept) {
+    for (auto &[name, method] : new_methods) {
+        auto fn = interp->functions.get_func_by_uuid(method.uuid);
+        if (fn->module != module) continue;
+
+        reuse_function(interp->functions.get_func_by_uuid(old_methods.at(name).uuid), fn, kept);
+    }
+}
+
+// Points the module's members back at the definitions from its last compile, which has the same interface.
+static void reuse_compiled_members(Interpreter *interp, Module *module, std::unordered_set<UUID> &kept) {
+    for (auto &[id, member] : module->members) {
+        auto &old = module->compiled_members.at(id);
+        switch (member.kind) {
+            case Module::Member::Function:
+                reuse_function(interp->functions.get_func_by_uuid(old.uuid), interp->functions.get_func_by_uuid(member.uuid), kept);
+                break;
+            case Module::Member::Struct: {
+                auto old_defn = interp->types.get_struct_by_uuid(old.uuid);
+                reuse_methods(interp, module, old_defn->methods, interp->types.get_struct_by_uuid(member.uuid)->methods, kept);
+                kept.insert(old.uuid);
+            } break;
+            case Module::Member::Enum: {
+                auto old_defn = interp->types.get_enum_by_uuid(old.uuid);
+                reuse_methods(interp, module, old_defn->methods, interp->types.get_enum_by_uuid(member.uuid)->methods, kept);
+                kept.insert(old.uuid);
+            } break;
+            case Module::Member::Submodule:
+                break;
+        }
+        member.uuid = old.uuid;
+    }
+}
+
+// Same as above for the methods added to other modules' types that haven't changed.
+static void reuse_added_methods(Interpreter *interp, Module *module, const std::vector<Added_Method> &added, std::unordered_set<UUID> &kept) {
+    for (auto &old : added) {
+        auto it = old.methods->find(old.name);
+        if (it == old.methods->end() || it->second.is_static != old.method.is_static) continue;
+
+        auto old_fn = interp->functions.get_func_by_uuid(old.method.uuid);
+        auto new_fn = interp->functions.get_func_by_uuid(it->second.uuid);
+        if (new_fn->module != module) continue;
+
+        std::string old_signature, new_signature;
+        describe_function(old_signature, old_fn, module);
+        describe_function(new_signature, new_fn, module);
+        if (old_signature != new_signature) continue;
+
+        reuse_function(old_fn, new_fn, kept);
+        it->second.uuid = old_fn->uuid;
+    }
+}
+
+static uint64_t hash_file(const char *path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    std::string source { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    return hash_bytes(source.data(), source.size());
+}
+
+static void recompile_module(Interpreter *interp, Module *module) {
+    auto parsed = parse_module(module->module_path.c_str());
+    interp->add_source(module->module_path.str())->hash = parsed.hash;
+
+    // a compile that failed leaves the members from the one before it to go back to
+    if (!module->stale) {
+        module->compiled_members = module->members;
+    }
+
+    Definitions previous = definitions_of(interp, module);
+    std::unordered_set<UUID> previous_uuids;
+    for (auto fn : previous.funcs) previous_uuids.insert(fn->uuid);
+    previous_uuids.insert(previous.structs.begin(), previous.structs.end());
+    previous_uuids.insert(previous.enums.begin(), previous.enums.end());
+    previous_uuids.insert(previous.traits.begin(), previous.traits.end());
+
+    Function_Definition top_level = module->top_level;
+    auto imports = module->imports;
+    auto added = remove_added_methods(interp, module);
+
+    module->source_hash = parsed.hash;
+    module->members.clear();
+    module->imports.clear();
+    module->top_level.instructions.clear();
+    module->top_level.unoptimized.clear();
+    try {
+        interp->build_module(module, parsed.ast);
+    } catch (const Recoverable_Error &) {
+        // back how it was so nothing refers to what didn't compile, it's still stale so it's compiled again next pass
+        remove_added_methods(interp, module);
+        drop_definitions(interp, definitions_of(interp, module), previous_uuids);
+        for (auto &old : added) {
+            (*old.methods)[old.name] = old.method;
+        }
+        module->members = module->compiled_members;
+        module->imports = imports;
+        module->top_level = top_level;
+        throw;
+    }
+
+    std::unordered_set<UUID> kept;
+    auto same_interface =
+        describe_interface(interp, module, module->compiled_members, true) ==
+        describe_interface(interp, module, module->members, true);
+    if (same_interface) {
+        reuse_compiled_members(interp, module, kept);
+        // traits aren't members but the types of kept definitions can refer to them
+        kept.insert(previous.traits.begin(), previous.traits.end());
+        // the kept types still have the methods other modules added to them
+        update_interfaces(interp, module);
+    }
+    reuse_added_methods(interp, module, added, kept);
+    drop_definitions(interp, previous, kept);
+
+    for (auto &old : added) {
+        std::string interface = describe_interface(interp, old.owner, old.owner->members, false);
+        old.owner->interface_hash = hash_bytes(interface.data(), interface.size());
+    }
+}
+
+void update_module(Interpreter *interp, Module *module) {
+    if (module->pass == interp->pass) return;
+    module->pass = interp->pass;
+
+    // imports first so their interfaces are current by the time they're compared
+    for (size_t i = 0; i < module->imports.size(); i++) {
+        update_module(interp, module->imports[i].module);
+    }
+
+    bool changed = module->stale || hash_file(module->module_path.c_str()) != module->source_hash;
+    for (auto &import : module->imports) {
+        changed = changed || import.interface_hash != import.module->interface_hash;
+    }
+
+    if (changed) {
+        recompile_module(interp, module);
+    }
+}
+
+static void drop_module(Interpreter *interp, Module *module) {
+    remove_added_methods(interp, module);
+    drop_definitions(interp, definitions_of(interp, module), {});
+
+    // the modules made for the directories in an import path
+    for (auto &[_, other] : interp->modules.modules) {
+        for (auto it = other.members.begin(); it != other.members.end();) {
+            if (it->second.kind == Module::Member::Submodule && it->second.uuid == module->uuid) {
+                it = other.members.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    interp->modules.path_map.erase(module->module_path.str());
+    interp->modules.modules.erase(module->uuid);
+}
+
+// Drops the modules the program no longer imports, and the sources that went with them, so they're compiled again if it starts to.
+static void drop_unreachable_modules(Interpreter *interp, Module *main) {
+    std::unordered_set<Module *> reachable;
+    std::vector<Module *> queue = { main };
+    while (!queue.empty()) {
+        Module *module = queue.back();
+        queue.pop_back();
+        if (!reachable.insert(module).second) continue;
+
+        for (auto &import : module->imports) {
+            queue.push_back(import.module);
+        }
+    }
+
+    auto &sources = interp->sources;
+    for (size_t i = 0; i < sources.size();) {
+        auto it = interp->modules.path_map.find(sources[i].path);
+        Module *module = it != interp->modules.path_map.end() ? it->second : nullptr;
+        if (reachable.count(module)) {
+            i++;
+            continue;
+        }
+
+        if (module) {
+            drop_module(interp, module);
+        }
+        sources.erase(sources.begin() + i);
+    }
+}
+
+// Whether what every module was compiled against is still what it imports.
+static bool is_consistent(Interpreter *interp) {
+    for (auto &[_, module] : interp->modules.modules) {
+        for (auto &import : module.imports) {
+            if (import.interface_hash != import.module->interface_hash) return false;
+        }
+    }
+    return true;
+}
+
+Module *update_program(Interpreter *interp, const char *path) {
+    try {
+        //
+        // Going round again is only needed when a module has added methods to
+        // the types of one it doesn't import, and so could have been
+        // compiled before it, or when modules import each other.
+        //
+        Module *module;
+        do {
+            interp->pass++;
+            module = interp->compile_module(const_cast<char *>(path));
+            drop_unreachable_modules(interp, module);
+        } while (!is_consistent(interp));
+        return module;
+    } catch (const Recoverable_Error &) {
+        return nullptr;
+    }
+}
+
+void prepare_to_optimize(Interpreter *interp, Module *module) {
+    // functions compiled, or given new code, since the last pass haven't had their code as compiled kept yet
+    std::vector<bool> changed(interp->functions.table.size());
+    for (auto &[_, fn] : interp->functions.funcs) {
+        if (fn.unoptimized.empty()) {
+            fn.unoptimized = fn.instructions;
+            changed[fn.index] = true;
+        }
+    }
+
+    // as do the functions calling them, which might have inlined the old code
+    auto reset = [&](Function_Definition &fn, bool is_changed) {
+        if (!is_changed) {
+            for (auto &inst : decode_instructions(fn.unoptimized)) {
+                if (inst.op == Opcode::Call_Direct && changed[inst.value]) {
+                    is_changed = true;
+                    break;
+                }
+            }
+        }
+        if (is_changed) {
+            fn.instructions = fn.unoptimized;
+            fn.frame_size = 0;
+            fn.optimized = false;
+        }
+        fn.hotness = 0;
+        fn.native = nullptr;
+    };
+
+    bool top_level_changed = module->top_level.unoptimized.empty();
+    if (top_level_changed) {
+        module->top_level.unoptimized = module->top_level.instructions;
+    }
+    reset(module->top_level, top_level_changed);
+    for (auto &[_, fn] : interp->functions.funcs) {
+        reset(fn, changed[fn.index]);
+    }
+}
+
+void wait_for_change(Interpreter *interp) {
+    constexpr auto Poll_Interval = std::chrono::milliseconds(100);
+
+    std::vector<uint64_t> hashes;
+    for (auto &source : interp->sources) {
+        hashes.push_back(hash_file(source.path.c_str()));
+    }
+
+    while (true) {
+        std::this_thread::sleep_for(Poll_Interval);
+        for (size_t i = 0; i < hashes.size(); i++) {
+            if (hash_file(interp->sources[i].path.c_str()) != hashes[i]) return;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+//
+//  watch.h
+//  Fox
+//
+//  Created by Denver Lacey on 16/10/26.
+//  Copyright © 2026 Denver Lacey. All rights reserved.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+struct Interpreter;
+struct Module;
+
+//
+// --watch keeps a program compiled between runs and, when a source changes,
+// only compiles again the modules that could be affected. Every module keeps
+// the hash of its source, the modules it imports and the interface_hash() each
+// of them had when it was compiled, so a module is compiled again when its
+// source has changed or an import's interface has.
+//
+// When a module compiles to the same interface it had before, its members are
+// pointed back at the definitions from before, which get its new code, so the
+// modules importing it can go on using them without being compiled again.
+// Everything else it defined before is dropped.
+//
+
+//
+// Brings the program at `path`, and everything it imports, up to date and
+// returns its main module. Returns nullptr if it failed to compile, the error
+// has been reported by then and the modules it got to are compiled again next
+// time.
+//
+Module *update_program(Interpreter *interp, const char *path);
+
+// Recompiles `module` if it, or the interface of anything it imports, has changed since the last pass. Called by compile_module().
+void update_module(Interpreter *interp, Module *module);
+
+// Called once a module has compiled. Hashes its interface and those of the modules whose types it has added methods to.
+void update_interfaces(Interpreter *interp, Module *module);
+
+// Puts the functions that have changed since the last pass, and those calling them, back how they were compiled so they're optimized again.
+void prepare_to_optimize(Interpreter *interp, Module *module);
+
+// Blocks until one of the program's sources changes.
+void wait_for_change(Interpreter *interp);